@@ -0,0 +1,224 @@
+#include "Chunker.h"
+#include <algorithm>
+#include <cstring>
+#include <util/assert.h>
+
+namespace sp {
+//=====================================
+namespace {
+struct GearTable {
+  std::uint64_t table[256];
+};
+} // namespace
+
+static constexpr GearTable
+make_gear_table() noexcept {
+  /* splitmix64 */
+  GearTable result{};
+  std::uint64_t state = 0x6A09E667F3BCC908ull;
+  for (std::size_t i = 0; i < 256; ++i) {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    result.table[i] = z ^ (z >> 31);
+  }
+
+  return result;
+}
+
+static constexpr GearTable gear = make_gear_table();
+
+static std::size_t
+chunker_log2(std::size_t in) noexcept {
+  std::size_t result = 0;
+  while (in > 1) {
+    in >>= 1;
+    ++result;
+  }
+  return result;
+}
+
+/* The $bits most significant bits, which depend on the most bytes */
+static std::uint64_t
+mask_of(std::size_t bits) noexcept {
+  if (bits == 0) {
+    return 0;
+  }
+  return ~std::uint64_t(0) << (64 - bits);
+}
+
+//=====================================
+Chunk::Chunk() noexcept
+    : offset{0}
+    , length{0}
+    , fingerprint{0} {
+}
+
+Chunker::Chunker(std::size_t mi, std::size_t av, std::size_t ma) noexcept
+    : min{mi}
+    , avg{std::size_t(1) << chunker_log2(av)}
+    , max{ma}
+    /* normalization level 2 */
+    , mask_small{mask_of(chunker_log2(av) + 2)}
+    , mask_large{mask_of(chunker_log2(av) > 2 ? chunker_log2(av) - 2 : 0)}
+    , hash{0}
+    , offset{0}
+    , length{0}
+    , fingerprint{} {
+  assertxs(min <= avg && avg <= max, min, avg, max);
+  assertxs(max <= UINT32_MAX, max);
+}
+
+//=====================================
+static void
+emit(Chunker &self, Chunk &result) noexcept {
+  result.offset = self.offset;
+  result.length = std::uint32_t(self.length);
+  result.fingerprint = final(self.fingerprint);
+
+  self.offset += self.length;
+  self.length = 0;
+  self.hash = 0;
+  init(self.fingerprint);
+}
+
+std::size_t
+next(Chunker &self, const unsigned char *buffer, std::size_t length,
+     Chunk &result, bool &cut) noexcept {
+  cut = false;
+  std::size_t i = 0;
+
+  /* cut point skipping */
+  if (self.length < self.min) {
+    i = std::min(self.min - self.length, length);
+  }
+
+  std::uint64_t hash = self.hash;
+  const std::size_t small_end =
+      self.length < self.avg ? self.avg - self.length : 0;
+  const std::size_t large_end = self.max - self.length;
+
+  const std::size_t end1 = std::min(small_end, length);
+  for (; i < end1; ++i) {
+    hash = (hash << 1) + gear.table[buffer[i]];
+    if (!(hash & self.mask_small)) {
+      ++i;
+      cut = true;
+      break;
+    }
+  }
+
+  if (!cut) {
+    const std::size_t end2 = std::min(large_end, length);
+    for (; i < end2; ++i) {
+      hash = (hash << 1) + gear.table[buffer[i]];
+      if (!(hash & self.mask_large)) {
+        ++i;
+        cut = true;
+        break;
+      }
+    }
+  }
+
+  update(self.fingerprint, buffer, i);
+  self.length += i;
+  self.hash = hash;
+
+  if (!cut && self.length == self.max) {
+    cut = true;
+  }
+
+  if (cut) {
+    emit(self, result);
+  }
+
+  return i;
+}
+
+bool
+finish(Chunker &self, Chunk &result) noexcept {
+  if (self.length == 0) {
+    return false;
+  }
+
+  emit(self, result);
+  return true;
+}
+
+//=====================================
+static bool
+write(Sink &out, const Chunk &chunk) noexcept {
+  unsigned char record[16];
+  std::memcpy(record, &chunk.offset, 8);
+  std::memcpy(record + 8, &chunk.length, 4);
+  std::memcpy(record + 12, &chunk.fingerprint, 4);
+  return write(out, record, sizeof(record));
+}
+
+/* undo next() or finish() */
+static void
+restore(Chunker &self, const Chunker &saved) noexcept {
+  self.hash = saved.hash;
+  self.offset = saved.offset;
+  self.length = saved.length;
+  self.fingerprint = saved.fingerprint;
+}
+
+bool
+chunk(Chunker &self, Thing &in, Sink &out) noexcept {
+  assertx(!is_marked(in));
+  CircularByteBuffer &buffer = in.buffer;
+
+  while (true) {
+    if (remaining_read(buffer) == 0) {
+      if (!in.fill || !in.fill(buffer, in.arg) || remaining_read(buffer) == 0) {
+        break;
+      }
+    }
+
+    /* zero-copy, scan the readable segments in place */
+    CircularByteBuffer::BufferArray segments;
+    if (!read_buffer(buffer, segments)) {
+      break;
+    }
+
+    std::size_t consumed = 0;
+    for (std::size_t s = 0; s < length(segments); ++s) {
+      const unsigned char *it = std::get<0>(segments[s]);
+      std::size_t remaining = std::get<1>(segments[s]);
+
+      while (remaining > 0) {
+        /* the chunker and $in only move past a cut once its record is
+         * written, a retry finds the same cut again */
+        const Chunker before(self);
+        Chunk current;
+        bool cut = false;
+        const std::size_t n = next(self, it, remaining, current, cut);
+
+        if (cut && !write(out, current)) {
+          restore(self, before);
+          consume_bytes(buffer, consumed);
+          return false;
+        }
+
+        it += n;
+        remaining -= n;
+        consumed += n;
+      }
+    }
+
+    consume_bytes(buffer, consumed);
+  }
+
+  const Chunker before(self);
+  Chunk last;
+  if (finish(self, last) && !write(out, last)) {
+    restore(self, before);
+    return false;
+  }
+
+  return true;
+}
+
+//=====================================
+} // namespace sp
@@ -0,0 +1,86 @@
+#ifndef SP_UTIL_BUFFER_CHUNKER_H
+#define SP_UTIL_BUFFER_CHUNKER_H
+
+#include <buffer/Sink.h>
+#include <buffer/Thing.h>
+#include <cstddef>
+#include <cstdint>
+#include <hash/crc.h>
+
+/*
+ * Content defined chunking, FastCDC.
+ *
+ * A gear hash, h = (h << 1) + G[byte], is rolled over the input and a chunk
+ * boundary is declared where the masked bits of h are zero. Since the hash
+ * only depends on the last 64 bytes the boundaries are determined by the
+ * content, inserting a byte only moves the boundaries near the insertion.
+ *
+ * - The first $min bytes of a chunk are not hashed(cut point skipping)
+ * - Before $avg a mask with more bits is used and after $avg one with fewer
+ *   bits(normalized chunking), which concentrates the sizes around $avg
+ * - A chunk is cut at $max regardless of content
+ *
+ * Every chunk gets a crc32c fingerprint. It is meant to find duplicate
+ * candidates, a candidate should be verified before it is trusted.
+ *
+ * # ref
+ * https://www.usenix.org/system/files/conference/atc16/atc16-paper-xia.pdf
+ */
+namespace sp {
+//=====================================
+struct Chunk {
+  /* stream offset of the first byte */
+  std::uint64_t offset;
+  std::uint32_t length;
+  std::uint32_t fingerprint;
+
+  Chunk() noexcept;
+};
+
+//=====================================
+struct Chunker {
+  /* $avg is rounded to the nearest lower power of 2 */
+  const std::size_t min;
+  const std::size_t avg;
+  const std::size_t max;
+  const std::uint64_t mask_small;
+  const std::uint64_t mask_large;
+
+  /* current chunk */
+  std::uint64_t hash;
+  std::uint64_t offset;
+  std::size_t length;
+  crc32c::Context fingerprint;
+
+  Chunker(std::size_t min, std::size_t avg, std::size_t max) noexcept;
+};
+
+//=====================================
+/* Scan at most $length bytes and returns the number of bytes belonging to the
+ * current chunk. If the chunk ended $result is set and the chunker is reset
+ * for the next chunk.
+ */
+std::size_t
+next(Chunker &, const unsigned char *, std::size_t length, Chunk &result,
+     bool &cut) noexcept;
+
+/* End of stream, returns false if there is no pending chunk */
+bool
+finish(Chunker &, Chunk &result) noexcept;
+
+//=====================================
+/* Chunks the whole of $in until no more data can be filled, and for each
+ * chunk writes a 16 byte record to $out:
+ *   [offset:u64][length:u32][fingerprint:u32] (native byte order)
+ * The input is scanned in place in the CircularByteBuffer of $in, which may
+ * not be marked. Returns false if $out could not be written, the chunker and
+ * $in are then left before the chunk whose record failed so the call can be
+ * retried.
+ */
+bool
+chunk(Chunker &, Thing &in, Sink &out) noexcept;
+
+//=====================================
+} // namespace sp
+
+#endif
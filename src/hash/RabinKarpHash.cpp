@@ -1,15 +1,94 @@
 #include "RabinKarpHash.h"
+#include <new>
 #include <util/array.h>
 #include <util/assert.h>
 
 namespace sp {
 //=====================================
-RabinKarpHash::RabinKarpHash(std::size_t c) noexcept
+/* https://github.com/lemire/rollinghashcpp/blob/master/rabinkarphash.h
+ * https://github.com/lemire/rollinghashcpp/blob/master/cyclichash.h
+ */
+namespace {
+struct BuzhashTable {
+  std::uint64_t table[256];
+};
+} // namespace
+
+static constexpr BuzhashTable
+make_buzhash_table() noexcept {
+  /* splitmix64 */
+  BuzhashTable result{};
+  std::uint64_t state = 0x2545F4914F6CDD1Dull;
+  for (std::size_t i = 0; i < 256; ++i) {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    result.table[i] = z ^ (z >> 31);
+  }
+
+  return result;
+}
+
+static constexpr BuzhashTable buzhash = make_buzhash_table();
+
+static constexpr std::uint64_t mersenne61 = (std::uint64_t(1) << 61) - 1;
+static constexpr std::uint64_t base = 0x1b2f3c4d5e6f7a8bull % mersenne61;
+
+__extension__ typedef unsigned __int128 uint128_t;
+
+/* a * b mod 2^61-1, a,b < 2^61-1 */
+static std::uint64_t
+mul_mod(std::uint64_t a, std::uint64_t b) noexcept {
+  const uint128_t r = uint128_t(a) * b;
+  std::uint64_t result =
+      std::uint64_t(r & mersenne61) + std::uint64_t(r >> 61);
+  if (result >= mersenne61) {
+    result -= mersenne61;
+  }
+  return result;
+}
+
+static std::uint64_t
+add_mod(std::uint64_t a, std::uint64_t b) noexcept {
+  std::uint64_t result = a + b;
+  if (result >= mersenne61) {
+    result -= mersenne61;
+  }
+  return result;
+}
+
+static std::uint64_t
+rotl(std::uint64_t in, std::uint64_t n) noexcept {
+  n &= 63;
+  return n == 0 ? in : (in << n) | (in >> (64 - n));
+}
+
+/* bytes are offset by one so that a run of zero bytes does not hash to 0 */
+static std::uint64_t
+value_of(char c) noexcept {
+  return std::uint64_t((unsigned char)c) + 1;
+}
+
+//=====================================
+RabinKarpHash::RabinKarpHash(std::size_t c, RollingHash t) noexcept
     : length{0}
     , capacity{c}
     , hash{0}
-    , buffer{nullptr} {
-  buffer = new char[capacity];
+    , type{t}
+    , out_factor{0}
+    , buffer{nullptr}
+    , head{0} {
+  assertx(capacity > 0);
+  buffer = new (std::nothrow) unsigned char[capacity];
+
+  if (type == RollingHash::POLYNOMIAL) {
+    out_factor = 1;
+    for (std::size_t i = 1; i < capacity; ++i) {
+      out_factor = mul_mod(out_factor, base);
+    }
+  } else {
+    out_factor = capacity & 63;
+  }
 }
 
 RabinKarpHash::~RabinKarpHash() noexcept {
@@ -19,47 +98,99 @@ RabinKarpHash::~RabinKarpHash() noexcept {
   }
 }
 
+//=====================================
+void
+push(RabinKarpHash &self, char in) noexcept {
+  assertxs(self.length < self.capacity, self.length, self.capacity);
+
+  if (self.type == RollingHash::POLYNOMIAL) {
+    self.hash = add_mod(mul_mod(self.hash, base), value_of(in));
+  } else {
+    self.hash = rotl(self.hash, 1) ^ buzhash.table[(unsigned char)in];
+  }
+
+  self.buffer[(self.head + self.length) % self.capacity] = (unsigned char)in;
+  ++self.length;
+}
+
+void
+roll(RabinKarpHash &self, char out, char in) noexcept {
+  assertxs(self.length == self.capacity, self.length, self.capacity);
+  assertxs(self.buffer[self.head] == (unsigned char)out, self.head);
+
+  if (self.type == RollingHash::POLYNOMIAL) {
+    const std::uint64_t removed = mul_mod(value_of(out), self.out_factor);
+    const std::uint64_t h = add_mod(self.hash, mersenne61 - removed);
+    self.hash = add_mod(mul_mod(h, base), value_of(in));
+  } else {
+    self.hash = rotl(self.hash, 1) ^
+                rotl(buzhash.table[(unsigned char)out], self.out_factor) ^
+                buzhash.table[(unsigned char)in];
+  }
+
+  self.buffer[self.head] = (unsigned char)in;
+  if (++self.head == self.capacity) {
+    self.head = 0;
+  }
+}
+
 //=====================================
 const char *
 update(RabinKarpHash &self, const char *begin, const char *end) noexcept {
-  assertxs(self.buffer, self.length, self.capacity);
-  assertx(begin < end);
-
-  /* https://github.com/lemire/rollinghashcpp/blob/master/rabinkarphash.h
-   * constexpr std::uint32_t B = 37;
-   * constexpr std::uint32_t HASHMASK =
-   *
-   * std::uint32_t x = 1;
-   * while (begin != end) {
-   *   x = (x * B) & HASHMASK;
-   *
-   *   if (self.length == self.capacity) {
-   *     break;
-   *   }
-   *   ++self.length;
-   * }
-   *
-   * x = (x * hasher.hashvalues[c[k]]) & HASHMASK;
-   * self.hash = (self.hash + x) & HASHMASK;
-   */
-
-  return nullptr;
+  assertx(begin <= end);
+
+  if (!self.buffer || begin == end) {
+    return begin;
+  }
+
+  if (self.length == self.capacity) {
+    roll(self, char(self.buffer[self.head]), *begin);
+    return begin + 1;
+  }
+
+  for (; begin != end && self.length < self.capacity; ++begin) {
+    push(self, *begin);
+  }
+
+  return begin;
 }
 
 std::size_t
 update(RabinKarpHash &self, const char *buffer, std::size_t len) noexcept {
-  assertxs(self.buffer, self.length, self.capacity);
   const char *const end = buffer + len;
   const char *const it = update(self, buffer, end);
   return sp::distance(buffer, it);
 }
 
 //=====================================
-std::uint32_t
+void
+clear(RabinKarpHash &self) noexcept {
+  self.length = 0;
+  self.head = 0;
+  self.hash = 0;
+}
+
+//=====================================
+std::uint64_t
 hash(const RabinKarpHash &self) noexcept {
   assertxs(self.length == self.capacity, self.length, self.capacity);
   return self.hash;
 }
 
+//=====================================
+std::uint64_t
+rolling_hash(RollingHash type, const char *buffer, std::size_t len) noexcept {
+  std::uint64_t result = 0;
+  for (std::size_t i = 0; i < len; ++i) {
+    if (type == RollingHash::POLYNOMIAL) {
+      result = add_mod(mul_mod(result, base), value_of(buffer[i]));
+    } else {
+      result = rotl(result, 1) ^ buzhash.table[(unsigned char)buffer[i]];
+    }
+  }
+
+  return result;
+}
+
 //=====================================
 } // namespace sp
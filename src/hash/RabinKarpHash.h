@@ -1,21 +1,70 @@
+#ifndef SP_UTIL_HASH_RABIN_KARP_HASH_H
+#define SP_UTIL_HASH_RABIN_KARP_HASH_H
+
 #include <cstddef>
 #include <cstdint>
 
-// TODO implement
-// TODO document
+/*
+ * Rolling hash over a fixed size window of the last $capacity bytes, moving
+ * the window one byte is O(1) regardless of the window size.
+ *
+ * POLYNOMIAL: Rabin-Karp, h = sum(c[i] * B^(w-1-i)) mod 2^61-1
+ *   roll: h = (h - out * B^(w-1)) * B + in
+ * BUZHASH: cyclic polynomial over GF(2), h = xor(rotl(T[c[i]], w-1-i)) where
+ *   T is a table of random 64 bit values
+ *   roll: h = rotl(h, 1) ^ rotl(T[out], w) ^ T[in]
+ *
+ * Buzhash is cheaper to roll(no multiply), the polynomial hash has
+ * provably low collision probability for a random base.
+ */
 namespace sp {
+//=====================================
+enum class RollingHash { POLYNOMIAL, BUZHASH };
+
 //=====================================
 struct RabinKarpHash {
+  /* number of bytes in the window, <= capacity */
   std::size_t length;
+  /* window size */
   const std::size_t capacity;
-  std::uint32_t hash;
-  char *buffer;
+  std::uint64_t hash;
+  const RollingHash type;
+  /* POLYNOMIAL: B^(w-1) mod 2^61-1, BUZHASH: w mod 64 */
+  std::uint64_t out_factor;
+  /* the window contents, circular with $head as the oldest byte, null if the
+   * allocation failed */
+  unsigned char *buffer;
+  std::size_t head;
+
+  explicit RabinKarpHash(std::size_t window,
+                         RollingHash = RollingHash::POLYNOMIAL) noexcept;
+
+  RabinKarpHash(const RabinKarpHash &) = delete;
+  RabinKarpHash(const RabinKarpHash &&) = delete;
+
+  RabinKarpHash &
+  operator=(const RabinKarpHash &) = delete;
+  RabinKarpHash &
+  operator=(const RabinKarpHash &&) = delete;
 
-  explicit RabinKarpHash(std::size_t c) noexcept;
   ~RabinKarpHash() noexcept;
 };
 
 //=====================================
+/* Append $in to a non full window */
+void
+push(RabinKarpHash &self, char in) noexcept;
+
+/* Slide a full window one byte, $out is the oldest byte in the window which is
+ * removed and $in the byte appended */
+void
+roll(RabinKarpHash &self, char out, char in) noexcept;
+
+//=====================================
+/* Consume input until the window is full, if the window already is full it is
+ * rolled by one byte. Returns the position after the last consumed byte,
+ * nothing is consumed if the window buffer could not be allocated.
+ */
 const char *
 update(RabinKarpHash &self, const char *begin, const char *end) noexcept;
 
@@ -23,8 +72,21 @@ std::size_t
 update(RabinKarpHash &self, const char *buffer, std::size_t len) noexcept;
 
 //=====================================
-std::uint32_t
+void
+clear(RabinKarpHash &self) noexcept;
+
+//=====================================
+/* The hash of the window, requires a full window */
+std::uint64_t
 hash(const RabinKarpHash &self) noexcept;
 
+//=====================================
+/* The hash of $buffer as if it was pushed into an empty RabinKarpHash of
+ * window $len */
+std::uint64_t
+rolling_hash(RollingHash, const char *buffer, std::size_t len) noexcept;
+
 //=====================================
 } // namespace sp
+
+#endif
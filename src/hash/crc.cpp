@@ -1,9 +1,17 @@
 #include "crc.h"
+#include <algorithm>
 #include <cstddef>
 #include <cstring>
 #include <memory>
 #include <util/assert.h>
 
+#include <pthread.h>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#include <nmmintrin.h>
+#endif
+
 // https://github.com/Michaelangel007/crc32
 // http://www.ross.net/crc/download/crc_v3.txt
 
@@ -90,21 +98,438 @@ crc(const void *b, std::size_t length, std::uint32_t polynomial) noexcept {
   return ~crc;
 }
 
+//=====================================
+/*
+ * Table driven, slicing-by-N
+ *
+ * table[0] is the classic byte-at-a-time table where table[0][b] is the CRC
+ * of the byte b. table[k][b] is the CRC of the byte b followed by k zero
+ * bytes, which makes it possible to look up N independent bytes and xor the
+ * results together instead of doing N dependent lookups.
+ *
+ * The functions below operate on the raw CRC register, the caller does the
+ * initial and final inversion.
+ */
+namespace {
+struct CrcTable {
+  crc32_t table[16][256];
+};
+} // namespace
+
+static constexpr CrcTable
+make_table(crc32_t polynomial) noexcept {
+  CrcTable result{};
+  for (crc32_t i = 0; i < 256; ++i) {
+    crc32_t crc = i;
+    for (std::size_t bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ ((crc & 1) ? polynomial : 0);
+    }
+    result.table[0][i] = crc;
+  }
+
+  for (std::size_t k = 1; k < 16; ++k) {
+    for (std::size_t i = 0; i < 256; ++i) {
+      const crc32_t prev = result.table[k - 1][i];
+      result.table[k][i] = (prev >> 8) ^ result.table[0][prev & 0xff];
+    }
+  }
+
+  return result;
+}
+
+static constexpr CrcTable crc32c_table = make_table(0x82F63B78);
+static constexpr CrcTable crc32_table = make_table(0xEDB88320);
+
+static inline crc32_t
+read32(const byte *it) noexcept {
+  crc32_t result;
+  std::memcpy(&result, it, sizeof(result));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  result = __builtin_bswap32(result);
+#endif
+  return result;
+}
+
+static crc32_t
+crc_bytes(const CrcTable &t, crc32_t crc, const byte *it,
+          std::size_t length) noexcept {
+  while (length--) {
+    crc = (crc >> 8) ^ t.table[0][(crc ^ *it++) & 0xff];
+  }
+
+  return crc;
+}
+
+static crc32_t
+crc_slicing8(const CrcTable &t, crc32_t crc, const byte *it,
+             std::size_t length) noexcept {
+  for (; length >= 8; length -= 8, it += 8) {
+    const crc32_t one = read32(it) ^ crc;
+    const crc32_t two = read32(it + 4);
+
+    crc = t.table[7][one & 0xff] ^ t.table[6][(one >> 8) & 0xff] ^
+          t.table[5][(one >> 16) & 0xff] ^ t.table[4][one >> 24] ^
+          t.table[3][two & 0xff] ^ t.table[2][(two >> 8) & 0xff] ^
+          t.table[1][(two >> 16) & 0xff] ^ t.table[0][two >> 24];
+  }
+
+  return crc_bytes(t, crc, it, length);
+}
+
+static crc32_t
+crc_slicing16(const CrcTable &t, crc32_t crc, const byte *it,
+              std::size_t length) noexcept {
+  for (; length >= 16; length -= 16, it += 16) {
+    const crc32_t one = read32(it) ^ crc;
+    const crc32_t two = read32(it + 4);
+    const crc32_t three = read32(it + 8);
+    const crc32_t four = read32(it + 12);
+
+    crc = t.table[15][one & 0xff] ^ t.table[14][(one >> 8) & 0xff] ^
+          t.table[13][(one >> 16) & 0xff] ^ t.table[12][one >> 24] ^
+          t.table[11][two & 0xff] ^ t.table[10][(two >> 8) & 0xff] ^
+          t.table[9][(two >> 16) & 0xff] ^ t.table[8][two >> 24] ^
+          t.table[7][three & 0xff] ^ t.table[6][(three >> 8) & 0xff] ^
+          t.table[5][(three >> 16) & 0xff] ^ t.table[4][three >> 24] ^
+          t.table[3][four & 0xff] ^ t.table[2][(four >> 8) & 0xff] ^
+          t.table[1][(four >> 16) & 0xff] ^ t.table[0][four >> 24];
+  }
+
+  return crc_bytes(t, crc, it, length);
+}
+
+//=====================================
+#if defined(__x86_64__)
+__attribute__((target("sse4.2"))) static crc32_t
+crc_sse42(crc32_t crc, const byte *it, std::size_t length) noexcept {
+  std::uint64_t crc64 = crc;
+  for (; length >= 8; length -= 8, it += 8) {
+    std::uint64_t current;
+    std::memcpy(&current, it, sizeof(current));
+    crc64 = _mm_crc32_u64(crc64, current);
+  }
+
+  crc = crc32_t(crc64);
+  while (length--) {
+    crc = _mm_crc32_u8(crc, *it++);
+  }
+
+  return crc;
+}
+#endif
+
+static bool
+cpu_has_sse42() noexcept {
+#if defined(__x86_64__)
+  unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+  if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+    return (ecx & bit_SSE4_2) != 0;
+  }
+#endif
+  return false;
+}
+
+//=====================================
+/*
+ * CRC combine, GF(2) polynomial arithmetic modulo the CRC polynomial.
+ *
+ * Appending n zero bytes to a message multiplies its (raw) CRC by x^(8n), so
+ *   crc(AB) = crc(A) * x^(8 len(B)) + crc(B)  (mod P)
+ * where the initial/final inversion cancels out. x^(8n) is computed by square
+ * and multiply using a table of x^(2^k).
+ *
+ * Polynomials are in the reflected representation, x^0 is the MSB.
+ */
+namespace {
+struct X2nTable {
+  crc32_t table[32];
+};
+} // namespace
+
+/* a * b mod P */
+static constexpr crc32_t
+multmodp(crc32_t a, crc32_t b, crc32_t polynomial) noexcept {
+  crc32_t m = crc32_t(1) << 31;
+  crc32_t p = 0;
+  while (m) {
+    if (a & m) {
+      p ^= b;
+    }
+    m >>= 1;
+    b = (b & 1) ? (b >> 1) ^ polynomial : b >> 1;
+  }
+
+  return p;
+}
+
+static constexpr X2nTable
+make_x2n_table(crc32_t polynomial) noexcept {
+  X2nTable result{};
+  /* x^1 */
+  crc32_t p = crc32_t(1) << 30;
+  for (std::size_t k = 0; k < 32; ++k) {
+    result.table[k] = p;
+    p = multmodp(p, p, polynomial);
+  }
+
+  return result;
+}
+
+static constexpr X2nTable crc32c_x2n = make_x2n_table(0x82F63B78);
+static constexpr X2nTable crc32_x2n = make_x2n_table(0xEDB88320);
+
+/* x^(n * 2^k) mod P */
+static crc32_t
+x2nmodp(const X2nTable &t, std::size_t n, std::size_t k,
+        crc32_t polynomial) noexcept {
+  /* x^0 */
+  crc32_t p = crc32_t(1) << 31;
+  while (n) {
+    if (n & 1) {
+      p = multmodp(t.table[k & 31], p, polynomial);
+    }
+    n >>= 1;
+    ++k;
+  }
+
+  return p;
+}
+
+static crc32_t
+crc_combine(const X2nTable &t, crc32_t polynomial, crc32_t crc_a,
+            crc32_t crc_b, std::size_t length_b) noexcept {
+  /* 8 * length_b = length_b * 2^3 */
+  return multmodp(x2nmodp(t, length_b, 3, polynomial), crc_a, polynomial) ^
+         crc_b;
+}
+
+//=====================================
+/*
+ * Parallel encode, every worker computes the crc of its own chunk and the
+ * chunk crcs are folded together in order using combine().
+ */
+namespace {
+struct CrcChunk {
+  std::uint32_t (*encode)(const void *, std::size_t);
+  const byte *buffer;
+  std::size_t length;
+  std::uint32_t crc;
+};
+} // namespace
+
+static void *
+crc_chunk_worker(void *arg) noexcept {
+  auto chunk = reinterpret_cast<CrcChunk *>(arg);
+  chunk->crc = chunk->encode(chunk->buffer, chunk->length);
+  return nullptr;
+}
+
+static crc32_t
+crc_parallel(std::uint32_t (*encode)(const void *, std::size_t),
+             std::uint32_t (*combine)(std::uint32_t, std::uint32_t,
+                                      std::size_t),
+             const byte *buffer, std::size_t length,
+             std::size_t threads) noexcept {
+  constexpr std::size_t min_chunk = 64 * 1024;
+  constexpr std::size_t max_threads = 64;
+
+  threads = std::min(threads, length / min_chunk);
+  threads = std::min(threads, max_threads);
+  if (threads <= 1) {
+    return encode(buffer, length);
+  }
+
+  CrcChunk chunks[max_threads];
+  pthread_t workers[max_threads];
+  bool started[max_threads] = {};
+
+  const std::size_t chunk_length = length / threads;
+  for (std::size_t i = 0; i < threads; ++i) {
+    chunks[i].encode = encode;
+    chunks[i].buffer = buffer + (i * chunk_length);
+    chunks[i].length = chunk_length;
+    chunks[i].crc = 0;
+  }
+  /* the last chunk takes the remainder */
+  chunks[threads - 1].length += length % threads;
+
+  for (std::size_t i = 1; i < threads; ++i) {
+    started[i] =
+        pthread_create(&workers[i], nullptr, crc_chunk_worker, &chunks[i]) == 0;
+  }
+
+  /* the calling thread does the first chunk and any worker which failed to
+   * start */
+  crc_chunk_worker(&chunks[0]);
+  for (std::size_t i = 1; i < threads; ++i) {
+    if (started[i]) {
+      pthread_join(workers[i], nullptr);
+    } else {
+      crc_chunk_worker(&chunks[i]);
+    }
+  }
+
+  crc32_t result = chunks[0].crc;
+  for (std::size_t i = 1; i < threads; ++i) {
+    result = combine(result, chunks[i].crc, chunks[i].length);
+  }
+
+  return result;
+}
+
+//=====================================
 namespace crc32c {
+using encode_fp = crc32_t (*)(crc32_t, const byte *, std::size_t);
+
+static crc32_t
+raw_slicing16(crc32_t crc, const byte *it, std::size_t length) noexcept {
+  return crc_slicing16(crc32c_table, crc, it, length);
+}
+
+static encode_fp
+select() noexcept {
+#if defined(__x86_64__)
+  if (cpu_has_sse42()) {
+    return crc_sse42;
+  }
+#endif
+  return raw_slicing16;
+}
+
+static crc32_t
+raw_update(crc32_t crc, const byte *it, std::size_t length) noexcept {
+  /* resolved once, on first use */
+  static const encode_fp impl = select();
+  return impl(crc, it, length);
+}
+
 std::uint32_t
 encode(const void *b, std::size_t len) noexcept {
+  return ~raw_update(~crc32_t(0), (const byte *)b, len);
+}
+
+std::uint32_t
+encode_bitwise(const void *b, std::size_t len) noexcept {
   // return crc_reversed<crc32_t>(b, len, crc32_t(0x1EDC6F41));
   crc32_t p(0x82F63B78);
   return crc<crc32_t>(b, len, p);
 }
+
+std::uint32_t
+encode_slicing8(const void *b, std::size_t len) noexcept {
+  return ~crc_slicing8(crc32c_table, ~crc32_t(0), (const byte *)b, len);
 }
 
-namespace crc32 {
+std::uint32_t
+encode_slicing16(const void *b, std::size_t len) noexcept {
+  return ~crc_slicing16(crc32c_table, ~crc32_t(0), (const byte *)b, len);
+}
+
+bool
+has_hardware() noexcept {
+  static const bool result = cpu_has_sse42();
+  return result;
+}
+
+std::uint32_t
+encode_hardware(const void *b, std::size_t len) noexcept {
+  assertx(has_hardware());
+#if defined(__x86_64__)
+  return ~crc_sse42(~crc32_t(0), (const byte *)b, len);
+#else
+  return encode_slicing16(b, len);
+#endif
+}
+
+//=====================================
+Context::Context() noexcept
+    : crc{~crc32_t(0)} {
+}
+
+void
+init(Context &self) noexcept {
+  self.crc = ~crc32_t(0);
+}
+
+void
+update(Context &self, const void *b, std::size_t len) noexcept {
+  self.crc = raw_update(self.crc, (const byte *)b, len);
+}
 
+std::uint32_t
+final(const Context &self) noexcept {
+  return ~self.crc;
+}
+
+//=====================================
+std::uint32_t
+combine(std::uint32_t crc_a, std::uint32_t crc_b,
+        std::size_t length_b) noexcept {
+  return crc_combine(crc32c_x2n, 0x82F63B78, crc_a, crc_b, length_b);
+}
+
+//=====================================
+std::uint32_t
+encode_parallel(const void *b, std::size_t len, std::size_t threads) noexcept {
+  return crc_parallel(encode, combine, (const byte *)b, len, threads);
+}
+} // namespace crc32c
+
+//=====================================
+namespace crc32 {
+/* The crc32 instruction only implements the CRC32C polynomial */
 std::uint32_t
 encode(const void *b, std::size_t len) noexcept {
+  return encode_slicing16(b, len);
+}
+
+std::uint32_t
+encode_bitwise(const void *b, std::size_t len) noexcept {
   // return crc_reversed<crc32_t>(b, len, crc32_t(0x04C11DB7));
   crc32_t p(0xEDB88320);
   return crc<crc32_t>(b, len, p);
 }
+
+std::uint32_t
+encode_slicing8(const void *b, std::size_t len) noexcept {
+  return ~crc_slicing8(crc32_table, ~crc32_t(0), (const byte *)b, len);
+}
+
+std::uint32_t
+encode_slicing16(const void *b, std::size_t len) noexcept {
+  return ~crc_slicing16(crc32_table, ~crc32_t(0), (const byte *)b, len);
+}
+
+//=====================================
+Context::Context() noexcept
+    : crc{~crc32_t(0)} {
+}
+
+void
+init(Context &self) noexcept {
+  self.crc = ~crc32_t(0);
+}
+
+void
+update(Context &self, const void *b, std::size_t len) noexcept {
+  self.crc = crc_slicing16(crc32_table, self.crc, (const byte *)b, len);
+}
+
+std::uint32_t
+final(const Context &self) noexcept {
+  return ~self.crc;
+}
+
+//=====================================
+std::uint32_t
+combine(std::uint32_t crc_a, std::uint32_t crc_b,
+        std::size_t length_b) noexcept {
+  return crc_combine(crc32_x2n, 0xEDB88320, crc_a, crc_b, length_b);
+}
+
+//=====================================
+std::uint32_t
+encode_parallel(const void *b, std::size_t len, std::size_t threads) noexcept {
+  return crc_parallel(encode, combine, (const byte *)b, len, threads);
 }
+} // namespace crc32
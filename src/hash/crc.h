@@ -1,18 +1,154 @@
 #ifndef SP_UTIL_HASH_CRC_H
 #define SP_UTIL_HASH_CRC_H
 
+#include <collection/Array.h>
+#include <cstddef>
 #include <cstdint>
+#include <tuple>
 
+/*
+ * encode() dispatches at runtime to the fastest available implementation:
+ * - hardware:  SSE4.2 crc32 instruction, CRC32C only (x86-64, checked using
+ *              CPUID)
+ * - slicing16: table driven, 16 bytes per iteration using 16 lookup tables
+ * - slicing8:  table driven, 8 bytes per iteration using 8 lookup tables
+ * - bitwise:   the reference implementation, one bit per iteration
+ *
+ * Fragmented input is hashed using a Context:
+ *   init(ctx); update(ctx, a, a_len); update(ctx, b, b_len); final(ctx)
+ * which is equal to encode() of the concatenated input. update() also
+ * accepts the segments of a CircularByteBuffer(see read_buffer()).
+ *
+ * combine(crc(A), crc(B), len(B)) computes crc(AB) in O(log(len(B))) without
+ * access to A or B, which makes it possible to checksum chunks in parallel.
+ */
 namespace crc32c {
-
 std::uint32_t
 encode(const void *buffer, std::size_t length) noexcept;
-}
 
-namespace crc32 {
+//=====================================
+std::uint32_t
+encode_bitwise(const void *buffer, std::size_t length) noexcept;
+
+std::uint32_t
+encode_slicing8(const void *buffer, std::size_t length) noexcept;
+
+std::uint32_t
+encode_slicing16(const void *buffer, std::size_t length) noexcept;
+
+//=====================================
+/* returns true if the cpu supports encode_hardware() */
+bool
+has_hardware() noexcept;
+
+std::uint32_t
+encode_hardware(const void *buffer, std::size_t length) noexcept;
+
+//=====================================
+struct Context {
+  /* the raw crc register */
+  std::uint32_t crc;
 
+  /* same as init() */
+  Context() noexcept;
+};
+
+void
+init(Context &) noexcept;
+
+void
+update(Context &, const void *buffer, std::size_t length) noexcept;
+
+template <typename T>
+void
+update(Context &, const sp::Array<std::tuple<T *, std::size_t>> &) noexcept;
+
+std::uint32_t
+final(const Context &) noexcept;
+
+//=====================================
+std::uint32_t
+combine(std::uint32_t crc_a, std::uint32_t crc_b, std::size_t length_b) noexcept;
+
+//=====================================
+/* Splits $buffer into $threads chunks which are checksummed concurrently and
+ * merged using combine(), the result is identical to encode(). Inputs smaller
+ * than a few chunks of 64KB are not worth a thread and are done serially.
+ */
+std::uint32_t
+encode_parallel(const void *buffer, std::size_t length,
+                std::size_t threads) noexcept;
+} // namespace crc32c
+
+namespace crc32 {
 std::uint32_t
 encode(const void *buffer, std::size_t length) noexcept;
+
+//=====================================
+std::uint32_t
+encode_bitwise(const void *buffer, std::size_t length) noexcept;
+
+std::uint32_t
+encode_slicing8(const void *buffer, std::size_t length) noexcept;
+
+std::uint32_t
+encode_slicing16(const void *buffer, std::size_t length) noexcept;
+
+//=====================================
+struct Context {
+  /* the raw crc register */
+  std::uint32_t crc;
+
+  /* same as init() */
+  Context() noexcept;
+};
+
+void
+init(Context &) noexcept;
+
+void
+update(Context &, const void *buffer, std::size_t length) noexcept;
+
+template <typename T>
+void
+update(Context &, const sp::Array<std::tuple<T *, std::size_t>> &) noexcept;
+
+std::uint32_t
+final(const Context &) noexcept;
+
+//=====================================
+std::uint32_t
+combine(std::uint32_t crc_a, std::uint32_t crc_b, std::size_t length_b) noexcept;
+
+//=====================================
+std::uint32_t
+encode_parallel(const void *buffer, std::size_t length,
+                std::size_t threads) noexcept;
+} // namespace crc32
+
+//=====================================
+//====Implementation===================
+//=====================================
+namespace crc32c {
+template <typename T>
+void
+update(Context &ctx,
+       const sp::Array<std::tuple<T *, std::size_t>> &segments) noexcept {
+  for_each(segments, [&ctx](const std::tuple<T *, std::size_t> &current) {
+    update(ctx, std::get<0>(current), std::get<1>(current));
+  });
+}
+} // namespace crc32c
+
+namespace crc32 {
+template <typename T>
+void
+update(Context &ctx,
+       const sp::Array<std::tuple<T *, std::size_t>> &segments) noexcept {
+  for_each(segments, [&ctx](const std::tuple<T *, std::size_t> &current) {
+    update(ctx, std::get<0>(current), std::get<1>(current));
+  });
 }
+} // namespace crc32
 
 #endif
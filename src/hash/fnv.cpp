@@ -175,10 +175,11 @@ encode(const void *buf, std::size_t length, std::uint64_t hash) noexcept {
   return encode(buf, length, prime, hash);
 }
 
+static constexpr std::uint64_t offset_basis64{0xcbf29ce484222325ULL};
+
 std::uint64_t
 encode64(const void *buf, std::size_t length) noexcept {
-  constexpr std::uint64_t offset_basis{0xcbf29ce484222325ULL};
-  return encode(buf, length, offset_basis);
+  return encode(buf, length, offset_basis64);
 }
 
 //=====================================
@@ -194,5 +195,25 @@ encode32(const void *buf, std::size_t length) noexcept {
   return encode(buf, length, offset_basis);
 }
 
+//=====================================
+Context::Context() noexcept
+    : hash{offset_basis64} {
+}
+
+void
+init(Context &self) noexcept {
+  self.hash = offset_basis64;
+}
+
+void
+update(Context &self, const void *buf, std::size_t length) noexcept {
+  self.hash = encode(buf, length, self.hash);
+}
+
+std::uint64_t
+final(const Context &self) noexcept {
+  return self.hash;
+}
+
 //=====================================
 }
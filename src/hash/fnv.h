@@ -1,8 +1,10 @@
 #ifndef SP_UTIL_HASH_FNV_H
 #define SP_UTIL_HASH_FNV_H
 
+#include <collection/Array.h>
 #include <cstddef>
 #include <cstdint>
+#include <tuple>
 #include <type_traits>
 
 namespace fnv_1a {
@@ -20,6 +22,40 @@ encode(const void *buf, std::size_t length, std::uint32_t hash) noexcept;
 std::uint32_t
 encode32(const void *buf, std::size_t length) noexcept;
 
+//=====================================
+/* Streaming version of encode64() for fragmented input, see crc.h */
+struct Context {
+  std::uint64_t hash;
+
+  /* same as init() */
+  Context() noexcept;
+};
+
+void
+init(Context &) noexcept;
+
+void
+update(Context &, const void *buf, std::size_t length) noexcept;
+
+template <typename T>
+void
+update(Context &, const sp::Array<std::tuple<T *, std::size_t>> &) noexcept;
+
+std::uint64_t
+final(const Context &) noexcept;
+
+//=====================================
+//====Implementation===================
+//=====================================
+template <typename T>
+void
+update(Context &ctx,
+       const sp::Array<std::tuple<T *, std::size_t>> &segments) noexcept {
+  for_each(segments, [&ctx](const std::tuple<T *, std::size_t> &current) {
+    update(ctx, std::get<0>(current), std::get<1>(current));
+  });
+}
+
 //=====================================
 } // namespace fnv_1a
 
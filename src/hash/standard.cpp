@@ -1,5 +1,8 @@
 #include "standard.h"
+#include <buffer/BytesView.h>
 #include <hash/fnv.h>
+#include <hash/wyhash.h>
+#include <string/view.h>
 
 // TODO ifdef to use 32 bit version in x86 mode
 namespace sp {
@@ -60,4 +63,30 @@ std::size_t
 Hasher<unsigned long>::operator()(unsigned long in) const noexcept {
   return fnv_1a::encode64(&in, sizeof(in));
 }
+
+//=====================================
+std::size_t
+Hasher<string_view>::operator()(const string_view &in) const noexcept {
+  return wyhash::encode64(in.str, in.length);
+}
+
+//=====================================
+template <typename T>
+static std::size_t
+hash_readable(const IBytesView<T> &in) noexcept {
+  const std::size_t length = in.length > in.pos ? in.length - in.pos : 0;
+  return wyhash::encode64(in.raw + in.pos, length);
+}
+
+std::size_t
+Hasher<IBytesView<unsigned char>>::operator()(
+    const IBytesView<unsigned char> &in) const noexcept {
+  return hash_readable(in);
+}
+
+std::size_t
+Hasher<IBytesView<const unsigned char>>::operator()(
+    const IBytesView<const unsigned char> &in) const noexcept {
+  return hash_readable(in);
+}
 }
@@ -9,6 +9,11 @@ namespace sp {
 template <typename>
 struct Hasher;
 
+struct string_view;
+
+template <typename>
+struct IBytesView;
+
 //=====================================
 template <typename T>
 struct Equality {
@@ -103,6 +108,27 @@ struct Hasher<unsigned long> {
   operator()(unsigned long) const noexcept;
 };
 
+//=====================================
+/* Strings and byte views are hashed using wyhash */
+template <>
+struct Hasher<string_view> {
+  std::size_t
+  operator()(const string_view &) const noexcept;
+};
+
+/* the readable bytes, [pos, length) */
+template <>
+struct Hasher<IBytesView<unsigned char>> {
+  std::size_t
+  operator()(const IBytesView<unsigned char> &) const noexcept;
+};
+
+template <>
+struct Hasher<IBytesView<const unsigned char>> {
+  std::size_t
+  operator()(const IBytesView<const unsigned char> &) const noexcept;
+};
+
 #if 0
 //=====================================
 template <typename T>
@@ -0,0 +1,113 @@
+/*
+ * This is free and unencumbered software released into the public domain
+ * under The Unlicense (http://unlicense.org/)
+ * main repo: https://github.com/wangyi-fudan/wyhash
+ * author: 王一 Wang Yi <godspeed_china@yeah.net>
+ */
+#include "wyhash.h"
+#include <cstring>
+#include <util/assert.h>
+
+namespace wyhash {
+//=====================================
+static const std::uint64_t secret[4] = {
+    0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, //
+    0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull  //
+};
+
+__extension__ typedef unsigned __int128 uint128_t;
+
+/* 64x64 -> 128 bit multiply, $a = low, $b = high */
+static inline void
+mum(std::uint64_t &a, std::uint64_t &b) noexcept {
+  const uint128_t r = uint128_t(a) * b;
+  a = std::uint64_t(r);
+  b = std::uint64_t(r >> 64);
+}
+
+static inline std::uint64_t
+mix(std::uint64_t a, std::uint64_t b) noexcept {
+  mum(a, b);
+  return a ^ b;
+}
+
+/* unaligned little endian reads */
+static inline std::uint64_t
+read8(const unsigned char *p) noexcept {
+  std::uint64_t result;
+  std::memcpy(&result, p, sizeof(result));
+  return result;
+}
+
+static inline std::uint64_t
+read4(const unsigned char *p) noexcept {
+  std::uint32_t result;
+  std::memcpy(&result, p, sizeof(result));
+  return result;
+}
+
+/* 1-3 bytes, first, middle and last byte */
+static inline std::uint64_t
+read3(const unsigned char *p, std::size_t k) noexcept {
+  return (std::uint64_t(p[0]) << 16) | (std::uint64_t(p[k >> 1]) << 8) |
+         p[k - 1];
+}
+
+//=====================================
+std::uint64_t
+encode(const void *buf, std::size_t length, std::uint64_t seed) noexcept {
+  assertxs(buf || length == 0, length);
+
+  const unsigned char *p = (const unsigned char *)buf;
+  seed ^= mix(seed ^ secret[0], secret[1]);
+
+  std::uint64_t a = 0;
+  std::uint64_t b = 0;
+  if (length <= 16) {
+    if (length >= 4) {
+      /* two, possibly overlapping, 4 byte reads from each end */
+      const std::size_t mid = (length >> 3) << 2;
+      a = (read4(p) << 32) | read4(p + mid);
+      b = (read4(p + length - 4) << 32) | read4(p + length - 4 - mid);
+    } else if (length > 0) {
+      a = read3(p, length);
+    }
+  } else {
+    std::size_t i = length;
+    if (i >= 48) {
+      std::uint64_t see1 = seed;
+      std::uint64_t see2 = seed;
+      do {
+        seed = mix(read8(p) ^ secret[1], read8(p + 8) ^ seed);
+        see1 = mix(read8(p + 16) ^ secret[2], read8(p + 24) ^ see1);
+        see2 = mix(read8(p + 32) ^ secret[3], read8(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i >= 48);
+      seed ^= see1 ^ see2;
+    }
+
+    while (i > 16) {
+      seed = mix(read8(p) ^ secret[1], read8(p + 8) ^ seed);
+      i -= 16;
+      p += 16;
+    }
+
+    /* the last 16 bytes, may overlap with the already consumed */
+    a = read8(p + i - 16);
+    b = read8(p + i - 8);
+  }
+
+  a ^= secret[1];
+  b ^= seed;
+  mum(a, b);
+  return mix(a ^ secret[0] ^ length, b ^ secret[1]);
+}
+
+std::uint64_t
+encode64(const void *buf, std::size_t length) noexcept {
+  return encode(buf, length, 0);
+}
+
+//=====================================
+} // namespace wyhash
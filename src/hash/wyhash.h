@@ -0,0 +1,38 @@
+#ifndef SP_UTIL_HASH_WYHASH_H
+#define SP_UTIL_HASH_WYHASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+/*
+ * wyhash, 64 bit non cryptographic hash by Wang Yi.
+ *
+ * Consumes the input 48 bytes per iteration using three independent 64x64->128
+ * bit multiply-xor lanes, inputs of at most 16 bytes are handled without any
+ * loop. Compared to fnv_1a which does one byte per multiply this is an order
+ * of magnitude faster on long keys and has better avalanche.
+ *
+ * source: https://github.com/wangyi-fudan/wyhash (final version 4)
+ */
+namespace wyhash {
+//=====================================
+std::uint64_t
+encode(const void *buf, std::size_t length, std::uint64_t seed) noexcept;
+
+std::uint64_t
+encode64(const void *buf, std::size_t length) noexcept;
+
+//=====================================
+template <typename T>
+std::enable_if_t< //
+    std::is_trivially_copyable<T>::value && !std::is_pointer<T>::value,
+    std::size_t>
+hash(const T &in) noexcept {
+  return encode64(&in, sizeof(in));
+}
+
+//=====================================
+} // namespace wyhash
+
+#endif
@@ -0,0 +1 @@
+#include "ConcurrentHashMap.h"
@@ -0,0 +1,261 @@
+#ifndef SP_UTIL_MAP_CONCURRENT_HASH_MAP_H
+#define SP_UTIL_MAP_CONCURRENT_HASH_MAP_H
+
+#include <concurrent/ReadWriteLock.h>
+#include <cstdlib>
+#include <map/HashMapProbing.h>
+#include <new>
+#include <utility>
+
+/*
+ * Thread safe hash map where the key space is sharded over a number of
+ * HashMapProbing, each guarded by its own ReadWriteLock. Lookups only takes a
+ * shared lock so concurrent lookups never block each other, writers only
+ * block the operations in the same shard.
+ *
+ * The shard is selected using the upper bits of the hash since the lower bits
+ * are used by HashSetProbing to select the slot and h2 control byte.
+ *
+ * Each shard starts on its own cache line so that the lock and map header of
+ * one shard never share a line with its neighbours, otherwise threads working
+ * on different shards would still contend on the line (false sharing).
+ *
+ * Since a pointer into a shard is not safe to use after the shard lock is
+ * released the API copies out values, or gives access to the value in a
+ * callback invoked while the lock is held.
+ */
+namespace sp {
+namespace impl {
+//=====================================
+template <typename Key, typename Value, typename H, typename Eq>
+struct alignas(64) ConcurrentHashMapShard {
+  ReadWriteLock lock;
+  HashMapProbing<Key, Value, H, Eq> map;
+
+  ConcurrentHashMapShard() noexcept;
+};
+} // namespace impl
+
+//=====================================
+template <typename Key, typename Value, typename H = sp::Hasher<Key>,
+          typename Eq = sp::Equality<Key>>
+struct ConcurrentHashMap {
+  using key_type = Key;
+  using value_type = Value;
+  using Shard = impl::ConcurrentHashMapShard<Key, Value, H, Eq>;
+
+  Shard *shards;
+  /* number of shards, power of 2 */
+  std::size_t length;
+  std::size_t shift;
+
+  /* $shards is rounded up to the nearest power of 2 */
+  explicit ConcurrentHashMap(std::size_t shards = 64) noexcept;
+
+  ConcurrentHashMap(const ConcurrentHashMap &) = delete;
+  ConcurrentHashMap(const ConcurrentHashMap &&) = delete;
+
+  ~ConcurrentHashMap() noexcept;
+};
+
+//=====================================
+/* Insert or assign, returns false if the value could not be stored
+ */
+template <typename K, typename V, typename H, typename Eq, typename Key,
+          typename Value>
+bool
+insert(ConcurrentHashMap<K, V, H, Eq> &, Key &&, Value &&) noexcept;
+
+//=====================================
+/* Copies the value associated with $key into $out, returns false if not
+ * present
+ */
+template <typename Key, typename V, typename H, typename Eq, typename K>
+bool
+lookup(const ConcurrentHashMap<Key, V, H, Eq> &, const K &, V &out) noexcept;
+
+//=====================================
+template <typename Key, typename V, typename H, typename Eq, typename K>
+bool
+contains(const ConcurrentHashMap<Key, V, H, Eq> &, const K &) noexcept;
+
+//=====================================
+template <typename Key, typename V, typename H, typename Eq, typename K>
+bool
+remove(ConcurrentHashMap<Key, V, H, Eq> &, const K &) noexcept;
+
+//=====================================
+/* Atomically read-modify-write the value associated with $key.
+ * $compute(V&) is invoked while holding the exclusive lock of the shard, if
+ * $key is not present a default constructed value is inserted first.
+ */
+template <typename Key, typename V, typename H, typename Eq, typename K,
+          typename F>
+bool
+compute(ConcurrentHashMap<Key, V, H, Eq> &, const K &, F compute) noexcept;
+
+//=====================================
+/* The sum of all shards, not a snapshot when there are concurrent writers
+ */
+template <typename Key, typename V, typename H, typename Eq>
+std::size_t
+length(const ConcurrentHashMap<Key, V, H, Eq> &) noexcept;
+
+//=====================================
+//====Implementation===================
+//=====================================
+namespace impl {
+template <typename Key, typename Value, typename H, typename Eq>
+ConcurrentHashMapShard<Key, Value, H, Eq>::ConcurrentHashMapShard() noexcept
+    : lock{}
+    , map{} {
+}
+} // namespace impl
+
+template <typename Key, typename Value, typename H, typename Eq>
+ConcurrentHashMap<Key, Value, H, Eq>::ConcurrentHashMap(
+    std::size_t count) noexcept
+    : shards{nullptr}
+    , length{1}
+    , shift{sizeof(std::size_t) * 8} {
+  while (length < count) {
+    length <<= 1;
+    --shift;
+  }
+
+  /* new[] does not respect the over-alignment of Shard before C++17 */
+  void *const raw = aligned_alloc(alignof(Shard), sizeof(Shard) * length);
+  assertx(raw);
+  if (raw) {
+    shards = static_cast<Shard *>(raw);
+    for (std::size_t i = 0; i < length; ++i) {
+      ::new (shards + i) Shard;
+    }
+  } else {
+    length = 0;
+  }
+}
+
+template <typename Key, typename Value, typename H, typename Eq>
+ConcurrentHashMap<Key, Value, H, Eq>::~ConcurrentHashMap() noexcept {
+  if (shards) {
+    for (std::size_t i = 0; i < length; ++i) {
+      shards[i].~Shard();
+    }
+    free(shards);
+  }
+  shards = nullptr;
+  length = 0;
+}
+
+//=====================================
+namespace impl {
+template <typename Key, typename V, typename H, typename Eq, typename K>
+static ConcurrentHashMapShard<Key, V, H, Eq> &
+shard_of(const ConcurrentHashMap<Key, V, H, Eq> &self,
+         const K &needle) noexcept {
+  std::size_t idx = 0;
+  if (self.length > 1) {
+    H hash;
+    idx = hash(needle) >> self.shift;
+  }
+
+  assertxs(idx < self.length, idx, self.length);
+  return self.shards[idx];
+}
+} // namespace impl
+
+//=====================================
+template <typename K, typename V, typename H, typename Eq, typename Key,
+          typename Value>
+bool
+insert(ConcurrentHashMap<K, V, H, Eq> &self, Key &&key,
+       Value &&value) noexcept {
+  auto &shard = impl::shard_of(self, key);
+
+  EagerExclusiveLock guard(shard.lock);
+  return insert(shard.map, std::forward<Key>(key),
+                std::forward<Value>(value)) != nullptr;
+}
+
+//=====================================
+template <typename Key, typename V, typename H, typename Eq, typename K>
+bool
+lookup(const ConcurrentHashMap<Key, V, H, Eq> &self, const K &needle,
+       V &out) noexcept {
+  auto &shard = impl::shard_of(self, needle);
+
+  SharedLock guard(shard.lock);
+  const auto &c_map = shard.map;
+  const V *const result = lookup(c_map, needle);
+  if (result) {
+    out = *result;
+    return true;
+  }
+
+  return false;
+}
+
+//=====================================
+template <typename Key, typename V, typename H, typename Eq, typename K>
+bool
+contains(const ConcurrentHashMap<Key, V, H, Eq> &self,
+         const K &needle) noexcept {
+  auto &shard = impl::shard_of(self, needle);
+
+  SharedLock guard(shard.lock);
+  const auto &c_map = shard.map;
+  return lookup(c_map, needle) != nullptr;
+}
+
+//=====================================
+template <typename Key, typename V, typename H, typename Eq, typename K>
+bool
+remove(ConcurrentHashMap<Key, V, H, Eq> &self, const K &needle) noexcept {
+  auto &shard = impl::shard_of(self, needle);
+
+  EagerExclusiveLock guard(shard.lock);
+  return remove(shard.map, needle);
+}
+
+//=====================================
+template <typename Key, typename V, typename H, typename Eq, typename K,
+          typename F>
+bool
+compute(ConcurrentHashMap<Key, V, H, Eq> &self, const K &needle,
+        F f) noexcept {
+  auto &shard = impl::shard_of(self, needle);
+
+  EagerExclusiveLock guard(shard.lock);
+  V *result = lookup(shard.map, needle);
+  if (!result) {
+    result = insert(shard.map, Key(needle), V{});
+  }
+
+  if (result) {
+    f(*result);
+    return true;
+  }
+
+  return false;
+}
+
+//=====================================
+template <typename Key, typename V, typename H, typename Eq>
+std::size_t
+length(const ConcurrentHashMap<Key, V, H, Eq> &self) noexcept {
+  std::size_t result = 0;
+  for (std::size_t i = 0; i < self.length; ++i) {
+    auto &shard = self.shards[i];
+
+    SharedLock guard(shard.lock);
+    result += length(shard.map);
+  }
+
+  return result;
+}
+
+//=====================================
+} // namespace sp
+
+#endif
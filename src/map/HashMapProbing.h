@@ -19,7 +19,8 @@ struct HashMapProbing {
 
   HashSetProbing<Entry, Hash, Equality> set;
 
-  HashMapProbing() noexcept;
+  /* see HashSetProbing for $migrate_step */
+  HashMapProbing(std::size_t cap = 16, std::size_t migrate_step = 0) noexcept;
   HashMapProbing(const HashMapProbing &) = delete;
   HashMapProbing(const HashMapProbing &&) = delete;
 
@@ -32,6 +33,16 @@ template <typename K, typename V, typename H, typename Eq, typename Key,
 V *
 insert(HashMapProbing<K, V, H, Eq> &, Key &&, Value &&) noexcept;
 
+//=====================================
+/* Batch insert or assign of $keys[i] -> $values[i], returns the number of
+ * stored values. See HashSetProbing insert_all().
+ */
+template <typename K, typename V, typename H, typename Eq, typename Key,
+          typename Value>
+std::size_t
+insert_all(HashMapProbing<K, V, H, Eq> &, const Key *keys, const Value *values,
+           std::size_t) noexcept;
+
 //=====================================
 template <typename Key, typename V, typename H, typename Eq, typename K>
 const V *
@@ -41,6 +52,19 @@ template <typename Key, typename V, typename H, typename Eq, typename K>
 V *
 lookup(HashMapProbing<Key, V, H, Eq> &, const K &) noexcept;
 
+//=====================================
+/* $result[i] is the value of $keys[i] or null, returns the number of matches
+ */
+template <typename Key, typename V, typename H, typename Eq, typename K>
+std::size_t
+lookup_all(const HashMapProbing<Key, V, H, Eq> &, const K *keys, std::size_t,
+           const V **result) noexcept;
+
+template <typename Key, typename V, typename H, typename Eq, typename K>
+std::size_t
+lookup_all(HashMapProbing<Key, V, H, Eq> &, const K *keys, std::size_t,
+           V **result) noexcept;
+
 //=====================================
 template <typename Key, typename V, typename H, typename Eq, typename K>
 const V &
@@ -56,6 +80,11 @@ template <typename Key, typename V, typename H, typename Eq, typename K>
 bool
 remove(HashMapProbing<Key, V, H, Eq> &, const K &) noexcept;
 
+//=====================================
+template <typename Key, typename V, typename H, typename Eq>
+bool
+reserve(HashMapProbing<Key, V, H, Eq> &, std::size_t entries) noexcept;
+
 //=====================================
 template <typename Key, typename V, typename H, typename Eq>
 std::size_t
@@ -65,8 +94,9 @@ length(const HashMapProbing<Key, V, H, Eq> &) noexcept;
 //====Implementation===================
 //=====================================
 template <typename Key, typename Value, typename H, typename Eq>
-HashMapProbing<Key, Value, H, Eq>::HashMapProbing() noexcept
-    : set{} {
+HashMapProbing<Key, Value, H, Eq>::HashMapProbing(std::size_t cap,
+                                                  std::size_t step) noexcept
+    : set{cap, step} {
 }
 
 template <typename Key, typename Value, typename H, typename Eq>
@@ -80,35 +110,61 @@ V *
 insert(HashMapProbing<K, V, H, Eq> &self, Key &&key, Value &&value) noexcept {
   using Entry = impl::HashMapEntry<K, V>;
 
-  assertx(false);
-#if 0
   bool inserted = false;
-  auto on_compute = [key = std::forward<decltype(key)>(key),
-                     value = std::forward<decltype(value)>(value),
-                     &inserted](auto &bucket, const auto &) {
+  auto on_compute = [&key, &value, &inserted](Entry &bucket, const auto &) {
     inserted = true;
 
-    return new (&bucket) Entry(std::forward<decltype(key)>(key),
-                               std::forward<decltype(value)>(value));
+    new (&bucket) Entry(std::forward<Key>(key), std::forward<Value>(value));
   };
 
-  const Key &needle = key;
+  const auto &needle = key;
   Entry *const res = lookup_compute(self.set, needle, on_compute);
   if (res) {
     V *const result = &res->value;
 
     if (!inserted) {
       result->~V();
-      new (result) V{std::forward<Value>(value)};
+      new (result) V(std::forward<Value>(value));
     }
 
     return result;
   }
-#endif
 
   return nullptr;
 }
 
+//=====================================
+template <typename K, typename V, typename H, typename Eq, typename Key,
+          typename Value>
+std::size_t
+insert_all(HashMapProbing<K, V, H, Eq> &self, const Key *keys,
+           const Value *values, std::size_t length) noexcept {
+  using Entry = impl::HashMapEntry<K, V>;
+
+  if (!reserve(self.set, sp::length(self) + length) ||
+      !impl::allocate(self.set)) {
+    return 0;
+  }
+
+  auto needle = [keys](std::size_t i) -> const Key & {
+    /**/
+    return keys[i];
+  };
+
+  auto on_dup = [values](std::size_t i, Entry &bucket, const auto &) {
+    bucket.value.~V();
+    new (&bucket.value) V(values[i]);
+    return &bucket;
+  };
+
+  auto on_factory = [&self, keys, values](std::size_t i, std::size_t empty) {
+    Entry *const result = (Entry *)(self.set.table + empty);
+    return new (result) Entry(keys[i], values[i]);
+  };
+
+  return impl::insert_batch(self.set, length, needle, on_dup, on_factory);
+}
+
 //=====================================
 template <typename Key, typename V, typename H, typename Eq, typename K>
 const V *
@@ -130,6 +186,36 @@ lookup(HashMapProbing<Key, V, H, Eq> &self, const K &needle) noexcept {
   return (V *)lookup(c_self, needle);
 }
 
+//=====================================
+template <typename Key, typename V, typename H, typename Eq, typename K>
+std::size_t
+lookup_all(const HashMapProbing<Key, V, H, Eq> &self, const K *keys,
+           std::size_t length, const V **result) noexcept {
+  using Entry = impl::HashMapEntry<Key, V>;
+  std::size_t found = 0;
+
+  auto needle = [keys](std::size_t i) -> const K & {
+    /**/
+    return keys[i];
+  };
+
+  impl::lookup_batch(self.set, length, needle,
+                     [result, &found](std::size_t i, const Entry *res) {
+                       result[i] = res ? &res->value : nullptr;
+                       found += res != nullptr;
+                     });
+
+  return found;
+}
+
+template <typename Key, typename V, typename H, typename Eq, typename K>
+std::size_t
+lookup_all(HashMapProbing<Key, V, H, Eq> &self, const K *keys,
+           std::size_t length, V **result) noexcept {
+  const auto &c_self = self;
+  return lookup_all(c_self, keys, length, (const V **)result);
+}
+
 //=====================================
 template <typename Key, typename V, typename H, typename Eq, typename K>
 const V &
@@ -166,6 +252,13 @@ remove(HashMapProbing<Key, V, H, Eq> &self, const K &needle) noexcept {
   return remove(self.set, needle);
 }
 
+//=====================================
+template <typename Key, typename V, typename H, typename Eq>
+bool
+reserve(HashMapProbing<Key, V, H, Eq> &self, std::size_t entries) noexcept {
+  return reserve(self.set, entries);
+}
+
 //=====================================
 template <typename Key, typename V, typename H, typename Eq>
 std::size_t
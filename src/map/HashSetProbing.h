@@ -4,17 +4,23 @@
 #include <algorithm>
 #include <cstddef>
 #include <hash/standard.h>
+#include <map/impl/control.h>
 #include <type_traits>
-#include <util/QuadSet.h>
 #include <util/array.h>
 #include <util/assert.h>
 
-#define HSPTag_EMPTY char(0)
-#define HSPTag_PRESENT char(1)
-#define HSPTag_TOMBSTONE char(2)
-
 /*
  * Linear probing
+ *
+ * The slot state is kept in a separate array of control bytes(see
+ * map/impl/control.h) which is scanned a group of slots at a time. The probe
+ * sequence is still linear slot by slot, a group is only a window into it.
+ *
+ * Resize is either done in one go(migrate_step = 0) or incrementally. In the
+ * incremental mode the old table is kept alongside the new one and every
+ * insert/remove migrates migrate_step slots of the old table into the new one,
+ * which bounds the worst case latency of a single insert. Lookups do not
+ * migrate, they check the new table and fall back to the old one.
  */
 namespace sp {
 //=====================================
@@ -25,12 +31,18 @@ struct HashSetProbing {
   using value_type = T;
 
   Bucket *table;
-  sp::Quadset tags;
+  impl::HSPControl tags;
 
   std::size_t length;
   std::size_t capacity;
 
-  HashSetProbing(std::size_t cap = 16) noexcept;
+  /* incremental resize */
+  HashSetProbing<T, Hash, Eq> *old;
+  std::size_t migrate_step;
+  std::size_t migrate_idx;
+  std::size_t migrate_remaining;
+
+  HashSetProbing(std::size_t cap = 16, std::size_t migrate_step = 0) noexcept;
 
   ~HashSetProbing() noexcept;
 };
@@ -42,6 +54,16 @@ template <typename T, typename H, typename Eq, typename V>
 T *
 insert(HashSetProbing<T, H, Eq> &, V &&) noexcept;
 
+//=====================================
+/* Insert a batch of values, the batch is hashed and the target groups are
+ * prefetched ahead of the actual insert so that the cache misses of
+ * independent values overlap. Returns the number of inserted values,
+ * duplicates are skipped.
+ */
+template <typename T, typename H, typename Eq, typename V>
+std::size_t
+insert_all(HashSetProbing<T, H, Eq> &, const V *, std::size_t) noexcept;
+
 //=====================================
 template <typename T, typename H, typename Eq, typename V>
 T *
@@ -56,6 +78,20 @@ template <typename T, typename H, typename Eq, typename V>
 T *
 lookup(HashSetProbing<T, H, Eq> &, const V &) noexcept;
 
+//=====================================
+/* Batch lookup, $result[i] is the match of $needles[i] or null. Returns the
+ * number of matches. See insert_all() for prefetching.
+ */
+template <typename T, typename H, typename Eq, typename V>
+std::size_t
+lookup_all(const HashSetProbing<T, H, Eq> &, const V *needles, std::size_t,
+           const T **result) noexcept;
+
+template <typename T, typename H, typename Eq, typename V>
+std::size_t
+lookup_all(HashSetProbing<T, H, Eq> &, const V *needles, std::size_t,
+           T **result) noexcept;
+
 //=====================================
 template <typename T, typename H, typename Eq>
 const T *
@@ -82,6 +118,9 @@ bool
 contains(const HashSetProbing<T, H, Eq> &, const V &) noexcept;
 
 //=====================================
+/* Leaves no tombstone behind, the entries following the removed one in the
+ * same cluster may be moved which invalidates pointers to them.
+ */
 template <typename T, typename H, typename Eq, typename V>
 bool
 remove(HashSetProbing<T, H, Eq> &, const V &) noexcept;
@@ -91,6 +130,14 @@ template <typename T, typename H, typename Eq>
 std::size_t
 capacity(const HashSetProbing<T, H, Eq> &) noexcept;
 
+//=====================================
+/* Grow the table up front so that $entries values can be stored without
+ * any rehash. An ongoing incremental resize is completed.
+ */
+template <typename T, typename H, typename Eq>
+bool
+reserve(HashSetProbing<T, H, Eq> &, std::size_t entries) noexcept;
+
 //=====================================
 template <typename T, typename H, typename Eq>
 void
@@ -127,11 +174,16 @@ length(const HashSetProbing<T, H, Eq> &) noexcept;
 //====Implementation===================
 //=====================================
 template <typename T, typename H, typename Eq>
-HashSetProbing<T, H, Eq>::HashSetProbing(std::size_t cap) noexcept
+HashSetProbing<T, H, Eq>::HashSetProbing(std::size_t cap,
+                                         std::size_t step) noexcept
     : table{nullptr}
     , tags{nullptr, 0}
     , length{0}
-    , capacity{cap < 16 ? 16 : cap} {
+    , capacity{cap < 16 ? 16 : cap}
+    , old{nullptr}
+    , migrate_step{step}
+    , migrate_idx{0}
+    , migrate_remaining{0} {
 }
 
 template <typename T, typename H, typename Eq>
@@ -154,9 +206,20 @@ HashSetProbing<T, H, Eq>::~HashSetProbing() noexcept {
     delete[] this->table;
   }
 
+  if (this->tags.buffer) {
+    delete[] this->tags.buffer;
+  }
+
+  if (this->old) {
+    delete this->old;
+  }
+
   this->table = nullptr;
+  this->tags.buffer = nullptr;
+  this->tags.capacity = 0;
   this->length = 0;
   this->capacity = 0;
+  this->old = nullptr;
 }
 
 //=====================================
@@ -172,14 +235,169 @@ index_of(std::size_t hash, std::size_t length) noexcept {
   return res;
 }
 
+template <typename T, typename H, typename Eq>
+static bool
+eager_resize(const HashSetProbing<T, H, Eq> &self) noexcept {
+  constexpr std::size_t percent = 2;
+  const std::size_t one_percent = self.capacity / 100;
+  const std::size_t resz = std::max(one_percent * percent, std::size_t(1));
+  const std::size_t resize_length = self.capacity - resz;
+
+  bool res = self.length > resize_length;
+  if (res) {
+    // printf("cap[%zu],resize[%zu]\n", self.capacity, resize_length);
+  }
+
+  return res;
+}
+
+template <typename T, typename H, typename Eq>
+static bool
+allocate(HashSetProbing<T, H, Eq> &self) noexcept {
+  if (!self.table) {
+    using Bucket = typename HashSetProbing<T, H, Eq>::Bucket;
+    // XXX check null
+    assertxs(self.capacity > 0, self.capacity);
+    assertxs(self.capacity >= HSPGroup::width, self.capacity);
+    self.table = new Bucket[self.capacity];
+
+    const std::size_t ctrls = HSPControl_number_of_buffer(self.capacity);
+    self.tags.capacity = self.capacity;
+    self.tags.buffer = new HSPCtrl[ctrls];
+    std::memset(self.tags.buffer, HSPCtrl_EMPTY, ctrls);
+  }
+
+  return self.table != nullptr;
+}
+
+template <typename T, typename H, typename Eq, typename V>
+static std::size_t
+lookup_bucket(const HashSetProbing<T, H, Eq> &self, const V &needle,
+              std::size_t h) noexcept {
+  if (self.table) {
+    const HSPCtrl h2 = hsp_h2(h);
+    std::size_t idx = impl::index_of(hsp_h1(h), self.capacity);
+
+    for (std::size_t probed = 0; probed < self.capacity;
+         probed += HSPGroup::width) {
+      const HSPGroup group(self.tags.buffer + idx);
+      const HSPBitMask stop = match_empty(group);
+
+      HSPBitMask candidates = before(match(group, h2), stop);
+      while (candidates) {
+        const std::size_t current =
+            index_of(idx + lowest(candidates), self.capacity);
+        const T *const res = (const T *)&self.table[current];
+
+        Eq equality;
+        if (equality(*res, needle)) {
+          /* Match */
+          return current;
+        }
+        pop_lowest(candidates);
+      }
+
+      if (stop) {
+        /* Miss, resolved by the control bytes alone */
+        break;
+      }
+
+      idx = index_of(idx + HSPGroup::width, self.capacity);
+    }
+  }
+
+  return self.capacity;
+}
+
+template <typename T, typename H, typename Eq, typename V>
+static std::size_t
+lookup_bucket(const HashSetProbing<T, H, Eq> &self, const V &needle) noexcept {
+  if (self.table) {
+    H hash;
+    return lookup_bucket(self, needle, hash(needle));
+  }
+
+  return self.capacity;
+}
+
+/*
+ * Insert a value which is known not to be present in $self, does not resize.
+ */
+template <typename T, typename H, typename Eq>
+static T *
+insert_unique(HashSetProbing<T, H, Eq> &self, T &&value) noexcept {
+  H hash;
+  const std::size_t h = hash(value);
+  std::size_t idx = index_of(hsp_h1(h), self.capacity);
+
+  for (std::size_t probed = 0; probed < self.capacity;
+       probed += HSPGroup::width) {
+    const HSPGroup group(self.tags.buffer + idx);
+    const HSPBitMask free = match_empty_or_tombstone(group);
+
+    if (free) {
+      const std::size_t empty = index_of(idx + lowest(free), self.capacity);
+      sp::set(self.tags, empty, hsp_h2(h));
+      ++self.length;
+
+      T *const result = (T *)(self.table + empty);
+      return new (result) T(std::move(value));
+    }
+
+    idx = index_of(idx + HSPGroup::width, self.capacity);
+  }
+
+  return nullptr;
+}
+
+/*
+ * Migrate at most $slots slots of $self.old into $self.
+ *
+ * The old table is drained backwards starting from an EMPTY slot. When slot
+ * $idx is drained the slot after it is therefore already EMPTY, so no probe
+ * sequence of the remaining old entries pass through $idx and it can be
+ * marked EMPTY without leaving a tombstone behind.
+ */
+template <typename T, typename H, typename Eq>
+static void
+migrate(HashSetProbing<T, H, Eq> &self, std::size_t slots) noexcept {
+  HashSetProbing<T, H, Eq> *const old = self.old;
+  if (!old) {
+    return;
+  }
+
+  for (; slots > 0 && self.migrate_remaining > 0 && old->length > 0; --slots) {
+    const std::size_t idx = self.migrate_idx;
+
+    if (sp::test(old->tags, idx) == HSPTag_PRESENT) {
+      T *const current = (T *)&old->table[idx];
+      T *const ins = insert_unique(self, std::move(*current));
+      assertx(ins);
+
+      current->~T();
+      --old->length;
+    }
+
+    sp::set(old->tags, idx, HSPCtrl_EMPTY);
+    self.migrate_idx = index_of(idx + old->capacity - 1, old->capacity);
+    --self.migrate_remaining;
+  }
+
+  if (self.migrate_remaining == 0 || old->length == 0) {
+    assertxs(old->length == 0, old->length, self.migrate_remaining);
+    delete old;
+    self.old = nullptr;
+    self.migrate_remaining = 0;
+  }
+}
+
 template <typename T, typename H, typename Eq>
 static T *
 rehash(HashSetProbing<T, H, Eq> &self, const T *const needle) noexcept {
   // printf("rehash()\n");
   T *result = nullptr;
 
-  HashSetProbing<T, H, Eq> tmp;
-  tmp.capacity = self.capacity * 2;
+  HashSetProbing<T, H, Eq> tmp(self.capacity * 2, self.migrate_step);
 
   // XXX new and check non null before move
 
@@ -191,7 +409,7 @@ rehash(HashSetProbing<T, H, Eq> &self, const T *const needle) noexcept {
       auto &bucket = self.table[idx];
 
       ++cnt;
-      sp::set(self.tags, idx, HSPTag_EMPTY);
+      sp::set(self.tags, idx, HSPCtrl_EMPTY);
       T *const current = (T *)&bucket;
 
       T *const ins = ::sp::insert(tmp, std::move(*current));
@@ -217,86 +435,119 @@ rehash(HashSetProbing<T, H, Eq> &self, const T *const needle) noexcept {
   return result;
 }
 
+/*
+ * Start an incremental resize, the current table becomes $self.old and is
+ * migrated by later insert/remove. $needle stays where it is.
+ */
 template <typename T, typename H, typename Eq>
-static bool
-eager_resize(const HashSetProbing<T, H, Eq> &self) noexcept {
-  constexpr std::size_t percent = 2;
-  const std::size_t one_percent = self.capacity / 100;
-  const std::size_t resz = std::max(one_percent * percent, std::size_t(1));
-  const std::size_t resize_length = self.capacity - resz;
+static T *
+rehash_incremental(HashSetProbing<T, H, Eq> &self, T *const needle) noexcept {
+  if (self.old) {
+    /* The previous resize is not done yet, finish it first */
+    migrate(self, self.migrate_remaining);
+    assertx(!self.old);
+
+    if (!eager_resize(self)) {
+      return needle;
+    }
+  }
 
-  bool res = self.length > resize_length;
-  if (res) {
-    // printf("cap[%zu],resize[%zu]\n", self.capacity, resize_length);
+  std::size_t start = 0;
+  while (start < self.capacity && sp::test(self.tags, start) != HSPTag_EMPTY) {
+    ++start;
   }
 
-  return res;
+  if (start == self.capacity) {
+    /* No EMPTY slot to drain from, small tables are allowed to get full */
+    return rehash(self, needle);
+  }
+
+  auto *const old = new HashSetProbing<T, H, Eq>(self.capacity);
+  {
+    using std::swap;
+    swap(self.table, old->table);
+    swap(self.tags, old->tags);
+    swap(self.length, old->length);
+  }
+
+  self.capacity = self.capacity * 2;
+  self.old = old;
+  self.migrate_idx = start;
+  self.migrate_remaining = old->capacity;
+  allocate(self);
+
+  return needle;
 }
 
 template <typename T, typename H, typename Eq, typename V, typename D,
           typename F>
 T *
-do_insert(HashSetProbing<T, H, Eq> &self, const V &needle, D dup,
-          F fac) noexcept {
-  if (!self.table) {
-    using Bucket = typename HashSetProbing<T, H, Eq>::Bucket;
-    // XXX check null
-    assertxs(self.capacity > 0, self.capacity);
-    self.table = new Bucket[self.capacity];
-
-    self.tags.capacity = Quadset_number_of_buffer(self.capacity);
-    assertxs(self.tags.capacity > 0, self.tags.capacity, self.capacity);
-    self.tags.buffer = new std::uint64_t[self.tags.capacity]{0};
-
-    assertx_f({
-      for (std::size_t i = 0; i < self.tags.capacity; ++i) {
-        assertxs(self.tags.buffer[i] == std::uint64_t(0), self.tags.buffer[i]);
+do_insert(HashSetProbing<T, H, Eq> &self, const V &needle, std::size_t h,
+          D dup, F fac) noexcept {
+  if (self.old) {
+    migrate(self, self.migrate_step);
+
+    if (self.old) {
+      HashSetProbing<T, H, Eq> &old = *self.old;
+      const std::size_t index = lookup_bucket(old, needle, h);
+      if (index != old.capacity) {
+        /* Duplicate, not yet migrated */
+        return dup(*((T *)&old.table[index]), needle);
       }
-    });
+    }
   }
 
-  if (self.table) {
-    H hash;
-    const std::size_t h = hash(needle);
-    const std::size_t dest = index_of(h, self.capacity);
-    std::size_t idx = dest;
+  if (allocate(self)) {
+    const HSPCtrl h2 = hsp_h2(h);
+    std::size_t idx = index_of(hsp_h1(h), self.capacity);
 
     std::size_t empty = self.capacity;
-    do {
-      auto &bucket = self.table[idx];
-      const auto tag = sp::test(self.tags, idx);
-
-      if (empty == self.capacity) {
-        if (tag == HSPTag_EMPTY || tag == HSPTag_TOMBSTONE) {
-          empty = idx;
-        }
-      }
+    for (std::size_t probed = 0; probed < self.capacity;
+         probed += HSPGroup::width) {
+      const HSPGroup group(self.tags.buffer + idx);
+      const HSPBitMask stop = match_empty(group);
 
-      if (tag == HSPTag_EMPTY) {
-        break;
-      } else if (tag == HSPTag_PRESENT) {
-        T *const b = (T *)&bucket;
-        const T *const res = b;
+      HSPBitMask candidates = before(match(group, h2), stop);
+      while (candidates) {
+        const std::size_t current =
+            index_of(idx + lowest(candidates), self.capacity);
+        T *const b = (T *)&self.table[current];
 
         Eq equality;
-        if (equality(*res, needle)) {
+        if (equality(*b, needle)) {
 
           /* Duplicate */
           return dup(*b, needle);
         }
+        pop_lowest(candidates);
       }
 
-      idx = (idx + 1) % self.capacity;
-    } while (idx != dest);
+      if (empty == self.capacity) {
+        const HSPBitMask free = up_to(match_empty_or_tombstone(group), stop);
+        if (free) {
+          empty = index_of(idx + lowest(free), self.capacity);
+        }
+      }
+
+      if (stop) {
+        break;
+      }
+
+      idx = index_of(idx + HSPGroup::width, self.capacity);
+    }
 
     if (empty != self.capacity) {
       assertxs(empty < self.capacity, empty, self.capacity);
 
-      sp::set(self.tags, empty, HSPTag_PRESENT);
+      sp::set(self.tags, empty, h2);
       T *const result = fac(empty);
       ++self.length;
 
       if (eager_resize(self)) {
+        if (self.migrate_step > 0) {
+          return rehash_incremental(self, result);
+        }
+
         return rehash(self, result);
       }
 
@@ -306,6 +557,106 @@ do_insert(HashSetProbing<T, H, Eq> &self, const V &needle, D dup,
 
   return nullptr;
 }
+
+template <typename T, typename H, typename Eq, typename V, typename D,
+          typename F>
+T *
+do_insert(HashSetProbing<T, H, Eq> &self, const V &needle, D dup,
+          F fac) noexcept {
+  H hash;
+  return do_insert(self, needle, hash(needle), dup, fac);
+}
+
+/*
+ * Number of values which are hashed and prefetched ahead of being resolved
+ */
+static constexpr std::size_t HSP_BATCH = 16;
+
+template <typename T, typename H, typename Eq>
+static void
+prefetch(const HashSetProbing<T, H, Eq> &self, std::size_t h) noexcept {
+  if (self.table) {
+    const std::size_t idx = index_of(hsp_h1(h), self.capacity);
+    __builtin_prefetch(self.tags.buffer + idx);
+    __builtin_prefetch(self.table + idx);
+  }
+}
+
+/*
+ * Resolve $f(i, const T *) for i in [0, $length) where $needle(i) is the
+ * value to lookup, a batch of HSP_BATCH values are hashed and prefetched
+ * before the first of them is resolved.
+ */
+template <typename T, typename H, typename Eq, typename N, typename F>
+static void
+lookup_batch(const HashSetProbing<T, H, Eq> &self, std::size_t length,
+             N needle, F f) noexcept {
+  for (std::size_t start = 0; start < length; start += HSP_BATCH) {
+    const std::size_t end = std::min(start + HSP_BATCH, length);
+    std::size_t hashes[HSP_BATCH];
+
+    for (std::size_t i = start; i < end; ++i) {
+      H hash;
+      hashes[i - start] = hash(needle(i));
+      prefetch(self, hashes[i - start]);
+    }
+
+    for (std::size_t i = start; i < end; ++i) {
+      const HashSetProbing<T, H, Eq> *current = &self;
+      const T *result = nullptr;
+      while (current && !result) {
+        const std::size_t index =
+            lookup_bucket(*current, needle(i), hashes[i - start]);
+        if (index != current->capacity) {
+          result = (const T *)&current->table[index];
+        }
+        current = current->old;
+      }
+
+      f(i, result);
+    }
+  }
+}
+
+/*
+ * Same as lookup_batch() but inserts using do_insert(), $dup(i, T&, needle)
+ * and $fac(i, empty) are given the batch index. $self is expected to be
+ * reserved for the whole batch. Returns the number of non null results.
+ */
+template <typename T, typename H, typename Eq, typename N, typename D,
+          typename F>
+static std::size_t
+insert_batch(HashSetProbing<T, H, Eq> &self, std::size_t length, N needle,
+             D dup, F fac) noexcept {
+  std::size_t result = 0;
+
+  for (std::size_t start = 0; start < length; start += HSP_BATCH) {
+    const std::size_t end = std::min(start + HSP_BATCH, length);
+    std::size_t hashes[HSP_BATCH];
+
+    for (std::size_t i = start; i < end; ++i) {
+      H hash;
+      hashes[i - start] = hash(needle(i));
+      prefetch(self, hashes[i - start]);
+    }
+
+    for (std::size_t i = start; i < end; ++i) {
+      auto on_dup = [&dup, i](T &bucket, const auto &n) -> T * {
+        /**/
+        return dup(i, bucket, n);
+      };
+      auto on_factory = [&fac, i](std::size_t empty) -> T * {
+        /**/
+        return fac(i, empty);
+      };
+
+      result += do_insert(self, needle(i), hashes[i - start], on_dup,
+                          on_factory) != nullptr;
+    }
+  }
+
+  return result;
+}
 } // namespace impl
 
 template <typename T, typename H, typename Eq, typename V>
@@ -326,6 +677,33 @@ insert(HashSetProbing<T, H, Eq> &self, V &&value) noexcept {
   // return nullptr;
 }
 
+//=====================================
+template <typename T, typename H, typename Eq, typename V>
+std::size_t
+insert_all(HashSetProbing<T, H, Eq> &self, const V *values,
+           std::size_t length) noexcept {
+  if (!reserve(self, sp::length(self) + length) || !impl::allocate(self)) {
+    return 0;
+  }
+
+  auto needle = [values](std::size_t i) -> const V & {
+    /**/
+    return values[i];
+  };
+
+  auto on_dup = [](std::size_t, const auto &, const auto &) -> T * {
+    /**/
+    return nullptr;
+  };
+
+  auto on_factory = [&self, values](std::size_t i, std::size_t empty) -> T * {
+    T *const result = (T *)(self.table + empty);
+    return new (result) T(values[i]);
+  };
+
+  return impl::insert_batch(self, length, needle, on_dup, on_factory);
+}
+
 //=====================================
 namespace impl {
 template <typename T, typename H, typename Eq, typename V>
@@ -366,41 +744,6 @@ upsert(HashSetProbing<T, H, Eq> &self, V &&needle) noexcept {
   return result;
 }
 
-//=====================================
-namespace impl {
-template <typename T, typename H, typename Eq, typename V>
-static std::size_t
-lookup_bucket(const HashSetProbing<T, H, Eq> &self, const V &needle) noexcept {
-  if (self.table) {
-    H hash;
-    const std::size_t h = hash(needle);
-    const std::size_t dest = impl::index_of(h, self.capacity);
-    std::size_t idx = dest;
-
-    do {
-      auto &bucket = self.table[idx];
-      const auto tag = sp::test(self.tags, idx);
-      const T *const res = (T *)&bucket;
-
-      if (tag == HSPTag_PRESENT) {
-
-        Eq equality;
-        if (equality(*res, needle)) {
-          /* Match */
-          return idx;
-        }
-      } else if (tag == HSPTag_EMPTY) {
-        break;
-      }
-
-      idx = (idx + 1) % self.capacity;
-    } while (idx != dest);
-  }
-
-  return self.capacity;
-}
-} // namespace impl
-
 template <typename T, typename H, typename Eq, typename V>
 const T *
 lookup(const HashSetProbing<T, H, Eq> &self, const V &needle) noexcept {
@@ -413,6 +756,11 @@ lookup(const HashSetProbing<T, H, Eq> &self, const V &needle) noexcept {
     return (const T *)&bucket;
   }
 
+  if (self.old) {
+    const HashSetProbing<T, H, Eq> &old = *self.old;
+    return lookup(old, needle);
+  }
+
   return nullptr;
 }
 
@@ -423,6 +771,35 @@ lookup(HashSetProbing<T, H, Eq> &self, const V &needle) noexcept {
   return (T *)lookup(c_self, needle);
 }
 
+//=====================================
+template <typename T, typename H, typename Eq, typename V>
+std::size_t
+lookup_all(const HashSetProbing<T, H, Eq> &self, const V *needles,
+           std::size_t length, const T **result) noexcept {
+  std::size_t found = 0;
+
+  auto needle = [needles](std::size_t i) -> const V & {
+    /**/
+    return needles[i];
+  };
+
+  impl::lookup_batch(self, length, needle,
+                     [result, &found](std::size_t i, const T *res) {
+                       result[i] = res;
+                       found += res != nullptr;
+                     });
+
+  return found;
+}
+
+template <typename T, typename H, typename Eq, typename V>
+std::size_t
+lookup_all(HashSetProbing<T, H, Eq> &self, const V *needles,
+           std::size_t length, T **result) noexcept {
+  const auto &c_self = self;
+  return lookup_all(c_self, needles, length, (const T **)result);
+}
+
 //=====================================
 template <typename T, typename H, typename Eq>
 const T *
@@ -477,36 +854,48 @@ lookup_compute(HashSetProbing<T, H, Eq> &self, const V &needle,
 
 //=====================================
 namespace impl {
+/*
+ * Backward shift deletion. The entries following the $hole in the same
+ * cluster are moved back to fill it, unless that would place an entry before
+ * its home slot. When the cluster ends the last hole is marked EMPTY, so a
+ * remove never leaves a tombstone behind and probe sequences do not grow under
+ * insert/remove churn.
+ */
 template <typename T, typename H, typename Eq>
 static void
-cleanup(HashSetProbing<T, H, Eq> &self,
-        typename HashSetProbing<T, H, Eq>::Bucket *needle) noexcept {
-  assertx(needle);
-
+backward_shift(HashSetProbing<T, H, Eq> &self, std::size_t hole) noexcept {
   const std::size_t capacity = self.capacity;
-  const std::size_t dest = sp::index_of(self.table, capacity, capacity, needle);
+  std::size_t idx = hole;
 
-  assertxs(dest != capacity, dest, capacity);
-
-  const std::size_t next_idx = (dest + 1) % capacity;
-  auto tag = sp::test(self.tags, next_idx);
-  if (tag != HSPTag_EMPTY) {
-    return;
-  }
+  while (true) {
+    idx = index_of(idx + 1, capacity);
+    const auto tag = sp::test(self.tags, idx);
 
-  std::size_t idx = dest;
-  do {
-    tag = sp::test(self.tags, idx);
-    if (tag != HSPTag_TOMBSTONE) {
-      // if (tag == HSPTag_PRESENT) {
-      return;
+    if (tag == HSPTag_EMPTY) {
+      break;
     }
 
-    assertx(tag == HSPTag_EMPTY || tag == HSPTag_TOMBSTONE);
-    sp::set(self.tags, idx, HSPTag_EMPTY);
+    if (tag == HSPTag_PRESENT) {
+      T *const current = (T *)&self.table[idx];
+
+      H hash;
+      const std::size_t home = index_of(hsp_h1(hash(*current)), capacity);
+      const std::size_t dist_home = index_of(idx + capacity - home, capacity);
+      const std::size_t dist_hole = index_of(idx + capacity - hole, capacity);
+
+      if (dist_home >= dist_hole) {
+        /* $hole is between $home and $idx, move $current into it */
+        T *const dest = (T *)&self.table[hole];
+        new (dest) T(std::move(*current));
+        current->~T();
 
-    idx = (idx - 1) % capacity;
-  } while (idx != dest);
+        sp::set(self.tags, hole, self.tags.buffer[idx]);
+        hole = idx;
+      }
+    }
+  }
+
+  sp::set(self.tags, hole, HSPCtrl_EMPTY);
 }
 } // namespace impl
 
@@ -516,20 +905,25 @@ remove(HashSetProbing<T, H, Eq> &self, const V &needle) noexcept {
   using namespace impl;
   // printf("remve()\n");
 
+  if (self.old) {
+    migrate(self, self.migrate_step);
+  }
+
   const std::size_t index = lookup_bucket(self, needle);
   if (index != self.capacity) {
-    auto &bucket = self.table[index];
-    sp::set(self.tags, index, HSPTag_TOMBSTONE);
-
-    T *const value = (T *)&bucket;
+    T *const value = (T *)&self.table[index];
     value->~T();
 
     --self.length;
 
-    cleanup(self, &bucket);
+    backward_shift(self, index);
     return true;
   }
 
+  if (self.old) {
+    return remove(*self.old, needle);
+  }
+
   return false;
 }
 
@@ -559,6 +953,10 @@ for_each(HashSetProbing<T, H, Eq> &self, F f) noexcept {
       }
     }
   }
+
+  if (self.old) {
+    for_each(*self.old, f);
+  }
 }
 
 template <typename T, typename H, typename Eq, typename F>
@@ -575,6 +973,66 @@ for_each(const HashSetProbing<T, H, Eq> &self, F f) noexcept {
       }
     }
   }
+
+  if (self.old) {
+    for_each(*self.old, f);
+  }
+}
+
+//=====================================
+template <typename T, typename H, typename Eq>
+bool
+reserve(HashSetProbing<T, H, Eq> &self, std::size_t entries) noexcept {
+  using namespace impl;
+
+  std::size_t cap = self.capacity;
+  while (true) {
+    /* the same limit as eager_resize() */
+    const std::size_t resz = std::max((cap / 100) * 2, std::size_t(1));
+    if (entries <= cap - resz) {
+      break;
+    }
+    cap *= 2;
+  }
+
+  if (self.old) {
+    migrate(self, self.migrate_remaining);
+    assertx(!self.old);
+  }
+
+  if (cap == self.capacity) {
+    return true;
+  }
+
+  if (!self.table) {
+    self.capacity = cap;
+    return true;
+  }
+
+  HashSetProbing<T, H, Eq> tmp(cap, self.migrate_step);
+  if (!allocate(tmp)) {
+    return false;
+  }
+
+  std::size_t cnt = 0;
+  for (std::size_t idx = 0; idx < self.capacity && cnt < self.length; ++idx) {
+    if (sp::test(self.tags, idx) == HSPTag_PRESENT) {
+      ++cnt;
+      sp::set(self.tags, idx, HSPCtrl_EMPTY);
+      T *const current = (T *)&self.table[idx];
+
+      T *const ins = insert_unique(tmp, std::move(*current));
+      assertx_n(ins);
+
+      current->~T();
+    }
+  }
+
+  assertxs(cnt == self.length, cnt, self.length);
+  self.length = 0;
+
+  swap(self, tmp);
+  return true;
 }
 
 //=====================================
@@ -586,6 +1044,10 @@ swap(HashSetProbing<T, H, Eq> &f, HashSetProbing<T, H, Eq> &s) noexcept {
   swap(f.tags, s.tags);
   swap(f.length, s.length);
   swap(f.capacity, s.capacity);
+  swap(f.old, s.old);
+  swap(f.migrate_step, s.migrate_step);
+  swap(f.migrate_idx, s.migrate_idx);
+  swap(f.migrate_remaining, s.migrate_remaining);
 }
 
 //=====================================
@@ -620,6 +1082,10 @@ length(const HashSetProbing<T, H, Eq> &self) noexcept {
 template <typename T, typename H, typename Eq>
 std::size_t
 length(const HashSetProbing<T, H, Eq> &self) noexcept {
+  if (self.old) {
+    return self.length + self.old->length;
+  }
+
   return self.length;
 }
 
@@ -0,0 +1 @@
+#include "HashSetRobinHood.h"
@@ -0,0 +1,766 @@
+#ifndef SP_UTIL_MAP_HASH_SET_ROBIN_HOOD_H
+#define SP_UTIL_MAP_HASH_SET_ROBIN_HOOD_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <hash/standard.h>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <util/assert.h>
+#include <utility>
+
+/*
+ * Robin Hood linear probing
+ *
+ * Every slot stores the probe distance of its entry from the entry home slot.
+ * On insert an entry which has probed further than the resident of a slot
+ * takes the slot and the resident continues probing, this evens out the
+ * probe distances so that the variance stays low even at high load factors.
+ *
+ * Since the distances along a probe sequence are kept sorted, a lookup can
+ * stop as soon as it reaches a slot whose entry is closer to home than the
+ * lookup has probed. A full value compare is only done against entries with
+ * the same home slot.
+ *
+ * Removal uses backward shift deletion, no tombstones.
+ */
+namespace sp {
+//=====================================
+template <typename T, typename Hash = sp::Hasher<T>,
+          typename Eq = sp::Equality<T>>
+struct HashSetRobinHood {
+  using Bucket = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+  using value_type = T;
+
+  Bucket *table;
+  /* 0: EMPTY, otherwise probe distance + 1 */
+  std::uint8_t *distance;
+
+  std::size_t length;
+  std::size_t capacity;
+
+  HashSetRobinHood(std::size_t cap = 16) noexcept;
+
+  HashSetRobinHood(const HashSetRobinHood &) = delete;
+  HashSetRobinHood(const HashSetRobinHood &&) = delete;
+
+  ~HashSetRobinHood() noexcept;
+};
+
+//=====================================
+struct HashSetRobinHoodStats {
+  std::size_t length;
+  std::size_t capacity;
+
+  std::size_t max_probe;
+  double mean_probe;
+  double load_factor;
+
+  HashSetRobinHoodStats() noexcept;
+};
+
+//=====================================
+/* returns null on duplicate
+ */
+template <typename T, typename H, typename Eq, typename V>
+T *
+insert(HashSetRobinHood<T, H, Eq> &, V &&) noexcept;
+
+//=====================================
+template <typename T, typename H, typename Eq, typename V>
+T *
+upsert(HashSetRobinHood<T, H, Eq> &, V &&) noexcept;
+
+//=====================================
+template <typename T, typename H, typename Eq, typename V>
+const T *
+lookup(const HashSetRobinHood<T, H, Eq> &, const V &) noexcept;
+
+template <typename T, typename H, typename Eq, typename V>
+T *
+lookup(HashSetRobinHood<T, H, Eq> &, const V &) noexcept;
+
+//=====================================
+template <typename T, typename H, typename Eq>
+const T *
+lookup_default(const HashSetRobinHood<T, H, Eq> &, const T &needle,
+               const T &def) noexcept;
+
+template <typename T, typename H, typename Eq>
+T *
+lookup_default(HashSetRobinHood<T, H, Eq> &, const T &needle, T &def) noexcept;
+
+//=====================================
+template <typename T, typename H, typename Eq, typename V>
+T *
+lookup_insert(HashSetRobinHood<T, H, Eq> &, V &&) noexcept;
+
+//=====================================
+template <typename T, typename H, typename Eq, typename V, typename Compute>
+T *
+lookup_compute(HashSetRobinHood<T, H, Eq> &, const V &needle, Compute) noexcept;
+
+//=====================================
+template <typename T, typename H, typename Eq, typename V>
+bool
+contains(const HashSetRobinHood<T, H, Eq> &, const V &) noexcept;
+
+//=====================================
+/* Leaves no tombstone behind, the entries following the removed one in the
+ * same cluster may be moved which invalidates pointers to them.
+ */
+template <typename T, typename H, typename Eq, typename V>
+bool
+remove(HashSetRobinHood<T, H, Eq> &, const V &) noexcept;
+
+//=====================================
+template <typename T, typename H, typename Eq>
+std::size_t
+capacity(const HashSetRobinHood<T, H, Eq> &) noexcept;
+
+//=====================================
+template <typename T, typename H, typename Eq>
+void
+swap(HashSetRobinHood<T, H, Eq> &, HashSetRobinHood<T, H, Eq> &) noexcept;
+
+//=====================================
+template <typename T, typename H, typename Eq, typename F>
+void
+for_each(HashSetRobinHood<T, H, Eq> &, F) noexcept;
+
+template <typename T, typename H, typename Eq, typename F>
+void
+for_each(const HashSetRobinHood<T, H, Eq> &, F) noexcept;
+
+//=====================================
+/* Probe length statistics, the probe length of an entry is the number of
+ * slots between its home slot and where it is stored.
+ */
+template <typename T, typename H, typename Eq>
+HashSetRobinHoodStats
+stats(const HashSetRobinHood<T, H, Eq> &) noexcept;
+
+//=====================================
+namespace rec {
+template <typename T, typename H, typename Eq>
+bool
+verify(const HashSetRobinHood<T, H, Eq> &) noexcept;
+}
+
+//=====================================
+namespace n {
+template <typename T, typename H, typename Eq>
+std::size_t
+length(const HashSetRobinHood<T, H, Eq> &) noexcept;
+}
+
+template <typename T, typename H, typename Eq>
+std::size_t
+length(const HashSetRobinHood<T, H, Eq> &) noexcept;
+
+//=====================================
+//====Implementation===================
+//=====================================
+template <typename T, typename H, typename Eq>
+HashSetRobinHood<T, H, Eq>::HashSetRobinHood(std::size_t cap) noexcept
+    : table{nullptr}
+    , distance{nullptr}
+    , length{0}
+    , capacity{cap < 16 ? 16 : cap} {
+}
+
+template <typename T, typename H, typename Eq>
+HashSetRobinHood<T, H, Eq>::~HashSetRobinHood() noexcept {
+  if (this->table) {
+    if (!std::is_trivially_destructible<T>::value) {
+      std::size_t gced = 0;
+      for (std::size_t idx = 0; idx < capacity && gced < length; ++idx) {
+        if (this->distance[idx]) {
+          ++gced;
+          T *const v = (T *)&this->table[idx];
+          v->~T();
+        }
+      } // for
+    }
+
+    delete[] this->table;
+  }
+
+  if (this->distance) {
+    delete[] this->distance;
+  }
+
+  this->table = nullptr;
+  this->distance = nullptr;
+  this->length = 0;
+  this->capacity = 0;
+}
+
+inline HashSetRobinHoodStats::HashSetRobinHoodStats() noexcept
+    : length{0}
+    , capacity{0}
+    , max_probe{0}
+    , mean_probe{0}
+    , load_factor{0} {
+}
+
+//=====================================
+namespace impl {
+/* The largest probe distance which can be stored in a slot, an insert that
+ * would go beyond this forces a resize.
+ */
+static constexpr std::size_t HSRH_MAX_DISTANCE = 254;
+
+static inline std::size_t
+hsrh_index_of(std::size_t hash, std::size_t length) noexcept {
+  const std::size_t res = hash & (length - 1);
+  assertx_f({
+    const std::size_t cmp = hash % length;
+    assertxs(res < length, res, length);
+    assertxs(cmp == res, hash, length, cmp, res);
+  });
+  return res;
+}
+
+template <typename T, typename H, typename Eq>
+static bool
+allocate(HashSetRobinHood<T, H, Eq> &self) noexcept {
+  if (!self.table) {
+    using Bucket = typename HashSetRobinHood<T, H, Eq>::Bucket;
+    assertxs(self.capacity > 0, self.capacity);
+    /* the byte size of the table and distances would overflow */
+    constexpr std::size_t slot_bytes = sizeof(Bucket) + sizeof(std::uint8_t);
+    if (self.capacity > std::numeric_limits<std::size_t>::max() / slot_bytes) {
+      return false;
+    }
+
+    Bucket *const table = new (std::nothrow) Bucket[self.capacity];
+    std::uint8_t *const distance =
+        new (std::nothrow) std::uint8_t[self.capacity];
+    if (!table || !distance) {
+      delete[] table;
+      delete[] distance;
+      return false;
+    }
+
+    std::memset(distance, 0, self.capacity);
+    self.table = table;
+    self.distance = distance;
+  }
+
+  return self.table != nullptr;
+}
+
+template <typename T, typename H, typename Eq>
+static bool
+eager_resize(const HashSetRobinHood<T, H, Eq> &self,
+             std::size_t length) noexcept {
+  constexpr std::size_t percent = 2;
+  const std::size_t one_percent = self.capacity / 100;
+  const std::size_t resz = std::max(one_percent * percent, std::size_t(1));
+  const std::size_t resize_length = self.capacity - resz;
+
+  return length > resize_length;
+}
+
+/*
+ * Search for $needle, returns the slot if present. Otherwise $slot and
+ * $dist is where $needle should be placed, capacity if there is no room.
+ */
+template <typename T, typename H, typename Eq, typename V>
+static bool
+find(const HashSetRobinHood<T, H, Eq> &self, std::size_t hash,
+     const V &needle, std::size_t &slot, std::size_t &dist) noexcept {
+  std::size_t idx = hsrh_index_of(hash, self.capacity);
+
+  for (dist = 0; dist <= HSRH_MAX_DISTANCE; ++dist) {
+    const std::size_t current = self.distance[idx];
+    if (current < dist + 1) {
+      /* EMPTY or an entry closer to its home than we have probed, $needle
+       * is not present since it would have taken this slot.
+       */
+      slot = idx;
+      return false;
+    }
+
+    if (current == dist + 1) {
+      /* Same home slot as $needle */
+      const T *const value = (const T *)&self.table[idx];
+
+      Eq equality;
+      if (equality(*value, needle)) {
+        slot = idx;
+        return true;
+      }
+    }
+
+    idx = hsrh_index_of(idx + 1, self.capacity);
+  }
+
+  slot = self.capacity;
+  return false;
+}
+
+/*
+ * Make room at $slot by shifting the entries from $slot up to the next EMPTY
+ * slot one step forward. Returns false if any shifted entry would get a
+ * distance which can not be stored.
+ */
+template <typename T, typename H, typename Eq>
+static bool
+make_room(HashSetRobinHood<T, H, Eq> &self, std::size_t slot) noexcept {
+  std::size_t empty = slot;
+  while (self.distance[empty]) {
+    if (self.distance[empty] > HSRH_MAX_DISTANCE) {
+      return false;
+    }
+
+    empty = hsrh_index_of(empty + 1, self.capacity);
+    if (empty == slot) {
+      return false;
+    }
+  }
+
+  while (empty != slot) {
+    const std::size_t prev =
+        hsrh_index_of(empty + self.capacity - 1, self.capacity);
+
+    T *const src = (T *)&self.table[prev];
+    new (&self.table[empty]) T(std::move(*src));
+    src->~T();
+
+    self.distance[empty] = std::uint8_t(self.distance[prev] + 1);
+    self.distance[prev] = 0;
+    empty = prev;
+  }
+
+  return true;
+}
+
+template <typename T, typename H, typename Eq>
+static T *
+insert_unique(HashSetRobinHood<T, H, Eq> &self, T &&value) noexcept;
+
+template <typename T, typename H, typename Eq>
+static bool
+rehash(HashSetRobinHood<T, H, Eq> &self) noexcept {
+  if (self.capacity > std::numeric_limits<std::size_t>::max() / 2) {
+    return false;
+  }
+
+  HashSetRobinHood<T, H, Eq> tmp(self.capacity * 2);
+  if (!allocate(tmp)) {
+    return false;
+  }
+
+  std::size_t cnt = 0;
+  for (std::size_t idx = 0; idx < self.capacity && cnt < self.length; ++idx) {
+    if (self.distance[idx]) {
+      ++cnt;
+
+      T *const current = (T *)&self.table[idx];
+      T *const ins = insert_unique(tmp, std::move(*current));
+      assertx_n(ins);
+
+      current->~T();
+      self.distance[idx] = 0;
+    }
+  }
+
+  assertxs(cnt == self.length, cnt, self.length);
+  self.length = 0;
+
+  swap(self, tmp);
+  return true;
+}
+
+template <typename T, typename H, typename Eq>
+static T *
+insert_unique(HashSetRobinHood<T, H, Eq> &self, T &&value) noexcept {
+Lretry:
+  if (allocate(self)) {
+    H hash;
+    std::size_t slot = 0;
+    std::size_t dist = 0;
+    const bool found = find(self, hash(value), value, slot, dist);
+    assertx(!found);
+
+    if (slot != self.capacity && make_room(self, slot)) {
+      self.distance[slot] = std::uint8_t(dist + 1);
+      ++self.length;
+
+      T *const result = (T *)&self.table[slot];
+      return new (result) T(std::move(value));
+    }
+
+    if (rehash(self)) {
+      goto Lretry;
+    }
+  }
+
+  return nullptr;
+}
+
+template <typename T, typename H, typename Eq, typename V, typename D,
+          typename F>
+T *
+do_insert(HashSetRobinHood<T, H, Eq> &self, const V &needle, D dup,
+          F fac) noexcept {
+  H hash;
+  const std::size_t h = hash(needle);
+
+Lretry:
+  if (allocate(self)) {
+    std::size_t slot = 0;
+    std::size_t dist = 0;
+    if (find(self, h, needle, slot, dist)) {
+      /* Duplicate */
+      T *const b = (T *)&self.table[slot];
+      return dup(*b, needle);
+    }
+
+    if (slot != self.capacity && !eager_resize(self, self.length + 1)) {
+      if (make_room(self, slot)) {
+        self.distance[slot] = std::uint8_t(dist + 1);
+        T *const result = fac(slot);
+        ++self.length;
+
+        return result;
+      }
+    }
+
+    if (!eager_resize(self, self.length + 1) &&
+        self.length < (self.capacity / 8)) {
+      /* The probe distance overflowed in a sparse table, only a degenerate
+       * hash function gets here and growing the table would not help.
+       */
+      return nullptr;
+    }
+
+    /* Resize before the insert so that the returned pointer stays valid */
+    if (rehash(self)) {
+      goto Lretry;
+    }
+  }
+
+  return nullptr;
+}
+} // namespace impl
+
+template <typename T, typename H, typename Eq, typename V>
+T *
+insert(HashSetRobinHood<T, H, Eq> &self, V &&value) noexcept {
+  auto on_dup = [](const auto &, const auto &) -> T * {
+    /**/
+    return nullptr;
+  };
+
+  auto on_factory = [&self, &value](std::size_t empty) -> T * {
+    T *const result = (T *)(self.table + empty);
+    return new (result) T(std::forward<V>(value));
+  };
+
+  const V &needle = value;
+  return impl::do_insert(self, needle, on_dup, on_factory);
+}
+
+//=====================================
+namespace impl {
+template <typename T, typename H, typename Eq, typename V>
+T *
+lookup_insert(HashSetRobinHood<T, H, Eq> &self, V &&v,
+              bool &inserted) noexcept {
+  auto on_dup = [](auto &bucket, const auto &) -> T * {
+    /**/
+    return &bucket;
+  };
+
+  auto on_factory = [&self, &v, &inserted](std::size_t empty) -> T * {
+    inserted = true;
+    T *const result = (T *)(self.table + empty);
+    return new (result) T(std::forward<V>(v));
+  };
+
+  const auto &needle = v;
+  return impl::do_insert(self, needle, on_dup, on_factory);
+}
+} // namespace impl
+
+template <typename T, typename H, typename Eq, typename V>
+T *
+upsert(HashSetRobinHood<T, H, Eq> &self, V &&needle) noexcept {
+  using namespace impl;
+
+  bool inserted = false;
+  T *const result = lookup_insert(self, std::forward<V>(needle), inserted);
+
+  if (result) {
+    if (!inserted) {
+
+      result->~T();
+      new (result) T(std::forward<V>(needle));
+    }
+  }
+
+  return result;
+}
+
+//=====================================
+template <typename T, typename H, typename Eq, typename V>
+const T *
+lookup(const HashSetRobinHood<T, H, Eq> &self, const V &needle) noexcept {
+  using namespace impl;
+
+  if (self.table) {
+    H hash;
+    std::size_t slot = 0;
+    std::size_t dist = 0;
+    if (find(self, hash(needle), needle, slot, dist)) {
+      return (const T *)&self.table[slot];
+    }
+  }
+
+  return nullptr;
+}
+
+template <typename T, typename H, typename Eq, typename V>
+T *
+lookup(HashSetRobinHood<T, H, Eq> &self, const V &needle) noexcept {
+  const auto &c_self = self;
+  return (T *)lookup(c_self, needle);
+}
+
+//=====================================
+template <typename T, typename H, typename Eq>
+const T *
+lookup_default(const HashSetRobinHood<T, H, Eq> &self, const T &needle,
+               const T &def) noexcept {
+  const T *result = lookup(self, needle);
+  if (!result) {
+    result = &def;
+  }
+
+  return result;
+}
+
+template <typename T, typename H, typename Eq>
+T *
+lookup_default(HashSetRobinHood<T, H, Eq> &self, const T &needle,
+               T &def) noexcept {
+  const auto &c_self = self;
+  const auto &c_def = def;
+  return (T *)lookup_default(c_self, needle, c_def);
+}
+
+//=====================================
+template <typename T, typename H, typename Eq, typename V>
+T *
+lookup_insert(HashSetRobinHood<T, H, Eq> &self, V &&needle) noexcept {
+  using namespace impl;
+
+  bool inserted = false;
+  return lookup_insert(self, std::forward<V>(needle), inserted);
+}
+
+//=====================================
+template <typename T, typename H, typename Eq, typename V, typename C>
+T *
+lookup_compute(HashSetRobinHood<T, H, Eq> &self, const V &needle,
+               C compute) noexcept {
+  auto on_dup = [](T &bucket, const V &) -> T * {
+    /**/
+    return &bucket;
+  };
+
+  auto on_factory = [&self, &compute, &needle](std::size_t empty) -> T * {
+    T *const result = (T *)(self.table + empty);
+    compute(*result, needle);
+
+    return result;
+  };
+
+  return impl::do_insert(self, needle, on_dup, on_factory);
+}
+
+//=====================================
+template <typename T, typename H, typename Eq, typename V>
+bool
+contains(const HashSetRobinHood<T, H, Eq> &self, const V &needle) noexcept {
+  return lookup(self, needle) != nullptr;
+}
+
+//=====================================
+template <typename T, typename H, typename Eq, typename V>
+bool
+remove(HashSetRobinHood<T, H, Eq> &self, const V &needle) noexcept {
+  using namespace impl;
+
+  if (self.table) {
+    H hash;
+    std::size_t slot = 0;
+    std::size_t dist = 0;
+    if (find(self, hash(needle), needle, slot, dist)) {
+      T *const value = (T *)&self.table[slot];
+      value->~T();
+      --self.length;
+
+      /* Backward shift, stop at EMPTY or an entry already in its home slot */
+      std::size_t next = hsrh_index_of(slot + 1, self.capacity);
+      while (self.distance[next] > 1) {
+        T *const src = (T *)&self.table[next];
+        new (&self.table[slot]) T(std::move(*src));
+        src->~T();
+
+        self.distance[slot] = std::uint8_t(self.distance[next] - 1);
+        slot = next;
+        next = hsrh_index_of(slot + 1, self.capacity);
+      }
+      self.distance[slot] = 0;
+
+      return true;
+    }
+  }
+
+  return false;
+}
+
+//=====================================
+template <typename T, typename H, typename Eq>
+std::size_t
+capacity(const HashSetRobinHood<T, H, Eq> &self) noexcept {
+  if (!self.table) {
+    return 0;
+  }
+
+  return self.capacity;
+}
+
+//=====================================
+template <typename T, typename H, typename Eq, typename F>
+void
+for_each(HashSetRobinHood<T, H, Eq> &self, F f) noexcept {
+  if (self.table) {
+    for (std::size_t i = 0; i < self.capacity; ++i) {
+      if (self.distance[i]) {
+        T *const current = (T *)&self.table[i];
+        f(*current);
+      }
+    }
+  }
+}
+
+template <typename T, typename H, typename Eq, typename F>
+void
+for_each(const HashSetRobinHood<T, H, Eq> &self, F f) noexcept {
+  if (self.table) {
+    for (std::size_t i = 0; i < self.capacity; ++i) {
+      if (self.distance[i]) {
+        const T *const current = (const T *)&self.table[i];
+        f(*current);
+      }
+    }
+  }
+}
+
+//=====================================
+template <typename T, typename H, typename Eq>
+void
+swap(HashSetRobinHood<T, H, Eq> &f, HashSetRobinHood<T, H, Eq> &s) noexcept {
+  using std::swap;
+  swap(f.table, s.table);
+  swap(f.distance, s.distance);
+  swap(f.length, s.length);
+  swap(f.capacity, s.capacity);
+}
+
+//=====================================
+template <typename T, typename H, typename Eq>
+HashSetRobinHoodStats
+stats(const HashSetRobinHood<T, H, Eq> &self) noexcept {
+  HashSetRobinHoodStats result;
+  result.length = self.length;
+  result.capacity = capacity(self);
+
+  if (self.table) {
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < self.capacity; ++i) {
+      if (self.distance[i]) {
+        const std::size_t dist = std::size_t(self.distance[i] - 1);
+        result.max_probe = std::max(result.max_probe, dist);
+        total += dist;
+      }
+    }
+
+    if (self.length > 0) {
+      result.mean_probe = double(total) / double(self.length);
+    }
+    result.load_factor = double(self.length) / double(self.capacity);
+  }
+
+  return result;
+}
+
+//=====================================
+namespace rec {
+template <typename T, typename H, typename Eq>
+bool
+verify(const HashSetRobinHood<T, H, Eq> &self) noexcept {
+  using namespace sp::impl;
+
+  if (sp::n::length(self) != length(self)) {
+    assertxs(sp::n::length(self) == length(self), sp::n::length(self),
+             length(self), capacity(self));
+    return false;
+  }
+
+  if (self.table) {
+    for (std::size_t i = 0; i < self.capacity; ++i) {
+      if (self.distance[i]) {
+        const T *const current = (const T *)&self.table[i];
+
+        H hash;
+        const std::size_t home = hsrh_index_of(hash(*current), self.capacity);
+        const std::size_t dist =
+            hsrh_index_of(i + self.capacity - home, self.capacity);
+        assertxs(dist + 1 == self.distance[i], dist, self.distance[i], i);
+
+        /* Robin Hood invariant, distances along a cluster increase by at
+         * most one per slot */
+        const std::size_t next = hsrh_index_of(i + 1, self.capacity);
+        assertxs(self.distance[next] <= self.distance[i] + 1,
+                 self.distance[next], self.distance[i], i);
+      }
+    }
+  }
+
+  return true;
+}
+} // namespace rec
+
+//=====================================
+namespace n {
+template <typename T, typename H, typename Eq>
+std::size_t
+length(const HashSetRobinHood<T, H, Eq> &self) noexcept {
+  std::size_t result = 0;
+  for_each(self, [&result](const auto &) {
+    /**/
+    ++result;
+  });
+  return result;
+}
+} // namespace n
+
+template <typename T, typename H, typename Eq>
+std::size_t
+length(const HashSetRobinHood<T, H, Eq> &self) noexcept {
+  return self.length;
+}
+
+//=====================================
+} // namespace sp
+
+#endif
@@ -0,0 +1 @@
+#include "HashSetSplitOrdered.h"
@@ -0,0 +1,825 @@
+#ifndef SP_UTIL_MAP_HASH_SET_SPLIT_ORDERED_H
+#define SP_UTIL_MAP_HASH_SET_SPLIT_ORDERED_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <hash/standard.h>
+#include <type_traits>
+#include <util/assert.h>
+#include <utility>
+
+/*
+ * Lock-free split-ordered list hash set (Shalev, Shavit)
+ *
+ * All entries are kept in a single lock-free linked list (Michael) sorted by
+ * the bit reversed hash. A bucket is a pointer to a dummy node in the list,
+ * since the order is bit reversed the entries of bucket[b] in a table of
+ * size 2n are split between bucket[b] and bucket[b + n] which are adjacent in
+ * the list. Growing the table is therefore only a CAS of the bucket count, no
+ * entry is ever moved. Buckets are initialized lazily by the first insert or
+ * remove touching them, by splicing in a dummy node after its parent bucket.
+ *
+ * Like HashSetTree this splits hash ranges in to smaller parts, but here the
+ * "nodes" are the dummy list nodes and the bucket directory is a segmented
+ * array that is only ever appended to.
+ *
+ * Lookups never write to the set, not even to initialize a bucket, instead
+ * they start from the closest initialized parent bucket.
+ *
+ * Removed entries are reclaimed using epoch based reclamation (Fraser). Every
+ * operation registers itself in the current epoch for as long as it
+ * traverses the list. An unlinked node is put on the retired stack of the
+ * epoch it was unlinked in, it can only be referenced by operations which
+ * registered in that epoch or earlier. The epoch is only advanced when no
+ * operation is left in the previous epoch, the retired stack of the previous
+ * epoch is then freed. Two epochs are therefore enough, the stack of the
+ * previous epoch is reused for the next one. A stalled operation delays the
+ * reclamation but never makes it unsafe.
+ */
+namespace sp {
+namespace impl {
+//=====================================
+template <typename T>
+struct HSSONode {
+  using st = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+  /* bit reversed hash, LSB is 1 for regular and 0 for dummy nodes */
+  const std::size_t key;
+  /* LSB is the deleted mark of this node */
+  std::atomic<std::uintptr_t> next;
+  HSSONode<T> *retired;
+  st value;
+
+  explicit HSSONode(std::size_t) noexcept;
+};
+
+static constexpr std::size_t HSSO_SEGMENTS = sizeof(std::size_t) * 8;
+} // namespace impl
+
+//=====================================
+template <typename T, typename Hash = sp::Hasher<T>,
+          typename Eq = sp::Equality<T>>
+struct HashSetSplitOrdered {
+  using value_type = T;
+  using Node = impl::HSSONode<T>;
+  using Bucket = std::atomic<Node *>;
+
+  /* segment[0]: bucket[0, 2), segment[n]: bucket[2^n, 2^(n+1)) */
+  std::atomic<Bucket *> segments[impl::HSSO_SEGMENTS];
+  std::atomic<std::size_t> buckets;
+  std::atomic<std::size_t> length;
+
+  /* monotonic, the lowest bit selects $readers and $retired */
+  std::atomic<std::size_t> epoch;
+  mutable std::atomic<std::size_t> readers[2];
+  std::atomic<Node *> retired[2];
+
+  explicit HashSetSplitOrdered(std::size_t buckets = 16) noexcept;
+
+  HashSetSplitOrdered(const HashSetSplitOrdered &) = delete;
+  HashSetSplitOrdered(const HashSetSplitOrdered &&) = delete;
+
+  ~HashSetSplitOrdered() noexcept;
+};
+
+//=====================================
+/* returns null on duplicate, see lookup() for the lifetime of the result
+ */
+template <typename T, typename H, typename Eq, typename V>
+T *
+insert(HashSetSplitOrdered<T, H, Eq> &, V &&) noexcept;
+
+//=====================================
+/* The returned pointer is valid until the entry is removed, readers which
+ * race with a remove of the same entry should use the $f version
+ */
+template <typename T, typename H, typename Eq, typename V>
+const T *
+lookup(const HashSetSplitOrdered<T, H, Eq> &, const V &) noexcept;
+
+/* Invokes $f(const T&) with the entry while it can not be reclaimed, returns
+ * false if not present
+ */
+template <typename T, typename H, typename Eq, typename V, typename F>
+bool
+lookup(const HashSetSplitOrdered<T, H, Eq> &, const V &, F f) noexcept;
+
+//=====================================
+template <typename T, typename H, typename Eq, typename V>
+bool
+contains(const HashSetSplitOrdered<T, H, Eq> &, const V &) noexcept;
+
+//=====================================
+template <typename T, typename H, typename Eq, typename V>
+bool
+remove(HashSetSplitOrdered<T, H, Eq> &, const V &) noexcept;
+
+//=====================================
+template <typename T, typename H, typename Eq, typename F>
+void
+for_each(const HashSetSplitOrdered<T, H, Eq> &, F) noexcept;
+
+//=====================================
+template <typename T, typename H, typename Eq>
+std::size_t
+length(const HashSetSplitOrdered<T, H, Eq> &) noexcept;
+
+//=====================================
+namespace rec {
+/* Not thread safe */
+template <typename T, typename H, typename Eq>
+bool
+verify(const HashSetSplitOrdered<T, H, Eq> &) noexcept;
+}
+
+//=====================================
+namespace n {
+template <typename T, typename H, typename Eq>
+std::size_t
+length(const HashSetSplitOrdered<T, H, Eq> &) noexcept;
+}
+
+//=====================================
+//====Implementation===================
+//=====================================
+namespace impl {
+template <typename T>
+HSSONode<T>::HSSONode(std::size_t k) noexcept
+    : key(k)
+    , next(0)
+    , retired(nullptr)
+    , value() {
+}
+
+//=====================================
+static inline std::uint64_t
+hsso_reverse(std::uint64_t in) noexcept {
+  constexpr std::uint64_t m1 = 0x5555555555555555ull;
+  constexpr std::uint64_t m2 = 0x3333333333333333ull;
+  constexpr std::uint64_t m4 = 0x0F0F0F0F0F0F0F0Full;
+
+  in = ((in >> 1) & m1) | ((in & m1) << 1);
+  in = ((in >> 2) & m2) | ((in & m2) << 2);
+  in = ((in >> 4) & m4) | ((in & m4) << 4);
+  return __builtin_bswap64(in);
+}
+
+static inline std::size_t
+hsso_regular_key(std::size_t hash) noexcept {
+  return hsso_reverse(hash) | 1;
+}
+
+static inline std::size_t
+hsso_dummy_key(std::size_t bucket) noexcept {
+  return hsso_reverse(bucket);
+}
+
+/* bucket with the most significant bit cleared */
+static inline std::size_t
+hsso_parent(std::size_t bucket) noexcept {
+  assertx(bucket > 0);
+  const std::size_t msb = std::size_t(1) << (63 - __builtin_clzll(bucket));
+  return bucket & ~msb;
+}
+
+static inline std::size_t
+hsso_segment(std::size_t bucket) noexcept {
+  if (bucket < 2) {
+    return 0;
+  }
+  return std::size_t(63 - __builtin_clzll(bucket));
+}
+
+static inline std::size_t
+hsso_segment_length(std::size_t segment) noexcept {
+  return segment == 0 ? 2 : std::size_t(1) << segment;
+}
+
+static inline std::size_t
+hsso_segment_offset(std::size_t segment, std::size_t bucket) noexcept {
+  return segment == 0 ? bucket : bucket - (std::size_t(1) << segment);
+}
+
+//=====================================
+template <typename T>
+static inline HSSONode<T> *
+hsso_ptr(std::uintptr_t next) noexcept {
+  return reinterpret_cast<HSSONode<T> *>(next & ~std::uintptr_t(1));
+}
+
+static inline bool
+hsso_is_marked(std::uintptr_t next) noexcept {
+  return (next & 1) != 0;
+}
+
+template <typename T>
+static inline std::uintptr_t
+hsso_ref(HSSONode<T> *node) noexcept {
+  return reinterpret_cast<std::uintptr_t>(node);
+}
+
+template <typename T>
+static inline const T *
+hsso_value(const HSSONode<T> *node) noexcept {
+  return reinterpret_cast<const T *>(&node->value);
+}
+
+template <typename T, typename Eq, typename V>
+static inline bool
+hsso_match(const HSSONode<T> *node, std::size_t key, const V &needle) noexcept {
+  if (node->key != key) {
+    return false;
+  }
+
+  if ((key & 1) == 0) {
+    /* dummy nodes are unique per key */
+    return true;
+  }
+
+  Eq equality;
+  return equality(*hsso_value(node), needle);
+}
+
+//=====================================
+/* returns the bucket slot or null if the segment is not yet allocated
+ */
+template <typename T, typename H, typename Eq>
+static std::atomic<HSSONode<T> *> *
+bucket_slot(const HashSetSplitOrdered<T, H, Eq> &self,
+            std::size_t bucket) noexcept {
+  const std::size_t seg = hsso_segment(bucket);
+  auto *const segment = self.segments[seg].load(std::memory_order_acquire);
+  if (!segment) {
+    return nullptr;
+  }
+
+  return segment + hsso_segment_offset(seg, bucket);
+}
+
+template <typename T, typename H, typename Eq>
+static std::atomic<HSSONode<T> *> *
+bucket_slot_alloc(HashSetSplitOrdered<T, H, Eq> &self,
+                  std::size_t bucket) noexcept {
+  using Bucket = typename HashSetSplitOrdered<T, H, Eq>::Bucket;
+
+  const std::size_t seg = hsso_segment(bucket);
+  Bucket *segment = self.segments[seg].load(std::memory_order_acquire);
+  if (!segment) {
+    const std::size_t len = hsso_segment_length(seg);
+    Bucket *const fresh = new Bucket[len];
+    for (std::size_t i = 0; i < len; ++i) {
+      fresh[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    if (self.segments[seg].compare_exchange_strong(segment, fresh)) {
+      segment = fresh;
+    } else {
+      /* lost the race, $segment now contains the winning segment */
+      delete[] fresh;
+    }
+  }
+
+  return segment + hsso_segment_offset(seg, bucket);
+}
+
+//=====================================
+/* Registers the calling thread in the current epoch for the lifetime of the
+ * guard, no node reachable from the list is freed while it is alive
+ */
+template <typename T, typename H, typename Eq>
+struct HSSOGuard {
+  const HashSetSplitOrdered<T, H, Eq> &set;
+  std::size_t idx;
+
+  explicit HSSOGuard(const HashSetSplitOrdered<T, H, Eq> &s) noexcept
+      : set(s)
+      , idx(0) {
+    while (true) {
+      const std::size_t e = set.epoch.load();
+      idx = e & 1;
+      set.readers[idx].fetch_add(1);
+      /* the epoch can have advanced before we were counted */
+      if (set.epoch.load() == e) {
+        break;
+      }
+      set.readers[idx].fetch_sub(1);
+    }
+  }
+
+  HSSOGuard(const HSSOGuard &) = delete;
+
+  ~HSSOGuard() noexcept {
+    set.readers[idx].fetch_sub(1);
+  }
+};
+
+template <typename T>
+static void
+hsso_free(HSSONode<T> *it) noexcept {
+  while (it) {
+    HSSONode<T> *const next = it->retired;
+    if (it->key & 1) {
+      T *const value = (T *)&it->value;
+      value->~T();
+    }
+    delete it;
+    it = next;
+  }
+}
+
+template <typename T>
+static void
+hsso_push(std::atomic<HSSONode<T> *> &stack, HSSONode<T> *first,
+          HSSONode<T> *last) noexcept {
+  HSSONode<T> *head = stack.load(std::memory_order_relaxed);
+  do {
+    last->retired = head;
+  } while (!stack.compare_exchange_weak(head, first));
+}
+
+/* $node is unlinked, put it on the retired stack of the current epoch
+ */
+template <typename T, typename H, typename Eq>
+static void
+retire(HashSetSplitOrdered<T, H, Eq> &self, HSSONode<T> *node) noexcept {
+  hsso_push(self.retired[self.epoch.load() & 1], node, node);
+}
+
+/* Advance the epoch if no operation is left in the previous epoch and free
+ * the nodes retired during it
+ */
+template <typename T, typename H, typename Eq>
+static void
+reclaim(HashSetSplitOrdered<T, H, Eq> &self) noexcept {
+  std::size_t e = self.epoch.load();
+  const std::size_t previous = (e + 1) & 1;
+  if (self.readers[previous].load() != 0) {
+    return;
+  }
+  if (!self.retired[previous].load() && !self.retired[e & 1].load()) {
+    /* nothing to reclaim, do not contend on the epoch */
+    return;
+  }
+
+  HSSONode<T> *const list = self.retired[previous].exchange(nullptr);
+  if (!self.epoch.compare_exchange_strong(e, e + 1)) {
+    /* another thread advanced the epoch, the nodes are handed back and freed
+     * in a later epoch */
+    if (list) {
+      HSSONode<T> *last = list;
+      while (last->retired) {
+        last = last->retired;
+      }
+      hsso_push(self.retired[previous], list, last);
+    }
+    return;
+  }
+
+  hsso_free(list);
+}
+
+//=====================================
+/* Michael list search starting at $head. On return $prev points to the link
+ * which should point to $cur, $cur is either the matching node or the first
+ * node which sorts after $key. Marked nodes found on the way are unlinked.
+ */
+template <typename T, typename H, typename Eq, typename V>
+static bool
+find(HashSetSplitOrdered<T, H, Eq> &self, HSSONode<T> *head, std::size_t key,
+     const V &needle, std::atomic<std::uintptr_t> *&prev,
+     HSSONode<T> *&cur) noexcept {
+Lretry:
+  prev = &head->next;
+  cur = hsso_ptr<T>(prev->load(std::memory_order_acquire));
+
+  while (cur) {
+    std::uintptr_t next = cur->next.load(std::memory_order_acquire);
+
+    if (hsso_is_marked(next)) {
+      /* $cur is logically deleted, help unlinking it */
+      std::uintptr_t expected = hsso_ref(cur);
+      if (!prev->compare_exchange_strong(expected, next & ~std::uintptr_t(1))) {
+        goto Lretry;
+      }
+
+      retire(self, cur);
+
+      cur = hsso_ptr<T>(next);
+      continue;
+    }
+
+    if (cur->key > key) {
+      return false;
+    }
+
+    if (hsso_match<T, Eq>(cur, key, needle)) {
+      return true;
+    }
+
+    if (prev->load(std::memory_order_acquire) != hsso_ref(cur)) {
+      goto Lretry;
+    }
+
+    prev = &cur->next;
+    cur = hsso_ptr<T>(next);
+  }
+
+  return false;
+}
+
+/* Read only search, does not help with unlinking
+ */
+template <typename T, typename Eq, typename V>
+static const HSSONode<T> *
+search(const HSSONode<T> *head, std::size_t key, const V &needle) noexcept {
+  const HSSONode<T> *cur =
+      hsso_ptr<T>(head->next.load(std::memory_order_acquire));
+
+  while (cur && cur->key <= key) {
+    const std::uintptr_t next = cur->next.load(std::memory_order_acquire);
+    if (!hsso_is_marked(next) && hsso_match<T, Eq>(cur, key, needle)) {
+      return cur;
+    }
+
+    cur = hsso_ptr<T>(next);
+  }
+
+  return nullptr;
+}
+
+//=====================================
+template <typename T, typename H, typename Eq>
+static HSSONode<T> *
+initialize_bucket(HashSetSplitOrdered<T, H, Eq> &self,
+                  std::size_t bucket) noexcept;
+
+template <typename T, typename H, typename Eq>
+static HSSONode<T> *
+bucket_head(HashSetSplitOrdered<T, H, Eq> &self, std::size_t bucket) noexcept {
+  std::atomic<HSSONode<T> *> *const slot = bucket_slot_alloc(self, bucket);
+
+  HSSONode<T> *const head = slot->load(std::memory_order_acquire);
+  if (head) {
+    return head;
+  }
+
+  return initialize_bucket(self, bucket);
+}
+
+template <typename T, typename H, typename Eq>
+static HSSONode<T> *
+initialize_bucket(HashSetSplitOrdered<T, H, Eq> &self,
+                  std::size_t bucket) noexcept {
+  HSSONode<T> *const parent = bucket_head(self, hsso_parent(bucket));
+
+  const std::size_t key = hsso_dummy_key(bucket);
+  HSSONode<T> *const dummy = new HSSONode<T>(key);
+
+  HSSONode<T> *result = nullptr;
+  while (!result) {
+    std::atomic<std::uintptr_t> *prev = nullptr;
+    HSSONode<T> *cur = nullptr;
+    /* dummy nodes does not have a value, $needle is never compared */
+    if (find(self, parent, key, *hsso_value(dummy), prev, cur)) {
+      /* someone else initialized it */
+      delete dummy;
+      result = cur;
+    } else {
+      dummy->next.store(hsso_ref(cur), std::memory_order_relaxed);
+      std::uintptr_t expected = hsso_ref(cur);
+      if (prev->compare_exchange_strong(expected, hsso_ref(dummy))) {
+        result = dummy;
+      }
+    }
+  }
+
+  bucket_slot_alloc(self, bucket)->store(result, std::memory_order_release);
+  return result;
+}
+
+/* Closest initialized bucket which covers $bucket
+ */
+template <typename T, typename H, typename Eq>
+static const HSSONode<T> *
+bucket_head(const HashSetSplitOrdered<T, H, Eq> &self,
+            std::size_t bucket) noexcept {
+  while (true) {
+    auto *const slot = bucket_slot(self, bucket);
+    if (slot) {
+      const HSSONode<T> *const head = slot->load(std::memory_order_acquire);
+      if (head) {
+        return head;
+      }
+    }
+
+    assertx(bucket > 0);
+    bucket = hsso_parent(bucket);
+  }
+}
+} // namespace impl
+
+//=====================================
+template <typename T, typename H, typename Eq>
+HashSetSplitOrdered<T, H, Eq>::HashSetSplitOrdered(std::size_t cap) noexcept
+    : segments{}
+    , buckets{2}
+    , length{0}
+    , epoch{0}
+    , readers{}
+    , retired{} {
+  for (auto &segment : segments) {
+    segment.store(nullptr, std::memory_order_relaxed);
+  }
+  for (std::size_t i = 0; i < 2; ++i) {
+    readers[i].store(0, std::memory_order_relaxed);
+    retired[i].store(nullptr, std::memory_order_relaxed);
+  }
+
+  std::size_t b = 2;
+  while (b < cap) {
+    b <<= 1;
+  }
+  buckets.store(b, std::memory_order_relaxed);
+
+  /* bucket[0] is the head of the list */
+  impl::bucket_slot_alloc(*this, 0)->store(new Node(0));
+}
+
+template <typename T, typename H, typename Eq>
+HashSetSplitOrdered<T, H, Eq>::~HashSetSplitOrdered() noexcept {
+  using namespace impl;
+
+  Node *it = impl::bucket_slot(*this, 0)->load();
+  while (it) {
+    Node *const next = hsso_ptr<T>(it->next.load());
+    it->retired = nullptr;
+    hsso_free(it);
+    it = next;
+  }
+
+  for (auto &stack : retired) {
+    hsso_free(stack.exchange(nullptr));
+  }
+
+  for (auto &segment : segments) {
+    delete[] segment.load();
+    segment.store(nullptr);
+  }
+}
+
+//=====================================
+namespace impl {
+template <typename T, typename H, typename Eq>
+static void
+grow(HashSetSplitOrdered<T, H, Eq> &self, std::size_t len) noexcept {
+  /* Average chain length of a bucket */
+  constexpr std::size_t load_factor = 2;
+
+  std::size_t buckets = self.buckets.load(std::memory_order_relaxed);
+  if (len / buckets > load_factor) {
+    if (buckets < (std::size_t(1) << (HSSO_SEGMENTS - 1))) {
+      self.buckets.compare_exchange_strong(buckets, buckets * 2);
+    }
+  }
+}
+
+template <typename T, typename H, typename Eq, typename V>
+static T *
+insert_node(HashSetSplitOrdered<T, H, Eq> &self, V &&value) noexcept {
+  H hash;
+  const std::size_t h = hash(value);
+  const std::size_t key = hsso_regular_key(h);
+
+  const std::size_t buckets = self.buckets.load(std::memory_order_acquire);
+  HSSONode<T> *const head = bucket_head(self, h & (buckets - 1));
+
+  HSSONode<T> *node = nullptr;
+  while (true) {
+    std::atomic<std::uintptr_t> *prev = nullptr;
+    HSSONode<T> *cur = nullptr;
+    if (find(self, head, key, value, prev, cur)) {
+      if (node) {
+        T *const v = (T *)&node->value;
+        v->~T();
+        delete node;
+      }
+
+      return nullptr;
+    }
+
+    if (!node) {
+      node = new HSSONode<T>(key);
+      new (&node->value) T(std::forward<V>(value));
+    }
+
+    node->next.store(hsso_ref(cur), std::memory_order_relaxed);
+    std::uintptr_t expected = hsso_ref(cur);
+    if (prev->compare_exchange_strong(expected, hsso_ref(node))) {
+      break;
+    }
+  }
+
+  const std::size_t len = self.length.fetch_add(1) + 1;
+  grow(self, len);
+
+  return (T *)&node->value;
+}
+} // namespace impl
+
+template <typename T, typename H, typename Eq, typename V>
+T *
+insert(HashSetSplitOrdered<T, H, Eq> &self, V &&value) noexcept {
+  T *result = nullptr;
+  {
+    impl::HSSOGuard<T, H, Eq> guard(self);
+    result = impl::insert_node(self, std::forward<V>(value));
+  }
+  impl::reclaim(self);
+
+  return result;
+}
+
+//=====================================
+template <typename T, typename H, typename Eq, typename V, typename F>
+bool
+lookup(const HashSetSplitOrdered<T, H, Eq> &self, const V &needle,
+       F f) noexcept {
+  using namespace impl;
+  HSSOGuard<T, H, Eq> guard(self);
+
+  H hash;
+  const std::size_t h = hash(needle);
+  const std::size_t key = hsso_regular_key(h);
+
+  const std::size_t buckets = self.buckets.load(std::memory_order_acquire);
+  const HSSONode<T> *const head = bucket_head(self, h & (buckets - 1));
+
+  const HSSONode<T> *const result = search<T, Eq>(head, key, needle);
+  if (result) {
+    f(*hsso_value(result));
+    return true;
+  }
+
+  return false;
+}
+
+template <typename T, typename H, typename Eq, typename V>
+const T *
+lookup(const HashSetSplitOrdered<T, H, Eq> &self, const V &needle) noexcept {
+  const T *result = nullptr;
+  lookup(self, needle, [&result](const T &value) {
+    /**/
+    result = &value;
+  });
+
+  return result;
+}
+
+//=====================================
+template <typename T, typename H, typename Eq, typename V>
+bool
+contains(const HashSetSplitOrdered<T, H, Eq> &self, const V &needle) noexcept {
+  return lookup(self, needle) != nullptr;
+}
+
+//=====================================
+namespace impl {
+template <typename T, typename H, typename Eq, typename V>
+static bool
+remove_node(HashSetSplitOrdered<T, H, Eq> &self, const V &needle) noexcept {
+  H hash;
+  const std::size_t h = hash(needle);
+  const std::size_t key = hsso_regular_key(h);
+
+  const std::size_t buckets = self.buckets.load(std::memory_order_acquire);
+  HSSONode<T> *const head = bucket_head(self, h & (buckets - 1));
+
+  while (true) {
+    std::atomic<std::uintptr_t> *prev = nullptr;
+    HSSONode<T> *cur = nullptr;
+    if (!find(self, head, key, needle, prev, cur)) {
+      return false;
+    }
+
+    std::uintptr_t next = cur->next.load(std::memory_order_acquire);
+    if (hsso_is_marked(next)) {
+      continue;
+    }
+
+    /* Logical delete, the thread that marks the node owns the removal */
+    if (!cur->next.compare_exchange_strong(next, next | 1)) {
+      continue;
+    }
+    self.length.fetch_sub(1);
+
+    /* Physical delete, if it fails the next find() will unlink it */
+    std::uintptr_t expected = hsso_ref(cur);
+    if (prev->compare_exchange_strong(expected, next)) {
+      retire(self, cur);
+    } else {
+      find(self, head, key, needle, prev, cur);
+    }
+
+    return true;
+  }
+}
+} // namespace impl
+
+template <typename T, typename H, typename Eq, typename V>
+bool
+remove(HashSetSplitOrdered<T, H, Eq> &self, const V &needle) noexcept {
+  bool result = false;
+  {
+    impl::HSSOGuard<T, H, Eq> guard(self);
+    result = impl::remove_node(self, needle);
+  }
+  impl::reclaim(self);
+
+  return result;
+}
+
+//=====================================
+template <typename T, typename H, typename Eq, typename F>
+void
+for_each(const HashSetSplitOrdered<T, H, Eq> &self, F f) noexcept {
+  using namespace impl;
+  HSSOGuard<T, H, Eq> guard(self);
+
+  const HSSONode<T> *it = bucket_head(self, 0);
+  while (it) {
+    const std::uintptr_t next = it->next.load(std::memory_order_acquire);
+    if ((it->key & 1) && !hsso_is_marked(next)) {
+      f(*hsso_value(it));
+    }
+    it = hsso_ptr<T>(next);
+  }
+}
+
+//=====================================
+template <typename T, typename H, typename Eq>
+std::size_t
+length(const HashSetSplitOrdered<T, H, Eq> &self) noexcept {
+  return self.length.load(std::memory_order_relaxed);
+}
+
+//=====================================
+namespace rec {
+template <typename T, typename H, typename Eq>
+bool
+verify(const HashSetSplitOrdered<T, H, Eq> &self) noexcept {
+  using namespace sp::impl;
+
+  const std::size_t buckets = self.buckets.load();
+  const HSSONode<T> *it = bucket_head(self, 0);
+  const HSSONode<T> *priv = nullptr;
+  while (it) {
+    const std::uintptr_t next = it->next.load();
+    assertxs(!hsso_is_marked(next), it->key);
+
+    if (priv) {
+      assertxs(priv->key <= it->key, priv->key, it->key);
+    }
+
+    if (it->key & 1) {
+      H hash;
+      const std::size_t h = hash(*hsso_value(it));
+      assertxs(hsso_regular_key(h) == it->key, h, it->key);
+    }
+
+    priv = it;
+    it = hsso_ptr<T>(next);
+  }
+
+  for (std::size_t b = 0; b < buckets; ++b) {
+    auto *const slot = bucket_slot(self, b);
+    if (slot) {
+      const HSSONode<T> *const head = slot->load();
+      if (head) {
+        assertxs(head->key == hsso_dummy_key(b), head->key, b);
+      }
+    }
+  }
+
+  return true;
+}
+} // namespace rec
+
+//=====================================
+namespace n {
+template <typename T, typename H, typename Eq>
+std::size_t
+length(const HashSetSplitOrdered<T, H, Eq> &self) noexcept {
+  std::size_t result = 0;
+  for_each(self, [&result](const auto &) {
+    /**/
+    ++result;
+  });
+  return result;
+}
+} // namespace n
+
+//=====================================
+} // namespace sp
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef SP_UTIL_MAP_HASH_SET_TREE_H
 #define SP_UTIL_MAP_HASH_SET_TREE_H
 
+#include <cstdint>
+#include <cstring>
 #include <hash/standard.h>
 #include <hash/util.h>
 #include <limits>
@@ -15,8 +17,6 @@
 
 // TODO mix of hash to avoid identity 1 -> 1 hash problem
 // TODO remove(set,key)
-// TODO dynamic node size, not template size look at sparse bitset?
-// TODO load factor?
 //
 
 // XXX if trivialy copyable we can ignore dtor?
@@ -40,50 +40,53 @@
  */
 namespace sp {
 namespace impl {
-/* An HashSetTree implementation using separate chaining collision handling
- * strategy. Meaning on hash collision we place the new entry in a linkedlist
- * pointed to by the bucket.
+/* An HashSetTree implementation where the hash space is split into nodes.
+ * Each node is responsible for handling a range of hashes. Nodes are placed in
+ * an binary search tree and can are accessed by searching for them using a
+ * hash code.
  *
- * Buckets are split into nodes, which is a group of buckets. Each nodes are
- * responsible for handling a range of hashes. Nodes are placed in an binary
- * search tree and can are accessed by searching for them using a hash code.
+ * Within a node entries are stored in a flat open addressing table using
+ * linear probing, no allocation is done per entry. Next to the table is an
+ * array of tags, one byte per slot, which is 0 for an empty slot otherwise
+ * 7 bits of the hash not used by the slot index so that most mismatches can be
+ * rejected without comparing values. Removal uses backward shift deletion so
+ * no tombstones are required.
  *
- * When a node element count exceed a threshold the node is split in two by
+ * The node table starts small and is doubled when the node gets full, until
+ * it reaches the node max capacity. After that the node is split in two by
  * dividing the hash range responsibility in two and creating a new node
- * responsible for the second half of the divided hash range. The rehash
- * operation of the original node is performed by for each element in node,
- * calculate its hash value, determine if the hash falls in the domain of the
- * original or the new nodes hash range, if element is supposed to be in the
- * new node; then move it there. The new node is then inserted the node tree.
+ * responsible for the second half of the divided hash range. The entries of
+ * the original node are then redistributed between the two nodes depending on
+ * which hash range they fall in. The new node is then inserted the node tree.
+ * If the hash range is too small to split the node table keeps growing.
  */
 
-//=====================================
-template <typename T>
-struct HSBucket {
-  using st = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
-  HSBucket<T> *next;
-  st value;
-  bool present;
-
-  HSBucket() noexcept;
-  ~HSBucket() noexcept;
-};
-
 //=====================================
 struct HashKey;
 
 //=====================================
 template <typename T, std::size_t c = 256>
 struct HSNode {
-  static constexpr std::size_t capacity = c;
+  using Bucket = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+  static constexpr std::size_t min_capacity = 8;
+  static constexpr std::size_t max_capacity = c;
+
   std::size_t entries;
 
   const std::size_t start;
   std::size_t length;
 
-  HSBucket<T> buckets[c];
+  std::size_t capacity;
+  Bucket *table;
+  /* 0: EMPTY, otherwise 0x80 | 7 bits of the hash, see tag_of() */
+  std::uint8_t *tags;
 
   HSNode(std::size_t, std::size_t) noexcept;
+  HSNode(HSNode<T, c> &&) noexcept;
+  HSNode(const HSNode<T, c> &) = delete;
+
+  ~HSNode() noexcept;
 
   bool
   operator>(const HashKey &) const noexcept;
@@ -205,34 +208,56 @@ length(const HashSetTree<T, H, Eq> &) noexcept;
 //====Implementation===================
 //=====================================
 namespace impl {
-template <typename T>
-HSBucket<T>::HSBucket() noexcept
-    : next{nullptr}
-    , value()
-    , present(false) {
-}
+template <typename T, std::size_t c>
+constexpr std::size_t HSNode<T, c>::min_capacity;
 
-template <typename T>
-HSBucket<T>::~HSBucket() noexcept {
-  if (present) {
-    present = false;
-    T *const v = (T *)&value;
-    v->~T();
-  }
-  if (next) {
-    // rec
-    delete next;
-    next = nullptr;
-  }
-}
+template <typename T, std::size_t c>
+constexpr std::size_t HSNode<T, c>::max_capacity;
 
-//=====================================
 template <typename T, std::size_t c>
 HSNode<T, c>::HSNode(std::size_t strt, std::size_t len) noexcept
     : entries(0)
     , start(strt)
     , length{len}
-    , buckets{} {
+    , capacity{0}
+    , table{nullptr}
+    , tags{nullptr} {
+}
+
+template <typename T, std::size_t c>
+HSNode<T, c>::HSNode(HSNode<T, c> &&o) noexcept
+    : entries(o.entries)
+    , start(o.start)
+    , length{o.length}
+    , capacity{o.capacity}
+    , table{o.table}
+    , tags{o.tags} {
+  o.entries = 0;
+  o.capacity = 0;
+  o.table = nullptr;
+  o.tags = nullptr;
+}
+
+template <typename T, std::size_t c>
+HSNode<T, c>::~HSNode() noexcept {
+  if (table) {
+    if (!std::is_trivially_destructible<T>::value) {
+      for (std::size_t i = 0; i < capacity; ++i) {
+        if (tags[i]) {
+          T *const v = (T *)&table[i];
+          v->~T();
+        }
+      }
+    }
+
+    delete[] table;
+    delete[] tags;
+  }
+
+  entries = 0;
+  capacity = 0;
+  table = nullptr;
+  tags = nullptr;
 }
 
 template <typename T, std::size_t c>
@@ -342,147 +367,6 @@ namespace impl {
 //     n |= n >>> 16;
 //     return (n < 0) ? 1 : (n >= MAXIMUM_CAPACITY) ? MAXIMUM_CAPACITY : n + 1;
 // }
-template <typename T, typename V, typename Eq>
-static bool
-bucket_remove(HSBucket<T> &node, const V &needle, Eq eq) noexcept {
-  HSBucket<T> *current = &node;
-Lit:
-  if (current) {
-    if (current->present) {
-      T *const existing = (T *)&current->value;
-      if (eq(*existing, needle)) {
-        current->present = false;
-        existing->~T();
-
-        return true;
-      }
-    }
-
-    current = current->next;
-    goto Lit;
-  }
-
-  return false;
-}
-
-template <typename T, typename V, typename Fact, typename Dup, typename Eq>
-static T *
-bucket_factory(HSBucket<T> &node, const V &in, Fact f, Dup d, Eq eq) noexcept {
-  HSBucket<T> *current = &node;
-Lit:
-  if (current) {
-    if (current->present) {
-      const T *const existing = (const T *)&current->value;
-      if (eq(*existing, in)) {
-        /* Already present */
-        return d(*current);
-      }
-    }
-
-    if (current->next) {
-      current = current->next;
-      goto Lit;
-    }
-
-    if (current->present) {
-      current = current->next = new (std::nothrow) HSBucket<T>;
-    }
-
-    if (current) {
-      T *const current_value = (T *)&current->value;
-      assertx(!current->present);
-      current->present = true;
-      f(*current_value, in);
-      return current_value;
-    }
-
-  } else {
-    assertx(false);
-  }
-
-  return nullptr;
-}
-
-template <typename T, typename V, typename Eq>
-static T *
-bucket_insert(HSBucket<T> &node, V &&in, bool &inserted, Eq eq) noexcept {
-  auto factory = [&in](T &current, const auto &) {
-    return new (&current) T(std::forward<V>(in));
-  };
-
-  auto on_duplicate = [](HSBucket<T> &) {
-    /* $value is already present */
-    return nullptr;
-  };
-
-  T *const result = bucket_factory(node, in, factory, on_duplicate, eq);
-  inserted = result != nullptr;
-
-  return result;
-}
-
-template <typename T, typename V, typename Eq>
-static T *
-bucket_lookup_ins(HSBucket<T> &node, V &&val, bool &inserted, Eq eq) noexcept {
-  auto factory = [&val](T &current, const auto &) {
-    return new (&current) T(std::forward<V>(val));
-  };
-
-  bool existing = false;
-  auto on_duplicate = [&existing](HSBucket<T> &current) {
-    /* $value is already present, return it */
-    existing = true;
-    return (T *)&current.value;
-  };
-
-  T *const result = bucket_factory(node, val, factory, on_duplicate, eq);
-  inserted = !existing && result != nullptr;
-
-  return result;
-}
-
-template <typename T, typename V, typename Eq>
-static T *
-bucket_upsert(HSBucket<T> &node, V &&val, bool &inserted, Eq eq) noexcept {
-  auto factory = [&val](T &current, const auto &) {
-    return new (&current) T(std::forward<V>(val));
-  };
-
-  bool updated = false;
-  auto on_duplicate = [&updated, &val](HSBucket<T> &current) {
-    /* $value is already present, insert update */
-    assertx(current.present);
-
-    updated = true;
-
-    T *const existing = (T *)&current.value;
-    existing->~T();
-    return new (existing) T(std::forward<V>(val));
-  };
-
-  T *const result = bucket_factory(node, val, factory, on_duplicate, eq);
-  inserted = result != nullptr && !updated;
-
-  return result;
-}
-
-template <typename T, typename V, typename Factory, typename Eq>
-static T *
-bucket_lookup_compute(HSBucket<T> &node, const V &needle, Factory f,
-                      bool &inserted, Eq eq) noexcept {
-  bool existing = false;
-  auto on_duplicate = [&](HSBucket<T> &current) {
-    /* $value is already present, return it */
-    existing = true;
-    return (T *)&current.value;
-  };
-
-  T *const result = bucket_factory(node, needle, f, on_duplicate, eq);
-  inserted = !existing && result != nullptr;
-
-  return result;
-}
-
 static inline std::size_t
 index_of(const HashKey &code, std::size_t length) noexcept {
   const std::size_t res = code.hash & (length - 1);
@@ -494,22 +378,40 @@ index_of(const HashKey &code, std::size_t length) noexcept {
   return res;
 }
 
-template <typename T, std::size_t cap>
-static const HSBucket<T> &
-lookup(const HSNode<T, cap> &node, const HashKey &code) noexcept {
-  const std::size_t index = index_of(code, node.capacity);
-  return node.buckets[index];
+/* next slot in the probe sequence */
+static inline std::size_t
+next_of(std::size_t idx, std::size_t length) noexcept {
+  return (idx + 1) & (length - 1);
 }
 
-template <typename T, typename H>
-static std::size_t
-hash(const HSBucket<T> &subject) noexcept {
-  assertx(subject.present);
+/* number of low hash bits used by index_of() at $capacity */
+static constexpr std::size_t
+index_bits(std::size_t capacity) noexcept {
+  return capacity <= 1 ? 0 : 1 + index_bits(capacity / 2);
+}
+
+/* The index uses the low index_bits(cap) bits of the hash, the tag is taken
+ * from the bits above them so that keys sharing a home slot can be told apart.
+ * The top bits are folded in as well for hashes which only differ there.
+ */
+template <std::size_t cap>
+static inline std::uint8_t
+tag_of(const HashKey &code) noexcept {
+  constexpr std::size_t low = index_bits(cap);
+  constexpr std::size_t high = (sizeof(std::size_t) * 8) - 7;
+  const std::size_t bits = (code.hash >> low) ^ (code.hash >> high);
+  return std::uint8_t(0x80 | (bits & 0x7f));
+}
 
-  const T *const value = (const T *)&subject.value;
+template <typename T, typename H, std::size_t cap>
+static HashKey
+hash(const HSNode<T, cap> &node, std::size_t idx) noexcept {
+  assertx(node.tags[idx]);
+
+  const T *const value = (const T *)&node.table[idx];
 
   H h;
-  return h(*value);
+  return HashKey(h(*value));
 }
 
 /*
@@ -532,7 +434,7 @@ static HSNode<T, cap> *
 split(HashSetTree<T, Hash, Eq> &self, HSNode<T, cap> &subject) noexcept {
   const std::size_t split(subject.length / std::size_t(2));
 
-  if (split >= subject.capacity) {
+  if (split >= subject.max_capacity) {
     const std::size_t new_start = subject.start + split;
     const std::size_t before_length = subject.length;
     assertx_f({
@@ -582,138 +484,212 @@ split(HashSetTree<T, Hash, Eq> &self, HSNode<T, cap> &subject) noexcept {
   return nullptr;
 }
 
-#if 0
-namespace rec {
+/* returns the index of $needle or node.capacity if not present
+ */
+template <typename T, std::size_t cap, typename V, typename Eq>
+static std::size_t
+node_find(const HSNode<T, cap> &node, const HashKey &code, const V &needle,
+          const Eq &eq) noexcept {
+  if (node.table) {
+    const std::uint8_t tag = tag_of<cap>(code);
+    std::size_t idx = index_of(code, node.capacity);
+
+    while (node.tags[idx]) {
+      if (node.tags[idx] == tag) {
+        const T *const value = (const T *)&node.table[idx];
+        if (eq(*value, needle)) {
+          return idx;
+        }
+      }
+
+      idx = next_of(idx, node.capacity);
+    }
+  }
+
+  return node.capacity;
+}
+
+/* Place $value in the first free slot of its probe sequence, $node must
+ * have room and must not already contain $value
+ */
 template <typename T, typename H, std::size_t cap>
-HSBucket<T> *
-migrate_list(HSNode<T, cap> &src, HSBucket<T> *const current,
-             HSNode<T, cap> &dest) {
-  if (current) {
+static T *
+node_insert_unique(HSNode<T, cap> &node, T &&value) noexcept {
+  H h;
+  const HashKey code(h(value));
+  assertx(in_range(node, code));
+  assertxs(node.entries < node.capacity, node.entries, node.capacity);
 
-    HSBucket<T> *const next = current->next;
-    if (current->present) {
+  std::size_t idx = index_of(code, node.capacity);
+  while (node.tags[idx]) {
+    idx = next_of(idx, node.capacity);
+  }
 
-      const HashKey code(hash<T, H>(*current));
-      if (!in_range(src, code)) {
-        assertxs(in_range(dest, code), dest.start, dest.length, code.hash);
+  node.tags[idx] = tag_of<cap>(code);
+  ++node.entries;
 
-        HSBucket<T> &bucket = lookup(dest, code);
-        current->next = bucket.next;
-        bucket.next = current;
+  return new (&node.table[idx]) T(std::move(value));
+}
 
-        assertx(src.entries > 0);
-        --src.entries;
-        ++dest.entries;
+template <typename T, typename H, std::size_t cap>
+static bool
+node_resize(HSNode<T, cap> &node, std::size_t capacity) noexcept {
+  using Bucket = typename HSNode<T, cap>::Bucket;
+
+  HSNode<T, cap> tmp(node.start, node.length);
+  tmp.table = new (std::nothrow) Bucket[capacity];
+  tmp.tags = new (std::nothrow) std::uint8_t[capacity];
+  if (!tmp.table || !tmp.tags) {
+    delete[] tmp.table;
+    delete[] tmp.tags;
+    tmp.table = nullptr;
+    tmp.tags = nullptr;
+    return false;
+  }
+  tmp.capacity = capacity;
+  std::memset(tmp.tags, 0, capacity);
 
-        return migrate_list<T, H, cap>(src, next, dest);
-      }
+  for (std::size_t i = 0; i < node.capacity; ++i) {
+    if (node.tags[i]) {
+      T *const value = (T *)&node.table[i];
+      node_insert_unique<T, H>(tmp, std::move(*value));
+      value->~T();
+      node.tags[i] = 0;
     }
-
-    current->next = migrate_list<T, H, cap>(src, next, dest);
-    return current;
   }
 
-  return nullptr;
+  using std::swap;
+  swap(node.capacity, tmp.capacity);
+  swap(node.table, tmp.table);
+  swap(node.tags, tmp.tags);
+  swap(node.entries, tmp.entries);
+
+  return true;
 }
-} // namespace rec
-#endif
 
-template <typename T, std::size_t cap, typename H, typename Eq>
-static HSBucket<T> *
-migrate(HSNode<T, cap> &src, HSBucket<T> *c, HSNode<T, cap> &dest) noexcept {
-  if (c) {
-    if (c->present) {
-
-      const HashKey code(hash<T, H>(*c));
-      if (!in_range(src, code)) {
-        assertx(in_range(dest, code));
-
-        HSBucket<T> &bucket = lookup(dest, code);
-        T *const value = (T *)&c->value;
-        bool inserted = false;
-        Eq eq;
-
-        T *result = bucket_insert(bucket, std::move(*value), inserted, eq);
-        if (inserted) {
-          assertx(result);
-          assertx(src.entries > 0);
-          --src.entries;
-          ++dest.entries;
-
-          // TODO reclaim bucket
-          value->~T();
-          c->present = false;
-        }
+/* The node is considered full at 7/8 load
+ */
+template <typename T, std::size_t cap>
+static bool
+node_is_full(const HSNode<T, cap> &node, std::size_t entries) noexcept {
+  return entries > (node.capacity - (node.capacity / 8));
+}
 
-        return migrate<T, cap, H, Eq>(src, c->next, dest);
-      }
-    }
+template <typename T, typename H, std::size_t cap>
+static bool
+node_reserve(HSNode<T, cap> &node, std::size_t entries) noexcept {
+  if (!node.table) {
+    return node_resize<T, H>(node, node.min_capacity);
+  }
 
-    c->next = migrate<T, cap, H, Eq>(src, c->next, dest);
-    return c;
+  if (node_is_full(node, entries)) {
+    return node_resize<T, H>(node, node.capacity * 2);
   }
 
-  return nullptr;
+  return true;
 }
 
-template <typename T, typename H, typename Eq, std::size_t cap>
+/* Backward shift deletion
+ */
+template <typename T, typename H, std::size_t cap>
 static void
-verify_node(HashSetTree<T, H, Eq> &self, const HSNode<T, cap> &source,
-            const char *ctx) noexcept {
-  std::size_t cnt = 0;
+node_remove(HSNode<T, cap> &node, std::size_t hole) noexcept {
+  T *const value = (T *)&node.table[hole];
+  value->~T();
+  node.tags[hole] = 0;
+  assertxs(node.entries > 0, node.entries);
+  --node.entries;
+
+  std::size_t idx = hole;
+  while (true) {
+    idx = next_of(idx, node.capacity);
+    if (!node.tags[idx]) {
+      break;
+    }
 
-  for (std::size_t i = 0; i < source.capacity; ++i) {
-    const HSBucket<T> *current = source.buckets + i;
-    {
-    Lit:
-      if (current) {
-        if (current->present) {
-          const T *val = (const T *)&current->value;
-
-          H h;
-          const HashKey code(h(*val));
-
-          std::size_t idx = index_of(code, source.capacity);
-          assertxs(idx == i, idx, i);
-          ++cnt;
-        }
-        current = current->next;
-        goto Lit;
-      }
+    const std::size_t home = index_of(hash<T, H>(node, idx), node.capacity);
+    /* distance to home slot from the current slot and from the hole */
+    const std::size_t dist = (idx - home) & (node.capacity - 1);
+    const std::size_t hole_dist = (idx - hole) & (node.capacity - 1);
+    if (dist >= hole_dist) {
+      T *const src = (T *)&node.table[idx];
+      new (&node.table[hole]) T(std::move(*src));
+      src->~T();
+
+      node.tags[hole] = node.tags[idx];
+      node.tags[idx] = 0;
+      hole = idx;
     }
   }
+}
 
-  if (source.entries != cnt) {
-    sp::rec::verify(self);
-    dump(self.tree);
+/* Smallest table capacity which holds $entries without being full
+ */
+template <typename T, std::size_t cap>
+static std::size_t
+node_capacity_for(std::size_t entries) noexcept {
+  std::size_t result = HSNode<T, cap>::min_capacity;
+  while (entries > (result - (result / 8))) {
+    result *= 2;
   }
-  assertxs(source.entries == cnt, source.entries, cnt, ctx);
+  return result;
 }
 
 template <typename T, typename H, typename Eq, std::size_t cap>
 static bool
 rehash(HashSetTree<T, H, Eq> &self, HSNode<T, cap> &source) noexcept {
-  HSNode<T, cap> *const other = split(self, source);
-  assertx(verify(self.tree));
-
-  // static int asdhasd = 0;
-  // asdhasd++;
-  // printf("rehash[%d]\n", asdhasd);
+  const std::size_t half(source.length / std::size_t(2));
+  if (half < source.max_capacity) {
+    return false;
+  }
 
-  if (other) {
-    // assertx_f({ verify_node<T, H, Eq, cap>(self, source, "source_before");
-    // });
-    // assertx_f({ verify_node<T, H, Eq, cap>(self, *other, "other_before"); });
+  /* Allocate the tables of both halves before anything is moved, if either
+   * allocation fails $source is left as is */
+  HSNode<T, cap> low(source.start, half);
+  HSNode<T, cap> high(source.start + half, source.length - half);
 
-    for (std::size_t i = 0; i < source.capacity; ++i) {
-      migrate<T, cap, H, Eq>(source, source.buckets + i, *other);
+  std::size_t low_entries = 0;
+  for (std::size_t i = 0; i < source.capacity; ++i) {
+    if (source.tags[i] && in_range(low, hash<T, H>(source, i))) {
+      ++low_entries;
     }
+  }
+  const std::size_t high_entries = source.entries - low_entries;
 
-    // printf("---------\n");
-    // dump(self.tree);
+  if (!node_resize<T, H>(low, node_capacity_for<T, cap>(low_entries)) ||
+      !node_resize<T, H>(high, node_capacity_for<T, cap>(high_entries))) {
+    return false;
+  }
 
-    // assertx_f({ verify_node<T, H, Eq, cap>(self, *other, "other"); });
-    // assertx_f({ verify_node<T, H, Eq, cap>(self, source, "source"); });
+  HSNode<T, cap> *const other = split(self, source);
+  assertx(verify(self.tree));
+
+  if (other) {
+    /* Rebuild $source and move the entries no longer in range to $other,
+     * $low is left with the old table of $source */
+    using std::swap;
+    swap(low.capacity, source.capacity);
+    swap(low.table, source.table);
+    swap(low.tags, source.tags);
+    swap(low.entries, source.entries);
+
+    swap(high.capacity, other->capacity);
+    swap(high.table, other->table);
+    swap(high.tags, other->tags);
+    swap(high.entries, other->entries);
+
+    for (std::size_t i = 0; i < low.capacity; ++i) {
+      if (low.tags[i]) {
+        const HashKey code(hash<T, H>(low, i));
+        HSNode<T, cap> &dest = in_range(source, code) ? source : *other;
+
+        T *const value = (T *)&low.table[i];
+        node_insert_unique<T, H>(dest, std::move(*value));
+        value->~T();
+        low.tags[i] = 0;
+      }
+    }
+    low.entries = 0;
 
     return true;
   }
@@ -721,80 +697,95 @@ rehash(HashSetTree<T, H, Eq> &self, HSNode<T, cap> &source) noexcept {
   return false;
 } // impl::rehash()
 
-template <typename T, std::size_t cap>
-static HSBucket<T> &
-lookup(HSNode<T, cap> &node, const HashKey &code) noexcept {
+template <typename T, typename H, std::size_t cap, typename V, typename Fact,
+          typename Dup, typename Eq>
+static T *
+node_factory(HSNode<T, cap> &node, const HashKey &code, const V &in, Fact f,
+             Dup d, Eq eq) noexcept {
   assertx(in_range(node, code));
 
-  const auto &c_node = node;
-  return (HSBucket<T> &)lookup(c_node, code);
+  std::size_t idx = node_find(node, code, in, eq);
+  if (idx != node.capacity) {
+    /* Already present */
+    return d(*((T *)&node.table[idx]));
+  }
+
+  if (!node_reserve<T, H>(node, node.entries + 1)) {
+    return nullptr;
+  }
+
+  idx = index_of(code, node.capacity);
+  while (node.tags[idx]) {
+    idx = next_of(idx, node.capacity);
+  }
+
+  T *const result = (T *)&node.table[idx];
+  f(*result, in);
+  node.tags[idx] = tag_of<cap>(code);
+  ++node.entries;
+
+  return result;
 }
 
 // XXX combine these {
-template <typename T, std::size_t cap, typename V, typename Eq>
+template <typename T, typename H, std::size_t cap, typename V, typename Eq>
 static T *
 node_insert(HSNode<T, cap> &node, const HashKey &c, V &&val, Eq eq) noexcept {
-  assertx(in_range(node, c));
+  auto factory = [&val](T &current, const auto &) {
+    return new (&current) T(std::forward<V>(val));
+  };
 
-  HSBucket<T> &bucket = lookup(node, c);
-  bool is_inserted = false;
-  T *result = bucket_insert(bucket, std::forward<V>(val), is_inserted, eq);
-  if (is_inserted) {
-    assertx(result);
-    ++node.entries;
-  }
+  auto on_duplicate = [](T &) -> T * {
+    /* $value is already present */
+    return nullptr;
+  };
 
-  return result;
+  return node_factory<T, H>(node, c, val, factory, on_duplicate, eq);
 }
 
-template <typename T, std::size_t cap, typename V, typename Eq>
+template <typename T, typename H, std::size_t cap, typename V, typename Eq>
 static T *
 node_lookup_ins(HSNode<T, cap> &node, const HashKey &c, V &&val,
                 Eq eq) noexcept {
-  assertx(in_range(node, c));
+  auto factory = [&val](T &current, const auto &) {
+    return new (&current) T(std::forward<V>(val));
+  };
 
-  HSBucket<T> &bucket = lookup(node, c);
-  bool is_inserted = false;
-  T *result = bucket_lookup_ins(bucket, std::forward<V>(val), is_inserted, eq);
-  if (is_inserted) {
-    assertx(result);
-    ++node.entries;
-  }
+  auto on_duplicate = [](T &current) -> T * {
+    /* $value is already present, return it */
+    return &current;
+  };
 
-  return result;
+  return node_factory<T, H>(node, c, val, factory, on_duplicate, eq);
 }
 
-template <typename T, std::size_t cap, typename V, typename Eq>
+template <typename T, typename H, std::size_t cap, typename V, typename Eq>
 static T *
 node_upsert(HSNode<T, cap> &node, const HashKey &c, V &&val, Eq eq) noexcept {
-  assertx(in_range(node, c));
+  auto factory = [&val](T &current, const auto &) {
+    return new (&current) T(std::forward<V>(val));
+  };
 
-  HSBucket<T> &bucket = lookup(node, c);
-  bool is_inserted = false;
-  T *result = bucket_upsert(bucket, std::forward<V>(val), is_inserted, eq);
-  if (is_inserted) {
-    assertx(result);
-    ++node.entries;
-  }
+  auto on_duplicate = [&val](T &current) -> T * {
+    /* $value is already present, insert update */
+    current.~T();
+    return new (&current) T(std::forward<V>(val));
+  };
 
-  return result;
+  return node_factory<T, H>(node, c, val, factory, on_duplicate, eq);
 }
 
-template <typename T, std::size_t c, typename V, typename Factory, typename Eq>
+template <typename T, typename H, std::size_t c, typename V, typename Factory,
+          typename Eq>
 static T *
 node_lookup_compute(HSNode<T, c> &node, const HashKey &code, const V &needle,
                     Factory f, Eq eq) noexcept {
-  assertx(in_range(node, code));
-
-  HSBucket<T> &bucket = lookup(node, code);
-  bool is_inserted = false;
-  T *const result = bucket_lookup_compute(bucket, needle, f, is_inserted, eq);
-  if (is_inserted) {
-    assertx(result);
-    ++node.entries;
-  }
+  auto on_duplicate = [](T &current) -> T * {
+    /* $value is already present, return it */
+    return &current;
+  };
 
-  return result;
+  return node_factory<T, H>(node, code, needle, f, on_duplicate, eq);
 }
 // }
 
@@ -831,9 +822,10 @@ Lretry : {
   if (node) {
     assertx(in_range(*node, key));
 
-    if (!re_hash && node->entries >= node->capacity) {
+    if (!re_hash && node->capacity >= node->max_capacity &&
+        node_is_full(*node, node->entries + 1)) {
       re_hash = true;
-      // TODO resize factor
+      /* Split the node instead of growing it beyond max capacity */
       if (impl::rehash(self, *node)) {
         goto Lretry;
       }
@@ -859,7 +851,7 @@ insert(HashSetTree<T, H, Eq> &self, V &&in) noexcept {
 
   auto f = [](HSNode<T> &node, const HashKey &code, V &&v) {
     Eq equality;
-    return node_insert(node, code, std::forward<V>(v), equality);
+    return node_insert<T, H>(node, code, std::forward<V>(v), equality);
   };
 
   return impl::do_insert(self, std::forward<V>(in), f);
@@ -873,7 +865,7 @@ upsert(HashSetTree<T, H, Eq> &self, V &&in) noexcept {
 
   auto f = [](HSNode<T> &node, const HashKey &code, V &&v) {
     Eq equality;
-    return node_upsert(node, code, std::forward<V>(v), equality);
+    return node_upsert<T, H>(node, code, std::forward<V>(v), equality);
   };
 
   return impl::do_insert(self, std::forward<V>(in), f);
@@ -881,34 +873,18 @@ upsert(HashSetTree<T, H, Eq> &self, V &&in) noexcept {
 
 //=====================================
 namespace impl {
-template <typename T, typename V, typename Eq>
-static const T *
-lookup(const HSBucket<T> &node, const V &needle, const Eq &eq) noexcept {
-  const HSBucket<T> *current = &node;
-
-Lit:
-  if (current) {
-    if (current->present) {
-      const T *const value = (const T *)&current->value;
-      if (eq(*value, needle)) {
-        return value;
-      }
-    }
-
-    current = current->next;
-    goto Lit;
-  }
-  return nullptr;
-}
-
 template <typename T, std::size_t cap, typename V, typename Eq>
 static const T *
 node_lookup(const HSNode<T, cap> &node, const HashKey &c, const V &needle,
             const Eq &eq) noexcept {
   assertx(in_range(node, c));
 
-  const HSBucket<T> &bucket = lookup(node, c);
-  return lookup(bucket, needle, eq);
+  const std::size_t idx = node_find(node, c, needle, eq);
+  if (idx != node.capacity) {
+    return (const T *)&node.table[idx];
+  }
+
+  return nullptr;
 }
 } // namespace impl
 
@@ -970,7 +946,7 @@ lookup_insert(HashSetTree<T, H, Eq> &self, V &&value) noexcept {
 
   auto f = [](HSNode<T> &node, const HashKey &code, V &&v) {
     Eq equality;
-    return node_lookup_ins(node, code, std::forward<V>(v), equality);
+    return node_lookup_ins<T, H>(node, code, std::forward<V>(v), equality);
   };
 
   return impl::do_insert(self, std::forward<V>(value), f);
@@ -984,7 +960,7 @@ lookup_compute(HashSetTree<T, H, Eq> &self, const V &ndl, C compute) noexcept {
 
   auto f = [compute](HSNode<T> &node, const HashKey &code, const V &v) {
     Eq equality;
-    return node_lookup_compute(node, code, v, compute, equality);
+    return node_lookup_compute<T, H>(node, code, v, compute, equality);
   };
 
   return impl::do_insert(self, ndl, f);
@@ -1012,13 +988,11 @@ remove(HashSetTree<T, H, Eq> &self, const V &needle) noexcept {
   if (node) {
     assertx(in_range(*node, code));
 
-    HSBucket<T> &bucket = lookup(*node, code);
     Eq equality;
-
-    result = bucket_remove(bucket, needle, equality);
-    if (result) {
-      assertxs(node->entries > 0, node->entries);
-      --node->entries;
+    const std::size_t idx = node_find(*node, code, needle, equality);
+    if (idx != node->capacity) {
+      node_remove<T, H>(*node, idx);
+      result = true;
     }
   }
 
@@ -1032,21 +1006,10 @@ template <typename T, std::size_t c, typename F>
 static void
 for_each(const sp::impl::HSNode<T, c> &node, F f) noexcept {
   for (std::size_t i = 0; i < node.capacity; ++i) {
-    const sp::impl::HSBucket<T> &bucket = node.buckets[i];
-    f(bucket);
-  }
-}
-
-template <typename T, typename F>
-static void
-for_each(const sp::impl::HSBucket<T> &bucket, F f) noexcept {
-  const sp::impl::HSBucket<T> *it = &bucket;
-  while (it) {
-    if (it->present) {
-      const T *const value = (const T *)&it->value;
+    if (node.tags[i]) {
+      const T *const value = (const T *)&node.table[i];
       f(*value);
     }
-    it = it->next;
   }
 }
 } // namespace impl
@@ -1062,16 +1025,19 @@ verify(const sp::HashSetTree<T, H, Eq> &self) noexcept {
   std::size_t len = 0;
   binary::rec::inorder(self.tree, [&len, &node_cnt](const auto &node) {
     ++node_cnt;
-    for_each(node, [&node, &len](const auto &buckets) {
-      for_each(buckets, [&node, &len](const T &value) {
-        H h;
-        const sp::impl::HashKey code(h(value));
-
-        ++len;
-        assertxs(sp::impl::in_range(node, code), code.hash, node.start,
-                 node.length);
-      });
+    std::size_t entries = 0;
+    for_each(node, [&node, &len, &entries](const T &value) {
+      H h;
+      const sp::impl::HashKey code(h(value));
+
+      ++len;
+      ++entries;
+      assertxs(sp::impl::in_range(node, code), code.hash, node.start,
+               node.length);
+      const std::size_t idx = sp::impl::node_find(node, code, value, Eq{});
+      assertxs(idx != node.capacity, code.hash, node.capacity);
     });
+    assertxs(entries == node.entries, entries, node.entries);
     /**/
   });
 
@@ -1126,11 +1092,9 @@ length(const HashSetTree<T, H, Eq> &self) noexcept {
 
   std::size_t length = 0;
   binary::rec::inorder(self.tree, [&length](const auto &node) {
-    for_each(node, [&node, &length](const auto &buckets) {
-      for_each(buckets, [&node, &length](const T &) {
-        /**/
-        ++length;
-      });
+    for_each(node, [&length](const T &) {
+      /**/
+      ++length;
     });
     /**/
   });
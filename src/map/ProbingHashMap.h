@@ -4,6 +4,7 @@
 #include <util/assert.h>
 #include <collection/Array.h>
 #include <cstddef>
+#include <cstdint>
 #include <hash/util.h>
 #include <util/maybe.h>
 
@@ -13,15 +14,64 @@ struct ProbingHashMap {
   /**/
 };
 
-template <typename Value, std::size_t cap, sp::hasher<Value>>
+//=====================================
+/* Perfect hash function using the CHD (compress, hash, displace) scheme.
+ *
+ * The keys are first grouped into buckets, n/4 keys per bucket on average.
+ * The buckets are then placed, largest first, by searching for a
+ * displacement which maps every key of the bucket to a free slot in [0, n).
+ * Only the displacement per bucket is stored and a lookup is always exactly
+ * one probe.
+ *
+ * The builder is constexpr so for small key sets where the hashes are known
+ * at compile time the whole table can be computed by the compiler. Note that
+ * the builder uses about 5n bytes of stack space.
+ *
+ * Two keys with the same hash can not be separated in which case the build
+ * fails and valid is false.
+ */
+template <std::size_t n>
+struct PerfectHash {
+  static constexpr std::size_t buckets = (n / 4) + 1;
+
+  std::uint32_t displacement[buckets];
+  bool valid;
+};
+
+//=====================================
+/* Builds a perfect hash for the first $length hashes, the slots are in the
+ * range [0, n) so when $length == n the hash is minimal.
+ */
+template <std::size_t n>
+constexpr PerfectHash<n>
+perfect_hash(const std::size_t (&hashes)[n], std::size_t length = n) noexcept;
+
+//=====================================
+template <std::size_t n>
+constexpr std::size_t
+slot(const PerfectHash<n> &, std::size_t hash) noexcept;
+
+//=====================================
+enum class StaticHashBuild { PROBING, PERFECT };
+
+//=====================================
+/* Read only hash set referencing the values of the array it was built from.
+ *
+ * PROBING: linear probing starting at hash % cap
+ * PERFECT: one probe per lookup using a PerfectHash, falls back to PROBING
+ *          if the perfect hash could not be built
+ */
+template <typename Value, std::size_t cap, sp::hasher<Value> h>
 struct StaticProbingHashSet {
   using node_type = Value *;
-  /**/
-  node_type *key[cap];
-  node_type value[cap];
+
+  node_type table[cap];
+  PerfectHash<cap> perfect;
 
   StaticProbingHashSet() noexcept;
-  StaticProbingHashSet(UinStaticArray<Value, cap> &) noexcept;
+  explicit StaticProbingHashSet(
+      UinStaticArray<Value, cap> &,
+      StaticHashBuild = StaticHashBuild::PROBING) noexcept;
 };
 
 //=====================================
@@ -30,6 +80,10 @@ struct StaticProbingHashSet {
 // create(Value (&)[cap]) noexcept;
 
 //=====================================
+template <typename Value, std::size_t cap, sp::hasher<Value> h, typename K>
+const Value *
+lookup(const StaticProbingHashSet<Value, cap, h> &, const K &) noexcept;
+
 template <typename Value, std::size_t cap, sp::hasher<Value> h, typename K>
 Value *
 lookup(StaticProbingHashSet<Value, cap, h> &, const K &) noexcept;
@@ -39,26 +93,168 @@ lookup(StaticProbingHashSet<Value, cap, h> &, const K &) noexcept;
 /* ======================================================= */
 /* ======================================================= */
 /* ======================================================= */
+namespace impl {
+constexpr std::size_t
+perfect_hash_mix(std::size_t hash, std::uint32_t seed) noexcept {
+  /* murmur3 finalizer */
+  std::uint64_t x = hash;
+  x ^= seed * 0x9E3779B97F4A7C15ull;
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdull;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ull;
+  x ^= x >> 33;
+  return x;
+}
+
+template <std::size_t n>
+constexpr std::size_t
+perfect_hash_bucket(std::size_t hash) noexcept {
+  return perfect_hash_mix(hash, 0) % PerfectHash<n>::buckets;
+}
+
+template <std::size_t n>
+constexpr std::size_t
+perfect_hash_slot(std::size_t hash, std::uint32_t displacement) noexcept {
+  /* seed 0 is used to select the bucket */
+  return perfect_hash_mix(hash, displacement + 1) % n;
+}
+
+/* Try to place all keys of a bucket using $displacement
+ */
+template <std::size_t n>
+constexpr bool
+perfect_hash_place(const std::size_t (&hashes)[n],
+                   const std::uint32_t *bucket, std::size_t length,
+                   std::uint32_t displacement, bool (&occupied)[n]) noexcept {
+  for (std::size_t i = 0; i < length; ++i) {
+    const std::size_t s = perfect_hash_slot<n>(hashes[bucket[i]], displacement);
+    if (occupied[s]) {
+      /* undo the keys already placed */
+      for (std::size_t k = 0; k < i; ++k) {
+        occupied[perfect_hash_slot<n>(hashes[bucket[k]], displacement)] = false;
+      }
+      return false;
+    }
+
+    occupied[s] = true;
+  }
+
+  return true;
+}
+} // namespace impl
+
+template <std::size_t n>
+constexpr PerfectHash<n>
+perfect_hash(const std::size_t (&hashes)[n], std::size_t length) noexcept {
+  constexpr std::size_t buckets = PerfectHash<n>::buckets;
+  constexpr std::uint32_t max_displacement = std::uint32_t(1) << 20;
+
+  PerfectHash<n> result{{}, false};
+  if (length > n) {
+    return result;
+  }
+
+  /* Group the keys by bucket, counting sort */
+  std::uint32_t start[buckets + 1] = {};
+  std::uint32_t cursor[buckets] = {};
+  std::uint32_t order[n] = {};
+  bool occupied[n] = {};
+
+  for (std::size_t i = 0; i < length; ++i) {
+    ++start[impl::perfect_hash_bucket<n>(hashes[i]) + 1];
+  }
+
+  std::size_t max_size = 0;
+  for (std::size_t b = 0; b < buckets; ++b) {
+    if (start[b + 1] > max_size) {
+      max_size = start[b + 1];
+    }
+    start[b + 1] += start[b];
+    cursor[b] = start[b];
+  }
+
+  for (std::size_t i = 0; i < length; ++i) {
+    const std::size_t b = impl::perfect_hash_bucket<n>(hashes[i]);
+    order[cursor[b]++] = std::uint32_t(i);
+  }
+
+  /* Place the largest buckets first while there still are many free slots */
+  for (std::size_t size = max_size; size > 0; --size) {
+    for (std::size_t b = 0; b < buckets; ++b) {
+      const std::uint32_t *const bucket = order + start[b];
+      if (start[b + 1] - start[b] != size) {
+        continue;
+      }
+
+      for (std::size_t i = 0; i < size; ++i) {
+        for (std::size_t k = i + 1; k < size; ++k) {
+          if (hashes[bucket[i]] == hashes[bucket[k]]) {
+            /* duplicate hash */
+            return result;
+          }
+        }
+      }
+
+      std::uint32_t d = 0;
+      while (!impl::perfect_hash_place(hashes, bucket, size, d, occupied)) {
+        if (++d == max_displacement) {
+          return result;
+        }
+      }
+      result.displacement[b] = d;
+    }
+  }
+
+  result.valid = true;
+  return result;
+}
+
+template <std::size_t n>
+constexpr std::size_t
+slot(const PerfectHash<n> &self, std::size_t hash) noexcept {
+  const std::size_t b = impl::perfect_hash_bucket<n>(hash);
+  return impl::perfect_hash_slot<n>(hash, self.displacement[b]);
+}
 
+//=====================================
 template <typename Value, std::size_t cap, sp::hasher<Value> h>
 StaticProbingHashSet<Value, cap, h>::StaticProbingHashSet() noexcept
-    : key{nullptr}
-    , value{nullptr} {
-  // TODO
-  //
+    : table{nullptr}
+    , perfect{{}, false} {
 }
 
 template <typename Value, std::size_t cap, sp::hasher<Value> h>
 StaticProbingHashSet<Value, cap, h>::StaticProbingHashSet(
-    UinStaticArray<Value, cap> &in) noexcept
-    : key{nullptr}
-    , value{nullptr} {
-  for_each(in, [](Value &current) {
-    const std::size_t hash = h(current);
-    const std::size_t idx = hash % cap;
+    UinStaticArray<Value, cap> &in, StaticHashBuild build) noexcept
+    : table{nullptr}
+    , perfect{{}, false} {
+  if (build == StaticHashBuild::PERFECT) {
+    std::size_t hashes[cap] = {};
+    for (std::size_t i = 0; i < length(in); ++i) {
+      hashes[i] = h(in[i]);
+    }
 
+    perfect = perfect_hash(hashes, length(in));
+    if (perfect.valid) {
+      for (std::size_t i = 0; i < length(in); ++i) {
+        const std::size_t idx = slot(perfect, hashes[i]);
+        assertxs(table[idx] == nullptr, idx, i);
+        table[idx] = &in[i];
+      }
+
+      return;
+    }
+  }
+
+  for_each(in, [this](Value &current) {
+    std::size_t idx = h(current) % cap;
+    while (table[idx]) {
+      idx = (idx + 1) % cap;
+    }
+
+    table[idx] = &current;
   });
-  // assertx(false);
 }
 
 //=====================================
@@ -70,22 +266,44 @@ StaticProbingHashSet<Value, cap, h>::StaticProbingHashSet(
 // }
 //=====================================
 template <typename Value, std::size_t cap, sp::hasher<Value> h, typename K>
-Value *
-lookup(StaticProbingHashSet<Value, cap, h> &self, const K &needle) noexcept {
+const Value *
+lookup(const StaticProbingHashSet<Value, cap, h> &self,
+       const K &needle) noexcept {
   const std::size_t hash = h(needle);
-  const std::size_t idx = hash % cap;
-  auto key = self.key[idx];
-  if (key) {
-    Value *it = *key;
-    // const Value *const end = self.value + cap;
-    // while (it != end) {
-    //   ++it;
-    // }
+
+  if (self.perfect.valid) {
+    const Value *const result = self.table[slot(self.perfect, hash)];
+    if (result && *result == needle) {
+      return result;
+    }
+
+    return nullptr;
+  }
+
+  std::size_t idx = hash % cap;
+  for (std::size_t i = 0; i < cap; ++i) {
+    const Value *const current = self.table[idx];
+    if (!current) {
+      break;
+    }
+
+    if (*current == needle) {
+      return current;
+    }
+
+    idx = (idx + 1) % cap;
   }
 
   return nullptr;
 }
 
+template <typename Value, std::size_t cap, sp::hasher<Value> h, typename K>
+Value *
+lookup(StaticProbingHashSet<Value, cap, h> &self, const K &needle) noexcept {
+  const auto &c_self = self;
+  return (Value *)lookup(c_self, needle);
+}
+
 } // namespace sp
 
 #endif
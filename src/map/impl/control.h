@@ -0,0 +1,270 @@
+#ifndef SP_UTIL_MAP_IMPL_CONTROL_H
+#define SP_UTIL_MAP_IMPL_CONTROL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <util/assert.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define HSPTag_EMPTY char(0)
+#define HSPTag_PRESENT char(1)
+#define HSPTag_TOMBSTONE char(2)
+
+/*
+ * Swiss table style control bytes. Every slot in the table has one control
+ * byte which is either a special marker or the lower 7 bits of the hash(h2):
+ *
+ * EMPTY:     [1000_0000]
+ * TOMBSTONE: [1111_1110]
+ * PRESENT:   [0hhh_hhhh]
+ *
+ * The control bytes are scanned a group of 16 at a time so that most misses
+ * can be resolved without ever touching the (cold) array of values, a full
+ * value compare is only required when h2 matches.
+ *
+ * The first Group::width - 1 control bytes are cloned after the last slot so
+ * that a group load starting at any slot never have to wrap around.
+ */
+namespace sp {
+namespace impl {
+//=====================================
+using HSPCtrl = std::int8_t;
+
+static constexpr HSPCtrl HSPCtrl_EMPTY = HSPCtrl(-128);
+static constexpr HSPCtrl HSPCtrl_TOMBSTONE = HSPCtrl(-2);
+
+//=====================================
+struct HSPControl {
+  HSPCtrl *buffer;
+  /* number of slots, excluding the cloned tail */
+  std::size_t capacity;
+
+  HSPControl(HSPCtrl *, std::size_t) noexcept;
+};
+
+//=====================================
+/* Bitmask where bit[i] represent slot[group_start + i]
+ */
+struct HSPBitMask {
+  std::uint32_t mask;
+
+  explicit HSPBitMask(std::uint32_t) noexcept;
+
+  explicit operator bool() const noexcept;
+};
+
+//=====================================
+struct HSPGroup {
+  static constexpr std::size_t width = 16;
+
+#if defined(__SSE2__)
+  __m128i ctrl;
+#else
+  HSPCtrl ctrl[width];
+#endif
+
+  explicit HSPGroup(const HSPCtrl *) noexcept;
+};
+
+//=====================================
+static inline std::size_t
+hsp_h1(std::size_t hash) noexcept {
+  return hash >> 7;
+}
+
+static inline HSPCtrl
+hsp_h2(std::size_t hash) noexcept {
+  return HSPCtrl(hash & 0x7f);
+}
+
+//=====================================
+/* Number of control bytes required for $capacity slots
+ */
+static inline std::size_t
+HSPControl_number_of_buffer(std::size_t capacity) noexcept {
+  return capacity + (HSPGroup::width - 1);
+}
+
+//=====================================
+/* returns the index of the lowest set bit, mask must be non empty
+ */
+static inline std::size_t
+lowest(const HSPBitMask &) noexcept;
+
+/* removes the lowest set bit
+ */
+static inline void
+pop_lowest(HSPBitMask &) noexcept;
+
+/* keep only the bits below the lowest bit in $stop, if $stop is empty all bits
+ * are kept.
+ */
+static inline HSPBitMask
+before(const HSPBitMask &, const HSPBitMask &stop) noexcept;
+
+/* Same as before() but also keeps the lowest bit of $stop
+ */
+static inline HSPBitMask
+up_to(const HSPBitMask &, const HSPBitMask &stop) noexcept;
+
+//=====================================
+static inline HSPBitMask
+match(const HSPGroup &, HSPCtrl h2) noexcept;
+
+static inline HSPBitMask
+match_empty(const HSPGroup &) noexcept;
+
+static inline HSPBitMask
+match_empty_or_tombstone(const HSPGroup &) noexcept;
+
+//=====================================
+/* Translates the control byte into one of HSPTag_EMPTY, HSPTag_PRESENT or
+ * HSPTag_TOMBSTONE
+ */
+static inline std::uint8_t
+tag_of(HSPCtrl) noexcept;
+
+//=====================================
+//====Implementation===================
+//=====================================
+inline HSPControl::HSPControl(HSPCtrl *b, std::size_t c) noexcept
+    : buffer(b)
+    , capacity(c) {
+}
+
+//=====================================
+inline HSPBitMask::HSPBitMask(std::uint32_t m) noexcept
+    : mask(m) {
+}
+
+inline HSPBitMask::operator bool() const noexcept {
+  return mask != 0;
+}
+
+static inline std::size_t
+lowest(const HSPBitMask &self) noexcept {
+  assertx(self.mask);
+  return std::size_t(__builtin_ctz(self.mask));
+}
+
+static inline void
+pop_lowest(HSPBitMask &self) noexcept {
+  self.mask &= self.mask - 1;
+}
+
+static inline HSPBitMask
+before(const HSPBitMask &self, const HSPBitMask &stop) noexcept {
+  if (stop) {
+    const std::uint32_t bit = stop.mask & (~stop.mask + 1);
+    return HSPBitMask(self.mask & (bit - 1));
+  }
+  return self;
+}
+
+static inline HSPBitMask
+up_to(const HSPBitMask &self, const HSPBitMask &stop) noexcept {
+  if (stop) {
+    const std::uint32_t bit = stop.mask & (~stop.mask + 1);
+    return HSPBitMask(self.mask & ((bit << 1) - 1));
+  }
+  return self;
+}
+
+//=====================================
+#if defined(__SSE2__)
+inline HSPGroup::HSPGroup(const HSPCtrl *c) noexcept
+    : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(c))) {
+}
+
+static inline HSPBitMask
+match(const HSPGroup &self, HSPCtrl h2) noexcept {
+  const __m128i needle = _mm_set1_epi8(h2);
+  return HSPBitMask(
+      std::uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(needle, self.ctrl))));
+}
+
+static inline HSPBitMask
+match_empty(const HSPGroup &self) noexcept {
+  return match(self, HSPCtrl_EMPTY);
+}
+
+static inline HSPBitMask
+match_empty_or_tombstone(const HSPGroup &self) noexcept {
+  /* Both markers are less than -1, and present is always positive */
+  const __m128i special = _mm_set1_epi8(HSPCtrl(-1));
+  return HSPBitMask(
+      std::uint32_t(_mm_movemask_epi8(_mm_cmpgt_epi8(special, self.ctrl))));
+}
+#else
+inline HSPGroup::HSPGroup(const HSPCtrl *c) noexcept
+    : ctrl() {
+  std::memcpy(ctrl, c, sizeof(ctrl));
+}
+
+static inline HSPBitMask
+match(const HSPGroup &self, HSPCtrl h2) noexcept {
+  std::uint32_t result = 0;
+  for (std::size_t i = 0; i < HSPGroup::width; ++i) {
+    result |= std::uint32_t(self.ctrl[i] == h2) << i;
+  }
+  return HSPBitMask(result);
+}
+
+static inline HSPBitMask
+match_empty(const HSPGroup &self) noexcept {
+  return match(self, HSPCtrl_EMPTY);
+}
+
+static inline HSPBitMask
+match_empty_or_tombstone(const HSPGroup &self) noexcept {
+  std::uint32_t result = 0;
+  for (std::size_t i = 0; i < HSPGroup::width; ++i) {
+    result |= std::uint32_t(self.ctrl[i] < HSPCtrl(-1)) << i;
+  }
+  return HSPBitMask(result);
+}
+#endif
+
+//=====================================
+static inline std::uint8_t
+tag_of(HSPCtrl c) noexcept {
+  if (c == HSPCtrl_EMPTY) {
+    return std::uint8_t(HSPTag_EMPTY);
+  }
+  if (c == HSPCtrl_TOMBSTONE) {
+    return std::uint8_t(HSPTag_TOMBSTONE);
+  }
+  assertxs(c >= 0, int(c));
+  return std::uint8_t(HSPTag_PRESENT);
+}
+
+//=====================================
+} // namespace impl
+
+//=====================================
+inline std::uint8_t
+test(const impl::HSPControl &self, std::size_t idx) noexcept {
+  assertxs(idx < self.capacity, idx, self.capacity);
+  return impl::tag_of(self.buffer[idx]);
+}
+
+//=====================================
+/* Set the control byte of slot $idx and its clone if any
+ */
+inline void
+set(impl::HSPControl &self, std::size_t idx, impl::HSPCtrl c) noexcept {
+  assertxs(idx < self.capacity, idx, self.capacity);
+  self.buffer[idx] = c;
+  if (idx < (impl::HSPGroup::width - 1)) {
+    self.buffer[self.capacity + idx] = c;
+  }
+}
+
+//=====================================
+} // namespace sp
+
+#endif
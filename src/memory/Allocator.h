@@ -3,6 +3,7 @@
 
 #include <cstdlib>
 #include <cstring>
+#include <type_traits>
 #include <util/assert.h>
 
 // TODO hide malloc in impl to not require cstdlib include
@@ -50,6 +51,14 @@ void
 swap(Allocator<T> &, Allocator<T> &) noexcept {
 }
 
+//=====================================
+/* Allocators which return all of their memory when they are destroyed, a
+ * container of trivially destructible values does not have to deallocate its
+ * nodes one by one when it is destroyed.
+ */
+template <template <typename> class Allocator>
+struct AllocatorReleasesAll : std::false_type {};
+
 } // namespace sp
 
 #endif
@@ -0,0 +1,176 @@
+#ifndef SP_UTIL_MEMORY_SLAB_ALLOCATOR_H
+#define SP_UTIL_MEMORY_SLAB_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <memory/Allocator.h>
+#include <new>
+#include <type_traits>
+#include <util/assert.h>
+
+/*
+ * # SlabAllocator
+ * Hands out fixed size T:s from slabs of contiguous memory, a slab holds
+ * multiple T:s so allocations done after each other are placed next to each
+ * other in memory. Deallocated T:s are kept in a free list and are reused
+ * before a new slab is allocated. The memory of the slabs is only returned
+ * when the allocator is destroyed, all at once.
+ */
+namespace sp {
+//=====================================
+template <typename T>
+struct SlabAllocator {
+  using value_type = T;
+
+  static_assert(sizeof(T) >= sizeof(void *), "");
+  static_assert(alignof(T) % alignof(void *) == 0, "");
+
+  /* number of T:s in a slab, roughly a page */
+  static constexpr std::size_t slab_length =
+      sizeof(T) >= 256 ? 16 : 4096 / sizeof(T);
+
+  void *slabs;
+  void *stack;
+  T *bump;
+  std::size_t remaining;
+
+  SlabAllocator() noexcept;
+  ~SlabAllocator() noexcept;
+
+  SlabAllocator(const SlabAllocator<T> &) = delete;
+  SlabAllocator(const SlabAllocator<T> &&) = delete;
+
+  SlabAllocator<T> &
+  operator=(const SlabAllocator<T> &) = delete;
+  SlabAllocator<T> &
+  operator=(const SlabAllocator<T> &&) = delete;
+};
+
+//=====================================
+template <typename T>
+T *
+allocate(SlabAllocator<T> &) noexcept;
+
+//=====================================
+template <typename T>
+void
+deallocate(SlabAllocator<T> &, T *) noexcept;
+
+//=====================================
+template <typename T>
+void
+swap(SlabAllocator<T> &, SlabAllocator<T> &) noexcept;
+
+//=====================================
+template <>
+struct AllocatorReleasesAll<SlabAllocator> : std::true_type {};
+
+//=====================================
+//====Implementation===================
+//=====================================
+namespace impl {
+namespace SlabAllocator {
+struct SANode {
+  SANode *next;
+  explicit SANode(SANode *n) noexcept
+      : next(n) {
+  }
+};
+
+template <typename T>
+struct Slab {
+  Slab<T> *next;
+  typename std::aligned_storage<sizeof(T), alignof(T)>::type
+      nodes[sp::SlabAllocator<T>::slab_length];
+
+  explicit Slab(Slab<T> *n) noexcept
+      : next(n) {
+  }
+};
+} // namespace SlabAllocator
+} // namespace impl
+
+template <typename T>
+SlabAllocator<T>::SlabAllocator() noexcept
+    : slabs(nullptr)
+    , stack(nullptr)
+    , bump(nullptr)
+    , remaining(0) {
+}
+
+template <typename T>
+SlabAllocator<T>::~SlabAllocator() noexcept {
+  using Slab = impl::SlabAllocator::Slab<T>;
+  Slab *it = (Slab *)slabs;
+Lit:
+  if (it) {
+    Slab *next = it->next;
+    delete it;
+
+    it = next;
+    goto Lit;
+  }
+  slabs = nullptr;
+  stack = nullptr;
+  bump = nullptr;
+  remaining = 0;
+}
+
+//=====================================
+template <typename T>
+T *
+allocate(SlabAllocator<T> &a) noexcept {
+  using namespace impl::SlabAllocator;
+
+  if (a.stack) {
+    SANode *const result = (SANode *)a.stack;
+    a.stack = result->next;
+
+    void *const p = result;
+    std::memset(p, 0, sizeof(T));
+    return reinterpret_cast<T *>(result);
+  }
+
+  if (a.remaining == 0) {
+    Slab<T> *const slab = new (std::nothrow) Slab<T>((Slab<T> *)a.slabs);
+    if (!slab) {
+      return nullptr;
+    }
+
+    a.slabs = slab;
+    a.bump = reinterpret_cast<T *>(slab->nodes);
+    a.remaining = sp::SlabAllocator<T>::slab_length;
+  }
+
+  --a.remaining;
+  return a.bump++;
+}
+
+//=====================================
+template <typename T>
+void
+deallocate(SlabAllocator<T> &a, T *p) noexcept {
+  using namespace impl::SlabAllocator;
+  assertx(p);
+
+  void *const pah = p;
+  std::memset(pah, 0, sizeof(T));
+  a.stack = new (p) SANode((SANode *)a.stack);
+}
+
+//=====================================
+template <typename T>
+void
+swap(SlabAllocator<T> &first, SlabAllocator<T> &second) noexcept {
+  using std::swap;
+  swap(first.slabs, second.slabs);
+  swap(first.stack, second.stack);
+  swap(first.bump, second.bump);
+  swap(first.remaining, second.remaining);
+}
+
+//=====================================
+} // namespace sp
+
+#endif
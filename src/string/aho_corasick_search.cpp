@@ -0,0 +1,220 @@
+#include "aho_corasick_search.h"
+#include <cstring>
+#include <new>
+#include <util/assert.h>
+
+namespace sp {
+namespace ac {
+//=====================================
+AhoCorasick::AhoCorasick() noexcept
+    : classes{0}
+    , alphabet{0}
+    , transitions{nullptr}
+    , states{0}
+    , terminal{nullptr}
+    , report{nullptr}
+    , report_next{nullptr}
+    , lengths{nullptr}
+    , duplicate{nullptr}
+    , patterns{0} {
+}
+
+static void
+clear(AhoCorasick &self) noexcept {
+  delete[] self.transitions;
+  delete[] self.terminal;
+  delete[] self.report;
+  delete[] self.report_next;
+  delete[] self.lengths;
+  delete[] self.duplicate;
+
+  std::memset(self.classes, 0, sizeof(self.classes));
+  self.alphabet = 0;
+  self.transitions = nullptr;
+  self.states = 0;
+  self.terminal = nullptr;
+  self.report = nullptr;
+  self.report_next = nullptr;
+  self.lengths = nullptr;
+  self.duplicate = nullptr;
+  self.patterns = 0;
+}
+
+AhoCorasick::~AhoCorasick() noexcept {
+  clear(*this);
+}
+
+//=====================================
+static void
+insert(AhoCorasick &self, const char *pattern, std::size_t length,
+       std::uint32_t id) noexcept {
+  std::uint32_t state = 0;
+  for (std::size_t i = 0; i < length; ++i) {
+    std::uint32_t &next =
+        self.transitions[state * self.alphabet +
+                         self.classes[(unsigned char)pattern[i]]];
+    if (next == 0) {
+      next = std::uint32_t(self.states++);
+    }
+    state = next;
+  }
+
+  self.lengths[id] = std::uint32_t(length);
+  self.duplicate[id] = self.terminal[state];
+  self.terminal[state] = id;
+}
+
+/* Breadth first, so the failure state of a state is always done before the
+ * state itself. A missing edge is replaced with the edge of the failure state.
+ */
+static bool
+link(AhoCorasick &self) noexcept {
+  std::uint32_t *const fail = new (std::nothrow) std::uint32_t[self.states];
+  std::uint32_t *const queue = new (std::nothrow) std::uint32_t[self.states];
+  if (!fail || !queue) {
+    delete[] fail;
+    delete[] queue;
+    return false;
+  }
+
+  std::size_t head = 0;
+  std::size_t tail = 0;
+
+  fail[0] = 0;
+  self.report[0] = AhoCorasick::NONE;
+  self.report_next[0] = AhoCorasick::NONE;
+  for (std::size_t c = 0; c < self.alphabet; ++c) {
+    const std::uint32_t child = self.transitions[c];
+    if (child != 0) {
+      fail[child] = 0;
+      queue[tail++] = child;
+    }
+  }
+
+  while (head != tail) {
+    const std::uint32_t state = queue[head++];
+    std::uint32_t *const row = self.transitions + (state * self.alphabet);
+    const std::uint32_t *const fail_row =
+        self.transitions + (fail[state] * self.alphabet);
+
+    self.report_next[state] = self.report[fail[state]];
+    self.report[state] = self.terminal[state] != AhoCorasick::NONE
+                             ? state
+                             : self.report_next[state];
+
+    for (std::size_t c = 0; c < self.alphabet; ++c) {
+      const std::uint32_t child = row[c];
+      if (child != 0) {
+        fail[child] = fail_row[c];
+        queue[tail++] = child;
+      } else {
+        row[c] = fail_row[c];
+      }
+    }
+  }
+
+  assertxs(tail + 1 == self.states, tail, self.states);
+  delete[] fail;
+  delete[] queue;
+  return true;
+}
+
+bool
+build(AhoCorasick &self, const char *const *patterns,
+      const std::size_t *lengths, std::size_t n) noexcept {
+  clear(self);
+
+  std::size_t max_states = 1;
+  self.alphabet = 1;
+  for (std::size_t i = 0; i < n; ++i) {
+    if (lengths[i] == 0) {
+      clear(self);
+      return false;
+    }
+
+    max_states += lengths[i];
+    for (std::size_t k = 0; k < lengths[i]; ++k) {
+      std::uint16_t &current = self.classes[(unsigned char)patterns[i][k]];
+      if (current == 0) {
+        current = std::uint16_t(self.alphabet++);
+      }
+    }
+  }
+
+  if (max_states >= AhoCorasick::NONE || n >= AhoCorasick::NONE) {
+    clear(self);
+    return false;
+  }
+
+  self.transitions =
+      new (std::nothrow) std::uint32_t[max_states * self.alphabet]();
+  self.terminal = new (std::nothrow) std::uint32_t[max_states];
+  self.report = new (std::nothrow) std::uint32_t[max_states];
+  self.report_next = new (std::nothrow) std::uint32_t[max_states];
+  self.lengths = new (std::nothrow) std::uint32_t[n + 1];
+  self.duplicate = new (std::nothrow) std::uint32_t[n + 1];
+  if (!self.transitions || !self.terminal || !self.report ||
+      !self.report_next || !self.lengths || !self.duplicate) {
+    clear(self);
+    return false;
+  }
+
+  for (std::size_t i = 0; i < max_states; ++i) {
+    self.terminal[i] = AhoCorasick::NONE;
+  }
+
+  self.states = 1;
+  self.patterns = n;
+  for (std::size_t i = 0; i < n; ++i) {
+    insert(self, patterns[i], lengths[i], std::uint32_t(i));
+  }
+
+  if (!link(self)) {
+    clear(self);
+    return false;
+  }
+
+  return true;
+}
+
+bool
+build(AhoCorasick &self, const char *const *patterns, std::size_t n) noexcept {
+  std::size_t *const lengths = new (std::nothrow) std::size_t[n + 1];
+  if (!lengths) {
+    return false;
+  }
+
+  for (std::size_t i = 0; i < n; ++i) {
+    lengths[i] = std::strlen(patterns[i]);
+  }
+
+  const bool result = build(self, patterns, lengths, n);
+  delete[] lengths;
+  return result;
+}
+
+//=====================================
+const char *
+search(const AhoCorasick &self, const char *text, std::size_t length,
+       std::size_t &pattern) noexcept {
+  if (self.states == 0) {
+    return nullptr;
+  }
+
+  std::uint32_t state = 0;
+  for (std::size_t i = 0; i < length; ++i) {
+    state = impl::ac_next(self, state, (unsigned char)text[i]);
+
+    const std::uint32_t r = self.report[state];
+    if (r != AhoCorasick::NONE) {
+      pattern = self.terminal[r];
+      return text + (i + 1) - self.lengths[pattern];
+    }
+  }
+
+  return nullptr;
+}
+
+//=====================================
+} // namespace ac
+} // namespace sp
@@ -0,0 +1,197 @@
+#ifndef SP_UTIL_STRING_AHO_CORASICK_SEARCH_H
+#define SP_UTIL_STRING_AHO_CORASICK_SEARCH_H
+
+#include <cstddef>
+#include <cstdint>
+
+/* # Aho-Corasick
+ * Multi pattern search, finds all occurrences of all patterns in a single
+ * pass over the text, O(text + patterns + matches).
+ *
+ * The trie of the patterns is turned into a DFA where the missing edges are
+ * resolved through the failure links at build time, so the search loop is
+ * exactly one table lookup per text byte.
+ *
+ * The transition table is dense, but over byte classes rather than bytes:
+ * every byte present in any of the patterns gets its own class and all other
+ * bytes share class 0 which always leads back to the root. For typical
+ * pattern sets this makes a row a few dozen entries instead of 256.
+ *
+ * ## ref
+ * https://cr.yp.to/bib/1975/aho.pdf
+ * https://en.wikipedia.org/wiki/Aho%E2%80%93Corasick_algorithm
+ */
+namespace sp {
+namespace ac {
+//=====================================
+struct AhoCorasick {
+  static constexpr std::uint32_t NONE = ~std::uint32_t(0);
+
+  /* byte -> class */
+  std::uint16_t classes[256];
+  /* number of classes including class 0 */
+  std::size_t alphabet;
+
+  /* $transitions[state * $alphabet + class] */
+  std::uint32_t *transitions;
+  std::size_t states;
+
+  /* per state: first pattern ending at the state or NONE */
+  std::uint32_t *terminal;
+  /* per state: closest state on the failure chain, including the state
+   * itself, which has a terminal or NONE */
+  std::uint32_t *report;
+  /* per state: report[fail[state]] */
+  std::uint32_t *report_next;
+
+  /* per pattern: length and next pattern with the same content or NONE */
+  std::uint32_t *lengths;
+  std::uint32_t *duplicate;
+  std::size_t patterns;
+
+  AhoCorasick() noexcept;
+
+  AhoCorasick(const AhoCorasick &) = delete;
+  AhoCorasick(const AhoCorasick &&) = delete;
+
+  ~AhoCorasick() noexcept;
+};
+
+//=====================================
+/* Builds the automaton for $n patterns, returns false if a pattern is empty or
+ * the allocation failed. A pattern is identified by its index in $patterns.
+ */
+bool
+build(AhoCorasick &, const char *const *patterns, const std::size_t *lengths,
+      std::size_t n) noexcept;
+
+bool
+build(AhoCorasick &, const char *const *patterns, std::size_t n) noexcept;
+
+//=====================================
+/* Calls $f(const char *match, std::size_t pattern) for every occurrence of
+ * every pattern in $text, in the order of where the match ends. Returns the
+ * number of matches.
+ */
+template <typename F>
+std::size_t
+search(const AhoCorasick &, const char *text, std::size_t, F f) noexcept;
+
+/* Returns the first match to end in $text or nullptr, $pattern is set to the
+ * matching pattern.
+ */
+const char *
+search(const AhoCorasick &, const char *text, std::size_t,
+       std::size_t &pattern) noexcept;
+
+//=====================================
+/* Resumable search where the text is given chunk by chunk, the automaton
+ * state carries the partial matches across chunks.
+ */
+struct Stream {
+  const AhoCorasick *automaton;
+  std::uint32_t state;
+  /* number of bytes consumed */
+  std::uint64_t offset;
+
+  explicit Stream(const AhoCorasick &) noexcept;
+};
+
+/* Calls $f(std::uint64_t offset, std::size_t pattern) with the absolute
+ * stream offset of every match ending in $chunk. Returns the number of
+ * matches.
+ */
+template <typename F>
+std::size_t
+update(Stream &, const char *chunk, std::size_t, F f) noexcept;
+
+//=====================================
+//====Implementation===================
+//=====================================
+namespace impl {
+inline std::uint32_t
+ac_next(const AhoCorasick &self, std::uint32_t state,
+        unsigned char c) noexcept {
+  return self.transitions[state * self.alphabet + self.classes[c]];
+}
+
+/* Calls $f(std::size_t pattern) for every pattern ending in $state */
+template <typename F>
+std::size_t
+ac_report(const AhoCorasick &self, std::uint32_t state, F f) noexcept {
+  std::size_t result = 0;
+  for (std::uint32_t r = self.report[state]; r != AhoCorasick::NONE;
+       r = self.report_next[r]) {
+    for (std::uint32_t p = self.terminal[r]; p != AhoCorasick::NONE;
+         p = self.duplicate[p]) {
+      f(std::size_t(p));
+      ++result;
+    }
+  }
+
+  return result;
+}
+} // namespace impl
+
+template <typename F>
+std::size_t
+search(const AhoCorasick &self, const char *text, std::size_t length,
+       F f) noexcept {
+  std::size_t result = 0;
+  if (self.states == 0) {
+    return result;
+  }
+
+  std::uint32_t state = 0;
+  for (std::size_t i = 0; i < length; ++i) {
+    state = impl::ac_next(self, state, (unsigned char)text[i]);
+    if (self.report[state] != AhoCorasick::NONE) {
+      const char *const end = text + i + 1;
+      result += impl::ac_report(self, state, [&](std::size_t p) {
+        /**/
+        f(end - self.lengths[p], p);
+      });
+    }
+  }
+
+  return result;
+}
+
+//=====================================
+inline Stream::Stream(const AhoCorasick &a) noexcept
+    : automaton{&a}
+    , state{0}
+    , offset{0} {
+}
+
+template <typename F>
+std::size_t
+update(Stream &self, const char *chunk, std::size_t length, F f) noexcept {
+  const AhoCorasick &ac = *self.automaton;
+  std::size_t result = 0;
+  if (ac.states == 0) {
+    return result;
+  }
+
+  std::uint32_t state = self.state;
+  for (std::size_t i = 0; i < length; ++i) {
+    state = impl::ac_next(ac, state, (unsigned char)chunk[i]);
+    if (ac.report[state] != AhoCorasick::NONE) {
+      const std::uint64_t end = self.offset + i + 1;
+      result += impl::ac_report(ac, state, [&](std::size_t p) {
+        /**/
+        f(end - ac.lengths[p], p);
+      });
+    }
+  }
+
+  self.state = state;
+  self.offset += length;
+  return result;
+}
+
+//=====================================
+} // namespace ac
+} // namespace sp
+
+#endif
@@ -1 +1,146 @@
 #include "boyer_moore_horspool_search.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <util/assert.h>
+
+namespace sp {
+namespace bmh {
+//=====================================
+/* Only the bad character rule of Boyer-Moore is used. The shift is decided by
+ * the text character aligned with the last character of the needle, which is
+ * the distance from its last occurrence in needle[0, nlen-1) to the end.
+ */
+static void
+shift_table(std::size_t (&shift)[256], const char *needle,
+            std::size_t nlen) noexcept {
+  for (std::size_t i = 0; i < 256; ++i) {
+    shift[i] = nlen;
+  }
+
+  const std::size_t last = nlen - 1;
+  for (std::size_t i = 0; i < last; ++i) {
+    shift[(unsigned char)needle[i]] = last - i;
+  }
+}
+
+namespace impl {
+const char *
+search(const std::size_t (&shift)[256], const char *const text,
+       std::size_t tlen, const char *const needle, std::size_t nlen) noexcept {
+  if (nlen > tlen || nlen == 0) {
+    return nullptr;
+  }
+
+  assertxs(text, tlen, nlen);
+  assertxs(needle, tlen, nlen);
+
+  const std::size_t last = nlen - 1;
+  const unsigned char last_char = (unsigned char)needle[last];
+  std::size_t i = 0;
+  while (i <= tlen - nlen) {
+    const unsigned char current = (unsigned char)text[i + last];
+    if (current == last_char && std::memcmp(text + i, needle, last) == 0) {
+      return text + i;
+    }
+
+    i += shift[current];
+  }
+
+  return nullptr;
+}
+} // namespace impl
+
+const char *
+search(const char *const text, std::size_t tlen, //
+       const char *const needle, std::size_t nlen) noexcept {
+  if (nlen > tlen || nlen == 0) {
+    return nullptr;
+  }
+
+  std::size_t shift[256];
+  shift_table(shift, needle, nlen);
+  return impl::search(shift, text, tlen, needle, nlen);
+}
+
+const char *
+search(const char *text, std::size_t tlen, const char *needle) noexcept {
+  return search(text, tlen, needle, std::strlen(needle));
+}
+
+const char *
+search(const char *text, const char *needle) noexcept {
+  return search(text, std::strlen(text), needle);
+}
+
+//=====================================
+Stream::Stream() noexcept
+    : needle{nullptr}
+    , length{0}
+    , shift{0}
+    , window{nullptr}
+    , tail{0}
+    , offset{0} {
+}
+
+Stream::~Stream() noexcept {
+  delete[] window;
+  window = nullptr;
+}
+
+bool
+init(Stream &self, const char *needle, std::size_t nlen) noexcept {
+  delete[] self.window;
+  self.window = nullptr;
+  self.needle = needle;
+  self.length = nlen;
+  self.tail = 0;
+  self.offset = 0;
+
+  if (nlen == 0) {
+    return false;
+  }
+
+  /* room for nlen - 1 bytes of tail and nlen - 1 bytes of the next chunk */
+  self.window = new (std::nothrow) char[2 * nlen];
+  if (!self.window) {
+    return false;
+  }
+
+  shift_table(self.shift, needle, nlen);
+  return true;
+}
+
+namespace impl {
+std::size_t
+window_fill(Stream &self, const char *chunk, std::size_t length) noexcept {
+  const std::size_t head = std::min(self.length - 1, length);
+  std::memcpy(self.window + self.tail, chunk, head);
+  return self.tail + head;
+}
+
+void
+window_keep(Stream &self, const char *chunk, std::size_t length) noexcept {
+  const std::size_t keep = self.length - 1;
+  if (length >= keep) {
+    std::memcpy(self.window, chunk + (length - keep), keep);
+    self.tail = keep;
+    return;
+  }
+
+  /* [tail][chunk] is already in the window if window_fill() was done, but
+   * not when the tail was empty */
+  const std::size_t total = self.tail + length;
+  std::memcpy(self.window + self.tail, chunk, length);
+  if (total > keep) {
+    std::memmove(self.window, self.window + (total - keep), keep);
+    self.tail = keep;
+  } else {
+    self.tail = total;
+  }
+}
+} // namespace impl
+
+//=====================================
+} // namespace bmh
+} // namespace sp
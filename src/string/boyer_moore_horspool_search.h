@@ -2,6 +2,7 @@
 #define SP_UTIL_STRING_BOYER_MOORE_HORSPOOL_SEARCH_H
 
 #include <cstddef>
+#include <cstdint>
 
 namespace sp {
 namespace bmh {
@@ -16,7 +17,105 @@ const char *
 search(const char *text, const char *needle) noexcept;
 
 //=====================================
+/* Resumable search where the text is given chunk by chunk. The last
+ * $length - 1 bytes of the stream are kept so that a match spanning chunks
+ * can be found. $needle is referenced and has to outlive the Stream.
+ */
+struct Stream {
+  const char *needle;
+  std::size_t length;
+  std::size_t shift[256];
+  /* [tail of the previous chunks][head of the current chunk] */
+  char *window;
+  std::size_t tail;
+  /* number of bytes consumed */
+  std::uint64_t offset;
+
+  Stream() noexcept;
+
+  Stream(const Stream &) = delete;
+  Stream(const Stream &&) = delete;
+
+  ~Stream() noexcept;
+};
+
+/* returns false if $needle is empty */
+bool
+init(Stream &, const char *needle, std::size_t) noexcept;
+
+/* Calls $f(std::uint64_t offset) with the absolute stream offset of every,
+ * including overlapping, match ending in $chunk. Returns the number of
+ * matches.
+ */
+template <typename F>
+std::size_t
+update(Stream &, const char *chunk, std::size_t, F f) noexcept;
+
+//=====================================
+//====Implementation===================
+//=====================================
+namespace impl {
+const char *
+search(const std::size_t (&shift)[256], const char *text, std::size_t,
+       const char *needle, std::size_t) noexcept;
+
+/* Appends the start of $chunk to the kept tail, returns the length of the
+ * window */
+std::size_t
+window_fill(Stream &, const char *chunk, std::size_t) noexcept;
+
+void
+window_keep(Stream &, const char *chunk, std::size_t) noexcept;
+
+template <typename F>
+std::size_t
+search_all(const Stream &self, const char *text, std::size_t length,
+           std::size_t max_start, std::uint64_t offset, F &f) noexcept {
+  std::size_t result = 0;
+  const char *it = text;
+  const char *const end = text + length;
+  while ((it = search(self.shift, it, std::size_t(end - it), self.needle,
+                      self.length))) {
+    const std::size_t start = std::size_t(it - text);
+    if (start >= max_start) {
+      break;
+    }
+
+    f(offset + start);
+    ++result;
+    ++it;
+  }
+
+  return result;
 }
+} // namespace impl
+
+template <typename F>
+std::size_t
+update(Stream &self, const char *chunk, std::size_t length, F f) noexcept {
+  std::size_t result = 0;
+  if (!self.window || length == 0) {
+    return result;
+  }
+
+  /* matches starting in the kept tail */
+  if (self.tail > 0) {
+    const std::size_t tail = self.tail;
+    const std::size_t window = impl::window_fill(self, chunk, length);
+    result += impl::search_all(self, self.window, window, tail,
+                               self.offset - tail, f);
+  }
+
+  /* matches contained in $chunk */
+  result += impl::search_all(self, chunk, length, length, self.offset, f);
+
+  impl::window_keep(self, chunk, length);
+  self.offset += length;
+  return result;
 }
 
+//=====================================
+} // namespace bmh
+} // namespace sp
+
 #endif
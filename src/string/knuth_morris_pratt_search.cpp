@@ -3,6 +3,7 @@
 #include <collection/Array.h>
 #include <cstdint>
 #include <cstring>
+#include <new>
 #include <util/assert.h>
 
 namespace sp {
@@ -195,6 +196,42 @@ search(const char *text, const char *needle) noexcept {
   return search(text, std::strlen(text), needle);
 }
 
+//=====================================
+Stream::Stream() noexcept
+    : needle{nullptr}
+    , length{0}
+    , table{nullptr}
+    , matched{0}
+    , offset{0} {
+}
+
+Stream::~Stream() noexcept {
+  delete[] table;
+  table = nullptr;
+}
+
+bool
+init(Stream &self, const char *needle, std::size_t nlen) noexcept {
+  delete[] self.table;
+  self.table = nullptr;
+  self.needle = needle;
+  self.length = nlen;
+  self.matched = 0;
+  self.offset = 0;
+
+  if (nlen == 0 || nlen >= std::size_t(INT32_MAX)) {
+    return false;
+  }
+
+  self.table = new (std::nothrow) std::int32_t[nlen + 1];
+  if (!self.table) {
+    return false;
+  }
+
+  failure_function(needle, self.table, nlen);
+  return true;
+}
+
 //=====================================
 } // namespace kmp
 } // namespace sp
@@ -2,6 +2,7 @@
 #define SP_UTIL_STRING_KNUTH_MORRIS_PRATT_SEARCH_H
 
 #include <cstddef>
+#include <cstdint>
 // https://en.wikipedia.org/wiki/Knuth%E2%80%93Morris%E2%80%93Pratt_algorithm
 
 // TODO document
@@ -17,6 +18,72 @@ search(const char *text, std::size_t, const char *needle) noexcept;
 const char *
 search(const char *text, const char *needle) noexcept;
 
+//=====================================
+/* Resumable search where the text is given chunk by chunk, a match spanning
+ * several chunks is found since only the length of the currently matched
+ * prefix is needed to continue. $needle is referenced and has to outlive the
+ * Stream.
+ */
+struct Stream {
+  const char *needle;
+  std::size_t length;
+  std::int32_t *table;
+  /* currently matched prefix of $needle */
+  std::int32_t matched;
+  /* number of bytes consumed */
+  std::uint64_t offset;
+
+  Stream() noexcept;
+
+  Stream(const Stream &) = delete;
+  Stream(const Stream &&) = delete;
+
+  ~Stream() noexcept;
+};
+
+/* returns false if $needle is empty */
+bool
+init(Stream &, const char *needle, std::size_t) noexcept;
+
+/* Calls $f(std::uint64_t offset) with the absolute stream offset of every,
+ * including overlapping, match ending in $chunk. Returns the number of
+ * matches.
+ */
+template <typename F>
+std::size_t
+update(Stream &, const char *chunk, std::size_t, F f) noexcept;
+
+//=====================================
+//====Implementation===================
+//=====================================
+template <typename F>
+std::size_t
+update(Stream &self, const char *chunk, std::size_t length, F f) noexcept {
+  std::size_t result = 0;
+  if (!self.table) {
+    return result;
+  }
+
+  const std::int32_t nlen = std::int32_t(self.length);
+  std::int32_t n = self.matched;
+  for (std::size_t i = 0; i < length; ++i) {
+    const char c = chunk[i];
+    while (n >= 0 && self.needle[n] != c) {
+      n = self.table[n];
+    }
+
+    if (++n == nlen) {
+      f(self.offset + i + 1 - self.length);
+      ++result;
+      n = self.table[nlen];
+    }
+  }
+
+  self.matched = n;
+  self.offset += length;
+  return result;
+}
+
 //=====================================
 } // namespace kmp
 } // namespace sp
@@ -172,4 +172,214 @@ levenshtein(const char *first, const char *second) noexcept {
 
 //=====================================
 } // namespace dp
+
+namespace myers {
+//=====================================
+/* Advances one 64 row block one column. $hin is the horizontal delta entering
+ * the first row of the block, returns the delta leaving the row $last.
+ */
+static int
+advance_block(std::uint64_t &Pv, std::uint64_t &Mv, std::uint64_t Eq, int hin,
+              std::uint64_t last) noexcept {
+  const std::uint64_t Xv = Eq | Mv;
+  if (hin < 0) {
+    Eq |= 1;
+  }
+  const std::uint64_t Xh = (((Eq & Pv) + Pv) ^ Pv) | Eq;
+  std::uint64_t Ph = Mv | ~(Xh | Pv);
+  std::uint64_t Mh = Pv & Xh;
+
+  int hout = 0;
+  if (Ph & last) {
+    hout = 1;
+  } else if (Mh & last) {
+    hout = -1;
+  }
+
+  Ph <<= 1;
+  Mh <<= 1;
+  if (hin < 0) {
+    Mh |= 1;
+  } else if (hin > 0) {
+    Ph |= 1;
+  }
+
+  Pv = Mh | ~(Xv | Ph);
+  Mv = Ph & Xv;
+  return hout;
+}
+
+static std::size_t
+single_word(const char *a, std::size_t m, const char *b,
+            std::size_t n) noexcept {
+  /* only the entries which are read are cleared, cheaper than clearing all
+   * 256 for short strings */
+  std::uint64_t Peq[256];
+  for (std::size_t i = 0; i < m; ++i) {
+    Peq[(unsigned char)a[i]] = 0;
+  }
+  for (std::size_t j = 0; j < n; ++j) {
+    Peq[(unsigned char)b[j]] = 0;
+  }
+  for (std::size_t i = 0; i < m; ++i) {
+    Peq[(unsigned char)a[i]] |= std::uint64_t(1) << i;
+  }
+
+  const std::uint64_t last = std::uint64_t(1) << (m - 1);
+  std::uint64_t Pv = ~std::uint64_t(0);
+  std::uint64_t Mv = 0;
+  std::size_t score = m;
+  for (std::size_t j = 0; j < n; ++j) {
+    /* the first row is 0, 1, 2... so the delta entering the column is +1 */
+    const int hout =
+        advance_block(Pv, Mv, Peq[(unsigned char)b[j]], 1, last);
+    score = std::size_t(std::ptrdiff_t(score) + hout);
+  }
+
+  return score;
+}
+
+static std::size_t
+multi_word(const char *a, std::size_t m, const char *b,
+           std::size_t n) noexcept {
+  const std::size_t words = (m + 63) / 64;
+  std::uint64_t *const Peq = new std::uint64_t[256 * words]();
+  std::uint64_t *const Pv = new std::uint64_t[words];
+  std::uint64_t *const Mv = new std::uint64_t[words]();
+  assertx(Peq && Pv && Mv);
+
+  for (std::size_t i = 0; i < m; ++i) {
+    Peq[((unsigned char)a[i] * words) + (i / 64)] |= std::uint64_t(1)
+                                                     << (i % 64);
+  }
+  for (std::size_t w = 0; w < words; ++w) {
+    Pv[w] = ~std::uint64_t(0);
+  }
+
+  const std::uint64_t high = std::uint64_t(1) << 63;
+  const std::uint64_t last = std::uint64_t(1) << ((m - 1) % 64);
+  std::size_t score = m;
+  for (std::size_t j = 0; j < n; ++j) {
+    const std::uint64_t *const eq = Peq + ((unsigned char)b[j] * words);
+
+    int carry = 1;
+    for (std::size_t w = 0; w + 1 < words; ++w) {
+      carry = advance_block(Pv[w], Mv[w], eq[w], carry, high);
+    }
+    carry = advance_block(Pv[words - 1], Mv[words - 1], eq[words - 1], carry,
+                          last);
+    score = std::size_t(std::ptrdiff_t(score) + carry);
+  }
+
+  delete[] Peq;
+  delete[] Pv;
+  delete[] Mv;
+  return score;
+}
+
+std::size_t
+levenshtein(const char *a, std::size_t m, const char *b,
+            std::size_t n) noexcept {
+  if (m > n) {
+    return levenshtein(b, n, a, m);
+  }
+
+  if (m == 0) {
+    return n;
+  }
+
+  if (m <= 64) {
+    return single_word(a, m, b, n);
+  }
+
+  return multi_word(a, m, b, n);
+}
+
+std::size_t
+levenshtein(const char *a, const char *b) noexcept {
+  assertx(a);
+  assertx(b);
+  return levenshtein(a, std::strlen(a), b, std::strlen(b));
+}
+} // namespace myers
+
+//=====================================
+static std::size_t
+bounded_band(const char *a, std::size_t m, const char *b, std::size_t n,
+             std::size_t k, std::size_t *prev, std::size_t *cur) noexcept {
+  const std::size_t inf = k + 1;
+  for (std::size_t j = 0; j <= n; ++j) {
+    prev[j] = j <= k ? j : inf;
+  }
+
+  for (std::size_t i = 1; i <= m; ++i) {
+    const std::size_t lo = i > k ? i - k : 1;
+    const std::size_t hi = min(n, i + k);
+
+    /* the cell left of the band */
+    cur[lo - 1] = lo == 1 && i <= k ? i : inf;
+    std::size_t row_min = cur[lo - 1];
+
+    const char current = a[i - 1];
+    for (std::size_t j = lo; j <= hi; ++j) {
+      const std::size_t sub = prev[j - 1] + (current == b[j - 1] ? 0 : 1);
+      const std::size_t value = min(min(sub, prev[j] + 1, cur[j - 1] + 1), inf);
+      cur[j] = value;
+      row_min = min(row_min, value);
+    }
+
+    /* the cell right of the band, read by the next row */
+    if (hi < n) {
+      cur[hi + 1] = inf;
+    }
+
+    if (row_min > k) {
+      return inf;
+    }
+
+    std::size_t *const tmp = prev;
+    prev = cur;
+    cur = tmp;
+  }
+
+  return min(prev[n], inf);
+}
+
+std::size_t
+levenshtein_bounded(const char *a, std::size_t m, const char *b, std::size_t n,
+                    std::size_t k) noexcept {
+  if (m < n) {
+    /* the shorter string indexes the columns, which keeps the rows short */
+    return levenshtein_bounded(b, n, a, m, k);
+  }
+
+  /* the distance is at most $m, a larger $k would only overflow k + 1 and
+   * i + k */
+  k = min(k, m);
+
+  if (m - n > k) {
+    return k + 1;
+  }
+
+  if (n + 1 <= 64) {
+    std::size_t prev[64];
+    std::size_t cur[64];
+    return bounded_band(a, m, b, n, k, prev, cur);
+  }
+
+  std::size_t *const rows = new std::size_t[2 * (n + 1)];
+  assertx(rows);
+  const std::size_t result = bounded_band(a, m, b, n, k, rows, rows + n + 1);
+  delete[] rows;
+  return result;
+}
+
+std::size_t
+levenshtein_bounded(const char *a, const char *b, std::size_t k) noexcept {
+  assertx(a);
+  assertx(b);
+  return levenshtein_bounded(a, std::strlen(a), b, std::strlen(b), k);
+}
+
+//=====================================
 } // namespace ascii
@@ -1,6 +1,7 @@
 #ifndef SP_UTIL_STRING_LEVENSHTEIN_H
 #define SP_UTIL_STRING_LEVENSHTEIN_H
 
+#include <cstddef>
 #include <cstdint>
 
 namespace ascii {
@@ -22,7 +23,49 @@ namespace dp {
  */
 std::size_t
 levenshtein(const char *, const char *) noexcept;
-}
-}
+} // namespace dp
+
+namespace myers {
+//=====================================
+/* # Myers' bit-parallel algorithm
+ * The DP matrix is encoded column by column as vertical deltas(+1/-1 bit
+ * vectors) and a whole column, 64 cells per word, is computed using a
+ * handful of bitwise operations. The shorter string is used as the column,
+ * longer than 64 bytes are split into blocks of 64 which pass the horizontal
+ * delta of their last row as a carry to the next block.
+ *
+ * O(ceil(m/64) * n) time, O(ceil(m/64) * 256) words of memory
+ *
+ * ## ref
+ * https://dl.acm.org/doi/10.1145/316542.316550
+ * Hyyrö, Explaining and extending the bit-parallel approximate string
+ * matching algorithm of Myers
+ */
+std::size_t
+levenshtein(const char *, std::size_t, const char *, std::size_t) noexcept;
+
+std::size_t
+levenshtein(const char *, const char *) noexcept;
+} // namespace myers
+
+//=====================================
+/* Returns the distance if it is at most $k, otherwise $k + 1.
+ *
+ * Only the diagonal band of width 2k+1 of the DP matrix can contain cells
+ * <= k on the path to the result, so only the band is computed, and the
+ * computation stops as soon as a whole row of the band exceeds $k.
+ *
+ * O(k * min(m, n)) time
+ *
+ * ## ref
+ * Ukkonen, Algorithms for approximate string matching
+ */
+std::size_t
+levenshtein_bounded(const char *, std::size_t, const char *, std::size_t,
+                    std::size_t k) noexcept;
+
+std::size_t
+levenshtein_bounded(const char *, const char *, std::size_t k) noexcept;
+} // namespace ascii
 
 #endif
@@ -0,0 +1,174 @@
+#include "simd_search.h"
+#include <cstring>
+#include <string/boyer_moore_horspool_search.h>
+#include <util/assert.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace sp {
+namespace simd {
+//=====================================
+const char *
+search_scalar(const char *text, std::size_t tlen, const char *needle,
+              std::size_t nlen) noexcept {
+  return bmh::search(text, tlen, needle, nlen);
+}
+
+//=====================================
+/* Returns nullptr if not found in the blocks processed, the remaining
+ * [$i, tlen) is left for the caller to search.
+ */
+#if defined(__x86_64__)
+static const char *
+sse2_blocks(const char *text, std::size_t tlen, const char *needle,
+            std::size_t nlen, std::size_t &i) noexcept {
+  const __m128i first = _mm_set1_epi8(needle[0]);
+  const __m128i last = _mm_set1_epi8(needle[nlen - 1]);
+
+  for (i = 0; i + nlen + 15 <= tlen; i += 16) {
+    const __m128i block_first =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + i));
+    const __m128i block_last = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(text + i + nlen - 1));
+
+    const __m128i eq = _mm_and_si128(_mm_cmpeq_epi8(first, block_first),
+                                     _mm_cmpeq_epi8(last, block_last));
+    unsigned int mask = unsigned(_mm_movemask_epi8(eq));
+    while (mask) {
+      const std::size_t bit = std::size_t(__builtin_ctz(mask));
+      const char *const candidate = text + i + bit;
+      if (std::memcmp(candidate + 1, needle + 1, nlen - 2) == 0) {
+        return candidate;
+      }
+      mask &= mask - 1;
+    }
+  }
+
+  return nullptr;
+}
+
+__attribute__((target("avx2"))) static const char *
+avx2_blocks(const char *text, std::size_t tlen, const char *needle,
+            std::size_t nlen, std::size_t &i) noexcept {
+  const __m256i first = _mm256_set1_epi8(needle[0]);
+  const __m256i last = _mm256_set1_epi8(needle[nlen - 1]);
+
+  for (i = 0; i + nlen + 31 <= tlen; i += 32) {
+    const __m256i block_first =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text + i));
+    const __m256i block_last = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(text + i + nlen - 1));
+
+    const __m256i eq = _mm256_and_si256(_mm256_cmpeq_epi8(first, block_first),
+                                        _mm256_cmpeq_epi8(last, block_last));
+    unsigned int mask = unsigned(_mm256_movemask_epi8(eq));
+    while (mask) {
+      const std::size_t bit = std::size_t(__builtin_ctz(mask));
+      const char *const candidate = text + i + bit;
+      if (std::memcmp(candidate + 1, needle + 1, nlen - 2) == 0) {
+        return candidate;
+      }
+      mask &= mask - 1;
+    }
+  }
+
+  return nullptr;
+}
+#endif
+
+using blocks_fp = const char *(*)(const char *, std::size_t, const char *,
+                                  std::size_t, std::size_t &);
+
+static const char *
+search_blocks(blocks_fp blocks, const char *text, std::size_t tlen,
+              const char *needle, std::size_t nlen) noexcept {
+  if (nlen > tlen || nlen == 0) {
+    return nullptr;
+  }
+
+  if (nlen == 1) {
+    return (const char *)std::memchr(text, needle[0], tlen);
+  }
+
+  std::size_t i = 0;
+  const char *const result = blocks(text, tlen, needle, nlen, i);
+  if (result) {
+    return result;
+  }
+
+  /* tail, less than one block */
+  assertxs(i <= tlen, i, tlen);
+  return search_scalar(text + i, tlen - i, needle, nlen);
+}
+
+const char *
+search_sse2(const char *text, std::size_t tlen, const char *needle,
+            std::size_t nlen) noexcept {
+#if defined(__x86_64__)
+  return search_blocks(sse2_blocks, text, tlen, needle, nlen);
+#else
+  return search_scalar(text, tlen, needle, nlen);
+#endif
+}
+
+const char *
+search_avx2(const char *text, std::size_t tlen, const char *needle,
+            std::size_t nlen) noexcept {
+#if defined(__x86_64__)
+  if (has_avx2()) {
+    return search_blocks(avx2_blocks, text, tlen, needle, nlen);
+  }
+#endif
+  return search_sse2(text, tlen, needle, nlen);
+}
+
+bool
+has_avx2() noexcept {
+#if defined(__x86_64__)
+  /* also checks that the OS saves the ymm registers */
+  static const bool result = __builtin_cpu_supports("avx2");
+  return result;
+#else
+  return false;
+#endif
+}
+
+//=====================================
+using search_fp = const char *(*)(const char *, std::size_t, const char *,
+                                  std::size_t);
+
+static search_fp
+select() noexcept {
+#if defined(__x86_64__)
+  if (has_avx2()) {
+    return search_avx2;
+  }
+  return search_sse2;
+#else
+  return search_scalar;
+#endif
+}
+
+const char *
+search(const char *text, std::size_t tlen, const char *needle,
+       std::size_t nlen) noexcept {
+  /* resolved once, on first use */
+  static const search_fp impl = select();
+  return impl(text, tlen, needle, nlen);
+}
+
+const char *
+search(const char *text, std::size_t tlen, const char *needle) noexcept {
+  return search(text, tlen, needle, std::strlen(needle));
+}
+
+const char *
+search(const char *text, const char *needle) noexcept {
+  return search(text, std::strlen(text), needle);
+}
+
+//=====================================
+} // namespace simd
+} // namespace sp
@@ -0,0 +1,52 @@
+#ifndef SP_UTIL_STRING_SIMD_SEARCH_H
+#define SP_UTIL_STRING_SIMD_SEARCH_H
+
+#include <cstddef>
+
+/* # SIMD substring search
+ * Compares the first and the last byte of the needle against 16(SSE2) or
+ * 32(AVX2) candidate positions per iteration, only positions where both bytes
+ * match are verified with memcmp. Comparing two bytes far apart makes false
+ * positives rare even for text with a small alphabet.
+ *
+ * search() dispatches at runtime to the widest available implementation, the
+ * scalar fallback is bmh::search.
+ *
+ * ## ref
+ * http://0x80.pl/articles/simd-strfind.html
+ */
+namespace sp {
+namespace simd {
+//=====================================
+const char *
+search(const char *text, std::size_t, const char *needle, std::size_t) noexcept;
+
+const char *
+search(const char *text, std::size_t, const char *needle) noexcept;
+
+const char *
+search(const char *text, const char *needle) noexcept;
+
+//=====================================
+const char *
+search_scalar(const char *text, std::size_t, const char *needle,
+              std::size_t) noexcept;
+
+/* the same as search_scalar() if not supported */
+const char *
+search_sse2(const char *text, std::size_t, const char *needle,
+            std::size_t) noexcept;
+
+const char *
+search_avx2(const char *text, std::size_t, const char *needle,
+            std::size_t) noexcept;
+
+/* returns true if the cpu supports search_avx2() */
+bool
+has_avx2() noexcept;
+
+//=====================================
+} // namespace simd
+} // namespace sp
+
+#endif
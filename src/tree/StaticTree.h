@@ -1,6 +1,8 @@
 #ifndef SP_UTIL_TREE_STATIC2_TREE_H
 #define SP_UTIL_TREE_STATIC2_TREE_H
 
+#include <cstddef>
+#include <cstdint>
 #include <tree/tree.h>
 #include <tuple>
 #include <util/comparator.h>
@@ -47,6 +49,94 @@ template <typename C, typename P>
 void
 dump(const StaticTree<int, C, P> &, const std::string & = "") noexcept;
 
+//=====================================
+/* Builds a complete tree from the strictly ordered range [$begin, $end) in
+ * O(n), the values are placed in the first n slots. The tree must be empty
+ * and every value present according to $Present. Returns false if the tree
+ * is not empty or the range does not fit.
+ */
+template <typename T, typename C, typename P, typename It>
+bool
+bulk_load(StaticTree<T, C, P> &, It begin, It end) noexcept;
+
+//=====================================
+/* # Read-only layouts
+ * StaticTree places the children of $i at 2i+1 and 2i+2 (Eytzinger), the top
+ * levels share cache lines but every level below the cache is a miss. For
+ * large read-only sorted sets there are two other layouts, built once with
+ * bulk_load() and then searched with find():
+ *
+ * - StaticVebTree: van Emde Boas layout, the tree is recursively split at
+ *   half its height into a top tree followed by its bottom trees. A subtree
+ *   which fits in a cache line or a page is contiguous, without knowing the
+ *   size of either.
+ * - StaticBlockTree: k-ary Eytzinger layout, $keys sorted values per node and
+ *   $keys + 1 children at k(keys+1)+1+i. A node sized to a cache line makes a
+ *   search one miss per node, a B-tree without pointers.
+ *
+ * Both are complete trees where the last slots are padded with copies of the
+ * greatest value, veb_capacity() and block_capacity() are the number of slots
+ * needed for n values.
+ */
+template <typename T, typename C = sp::greater>
+struct StaticVebTree {
+  T *buffer;
+  const std::size_t capacity;
+  std::size_t height;
+  /* for every depth: the size of the top tree of the split where the depth is
+   * the root of the bottom trees, the size of the bottom trees, and the depth
+   * of the root of the top tree */
+  std::size_t top[64];
+  std::size_t bottom[64];
+  std::uint8_t top_depth[64];
+
+  StaticVebTree(T *, std::size_t) noexcept;
+
+  template <std::size_t SIZE>
+  explicit StaticVebTree(T (&)[SIZE]) noexcept;
+};
+
+template <typename T, std::size_t keys, typename C = sp::greater>
+struct StaticBlockTree {
+  static_assert(keys >= 1, "");
+
+  T *buffer;
+  const std::size_t capacity;
+  std::size_t blocks;
+
+  StaticBlockTree(T *, std::size_t) noexcept;
+
+  template <std::size_t SIZE>
+  explicit StaticBlockTree(T (&)[SIZE]) noexcept;
+};
+
+//=====================================
+constexpr std::size_t
+veb_capacity(std::size_t) noexcept;
+
+template <std::size_t keys>
+constexpr std::size_t
+block_capacity(std::size_t) noexcept;
+
+//=====================================
+/* Returns false if the tree is not empty or the range does not fit */
+template <typename T, typename C, typename It>
+bool
+bulk_load(StaticVebTree<T, C> &, It begin, It end) noexcept;
+
+template <typename T, std::size_t keys, typename C, typename It>
+bool
+bulk_load(StaticBlockTree<T, keys, C> &, It begin, It end) noexcept;
+
+//=====================================
+template <typename T, typename C, typename K>
+const T *
+find(const StaticVebTree<T, C> &, const K &) noexcept;
+
+template <typename T, std::size_t keys, typename C, typename K>
+const T *
+find(const StaticBlockTree<T, keys, C> &, const K &) noexcept;
+
 //=====================================
 //====Implementation===================
 //=====================================
@@ -162,6 +252,13 @@ find_index(const binary::StaticTree<T, C, P> &tree, const K &search) noexcept {
 
 Lit:
   if (idx < tree.capacity) {
+    /* the 16 descendants four levels down are next to each other, fetching
+     * them now hides the miss when the search gets there */
+    const std::size_t ahead = (16 * idx) + 15;
+    if (ahead < tree.capacity) {
+      __builtin_prefetch(tree.buffer + ahead);
+    }
+
     constexpr P present;
     if (present(tree.buffer[idx])) {
       constexpr C cmp;
@@ -205,6 +302,105 @@ dump(const binary::StaticTree<int, C, P> &tree, std::size_t idx,
   }
 } // impl::StaticTree::dump()
 
+template <typename T, typename C, typename P, typename It>
+static void
+bulk_load(binary::StaticTree<T, C, P> &tree, std::size_t n, std::size_t idx,
+          It &it) noexcept {
+  if (idx < n) {
+    bulk_load(tree, n, left_child(idx), it);
+    make(tree.buffer, idx, *it);
+    ++it;
+    bulk_load(tree, n, right_child(idx), it);
+  }
+}
+
+template <typename It, typename C>
+static std::size_t
+ordered_length(It begin, It end) noexcept {
+  C cmp;
+  std::size_t n = 0;
+  for (It it = begin, prev = begin; it != end; prev = it, ++it, ++n) {
+    assertx(n == 0 || cmp(*it, /*>*/ *prev));
+  }
+  return n;
+}
+
+/* the next value of the range or a copy of the last one once it is empty */
+template <typename T, typename It>
+static void
+pad_next(T *buffer, std::size_t idx, It &it, std::size_t &remaining,
+         std::size_t &last) noexcept {
+  if (remaining > 0) {
+    make(buffer, idx, *it);
+    ++it;
+    --remaining;
+    last = idx;
+  } else {
+    make(buffer, idx, buffer[last]);
+  }
+}
+
+//=====================================
+static inline void
+veb_split(std::size_t *top, std::size_t *bottom, std::uint8_t *top_depth,
+          std::size_t depth, std::size_t height) noexcept {
+  if (height > 1) {
+    const std::size_t top_height = height / 2;
+    const std::size_t bottom_height = height - top_height;
+    const std::size_t split = depth + top_height;
+
+    top[split] = (std::size_t(1) << top_height) - 1;
+    bottom[split] = (std::size_t(1) << bottom_height) - 1;
+    top_depth[split] = std::uint8_t(depth);
+
+    veb_split(top, bottom, top_depth, depth, top_height);
+    veb_split(top, bottom, top_depth, split, bottom_height);
+  }
+}
+
+/* The position of the node with the 1-based BFS index $i at $depth, $pos
+ * holds the position of its ancestors. The low bits of $i select which of the
+ * bottom trees following the top tree the node is the root of.
+ */
+template <typename T, typename C>
+static inline std::size_t
+veb_position(const binary::StaticVebTree<T, C> &tree, const std::size_t *pos,
+             std::size_t i, std::size_t depth) noexcept {
+  return pos[tree.top_depth[depth]] + tree.top[depth] +
+         ((i & tree.top[depth]) * tree.bottom[depth]);
+}
+
+template <typename T, typename C, typename It>
+static void
+bulk_load(binary::StaticVebTree<T, C> &tree, std::size_t *pos, std::size_t i,
+          std::size_t depth, It &it, std::size_t &remaining,
+          std::size_t &last) noexcept {
+  if (depth < tree.height) {
+    if (depth > 0) {
+      pos[depth] = veb_position(tree, pos, i, depth);
+    }
+
+    bulk_load(tree, pos, 2 * i, depth + 1, it, remaining, last);
+    pad_next(tree.buffer, pos[depth], it, remaining, last);
+    bulk_load(tree, pos, (2 * i) + 1, depth + 1, it, remaining, last);
+  }
+}
+
+//=====================================
+template <typename T, std::size_t keys, typename C, typename It>
+static void
+bulk_load(binary::StaticBlockTree<T, keys, C> &tree, std::size_t block,
+          It &it, std::size_t &remaining, std::size_t &last) noexcept {
+  if (block < tree.blocks) {
+    const std::size_t first = (block * (keys + 1)) + 1;
+    for (std::size_t i = 0; i < keys; ++i) {
+      bulk_load(tree, first + i, it, remaining, last);
+      pad_next(tree.buffer, (block * keys) + i, it, remaining, last);
+    }
+    bulk_load(tree, first + keys, it, remaining, last);
+  }
+}
+
 } // namespace StaticTree
 } // namespace impl
 
@@ -369,6 +565,183 @@ dump(const StaticTree<int, C, P> &tree, const std::string &prefix) noexcept {
   dump(tree, 0, prefix);
 }
 
+//=====================================
+template <typename T, typename C, typename P, typename It>
+bool
+bulk_load(StaticTree<T, C, P> &tree, It begin, It end) noexcept {
+  using namespace impl::StaticTree;
+
+  if (is_present(tree, 0)) {
+    return false;
+  }
+
+  const std::size_t n = ordered_length<It, C>(begin, end);
+  if (n > tree.capacity) {
+    return false;
+  }
+
+  impl::StaticTree::bulk_load(tree, n, 0, begin);
+  return true;
+}
+
+//=====================================
+template <typename T, typename C>
+StaticVebTree<T, C>::StaticVebTree(T *b, std::size_t c) noexcept
+    : buffer(b)
+    , capacity(c)
+    , height(0)
+    , top{}
+    , bottom{}
+    , top_depth{} {
+}
+
+template <typename T, typename C>
+template <std::size_t SIZE>
+StaticVebTree<T, C>::StaticVebTree(T (&b)[SIZE]) noexcept
+    : StaticVebTree(b, SIZE) {
+}
+
+template <typename T, std::size_t keys, typename C>
+StaticBlockTree<T, keys, C>::StaticBlockTree(T *b, std::size_t c) noexcept
+    : buffer(b)
+    , capacity(c)
+    , blocks(0) {
+}
+
+template <typename T, std::size_t keys, typename C>
+template <std::size_t SIZE>
+StaticBlockTree<T, keys, C>::StaticBlockTree(T (&b)[SIZE]) noexcept
+    : StaticBlockTree(b, SIZE) {
+}
+
+//=====================================
+constexpr std::size_t
+veb_capacity(std::size_t n) noexcept {
+  /* a perfect tree */
+  std::size_t result = 0;
+  while (result < n) {
+    result = (2 * result) + 1;
+  }
+  return result;
+}
+
+template <std::size_t keys>
+constexpr std::size_t
+block_capacity(std::size_t n) noexcept {
+  return ((n + keys - 1) / keys) * keys;
+}
+
+//=====================================
+template <typename T, typename C, typename It>
+bool
+bulk_load(StaticVebTree<T, C> &tree, It begin, It end) noexcept {
+  using namespace impl::StaticTree;
+
+  if (tree.height > 0) {
+    return false;
+  }
+
+  std::size_t remaining = ordered_length<It, C>(begin, end);
+  if (veb_capacity(remaining) > tree.capacity) {
+    return false;
+  }
+
+  std::size_t height = 0;
+  while (((std::size_t(1) << height) - 1) < remaining) {
+    ++height;
+  }
+  tree.height = height;
+  veb_split(tree.top, tree.bottom, tree.top_depth, 0, height);
+
+  std::size_t pos[64] = {0};
+  std::size_t last = 0;
+  impl::StaticTree::bulk_load(tree, pos, 1, 0, begin, remaining, last);
+  return true;
+}
+
+template <typename T, std::size_t keys, typename C, typename It>
+bool
+bulk_load(StaticBlockTree<T, keys, C> &tree, It begin, It end) noexcept {
+  using namespace impl::StaticTree;
+
+  if (tree.blocks > 0) {
+    return false;
+  }
+
+  std::size_t remaining = ordered_length<It, C>(begin, end);
+  if (block_capacity<keys>(remaining) > tree.capacity) {
+    return false;
+  }
+
+  tree.blocks = block_capacity<keys>(remaining) / keys;
+  std::size_t last = 0;
+  impl::StaticTree::bulk_load(tree, 0, begin, remaining, last);
+  return true;
+}
+
+//=====================================
+template <typename T, typename C, typename K>
+const T *
+find(const StaticVebTree<T, C> &tree, const K &search) noexcept {
+  using namespace impl::StaticTree;
+
+  /* the descent always goes to a leaf keeping the last value not ordered
+   * before $search, which has no hard to predict branches */
+  const T *candidate = nullptr;
+  std::size_t pos[64];
+  pos[0] = 0;
+  std::size_t i = 1;
+  constexpr C cmp;
+  for (std::size_t depth = 0; depth < tree.height;) {
+    const T *const current = tree.buffer + pos[depth];
+    const bool right = cmp(search, *current);
+    candidate = right ? candidate : current;
+    i = (2 * i) + (right ? 1 : 0);
+
+    if (++depth < tree.height) {
+      pos[depth] = veb_position(tree, pos, i, depth);
+    }
+  }
+
+  if (candidate && !cmp(*candidate, search)) {
+    return candidate;
+  }
+
+  return nullptr;
+}
+
+template <typename T, std::size_t keys, typename C, typename K>
+const T *
+find(const StaticBlockTree<T, keys, C> &tree, const K &search) noexcept {
+  const T *candidate = nullptr;
+  std::size_t block = 0;
+  while (block < tree.blocks) {
+    const T *const node = tree.buffer + (block * keys);
+
+    /* the number of values ordered before $search, counted without branches
+     * so the compiler can vectorize it */
+    std::size_t before = 0;
+    constexpr C cmp;
+    for (std::size_t i = 0; i < keys; ++i) {
+      before += cmp(search, node[i]) ? 1 : 0;
+    }
+
+    if (before < keys) {
+      candidate = node + before;
+    }
+    block = (block * (keys + 1)) + before + 1;
+  }
+
+  if (candidate) {
+    constexpr C cmp;
+    if (!cmp(*candidate, search)) {
+      return candidate;
+    }
+  }
+
+  return nullptr;
+}
+
 //=====================================
 } // namespace binary
 
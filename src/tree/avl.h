@@ -25,51 +25,62 @@ struct Node {
   explicit Node(K &&, Node<T> * = nullptr) noexcept;
 
   explicit operator std::string() const;
-
-  ~Node() noexcept;
 };
 
-template <typename T, typename Comparator = sp::greater>
-using Tree = bst::Tree<Node<T>, Comparator>;
+template <typename T, typename Comparator = sp::greater,
+          template <typename> class Allocator = sp::Allocator>
+using Tree = bst::Tree<Node<T>, Comparator, Allocator>;
 
 //=====================================
-template <typename T, typename C, typename K>
+template <typename T, typename C, template <typename> class A, typename K>
 std::tuple<T *, bool>
-insert(Tree<T, C> &, K &&) noexcept;
+insert(Tree<T, C, A> &, K &&) noexcept;
 
 //=====================================
-template <typename T, typename C, typename Key, typename... Arg>
+template <typename T, typename C, template <typename> class A, typename Key,
+          typename... Arg>
 std::tuple<T *, bool>
-emplace(Tree<T, C> &, const Key &, Arg &&...) noexcept;
+emplace(Tree<T, C, A> &, const Key &, Arg &&...) noexcept;
+
+//=====================================
+/* Builds a height balanced tree from the strictly ordered range
+ * [$begin, $end) in O(n), every node is allocated once and no comparisons or
+ * rotations are made. $It has to be a forward iterator, the range is walked
+ * once to be counted and once to be built. Returns false if the tree is not
+ * empty or if a node could not be allocated, then the tree is left empty.
+ */
+template <typename T, typename C, template <typename> class A, typename It>
+bool
+bulk_load(Tree<T, C, A> &, It begin, It end) noexcept;
 
 //=====================================
-template <typename T, typename C, typename K>
+template <typename T, typename C, template <typename> class A, typename K>
 const T *
-find(const Tree<T, C> &, const K &) noexcept;
+find(const Tree<T, C, A> &, const K &) noexcept;
 
-template <typename T, typename C, typename K>
+template <typename T, typename C, template <typename> class A, typename K>
 T *
-find(Tree<T, C> &, const K &) noexcept;
+find(Tree<T, C, A> &, const K &) noexcept;
 
 //=====================================
-template <typename T, typename C, typename K>
+template <typename T, typename C, template <typename> class A, typename K>
 bool
-remove(Tree<T, C> &, const K &) noexcept;
+remove(Tree<T, C, A> &, const K &) noexcept;
 
 //=====================================
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 void
-dump(const Tree<T, C> &tree, std::string prefix = "") noexcept;
+dump(const Tree<T, C, A> &tree, std::string prefix = "") noexcept;
 
 //=====================================
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 bool
-verify(const Tree<T, C> &) noexcept;
+verify(const Tree<T, C, A> &) noexcept;
 
 //=====================================
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 bool
-is_empty(const Tree<T, C> &) noexcept;
+is_empty(const Tree<T, C, A> &) noexcept;
 
 //=====================================
 //====Implementation===================
@@ -144,19 +155,6 @@ Node<T>::operator std::string() const {
   return s;
 }
 
-template <typename T>
-Node<T>::~Node() noexcept {
-  // TODO this is recursive
-  if (left) {
-    delete left;
-    left = nullptr;
-  }
-  if (right) {
-    delete right;
-    right = nullptr;
-  }
-}
-
 //=====================================
 namespace impl {
 template <typename T>
@@ -375,9 +373,9 @@ assert_no_cycle(Node<T> *tree) {
 
 } // namespace impl
 
-template <typename T, typename C, typename V>
+template <typename T, typename C, template <typename> class A, typename V>
 std::tuple<T *, bool>
-insert(Tree<T, C> &self, V &&value) noexcept {
+insert(Tree<T, C, A> &self, V &&value) noexcept {
   auto result = bst::impl::insert(self, std::forward<V>(value));
 
   Node<T> *const node = std::get<0>(result);
@@ -404,9 +402,81 @@ insert(Tree<T, C> &self, V &&value) noexcept {
 }
 
 //=====================================
-template <typename T, typename C, typename Key, typename... Arg>
+namespace impl {
+/* the middle of the next $n values becomes the root, the left half is built
+ * first to consume the range in order. Returns nullptr for $n > 0 if a node
+ * could not be allocated, the partial subtree is then already destroyed. */
+template <typename T, typename C, template <typename> class A, typename It>
+static Node<T> *
+bulk_load(Tree<T, C, A> &self, It &it, std::size_t n) noexcept {
+  if (n == 0) {
+    return nullptr;
+  }
+
+  const std::size_t n_left = (n - 1) / 2;
+  const std::size_t n_right = n - 1 - n_left;
+  Node<T> *const left = bulk_load(self, it, n_left);
+  if (n_left > 0 && !left) {
+    return nullptr;
+  }
+
+  auto result = bst::impl::make_node(self, *it);
+  if (!result) {
+    bst::impl::destroy_all(self, left);
+    return nullptr;
+  }
+  ++it;
+
+  result->left = left;
+  if (left) {
+    left->parent = result;
+  }
+
+  Node<T> *const right = bulk_load(self, it, n_right);
+  if (n_right > 0 && !right) {
+    bst::impl::destroy_all(self, result);
+    return nullptr;
+  }
+
+  result->right = right;
+  if (right) {
+    right->parent = result;
+  }
+
+  /* the sizes of the subtrees differ by at most one */
+  result->height = std::max(height(left), height(right)) + 1;
+
+  return result;
+}
+} // namespace impl
+
+template <typename T, typename C, template <typename> class A, typename It>
+bool
+bulk_load(Tree<T, C, A> &self, It begin, It end) noexcept {
+  if (self.root) {
+    return false;
+  }
+
+  C cmp;
+  std::size_t n = 0;
+  for (It it = begin, prev = begin; it != end; prev = it, ++it, ++n) {
+    assertx(n == 0 || cmp(*it, /*>*/ *prev));
+  }
+
+  Node<T> *const root = impl::bulk_load(self, begin, n);
+  if (n > 0 && !root) {
+    return false;
+  }
+
+  self.root = root;
+  return true;
+}
+
+//=====================================
+template <typename T, typename C, template <typename> class A, typename Key,
+          typename... Arg>
 std::tuple<T *, bool>
-emplace(Tree<T, C> &self, const Key &key, Arg &&... args) noexcept {
+emplace(Tree<T, C, A> &self, const Key &key, Arg &&... args) noexcept {
   auto result = bst::impl::emplace(self, key, std::forward<Arg>(args)...);
 
   Node<T> *const node = std::get<0>(result);
@@ -435,15 +505,15 @@ emplace(Tree<T, C> &self, const Key &key, Arg &&... args) noexcept {
 } // avl::emplace()
 
 //=====================================
-template <typename T, typename C, typename K>
+template <typename T, typename C, template <typename> class A, typename K>
 const T *
-find(const Tree<T, C> &self, const K &needle) noexcept {
+find(const Tree<T, C, A> &self, const K &needle) noexcept {
   return bst::find(self, needle);
 } // avl::find()
 
-template <typename T, typename C, typename K>
+template <typename T, typename C, template <typename> class A, typename K>
 T *
-find(Tree<T, C> &self, const K &needle) noexcept {
+find(Tree<T, C, A> &self, const K &needle) noexcept {
   return bst::find(self, needle);
 } // avl::find()
 
@@ -505,13 +575,13 @@ reb(Node<T> *root) noexcept {
   return atleast;
 }
 
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 static void
-take(Tree<T, C> &, Node<T> *) noexcept;
+take(Tree<T, C, A> &, Node<T> *) noexcept;
 
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 static Node<T> *
-unlink(Tree<T, C> &self, Node<T> *node) noexcept {
+unlink(Tree<T, C, A> &self, Node<T> *node) noexcept {
   auto xxx = [](Node<T> *parent, Node<T> *priv, Node<T> *subject) {
     if (parent) {
       if (parent->left == priv) {
@@ -566,9 +636,9 @@ unlink(Tree<T, C> &self, Node<T> *node) noexcept {
   return nullptr;
 }
 
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 static void
-take(Tree<T, C> &self, Node<T> *node) noexcept {
+take(Tree<T, C, A> &self, Node<T> *node) noexcept {
   Node<T> *const root = unlink(self, node);
   if (root) {
     if (!root->parent) {
@@ -586,16 +656,16 @@ take(Tree<T, C> &self, Node<T> *node) noexcept {
 
 } // namespace impl
 
-template <typename T, typename C, typename K>
+template <typename T, typename C, template <typename> class A, typename K>
 bool
-remove(Tree<T, C> &self, const K &needle) noexcept {
+remove(Tree<T, C, A> &self, const K &needle) noexcept {
   Node<T> *const node = bst::impl::find_node(self, needle);
   if (node) {
     impl::take(self, node);
 
     assertx(!node->left);
     assertx(!node->right);
-    delete node;
+    bst::impl::destroy_node(self, node);
 
     return true;
   }
@@ -604,9 +674,9 @@ remove(Tree<T, C> &self, const K &needle) noexcept {
 } // avl::remove()
 
 //=====================================
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 void
-dump(const Tree<T, C> &tree, std::string prefix) noexcept {
+dump(const Tree<T, C, A> &tree, std::string prefix) noexcept {
   return bst::impl::dump(tree.root, prefix);
 } // avl::dump()
 
@@ -676,17 +746,17 @@ verify(const Node<T> *parent, const Node<T> *tree, ssize_t &result) noexcept {
 } // avl::impl::verify()
 } // namespace impl
 
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 bool
-verify(const Tree<T, C> &self) noexcept {
+verify(const Tree<T, C, A> &self) noexcept {
   ssize_t balance = 0;
   return impl::verify<T>((Node<T> *)nullptr, self.root, balance);
 } // avl::verify()
 
 //=====================================
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 bool
-is_empty(const Tree<T, C> &self) noexcept {
+is_empty(const Tree<T, C, A> &self) noexcept {
   return self.root == nullptr;
 }
 
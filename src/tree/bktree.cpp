@@ -0,0 +1,12 @@
+#include "bktree.h"
+#include <string/levenshtein.h>
+
+namespace bk {
+//=====================================
+std::size_t
+Levenshtein::operator()(const char *a, const char *b) const noexcept {
+  return ascii::myers::levenshtein(a, b);
+}
+
+//=====================================
+} // namespace bk
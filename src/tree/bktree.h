@@ -0,0 +1,290 @@
+#ifndef SP_UTIL_TREE_BKTREE_H
+#define SP_UTIL_TREE_BKTREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+/* # BK-tree(Burkhard-Keller)
+ * Metric tree for finding all entries within distance $k of a needle.
+ *
+ * Every child is stored under its distance d to its parent. For a needle at
+ * distance d to a node, the triangle inequality gives that only the children
+ * with an edge in [d - k, d + k] can contain entries within $k, all other
+ * subtrees are skipped without computing a single distance.
+ *
+ * The children of a node are a singly linked list sorted on the edge
+ * distance, so the scan of a node ends at the first edge > d + k.
+ *
+ * Distance has to be a metric, for example the Levenshtein distance.
+ *
+ * ## ref
+ * https://dl.acm.org/doi/10.1145/362003.362025
+ */
+namespace bk {
+//=====================================
+/* Levenshtein distance between two null terminated strings */
+struct Levenshtein {
+  std::size_t
+  operator()(const char *, const char *) const noexcept;
+};
+
+//=====================================
+template <typename T>
+struct BKNode {
+  T value;
+  /* distance to the parent */
+  std::size_t distance;
+  /* first child, the child with the smallest distance */
+  BKNode<T> *child;
+  /* next child of the parent */
+  BKNode<T> *sibling;
+
+  template <typename V>
+  BKNode(V &&, std::size_t) noexcept;
+};
+
+//=====================================
+template <typename T, typename Distance = Levenshtein>
+struct Tree {
+  using value_type = T;
+  using node_type = BKNode<T>;
+
+  BKNode<T> *root;
+  std::size_t length;
+
+  Tree() noexcept;
+
+  Tree(const Tree &) = delete;
+  Tree(const Tree &&) = delete;
+
+  Tree &
+  operator=(const Tree &) = delete;
+  Tree &
+  operator=(const Tree &&) = delete;
+
+  ~Tree() noexcept;
+};
+
+//=====================================
+/* Returns nullptr if an entry with distance 0 to $value is already present */
+template <typename T, typename D, typename V>
+T *
+insert(Tree<T, D> &, V &&) noexcept;
+
+//=====================================
+/* Calls $f(const T &, std::size_t distance) for every entry within distance
+ * $k of $needle. Returns the number of entries the distance was computed
+ * for, a linear scan would visit all of them.
+ */
+template <typename T, typename D, typename K, typename F>
+std::size_t
+search(const Tree<T, D> &, const K &needle, std::size_t k, F f) noexcept;
+
+//=====================================
+template <typename T, typename D>
+std::size_t
+length(const Tree<T, D> &) noexcept;
+
+//=====================================
+namespace rec {
+/* every entry in a subtree has the distance of the edge to the subtree root,
+ * and the children are sorted and unique */
+template <typename T, typename D>
+bool
+verify(const Tree<T, D> &) noexcept;
+} // namespace rec
+
+//=====================================
+//====Implementation===================
+//=====================================
+template <typename T>
+template <typename V>
+BKNode<T>::BKNode(V &&v, std::size_t d) noexcept
+    : value(std::forward<V>(v))
+    , distance{d}
+    , child{nullptr}
+    , sibling{nullptr} {
+}
+
+//=====================================
+template <typename T, typename D>
+Tree<T, D>::Tree() noexcept
+    : root{nullptr}
+    , length{0} {
+}
+
+template <typename T, typename D>
+Tree<T, D>::~Tree() noexcept {
+  /* iterative, the sibling links are reused as the stack */
+  BKNode<T> *stack = root;
+  while (stack) {
+    BKNode<T> *const current = stack;
+    stack = current->sibling;
+
+    BKNode<T> *it = current->child;
+    while (it) {
+      BKNode<T> *const next = it->sibling;
+      it->sibling = stack;
+      stack = it;
+      it = next;
+    }
+
+    delete current;
+  }
+
+  root = nullptr;
+  length = 0;
+}
+
+//=====================================
+template <typename T, typename D, typename V>
+T *
+insert(Tree<T, D> &self, V &&value) noexcept {
+  D distance;
+  if (!self.root) {
+    self.root = new (std::nothrow) BKNode<T>(std::forward<V>(value), 0);
+    if (!self.root) {
+      return nullptr;
+    }
+    ++self.length;
+    return &self.root->value;
+  }
+
+  BKNode<T> *current = self.root;
+  while (true) {
+    const std::size_t d = distance(value, current->value);
+    if (d == 0) {
+      return nullptr;
+    }
+
+    /* find the edge d in the sorted children */
+    BKNode<T> **it = &current->child;
+    while (*it && (*it)->distance < d) {
+      it = &(*it)->sibling;
+    }
+
+    if (*it && (*it)->distance == d) {
+      current = *it;
+      continue;
+    }
+
+    auto node = new (std::nothrow) BKNode<T>(std::forward<V>(value), d);
+    if (!node) {
+      return nullptr;
+    }
+
+    node->sibling = *it;
+    *it = node;
+    ++self.length;
+    return &node->value;
+  }
+}
+
+//=====================================
+namespace impl {
+template <typename T, typename D, typename K, typename F>
+std::size_t
+bk_search(const BKNode<T> *node, D &distance, const K &needle, std::size_t k,
+          F &f) noexcept {
+  std::size_t result = 1;
+  const std::size_t d = distance(needle, node->value);
+  if (d <= k) {
+    f(node->value, d);
+  }
+
+  const std::size_t low = d > k ? d - k : 0;
+  const std::size_t high = d + k;
+  for (const BKNode<T> *it = node->child; it && it->distance <= high;
+       it = it->sibling) {
+    if (it->distance >= low) {
+      result += bk_search(it, distance, needle, k, f);
+    }
+  }
+
+  return result;
+}
+} // namespace impl
+
+template <typename T, typename D, typename K, typename F>
+std::size_t
+search(const Tree<T, D> &self, const K &needle, std::size_t k, F f) noexcept {
+  if (!self.root) {
+    return 0;
+  }
+
+  D distance;
+  return impl::bk_search(self.root, distance, needle, k, f);
+}
+
+//=====================================
+template <typename T, typename D>
+std::size_t
+length(const Tree<T, D> &self) noexcept {
+  return self.length;
+}
+
+//=====================================
+namespace rec {
+namespace impl {
+template <typename T, typename D>
+bool
+verify_subtree(const BKNode<T> *ancestor, std::size_t d,
+               const BKNode<T> *node, D &distance) noexcept {
+  if (distance(ancestor->value, node->value) != d) {
+    return false;
+  }
+
+  for (const BKNode<T> *it = node->child; it; it = it->sibling) {
+    if (!verify_subtree(ancestor, d, it, distance)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+template <typename T, typename D>
+bool
+verify(const BKNode<T> *node, D &distance, std::size_t &count) noexcept {
+  ++count;
+  std::size_t last = 0;
+  for (const BKNode<T> *it = node->child; it; it = it->sibling) {
+    if (it->distance <= last) {
+      return false;
+    }
+    last = it->distance;
+
+    if (!verify_subtree(node, it->distance, it, distance)) {
+      return false;
+    }
+
+    if (!verify(it, distance, count)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+} // namespace impl
+
+template <typename T, typename D>
+bool
+verify(const Tree<T, D> &self) noexcept {
+  std::size_t count = 0;
+  if (self.root) {
+    D distance;
+    if (!impl::verify(self.root, distance, count)) {
+      return false;
+    }
+  }
+
+  return count == self.length;
+}
+} // namespace rec
+
+//=====================================
+} // namespace bk
+
+#endif
@@ -0,0 +1 @@
+#include "bplus_tree.h"
@@ -0,0 +1,811 @@
+#ifndef SP_UTIL_TREE_BPLUS_TREE_H
+#define SP_UTIL_TREE_BPLUS_TREE_H
+
+#include <collection/Array.h>
+#include <cstddef>
+#include <util/assert.h>
+#include <util/comparator.h>
+#include <utility>
+
+/*
+ * # B+-tree
+ * The B+-tree variant of sp::rec::BTree:
+ * - All values are stored in the leaves
+ * - Internal nodes only contain separators, a copy of a value which is
+ *   greater than everything to the left and less than or equal to everything
+ *   to the right, and child pointers
+ * - The leaves are chained in order
+ *
+ * A range scan only descends the tree once, to find the first leaf, and then
+ * walks the leaf chain sequentially instead of going up and down the internal
+ * levels as an in-order traversal of a B-tree does.
+ *
+ * A separator is not necessarily present in the leaves since removing a value
+ * does not update the separators above it.
+ */
+namespace bplus {
+namespace impl {
+//=====================================
+template <typename T, std::size_t keys>
+struct BPNode {
+  const bool leaf;
+  sp::UinStaticArray<T, keys> elements;
+
+  explicit BPNode(bool) noexcept;
+
+  BPNode(const BPNode &) = delete;
+  BPNode(const BPNode &&) = delete;
+};
+
+template <typename T, std::size_t keys>
+struct BPInternal : BPNode<T, keys> {
+  sp::UinStaticArray<BPNode<T, keys> *, keys + 1> children;
+
+  BPInternal() noexcept;
+};
+
+template <typename T, std::size_t keys>
+struct BPLeaf : BPNode<T, keys> {
+  BPLeaf<T, keys> *next;
+
+  BPLeaf() noexcept;
+};
+} // namespace impl
+
+//=====================================
+template <typename T, std::size_t keys, typename Comparator = sp::greater>
+struct Tree {
+  static_assert(keys >= 3, "");
+  using value_type = T;
+  using node_type = impl::BPNode<T, keys>;
+  using leaf_type = impl::BPLeaf<T, keys>;
+  using internal_type = impl::BPInternal<T, keys>;
+
+  node_type *root;
+  /* the smallest leaf */
+  leaf_type *head;
+  std::size_t length;
+
+  Tree() noexcept;
+
+  Tree(const Tree &) = delete;
+  Tree(const Tree &&) = delete;
+
+  Tree &
+  operator=(const Tree &) = delete;
+  Tree &
+  operator=(const Tree &&) = delete;
+
+  ~Tree() noexcept;
+};
+
+//=====================================
+/* Returns the already present value if an equal value exists */
+template <typename T, std::size_t keys, typename C, typename Key>
+T *
+insert(Tree<T, keys, C> &, Key &&) noexcept;
+
+//=====================================
+template <typename T, std::size_t keys, typename C, typename Key>
+const T *
+find(const Tree<T, keys, C> &, const Key &) noexcept;
+
+template <typename T, std::size_t keys, typename C, typename Key>
+T *
+find(Tree<T, keys, C> &, const Key &) noexcept;
+
+//=====================================
+/* The smallest value greater than or equal to $needle, or nullptr */
+template <typename T, std::size_t keys, typename C, typename Key>
+const T *
+lower_bound(const Tree<T, keys, C> &, const Key &) noexcept;
+
+//=====================================
+/* Calls $f(const T &) in order for every value in [$low, $high), returns the
+ * number of values visited.
+ */
+template <typename T, std::size_t keys, typename C, typename Key, typename F>
+std::size_t
+for_each_in_range(const Tree<T, keys, C> &, const Key &low, const Key &high,
+                  F f) noexcept;
+
+//=====================================
+/* Calls $f(const T &) in order for every value */
+template <typename T, std::size_t keys, typename C, typename F>
+void
+for_each(const Tree<T, keys, C> &, F) noexcept;
+
+//=====================================
+template <typename T, std::size_t keys, typename C, typename Key>
+bool
+remove(Tree<T, keys, C> &, const Key &) noexcept;
+
+//=====================================
+template <typename T, std::size_t keys, typename C>
+bool
+is_empty(const Tree<T, keys, C> &) noexcept;
+
+template <typename T, std::size_t keys, typename C>
+std::size_t
+length(const Tree<T, keys, C> &) noexcept;
+
+//=====================================
+namespace rec {
+/* All leaves at the same depth, nodes are sorted, within the separator
+ * bounds of the parent and at least half full, and the leaf chain contains
+ * every value in order.
+ */
+template <typename T, std::size_t keys, typename C>
+bool
+verify(const Tree<T, keys, C> &) noexcept;
+} // namespace rec
+
+//=====================================
+//====Implementation===================
+//=====================================
+namespace impl {
+template <typename T, std::size_t keys>
+BPNode<T, keys>::BPNode(bool l) noexcept
+    : leaf{l}
+    , elements{} {
+}
+
+template <typename T, std::size_t keys>
+BPInternal<T, keys>::BPInternal() noexcept
+    : BPNode<T, keys>(false)
+    , children{} {
+}
+
+template <typename T, std::size_t keys>
+BPLeaf<T, keys>::BPLeaf() noexcept
+    : BPNode<T, keys>(true)
+    , next{nullptr} {
+}
+
+template <typename T, std::size_t keys>
+static BPInternal<T, keys> *
+as_internal(BPNode<T, keys> *node) noexcept {
+  assertx(!node->leaf);
+  return static_cast<BPInternal<T, keys> *>(node);
+}
+
+template <typename T, std::size_t keys>
+static const BPInternal<T, keys> *
+as_internal(const BPNode<T, keys> *node) noexcept {
+  assertx(!node->leaf);
+  return static_cast<const BPInternal<T, keys> *>(node);
+}
+
+template <typename T, std::size_t keys>
+static BPLeaf<T, keys> *
+as_leaf(BPNode<T, keys> *node) noexcept {
+  assertx(node->leaf);
+  return static_cast<BPLeaf<T, keys> *>(node);
+}
+
+template <typename T, std::size_t keys>
+static const BPLeaf<T, keys> *
+as_leaf(const BPNode<T, keys> *node) noexcept {
+  assertx(node->leaf);
+  return static_cast<const BPLeaf<T, keys> *>(node);
+}
+
+template <typename T, std::size_t keys>
+static void
+release(BPNode<T, keys> *node) noexcept {
+  if (node->leaf) {
+    delete as_leaf(node);
+    return;
+  }
+
+  auto internal = as_internal(node);
+  for (std::size_t i = 0; i < length(internal->children); ++i) {
+    release(internal->children[i]);
+  }
+  delete internal;
+}
+
+template <std::size_t keys>
+static constexpr std::size_t
+bp_minimum() noexcept {
+  return keys / 2;
+}
+
+//=====================================
+/* index of the first element >= $needle */
+template <typename C, typename T, typename K>
+static std::size_t
+bp_lower(const sp::UinArray<T> &elements, const K &needle) noexcept {
+  C cmp;
+  std::size_t low = 0;
+  std::size_t high = length(elements);
+  while (low < high) {
+    const std::size_t mid = low + ((high - low) / 2);
+    if (cmp(needle, /*>*/ elements[mid])) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+
+  return low;
+}
+
+/* index of the first element > $needle, which also is the index of the child
+ * containing $needle */
+template <typename C, typename T, typename K>
+static std::size_t
+bp_upper(const sp::UinArray<T> &elements, const K &needle) noexcept {
+  C cmp;
+  std::size_t low = 0;
+  std::size_t high = length(elements);
+  while (low < high) {
+    const std::size_t mid = low + ((high - low) / 2);
+    if (cmp(elements[mid], /*>*/ needle)) {
+      high = mid;
+    } else {
+      low = mid + 1;
+    }
+  }
+
+  return low;
+}
+
+template <typename C, typename T, typename K>
+static bool
+bp_equal(const T &first, const K &second) noexcept {
+  C cmp;
+  return !cmp(first, second) && !cmp(second, first);
+}
+
+template <typename C, typename T, std::size_t keys, typename K>
+static const BPLeaf<T, keys> *
+bp_find_leaf(const BPNode<T, keys> *node, const K &needle) noexcept {
+  while (!node->leaf) {
+    auto internal = as_internal(node);
+    node = internal->children[bp_upper<C>(internal->elements, needle)];
+  }
+
+  return as_leaf(node);
+}
+} // namespace impl
+
+//=====================================
+template <typename T, std::size_t keys, typename C>
+Tree<T, keys, C>::Tree() noexcept
+    : root{nullptr}
+    , head{nullptr}
+    , length{0} {
+}
+
+template <typename T, std::size_t keys, typename C>
+Tree<T, keys, C>::~Tree() noexcept {
+  if (root) {
+    impl::release(root);
+  }
+  root = nullptr;
+  head = nullptr;
+  length = 0;
+}
+
+//=====================================
+namespace impl {
+/* The result of an insert into a subtree which was split, $separator is to be
+ * inserted into the parent with $right as its greater child */
+template <typename T, std::size_t keys>
+struct BPSplit {
+  BPNode<T, keys> *right;
+  sp::UinStaticArray<T, 1> separator;
+
+  BPSplit() noexcept
+      : right{nullptr}
+      , separator{} {
+  }
+};
+
+template <typename C, typename T, std::size_t keys, typename Key>
+static T *
+bp_insert_leaf(BPLeaf<T, keys> *leaf, Key &&value, BPSplit<T, keys> &split,
+               bool &inserted) noexcept {
+  auto &elements = leaf->elements;
+  const std::size_t idx = bp_lower<C>(elements, value);
+  if (idx < length(elements) && bp_equal<C>(elements[idx], value)) {
+    return &elements[idx];
+  }
+
+  inserted = true;
+  if (!is_full(elements)) {
+    return insert_at(elements, idx, std::forward<Key>(value));
+  }
+
+  /* split, the right leaf gets the upper half */
+  constexpr std::size_t mid = (keys + 1) / 2;
+  auto right = new BPLeaf<T, keys>;
+  assertx(right);
+
+  const std::size_t from = idx < mid ? mid - 1 : mid;
+  for (std::size_t i = from; i < length(elements); ++i) {
+    T *const res = insert(right->elements, std::move(elements[i]));
+    assertx(res);
+  }
+  drop_back(elements, length(elements) - from);
+
+  T *result = nullptr;
+  if (idx < mid) {
+    result = insert_at(elements, idx, std::forward<Key>(value));
+  } else {
+    result = insert_at(right->elements, idx - mid, std::forward<Key>(value));
+  }
+  assertx(result);
+
+  right->next = leaf->next;
+  leaf->next = right;
+
+  split.right = right;
+  T *const sep = insert(split.separator, right->elements[0]);
+  assertx(sep);
+
+  return result;
+}
+
+template <typename C, typename T, std::size_t keys>
+static void
+bp_insert_internal(BPInternal<T, keys> *node, std::size_t idx,
+                   BPSplit<T, keys> &split) noexcept {
+  auto &elements = node->elements;
+  auto &children = node->children;
+  BPNode<T, keys> *const greater = split.right;
+
+  if (!is_full(elements)) {
+    T *const res = insert_at(elements, idx, std::move(split.separator[0]));
+    assertx(res);
+    auto child = insert_at(children, idx + 1, greater);
+    assertx(child);
+
+    clear(split.separator);
+    split.right = nullptr;
+    return;
+  }
+
+  /* keys + 1 separators, the middle one moves up */
+  sp::UinStaticArray<T, keys + 1> all_elements;
+  sp::UinStaticArray<BPNode<T, keys> *, keys + 2> all_children;
+  for (std::size_t i = 0; i < length(elements); ++i) {
+    insert(all_elements, std::move(elements[i]));
+  }
+  for (std::size_t i = 0; i < length(children); ++i) {
+    insert(all_children, children[i]);
+  }
+  insert_at(all_elements, idx, std::move(split.separator[0]));
+  insert_at(all_children, idx + 1, greater);
+  clear(elements);
+  clear(children);
+  clear(split.separator);
+
+  constexpr std::size_t mid = (keys + 1) / 2;
+  auto right = new BPInternal<T, keys>;
+  assertx(right);
+
+  for (std::size_t i = 0; i < mid; ++i) {
+    insert(elements, std::move(all_elements[i]));
+    insert(children, all_children[i]);
+  }
+  insert(children, all_children[mid]);
+
+  insert(split.separator, std::move(all_elements[mid]));
+
+  for (std::size_t i = mid + 1; i < length(all_elements); ++i) {
+    insert(right->elements, std::move(all_elements[i]));
+    insert(right->children, all_children[i]);
+  }
+  insert(right->children, all_children[length(all_elements)]);
+
+  split.right = right;
+}
+
+template <typename C, typename T, std::size_t keys, typename Key>
+static T *
+bp_insert(BPNode<T, keys> *node, Key &&value, BPSplit<T, keys> &split,
+          bool &inserted) noexcept {
+  if (node->leaf) {
+    return bp_insert_leaf<C>(as_leaf(node), std::forward<Key>(value), split,
+                             inserted);
+  }
+
+  auto internal = as_internal(node);
+  const std::size_t idx = bp_upper<C>(internal->elements, value);
+  T *const result = bp_insert<C>(internal->children[idx],
+                                 std::forward<Key>(value), split, inserted);
+  if (split.right) {
+    bp_insert_internal<C>(internal, idx, split);
+  }
+
+  return result;
+}
+} // namespace impl
+
+template <typename T, std::size_t keys, typename C, typename Key>
+T *
+insert(Tree<T, keys, C> &self, Key &&value) noexcept {
+  if (!self.root) {
+    auto leaf = new impl::BPLeaf<T, keys>;
+    assertx(leaf);
+    self.root = leaf;
+    self.head = leaf;
+  }
+
+  impl::BPSplit<T, keys> split;
+  bool inserted = false;
+  T *const result =
+      impl::bp_insert<C>(self.root, std::forward<Key>(value), split, inserted);
+
+  if (split.right) {
+    /* the tree grows in height */
+    auto root = new impl::BPInternal<T, keys>;
+    assertx(root);
+    insert(root->elements, std::move(split.separator[0]));
+    insert(root->children, self.root);
+    insert(root->children, split.right);
+    self.root = root;
+  }
+
+  if (inserted) {
+    ++self.length;
+  }
+
+  return result;
+}
+
+//=====================================
+template <typename T, std::size_t keys, typename C, typename Key>
+const T *
+find(const Tree<T, keys, C> &self, const Key &needle) noexcept {
+  if (!self.root) {
+    return nullptr;
+  }
+
+  auto leaf = impl::bp_find_leaf<C>(self.root, needle);
+  const std::size_t idx = impl::bp_lower<C>(leaf->elements, needle);
+  if (idx < length(leaf->elements) &&
+      impl::bp_equal<C>(leaf->elements[idx], needle)) {
+    return &leaf->elements[idx];
+  }
+
+  return nullptr;
+}
+
+template <typename T, std::size_t keys, typename C, typename Key>
+T *
+find(Tree<T, keys, C> &self, const Key &needle) noexcept {
+  const auto &c_self = self;
+  return (T *)find(c_self, needle);
+}
+
+//=====================================
+template <typename T, std::size_t keys, typename C, typename Key>
+const T *
+lower_bound(const Tree<T, keys, C> &self, const Key &needle) noexcept {
+  if (!self.root) {
+    return nullptr;
+  }
+
+  auto leaf = impl::bp_find_leaf<C>(self.root, needle);
+  std::size_t idx = impl::bp_lower<C>(leaf->elements, needle);
+  while (leaf && idx == length(leaf->elements)) {
+    /* everything in this leaf is less, the first of the next leaf is the
+     * answer */
+    leaf = leaf->next;
+    idx = 0;
+  }
+
+  return leaf ? &leaf->elements[idx] : nullptr;
+}
+
+//=====================================
+template <typename T, std::size_t keys, typename C, typename Key, typename F>
+std::size_t
+for_each_in_range(const Tree<T, keys, C> &self, const Key &low,
+                  const Key &high, F f) noexcept {
+  std::size_t result = 0;
+  if (!self.root) {
+    return result;
+  }
+
+  C cmp;
+  const impl::BPLeaf<T, keys> *leaf = impl::bp_find_leaf<C>(self.root, low);
+  std::size_t idx = impl::bp_lower<C>(leaf->elements, low);
+  for (; leaf; leaf = leaf->next, idx = 0) {
+    const auto &elements = leaf->elements;
+    for (; idx < length(elements); ++idx) {
+      if (!cmp(high, /*>*/ elements[idx])) {
+        return result;
+      }
+
+      f(elements[idx]);
+      ++result;
+    }
+  }
+
+  return result;
+}
+
+//=====================================
+template <typename T, std::size_t keys, typename C, typename F>
+void
+for_each(const Tree<T, keys, C> &self, F f) noexcept {
+  for (const impl::BPLeaf<T, keys> *it = self.head; it; it = it->next) {
+    for (std::size_t i = 0; i < length(it->elements); ++i) {
+      f(it->elements[i]);
+    }
+  }
+}
+
+//=====================================
+namespace impl {
+/* $child at $idx of $parent has fewer than the minimum elements */
+template <typename T, std::size_t keys>
+static void
+bp_fix_leaf(BPInternal<T, keys> *parent, std::size_t idx) noexcept {
+  auto &separators = parent->elements;
+  auto &children = parent->children;
+  BPLeaf<T, keys> *const child = as_leaf(children[idx]);
+  BPLeaf<T, keys> *const left =
+      idx > 0 ? as_leaf(children[idx - 1]) : nullptr;
+  BPLeaf<T, keys> *const right =
+      idx + 1 < length(children) ? as_leaf(children[idx + 1]) : nullptr;
+
+  if (left && length(left->elements) > bp_minimum<keys>()) {
+    /* borrow the greatest of the left sibling */
+    T *const last_left = last(left->elements);
+    insert_at(child->elements, 0, std::move(*last_left));
+    drop_back(left->elements, 1);
+    separators[idx - 1] = child->elements[0];
+    return;
+  }
+
+  if (right && length(right->elements) > bp_minimum<keys>()) {
+    /* borrow the smallest of the right sibling */
+    insert(child->elements, std::move(right->elements[0]));
+    stable_remove(right->elements, 0);
+    separators[idx] = right->elements[0];
+    return;
+  }
+
+  /* merge into the left one of the pair and unlink the right one */
+  BPLeaf<T, keys> *const into = left ? left : child;
+  BPLeaf<T, keys> *const from = left ? child : right;
+  const std::size_t sep = left ? idx - 1 : idx;
+  assertx(from);
+
+  for (std::size_t i = 0; i < length(from->elements); ++i) {
+    T *const res = insert(into->elements, std::move(from->elements[i]));
+    assertx(res);
+  }
+  into->next = from->next;
+
+  stable_remove(separators, sep);
+  stable_remove(children, sep + 1);
+  delete from;
+}
+
+template <typename T, std::size_t keys>
+static void
+bp_fix_internal(BPInternal<T, keys> *parent, std::size_t idx) noexcept {
+  auto &separators = parent->elements;
+  auto &children = parent->children;
+  BPInternal<T, keys> *const child = as_internal(children[idx]);
+  BPInternal<T, keys> *const left =
+      idx > 0 ? as_internal(children[idx - 1]) : nullptr;
+  BPInternal<T, keys> *const right =
+      idx + 1 < length(children) ? as_internal(children[idx + 1]) : nullptr;
+
+  if (left && length(left->elements) > bp_minimum<keys>()) {
+    /* rotate right through the separator */
+    insert_at(child->elements, 0, std::move(separators[idx - 1]));
+    insert_at(child->children, 0, *last(left->children));
+    separators[idx - 1] = std::move(*last(left->elements));
+    drop_back(left->elements, 1);
+    drop_back(left->children, 1);
+    return;
+  }
+
+  if (right && length(right->elements) > bp_minimum<keys>()) {
+    /* rotate left through the separator */
+    insert(child->elements, std::move(separators[idx]));
+    insert(child->children, right->children[0]);
+    separators[idx] = std::move(right->elements[0]);
+    stable_remove(right->elements, 0);
+    stable_remove(right->children, 0);
+    return;
+  }
+
+  /* merge, the separator moves down between the two */
+  BPInternal<T, keys> *const into = left ? left : child;
+  BPInternal<T, keys> *const from = left ? child : right;
+  const std::size_t sep = left ? idx - 1 : idx;
+  assertx(from);
+
+  insert(into->elements, std::move(separators[sep]));
+  for (std::size_t i = 0; i < length(from->elements); ++i) {
+    T *const res = insert(into->elements, std::move(from->elements[i]));
+    assertx(res);
+  }
+  for (std::size_t i = 0; i < length(from->children); ++i) {
+    auto res = insert(into->children, from->children[i]);
+    assertx(res);
+  }
+  clear(from->children);
+
+  stable_remove(separators, sep);
+  stable_remove(children, sep + 1);
+  delete from;
+}
+
+/* returns true if $node has fewer than the minimum elements */
+template <typename C, typename T, std::size_t keys, typename Key>
+static bool
+bp_remove(BPNode<T, keys> *node, const Key &needle, bool &removed) noexcept {
+  if (node->leaf) {
+    auto &elements = node->elements;
+    const std::size_t idx = bp_lower<C>(elements, needle);
+    if (idx < length(elements) && bp_equal<C>(elements[idx], needle)) {
+      stable_remove(elements, idx);
+      removed = true;
+    }
+
+    return length(elements) < bp_minimum<keys>();
+  }
+
+  auto internal = as_internal(node);
+  const std::size_t idx = bp_upper<C>(internal->elements, needle);
+  BPNode<T, keys> *const child = internal->children[idx];
+  if (bp_remove<C>(child, needle, removed)) {
+    if (child->leaf) {
+      bp_fix_leaf(internal, idx);
+    } else {
+      bp_fix_internal(internal, idx);
+    }
+  }
+
+  return length(internal->elements) < bp_minimum<keys>();
+}
+} // namespace impl
+
+template <typename T, std::size_t keys, typename C, typename Key>
+bool
+remove(Tree<T, keys, C> &self, const Key &needle) noexcept {
+  if (!self.root) {
+    return false;
+  }
+
+  bool removed = false;
+  impl::bp_remove<C>(self.root, needle, removed);
+
+  /* the root is allowed to be less than half full */
+  impl::BPNode<T, keys> *const root = self.root;
+  if (root->leaf) {
+    if (is_empty(root->elements)) {
+      delete impl::as_leaf(root);
+      self.root = nullptr;
+      self.head = nullptr;
+    }
+  } else if (is_empty(root->elements)) {
+    /* the tree shrinks in height */
+    auto internal = impl::as_internal(root);
+    self.root = internal->children[0];
+    clear(internal->children);
+    delete internal;
+  }
+
+  if (removed) {
+    --self.length;
+  }
+
+  return removed;
+}
+
+//=====================================
+template <typename T, std::size_t keys, typename C>
+bool
+is_empty(const Tree<T, keys, C> &self) noexcept {
+  return self.root == nullptr;
+}
+
+template <typename T, std::size_t keys, typename C>
+std::size_t
+length(const Tree<T, keys, C> &self) noexcept {
+  return self.length;
+}
+
+//=====================================
+namespace rec {
+namespace impl {
+/* [$low, $high) bounds, nullptr is unbounded */
+template <typename C, typename T, std::size_t keys>
+static bool
+verify(const bplus::impl::BPNode<T, keys> *node, bool root, const T *low,
+       const T *high, std::size_t depth, std::size_t &leaf_depth,
+       const bplus::impl::BPLeaf<T, keys> *&expected_leaf) noexcept {
+  C cmp;
+  const auto &elements = node->elements;
+  if (!root && length(elements) < bplus::impl::bp_minimum<keys>()) {
+    return false;
+  }
+
+  for (std::size_t i = 0; i < length(elements); ++i) {
+    if (i > 0 && !cmp(elements[i], /*>*/ elements[i - 1])) {
+      return false;
+    }
+    if (low && cmp(*low, /*>*/ elements[i])) {
+      return false;
+    }
+    if (high && !cmp(*high, /*>*/ elements[i])) {
+      return false;
+    }
+  }
+
+  if (node->leaf) {
+    if (leaf_depth == 0) {
+      leaf_depth = depth;
+    }
+    if (leaf_depth != depth) {
+      return false;
+    }
+
+    /* leaves are reached left to right, as the chain */
+    auto leaf = bplus::impl::as_leaf(node);
+    if (leaf != expected_leaf) {
+      return false;
+    }
+    expected_leaf = leaf->next;
+    return true;
+  }
+
+  auto internal = bplus::impl::as_internal(node);
+  if (length(internal->children) != length(elements) + 1) {
+    return false;
+  }
+
+  for (std::size_t i = 0; i < length(internal->children); ++i) {
+    const T *const l = i > 0 ? &elements[i - 1] : low;
+    const T *const h = i < length(elements) ? &elements[i] : high;
+    if (!verify<C>(internal->children[i], false, l, h, depth + 1, leaf_depth,
+                   expected_leaf)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+} // namespace impl
+
+template <typename T, std::size_t keys, typename C>
+bool
+verify(const Tree<T, keys, C> &self) noexcept {
+  if (!self.root) {
+    return self.head == nullptr && self.length == 0;
+  }
+
+  std::size_t leaf_depth = 0;
+  const bplus::impl::BPLeaf<T, keys> *expected_leaf = self.head;
+  if (!impl::verify<C>(self.root, true, (const T *)nullptr,
+                       (const T *)nullptr, 1, leaf_depth, expected_leaf)) {
+    return false;
+  }
+  if (expected_leaf != nullptr) {
+    return false;
+  }
+
+  std::size_t count = 0;
+  for_each(self, [&count](const T &) {
+    /**/
+    ++count;
+  });
+  return count == self.length;
+}
+} // namespace rec
+
+//=====================================
+} // namespace bplus
+
+#endif
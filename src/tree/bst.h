@@ -19,43 +19,42 @@ struct Node {
   explicit Node(K &&, Node<T> * = nullptr) noexcept;
 
   explicit operator std::string() const;
-
-  ~Node() noexcept;
 };
 
-template <typename T, typename Comparator = sp::greater>
-using Tree = bst::Tree<Node<T>, Comparator>;
+template <typename T, typename Comparator = sp::greater,
+          template <typename> class Allocator = sp::Allocator>
+using Tree = bst::Tree<Node<T>, Comparator, Allocator>;
 
 //=====================================
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 bool
-is_empty(const Tree<T, C> &) noexcept;
+is_empty(const Tree<T, C, A> &) noexcept;
 
 //=====================================
-template <typename T, typename C, typename K>
+template <typename T, typename C, template <typename> class A, typename K>
 std::tuple<T *, bool>
-insert(Tree<T, C> &, K &&) noexcept;
+insert(Tree<T, C, A> &, K &&) noexcept;
 
 //=====================================
-template <typename T, typename C, typename... Arg>
+template <typename T, typename C, template <typename> class A, typename... Arg>
 std::tuple<T *, bool>
-emplace(Tree<T, C> &, Arg &&...) noexcept;
+emplace(Tree<T, C, A> &, Arg &&...) noexcept;
 
 //=====================================
-template <typename T, typename C, typename K>
+template <typename T, typename C, template <typename> class A, typename K>
 bool
-remove(Tree<T, C> &, const K &) noexcept;
+remove(Tree<T, C, A> &, const K &) noexcept;
 
 //=====================================
 //=====================================
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 void
-dump(Tree<T, C> &tree, std::string prefix = "") noexcept;
+dump(Tree<T, C, A> &tree, std::string prefix = "") noexcept;
 
 //=====================================
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 bool
-verify(const Tree<T, C> &tree) noexcept;
+verify(const Tree<T, C, A> &tree) noexcept;
 
 //=====================================
 //====Implementation===================
@@ -87,20 +86,6 @@ Node<T>::operator std::string() const {
   return s;
 }
 
-template <typename T>
-Node<T>::~Node() noexcept {
-  // TODO this is recursive
-  if (left) {
-    delete left;
-  }
-  left = nullptr;
-
-  if (right) {
-    delete right;
-  }
-  right = nullptr;
-}
-
 //=====================================
 namespace impl {
 namespace binary {
@@ -143,16 +128,16 @@ verify(const Node<T> *parent, const Node<T> *tree) noexcept {
 } // namespace binary
 } // namespace impl
 //=====================================
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 bool
-is_empty(const Tree<T, C> &self) noexcept {
+is_empty(const Tree<T, C, A> &self) noexcept {
   return self.root == nullptr;
 }
 
 //=====================================
-template <typename T, typename C, typename K>
+template <typename T, typename C, template <typename> class A, typename K>
 std::tuple<T *, bool>
-insert(Tree<T, C> &tree, K &&value) noexcept {
+insert(Tree<T, C, A> &tree, K &&value) noexcept {
   auto result = bst::impl::insert(tree, std::forward<K>(value));
   Node<T> *node = std::get<0>(result);
   bool status = std::get<1>(result);
@@ -164,17 +149,17 @@ insert(Tree<T, C> &tree, K &&value) noexcept {
 }
 
 //=====================================
-template <typename T, typename C, typename... Arg>
+template <typename T, typename C, template <typename> class A, typename... Arg>
 std::tuple<T *, bool>
-emplace(Tree<T, C> &self, Arg &&... args) noexcept {
+emplace(Tree<T, C, A> &self, Arg &&... args) noexcept {
   // TODO make actual impl
   return insert(self, T(std::forward<Arg>(args)...));
 }
 
 //=====================================
-template <typename T, typename C, typename K>
+template <typename T, typename C, template <typename> class A, typename K>
 bool
-remove(Tree<T, C> &tree, const K &k) noexcept {
+remove(Tree<T, C, A> &tree, const K &k) noexcept {
   auto set_root = [&tree](Node<T> *root) {
     if (root) {
       if (root->parent == nullptr) {
@@ -191,7 +176,7 @@ remove(Tree<T, C> &tree, const K &k) noexcept {
     Node<T> *const root = bst::impl::remove(node);
     set_root(root);
 
-    delete (node);
+    bst::impl::destroy_node(tree, node);
     return true;
   }
 
@@ -199,16 +184,16 @@ remove(Tree<T, C> &tree, const K &k) noexcept {
 } // binary::remove()
 
 //=====================================
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 void
-dump(Tree<T, C> &tree, std::string prefix) noexcept {
+dump(Tree<T, C, A> &tree, std::string prefix) noexcept {
   return bst::impl::dump(tree.root, prefix);
 } // binary::dump()
 
 //=====================================
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 bool
-verify(const Tree<T, C> &tree) noexcept {
+verify(const Tree<T, C, A> &tree) noexcept {
   return impl::binary::verify((Node<T> *)nullptr, tree.root);
 } // binary::verify()
 
@@ -49,9 +49,9 @@ equal(const Node<T> *a, const Node<T> *b) noexcept {
 
 } // namespace impl
 
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 bool
-equal(const Tree<T, C> &a, const Tree<T, C> &b) noexcept {
+equal(const Tree<T, C, A> &a, const Tree<T, C, A> &b) noexcept {
   return impl::equal<T, C>(a.root, b.root);
 }
 
@@ -68,32 +68,30 @@ height(const Node<T> *node) noexcept {
 } // binary::impl::binary::height()
 } // namespace impl
 
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 std::size_t
-height(const Tree<T, C> &tree) noexcept {
+height(const Tree<T, C, A> &tree) noexcept {
   return impl::height(tree.root);
 }
 
 //=====================================
 namespace impl {
-template <typename T>
+template <typename T, typename C, template <typename> class A>
 Node<T> *
-delete_self(Node<T> *tree) noexcept {
+delete_self(Tree<T, C, A> &self, Node<T> *tree) noexcept {
   if (tree) {
-    tree->left = delete_self(tree->left);
-    tree->right = delete_self(tree->right);
-    // we need to null left&right since otherwise the dtor of node will try to
-    // delete the already reclaimed memory
-    delete tree;
+    delete_self(self, tree->left);
+    delete_self(self, tree->right);
+    bst::impl::destroy_node(self, tree);
   }
   return nullptr;
 }
 } // namespace impl
 
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 void
-delete_self(Tree<T, C> &tree) noexcept {
-  tree.root = impl::delete_self(tree.root);
+delete_self(Tree<T, C, A> &tree) noexcept {
+  tree.root = impl::delete_self(tree, tree.root);
 }
 
 //=====================================
@@ -119,21 +117,21 @@ inorder(T *tree, F f) noexcept {
 }
 } // namespace impl
 
-template <typename T, typename C, typename F>
+template <typename T, typename C, template <typename> class A, typename F>
 void
-inorder(const Tree<T, C> &tree, F f) noexcept {
+inorder(const Tree<T, C, A> &tree, F f) noexcept {
   return impl::inorder(tree.root, f);
 }
 
-template <typename T, typename C, typename F>
+template <typename T, typename C, template <typename> class A, typename F>
 void
-inorder(const avl::Tree<T, C> &tree, F f) noexcept {
+inorder(const avl::Tree<T, C, A> &tree, F f) noexcept {
   return impl::inorder(tree.root, f);
 }
 
-template <typename T, typename C, typename F>
+template <typename T, typename C, template <typename> class A, typename F>
 void
-inorder(avl::Tree<T, C> &tree, F f) noexcept {
+inorder(avl::Tree<T, C, A> &tree, F f) noexcept {
   return impl::inorder(tree.root, f);
 }
 
@@ -150,9 +148,9 @@ preorder(const Node<T> *tree, F f) noexcept {
 }
 } // namespace impl
 
-template <typename T, typename C, typename F>
+template <typename T, typename C, template <typename> class A, typename F>
 void
-preorder(const Tree<T, C> &tree, F f) noexcept {
+preorder(const Tree<T, C, A> &tree, F f) noexcept {
   return impl::preorder(tree.root, f);
 }
 
@@ -169,9 +167,9 @@ postorder(const Node<T> *tree, F f) noexcept {
 }
 } // namespace impl
 
-template <typename T, typename C, typename F>
+template <typename T, typename C, template <typename> class A, typename F>
 void
-postorder(const Tree<T, C> &tree, F f) noexcept {
+postorder(const Tree<T, C, A> &tree, F f) noexcept {
   return impl::postorder(tree.root, f);
 }
 
@@ -194,9 +192,9 @@ levelorder(const Node<T> *tree, F f, std::size_t cnt) noexcept {
 }
 } // namespace impl
 
-template <typename T, typename C, typename F>
+template <typename T, typename C, template <typename> class A, typename F>
 void
-levelorder(const Tree<T, C> &tree, F f) noexcept {
+levelorder(const Tree<T, C, A> &tree, F f) noexcept {
   // start at the top level and work down
   std::size_t level = 0;
   while (impl::levelorder(tree.root, f, level++))
@@ -217,9 +215,9 @@ reverse_levelorder(const Node<T> *tree, F f,
 }
 } // namespace impl
 
-template <typename T, typename C, typename F>
+template <typename T, typename C, template <typename> class A, typename F>
 void
-reverse_levelorder(const Tree<T, C> &tree, F f) noexcept {
+reverse_levelorder(const Tree<T, C, A> &tree, F f) noexcept {
   sp::DynamicStack<const Node<T> *> stack;
   // start at the bottom level and work up
   impl::reverse_levelorder(tree.root, f, stack);
@@ -230,56 +228,56 @@ reverse_levelorder(const Tree<T, C> &tree, F f) noexcept {
 }
 
 //=====================================
-template <typename T, typename C, typename F>
+template <typename T, typename C, template <typename> class A, typename F>
 void
-spiralorder(const Tree<T, C> &, F) noexcept {
+spiralorder(const Tree<T, C, A> &, F) noexcept {
   // http://www.techiedelight.com/spiral-order-traversal-binary-tree/
   // TODO
 }
 
 //=====================================
-template <typename T, typename C, typename F>
+template <typename T, typename C, template <typename> class A, typename F>
 void
-inverseorder(const Tree<T, C> &, F) noexcept;
+inverseorder(const Tree<T, C, A> &, F) noexcept;
 
 //=====================================
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 bool
-is_perfect_binary_tree(const Tree<T, C> &) noexcept {
+is_perfect_binary_tree(const Tree<T, C, A> &) noexcept {
   return false;
 }
 
 //=====================================
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 bool
-is_complete_binary_tree(const Tree<T, C> &) noexcept {
+is_complete_binary_tree(const Tree<T, C, A> &) noexcept {
   // http://www.techiedelight.com/check-given-binary-tree-complete-binary-tree-not/
   // every node is filled except possible last which is empty/full/left
   return false;
 }
 
 //=====================================
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 bool
-is_sum_tree(const Tree<T, C> &) noexcept {
+is_sum_tree(const Tree<T, C, A> &) noexcept {
   // check if the value of a node is the sum of all values for each child nodes
   // http://www.techiedelight.com/check-given-binary-tree-sum-tree-not/
   return false;
 }
 
 //=====================================
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 bool
-is_symmetric(const Tree<T, C> &) noexcept {
+is_symmetric(const Tree<T, C, A> &) noexcept {
   // http://www.techiedelight.com/check-given-binary-tree-symmetric-structure-not/
   // check the shape of the left subtree is the inverse on the right subtree
   return false;
 }
 
 //=====================================
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 bool
-is_height_balanced(const Tree<T, C> &) noexcept {
+is_height_balanced(const Tree<T, C, A> &) noexcept {
   // http://www.techiedelight.com/check-given-binary-tree-is-height-balanced-not/
   // is the difference in height either 0/1 between the left and right child
   return false;
@@ -314,9 +312,9 @@ is_binary_tree_bst(const Node<T> *tree) noexcept {
 }
 } // namespace impl
 
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 bool
-is_binary_tree_bst(const Tree<T, C> &tree) noexcept {
+is_binary_tree_bst(const Tree<T, C, A> &tree) noexcept {
   // right > parent
   // left < parent
   return impl::is_binary_tree_bst<T, C>(tree.root);
@@ -339,9 +337,9 @@ max_width(const Node<T> *tree, std::size_t n = 0) noexcept {
 }
 } // namespace impl
 
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 std::size_t
-max_width(const Tree<T, C> &tree) noexcept {
+max_width(const Tree<T, C, A> &tree) noexcept {
   // http://www.techiedelight.com/find-maximum-width-given-binary-tree/
   return impl::max_width(tree.root);
 }
@@ -350,50 +348,50 @@ max_width(const Tree<T, C> &tree) noexcept {
 
 //=====================================
 namespace rec {} // namespace rec
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 void
-print_cousin_nodes(const Tree<T, C> &) noexcept {
+print_cousin_nodes(const Tree<T, C, A> &) noexcept {
   // http: // www.techiedelight.com/print-cousins-of-given-node-binary-tree/
 }
 
 //=====================================
 namespace rec {} // namespace rec
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 void
-mirror(const Tree<T, C> &) noexcept {
+mirror(const Tree<T, C, A> &) noexcept {
   // http://www.techiedelight.com/convert-binary-tree-to-its-mirror/
 }
 
 //=====================================
 namespace rec {} // namespace rec
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 void
-lowest_common_ancestor(const Tree<T, C> &) noexcept {
+lowest_common_ancestor(const Tree<T, C, A> &) noexcept {
   // http://www.techiedelight.com/find-lowest-common-ancestor-lca-two-nodes-binary-tree/
 }
 
 //=====================================
 namespace rec {} // namespace rec
-template <typename T, typename C, typename F>
+template <typename T, typename C, template <typename> class A, typename F>
 void
-level_first_left(const Tree<T, C> &, F) noexcept {
+level_first_left(const Tree<T, C, A> &, F) noexcept {
   // http://www.techiedelight.com/print-left-view-of-binary-tree/
 }
 
 //=====================================
 namespace impl {} // namespace impl
 // Unbalanced Tree -> Balanced Tree
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 void
-balance(Tree<T, C> &) noexcept {
+balance(Tree<T, C, A> &) noexcept {
   // https://dzone.com/articles/algorithm-week-balancing
 }
 
 //=====================================
 namespace rec {} // namespace rec
 // Unbalanced Tree -> Balanced Tree
-template <typename T, typename C>
-Tree<T, C>
+template <typename T, typename C, template <typename> class A>
+Tree<T, C, A>
 construct_perfect(T *in, std::size_t) noexcept {
   // ctor perfect from sorted input
   return {};
@@ -413,9 +411,9 @@ reverse(Node<T> *tree) noexcept {
 }
 
 } // namespace impl
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 void
-reverse(Tree<T, C> &tree) noexcept {
+reverse(Tree<T, C, A> &tree) noexcept {
   reverse(tree.root); // TODO test
 }
 
@@ -428,9 +426,9 @@ namespace impl {
 //===Itterative===============================================
 //============================================================
 namespace it {
-template <typename T, typename C, typename F>
+template <typename T, typename C, template <typename> class A, typename F>
 void
-levelorder(const Tree<T, C> &tree, F f) noexcept {
+levelorder(const Tree<T, C, A> &tree, F f) noexcept {
   if (!tree.root) {
     return;
   }
@@ -462,9 +460,9 @@ levelorder(const Tree<T, C> &tree, F f) noexcept {
   }
 }
 
-template <typename T, typename C, typename F>
+template <typename T, typename C, template <typename> class A, typename F>
 void
-reverse_levelorder(const Tree<T, C> &tree, F f) noexcept {
+reverse_levelorder(const Tree<T, C, A> &tree, F f) noexcept {
   if (!tree.root) {
     return;
   }
@@ -0,0 +1 @@
+#include "btree_node_search.h"
@@ -0,0 +1,279 @@
+#ifndef SP_UTIL_TREE_BTREE_NODE_SEARCH_H
+#define SP_UTIL_TREE_BTREE_NODE_SEARCH_H
+
+#include <collection/Array.h>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <util/comparator.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/*
+ * # Intra-node search
+ * Returns the first element of a B-tree node which is greater than or equal
+ * to $needle, the same as bin_find_gte().
+ *
+ * For integer keys ordered by sp::greater or sp::less the node is instead
+ * searched by counting the number of elements ordered before $needle, which
+ * is the index of the result. The count is done 4(SSE2) or 8(AVX2) keys at a
+ * time without any data dependent branches, so unlike the binary search there
+ * is nothing for the branch predictor to miss. The count is linear in the
+ * node length so it only beats the binary search for smaller nodes, measured
+ * with 32 bit keys the SSE2 count breaks even at 32 keys and is slower at 64
+ * keys while the AVX2 count is still faster at 64 keys. Nodes longer than
+ * node_linear_max keys are therefore searched using bin_find_gte().
+ *
+ * The selection is done at compile time on T, Key and Comparator, everything
+ * else uses the generic comparator based bin_find_gte(). The instruction set
+ * is also selected at compile time, -mavx2 to get the 256 bit version.
+ */
+namespace sp {
+namespace rec {
+//=====================================
+/* Number of keys of type T which fit in $lines cache lines, to size nodes */
+template <typename T>
+constexpr std::size_t
+cache_line_keys(std::size_t lines) noexcept {
+  return (lines * 64) / sizeof(T);
+}
+
+//=====================================
+template <typename T, typename K, typename Comparator>
+const T *
+node_find_gte(const UinArray<T> &, const K &needle, Comparator &) noexcept;
+
+template <typename T, typename K, typename Comparator>
+T *
+node_find_gte(UinArray<T> &, const K &needle, Comparator &) noexcept;
+
+//=====================================
+//====Implementation===================
+//=====================================
+namespace impl {
+/* Longest node for which the linear count is used */
+#if defined(__AVX2__)
+static constexpr std::size_t node_linear_max = 64;
+#elif defined(__SSE2__)
+static constexpr std::size_t node_linear_max = 32;
+#else
+static constexpr std::size_t node_linear_max = 16;
+#endif
+
+template <typename Comparator>
+struct NodeOrder {
+  static constexpr bool simd = false;
+  static constexpr bool ascending = false;
+};
+
+template <>
+struct NodeOrder<sp::greater> {
+  static constexpr bool simd = true;
+  static constexpr bool ascending = true;
+};
+
+template <>
+struct NodeOrder<sp::less> {
+  static constexpr bool simd = true;
+  static constexpr bool ascending = false;
+};
+
+/* $needle can be converted to T without changing its value */
+template <typename T, typename K, typename Comparator>
+struct NodeSearchSimd {
+  using Key = typename std::decay<K>::type;
+
+  static constexpr bool value =
+      NodeOrder<Comparator>::simd && std::is_integral<T>::value &&
+      !std::is_same<T, bool>::value &&
+      (sizeof(T) == 4 || sizeof(T) == 8) && std::is_integral<Key>::value &&
+      std::is_signed<T>::value == std::is_signed<Key>::value &&
+      sizeof(Key) <= sizeof(T);
+};
+
+//=====================================
+template <bool ascending, typename T>
+static inline std::size_t
+node_count_scalar(const T *it, std::size_t i, std::size_t len,
+                  T needle) noexcept {
+  std::size_t result = 0;
+  for (; i < len; ++i) {
+    result += ascending ? std::size_t(it[i] < needle)
+                        : std::size_t(it[i] > needle);
+  }
+  return result;
+}
+
+/* The signed compare is used for unsigned keys by flipping the sign bit of
+ * both sides, which maps the unsigned order onto the signed order */
+template <typename T>
+using NodeSigned = typename std::conditional<sizeof(T) == 4, std::int32_t,
+                                             std::int64_t>::type;
+
+template <typename T>
+static inline NodeSigned<T>
+node_signed(T value, std::true_type) noexcept {
+  return value;
+}
+
+template <typename T>
+static inline NodeSigned<T>
+node_signed(T value, std::false_type) noexcept {
+  using S = NodeSigned<T>;
+  return S(value ^ T(std::numeric_limits<S>::min()));
+}
+
+template <typename T>
+static inline NodeSigned<T>
+node_bias() noexcept {
+  using S = NodeSigned<T>;
+  return std::is_signed<T>::value ? 0 : std::numeric_limits<S>::min();
+}
+
+/* count the vector width aligned prefix of $it, $i is where it stopped */
+template <bool ascending>
+static inline std::size_t
+node_count_vector(const void *it, std::size_t len, std::int32_t needle,
+                  std::int32_t bias, std::size_t &i) noexcept {
+  std::size_t result = 0;
+#if defined(__AVX2__)
+  const __m256i b = _mm256_set1_epi32(bias);
+  const __m256i n = _mm256_set1_epi32(needle);
+  for (; i + 8 <= len; i += 8) {
+    const __m256i e = _mm256_xor_si256(
+        _mm256_loadu_si256((const __m256i *)it + (i / 8)), b);
+    const __m256i gt =
+        ascending ? _mm256_cmpgt_epi32(n, e) : _mm256_cmpgt_epi32(e, n);
+    /* every lane sets 4 bits of the byte mask */
+    result += std::size_t(
+        __builtin_popcount(std::uint32_t(_mm256_movemask_epi8(gt))) / 4);
+  }
+#elif defined(__SSE2__)
+  const __m128i b = _mm_set1_epi32(bias);
+  const __m128i n = _mm_set1_epi32(needle);
+  for (; i + 4 <= len; i += 4) {
+    const __m128i e =
+        _mm_xor_si128(_mm_loadu_si128((const __m128i *)it + (i / 4)), b);
+    const __m128i gt = ascending ? _mm_cmpgt_epi32(n, e) : _mm_cmpgt_epi32(e, n);
+    result += std::size_t(
+        __builtin_popcount(std::uint32_t(_mm_movemask_epi8(gt))) / 4);
+  }
+#else
+  (void)it;
+  (void)len;
+  (void)needle;
+  (void)bias;
+  (void)i;
+#endif
+  return result;
+}
+
+template <bool ascending>
+static inline std::size_t
+node_count_vector(const void *it, std::size_t len, std::int64_t needle,
+                  std::int64_t bias, std::size_t &i) noexcept {
+  std::size_t result = 0;
+#if defined(__AVX2__)
+  const __m256i b = _mm256_set1_epi64x(bias);
+  const __m256i n = _mm256_set1_epi64x(needle);
+  for (; i + 4 <= len; i += 4) {
+    const __m256i e = _mm256_xor_si256(
+        _mm256_loadu_si256((const __m256i *)it + (i / 4)), b);
+    const __m256i gt =
+        ascending ? _mm256_cmpgt_epi64(n, e) : _mm256_cmpgt_epi64(e, n);
+    result += std::size_t(
+        __builtin_popcount(std::uint32_t(_mm256_movemask_epi8(gt))) / 8);
+  }
+#elif defined(__SSE4_2__)
+  const __m128i b = _mm_set1_epi64x(bias);
+  const __m128i n = _mm_set1_epi64x(needle);
+  for (; i + 2 <= len; i += 2) {
+    const __m128i e =
+        _mm_xor_si128(_mm_loadu_si128((const __m128i *)it + (i / 2)), b);
+    const __m128i gt = ascending ? _mm_cmpgt_epi64(n, e) : _mm_cmpgt_epi64(e, n);
+    result += std::size_t(
+        __builtin_popcount(std::uint32_t(_mm_movemask_epi8(gt))) / 8);
+  }
+#else
+  /* SSE2 has no 64 bit compare, the scalar count is used */
+  (void)it;
+  (void)len;
+  (void)needle;
+  (void)bias;
+  (void)i;
+#endif
+  return result;
+}
+
+/* Number of elements ordered before $needle, which is the index of the first
+ * element greater than or equal to $needle */
+template <bool ascending, typename T>
+static inline std::size_t
+node_count_before(const T *it, std::size_t len, T needle) noexcept {
+  std::size_t i = 0;
+  const std::size_t result = node_count_vector<ascending>(
+      it, len,
+      node_signed(needle, typename std::is_signed<T>::type{}), node_bias<T>(),
+      i);
+
+  /* the tail is never read past length, the rest of the node is not
+   * initialized */
+  return result + node_count_scalar<ascending>(it, i, len, needle);
+}
+
+template <typename T, typename K, typename Comparator>
+static inline const T *
+node_search(const UinArray<T> &self, const K &needle, Comparator &cmp,
+            std::true_type) noexcept {
+  const std::size_t len = length(self);
+  if (len > node_linear_max) {
+    return bin_find_gte(self, needle, cmp);
+  }
+
+  const T *const it = self.data();
+  const T n = needle;
+  const std::size_t idx =
+      node_count_before<NodeOrder<Comparator>::ascending>(it, len, n);
+
+  return idx < len ? it + idx : nullptr;
+}
+
+template <typename T, typename K, typename Comparator>
+static inline const T *
+node_search(const UinArray<T> &self, const K &needle, Comparator &cmp,
+            std::false_type) noexcept {
+  return bin_find_gte(self, needle, cmp);
+}
+} // namespace impl
+
+//=====================================
+template <typename T, typename K, typename Comparator>
+const T *
+node_find_gte(const UinArray<T> &self, const K &needle,
+              Comparator &cmp) noexcept {
+  using simd = std::integral_constant<
+      bool, impl::NodeSearchSimd<T, K, Comparator>::value>;
+  return impl::node_search(self, needle, cmp, simd{});
+}
+
+template <typename T, typename K, typename Comparator>
+T *
+node_find_gte(UinArray<T> &self, const K &needle, Comparator &cmp) noexcept {
+  const auto &c_self = self;
+  return (T *)node_find_gte(c_self, needle, cmp);
+}
+
+//=====================================
+} // namespace rec
+} // namespace sp
+
+#endif
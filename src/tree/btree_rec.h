@@ -1,10 +1,15 @@
 #ifndef SP_UTIL_TREE_BTREE_REC_H
 #define SP_UTIL_TREE_BTREE_REC_H
 
+#include <algorithm>
 #include <collection/Array.h>
 #include <cstddef>
+#include <memory/Allocator.h>
+#include <new>
 #include <sort/util.h>
+#include <tree/btree_node_search.h>
 #include <tuple>
+#include <type_traits>
 #include <util/comparator.h>
 
 // #define BTREE_REC_DEBUG
@@ -35,7 +40,6 @@ struct BTNode {
   sp::UinStaticArray<BTNode<T, keys, Comparator> *, order> children;
 
   BTNode() noexcept;
-  ~BTNode() noexcept;
 
   BTNode(const BTNode<T, keys, Comparator> &) = delete;
   BTNode(const BTNode<T, keys, Comparator> &&) = delete;
@@ -47,48 +51,94 @@ struct BTNode {
 };
 
 //=====================================
-template <typename T, std::size_t keys, typename Comparator = sp::greater>
+/* The nodes are allocated with $Allocator, sp::StackPooledAllocator or
+ * sp::SlabAllocator to keep the nodes of the tree in a pool.
+ */
+template <typename T, std::size_t keys, typename Comparator = sp::greater,
+          template <typename> class Allocator = sp::Allocator>
 struct BTree {
   static_assert(keys >= 2, "");
   using value_type = T;
 
   BTNode<T, keys, Comparator> *root;
+  Allocator<BTNode<T, keys, Comparator>> allocator;
 
   BTree() noexcept;
   ~BTree() noexcept;
 
-  BTree(const BTree<T, keys, Comparator> &) = delete;
-  BTree(const BTree<T, keys, Comparator> &&) = delete;
+  BTree(const BTree<T, keys, Comparator, Allocator> &) = delete;
+  BTree(const BTree<T, keys, Comparator, Allocator> &&) = delete;
 
   BTree &
-  operator=(const BTree<T, keys, Comparator> &) = delete;
+  operator=(const BTree<T, keys, Comparator, Allocator> &) = delete;
   BTree &
-  operator=(const BTree<T, keys, Comparator> &&) = delete;
+  operator=(const BTree<T, keys, Comparator, Allocator> &&) = delete;
 };
 
 //=====================================
-template <typename T, std::size_t keys, typename Comparator, typename Key>
+template <typename T, std::size_t keys, typename Comparator,
+          template <typename> class A, typename Key>
 T *
-insert(BTree<T, keys, Comparator> &, Key &&) noexcept;
+insert(BTree<T, keys, Comparator, A> &, Key &&) noexcept;
 
 //=====================================
-template <typename T, std::size_t keys, typename Comparator, typename Key>
+template <typename T, std::size_t keys, typename Comparator,
+          template <typename> class A, typename Key>
 const T *
-find(const BTree<T, keys, Comparator> &, const Key &) noexcept;
+find(const BTree<T, keys, Comparator, A> &, const Key &) noexcept;
 
-template <typename T, std::size_t keys, typename Comparator, typename Key>
+template <typename T, std::size_t keys, typename Comparator,
+          template <typename> class A, typename Key>
 T *
-find(BTree<T, keys, Comparator> &, const Key &) noexcept;
+find(BTree<T, keys, Comparator, A> &, const Key &) noexcept;
 
 //=====================================
-template <typename T, std::size_t keys, typename Comparator, typename Key>
+template <typename T, std::size_t keys, typename Comparator,
+          template <typename> class A, typename Key>
 bool
-remove(BTree<T, keys, Comparator> &, const Key &) noexcept;
+remove(BTree<T, keys, Comparator, A> &, const Key &) noexcept;
 
 //=====================================
-template <typename T, std::size_t keys, typename Comparator>
+template <typename T, std::size_t keys, typename Comparator,
+          template <typename> class A>
+bool
+is_empty(const BTree<T, keys, Comparator, A> &) noexcept;
+
+//=====================================
+/* Builds the tree bottom up from the strictly ordered range [$begin, $end) in
+ * O(n), every node is allocated once and no comparisons or splits are made.
+ * Nodes are filled to $fill of keys where possible, 1.0 is a perfectly packed
+ * tree and a lower fill leaves room for later inserts without splitting. The
+ * fill is clamped so that every node has at least keys/2 elements. $It has to
+ * be a forward iterator, the range is walked once to be counted and once to be
+ * built. Returns false if the tree is not empty or if a node could not be
+ * allocated, then the tree is left empty.
+ */
+template <typename T, std::size_t keys, typename Comparator,
+          template <typename> class A, typename It>
+bool
+bulk_load(BTree<T, keys, Comparator, A> &, It begin, It end,
+          double fill = 1.0) noexcept;
+
+//=====================================
+/* All leaves at the same depth, nodes sorted and within the bounds of the
+ * parent separators, and all nodes except the root non-empty and at least
+ * (keys-1)/2 full, which is what a split leaves behind.
+ */
+template <typename T, std::size_t keys, typename Comparator,
+          template <typename> class A>
 bool
-is_empty(const BTree<T, keys, Comparator> &) noexcept;
+verify(const BTree<T, keys, Comparator, A> &) noexcept;
+
+//=====================================
+/* In-order traversal calling $f(const T &) for every value in [$low, $high),
+ * returns the number of values visited.
+ */
+template <typename T, std::size_t keys, typename Comparator,
+          template <typename> class A, typename Key, typename F>
+std::size_t
+for_each_in_range(const BTree<T, keys, Comparator, A> &, const Key &low,
+                  const Key &high, F f) noexcept;
 
 //=====================================
 //====Implementation===================
@@ -99,26 +149,60 @@ BTNode<T, keys, Comparator>::BTNode() noexcept
     , children{} {
 }
 
-template <typename T, std::size_t keys, typename Comparator>
-BTNode<T, keys, Comparator>::~BTNode() noexcept {
-  for (std::size_t i = 0; i < length(children); ++i) {
-    if (children[i]) {
-      delete children[i];
+namespace impl {
+template <typename T, std::size_t keys, typename Cmp,
+          template <typename> class A>
+static BTNode<T, keys, Cmp> *
+make_node(A<BTNode<T, keys, Cmp>> &allocator) noexcept {
+  BTNode<T, keys, Cmp> *const result = allocate(allocator);
+  if (result) {
+    ::new (result) BTNode<T, keys, Cmp>;
+  }
+
+  return result;
+}
+
+template <typename T, std::size_t keys, typename Cmp,
+          template <typename> class A>
+static void
+destroy_node(A<BTNode<T, keys, Cmp>> &allocator,
+             BTNode<T, keys, Cmp> *node) noexcept {
+  assertx(node);
+  node->~BTNode();
+  deallocate(allocator, node);
+}
+
+template <typename T, std::size_t keys, typename Cmp,
+          template <typename> class A>
+static void
+destroy_all(A<BTNode<T, keys, Cmp>> &allocator,
+            BTNode<T, keys, Cmp> *node) noexcept {
+  if (node) {
+    for (std::size_t i = 0; i < length(node->children); ++i) {
+      destroy_all(allocator, node->children[i]);
     }
+    destroy_node(allocator, node);
   }
 }
+} // namespace impl
 
-template <typename T, std::size_t keys, typename Comparator>
-BTree<T, keys, Comparator>::BTree() noexcept
-    : root{nullptr} {
+template <typename T, std::size_t keys, typename Comparator,
+          template <typename> class A>
+BTree<T, keys, Comparator, A>::BTree() noexcept
+    : root{nullptr}
+    , allocator() {
 }
 
-template <typename T, std::size_t keys, typename Comparator>
-BTree<T, keys, Comparator>::~BTree() noexcept {
-  if (root) {
-    delete root;
-    root = nullptr;
+template <typename T, std::size_t keys, typename Comparator,
+          template <typename> class A>
+BTree<T, keys, Comparator, A>::~BTree() noexcept {
+  /* the allocator returns the memory of all nodes when it is destroyed, only
+   * the values would need their destructor to be called */
+  if (!sp::AllocatorReleasesAll<A>::value ||
+      !std::is_trivially_destructible<T>::value) {
+    impl::destroy_all(allocator, root);
   }
+  root = nullptr;
 }
 
 //=====================================
@@ -369,14 +453,17 @@ empty() noexcept {
 }
 
 //=====================================
-template <typename T, std::size_t keys, typename Cmp>
+template <typename T, std::size_t keys, typename Cmp,
+          template <typename> class A>
 static std::tuple<T *, BTNode<T, keys, Cmp> *>
-fixup(BTNode<T, keys, Cmp> *const tree, T *bubble,
+fixup(A<BTNode<T, keys, Cmp>> &, BTNode<T, keys, Cmp> *const tree, T *bubble,
       BTNode<T, keys, Cmp> *const greater, T *&out) noexcept;
 
-template <typename T, std::size_t keys, typename Cmp, typename Key>
+template <typename T, std::size_t keys, typename Cmp,
+          template <typename> class A, typename Key>
 static std::tuple<T *, BTNode<T, keys, Cmp> *>
-insert(BTNode<T, keys, Cmp> *const tree, Key &&needle, T *&out) noexcept {
+insert(A<BTNode<T, keys, Cmp>> &allocator, BTNode<T, keys, Cmp> *const tree,
+       Key &&needle, T *&out) noexcept {
   if (tree == nullptr) {
     auto bubble = new T(std::forward<Key>(needle));
     BTNode<T, keys, Cmp> *greater = nullptr;
@@ -390,7 +477,7 @@ insert(BTNode<T, keys, Cmp> *const tree, Key &&needle, T *&out) noexcept {
   /* 1. Traverse down */
   auto result = empty<T, keys, Cmp>();
   Cmp cmp;
-  T *const gte = bin_find_gte(elements, needle, cmp);
+  T *const gte = node_find_gte(elements, needle, cmp);
   if (gte) {
     if (!cmp(needle, *gte) && !cmp(*gte, needle)) {
       /* equal */
@@ -403,31 +490,32 @@ insert(BTNode<T, keys, Cmp> *const tree, Key &&needle, T *&out) noexcept {
     assertxs(index != capacity(elements), index, capacity(elements));
 
     const auto child = children[index];
-    result = insert(child, std::forward<Key>(needle), out);
+    result = insert(allocator, child, std::forward<Key>(needle), out);
   } else {
     assertx(!is_empty(*tree));
 
     /* go down the greater */
     auto child = last(children);
     assertxs(child, length(children));
-    result = insert(*child, std::forward<Key>(needle), out);
+    result = insert(allocator, *child, std::forward<Key>(needle), out);
   }
 
   /* 2. Fixup */
   T *const bubble = std::get<0>(result);
   if (bubble) {
     BTNode<T, keys, Cmp> *gt = std::get<1>(result);
-    return fixup(tree, bubble, gt, out);
+    return fixup(allocator, tree, bubble, gt, out);
   }
 
   return empty<T, keys, Cmp>();
 }
 
 //=====================================
-template <typename T, std::size_t keys, typename Cmp>
+template <typename T, std::size_t keys, typename Cmp,
+          template <typename> class A>
 static std::tuple<T *, BTNode<T, keys, Cmp> *>
-fixup(BTNode<T, keys, Cmp> *const tree, T *bubble,
-      BTNode<T, keys, Cmp> *const bub_gt, T *&out) noexcept {
+fixup(A<BTNode<T, keys, Cmp>> &allocator, BTNode<T, keys, Cmp> *const tree,
+      T *bubble, BTNode<T, keys, Cmp> *const bub_gt, T *&out) noexcept {
   assertx(tree);
   assertx(bubble);
 
@@ -448,7 +536,7 @@ fixup(BTNode<T, keys, Cmp> *const tree, T *bubble,
   const T *const med = median<T, keys, Cmp>(elements, bubble);
   assertx(med);
 
-  auto right = new BTNode<T, keys, Cmp>;
+  auto right = make_node(allocator);
   assertx(right); // XXX
 
   partition(*tree, med, *right);
@@ -480,18 +568,20 @@ fixup(BTNode<T, keys, Cmp> *const tree, T *bubble,
 
 //=====================================
 // TODO what is the log(order,elements) forumla to get the height?
-template <typename T, std::size_t keys, typename Cmp, typename Key>
+template <typename T, std::size_t keys, typename Cmp,
+          template <typename> class A, typename Key>
 T *
-insert(BTree<T, keys, Cmp> &self, Key &&value) noexcept {
+insert(BTree<T, keys, Cmp, A> &self, Key &&value) noexcept {
   T *out = nullptr;
-  auto result = impl::insert(self.root, std::forward<Key>(value), out);
+  auto result =
+      impl::insert(self.allocator, self.root, std::forward<Key>(value), out);
 
   T *const bubble = std::get<0>(result);
   if (bubble) {
     BTNode<T, keys, Cmp> *const left = self.root;
     BTNode<T, keys, Cmp> *const right = std::get<1>(result);
 
-    self.root = new BTNode<T, keys, Cmp>;
+    self.root = impl::make_node(self.allocator);
     assertx(self.root); // XXX
     {
       auto res = insert(self.root->children, left);
@@ -523,7 +613,7 @@ find(const BTNode<T, keys, Cmp> *const tree, const Key &needle) noexcept {
   const auto &elements = tree->elements;
 
   Cmp cmp;
-  const T *const gte = bin_find_gte(elements, needle, cmp);
+  const T *const gte = node_find_gte(elements, needle, cmp);
   if (gte) {
     if (!cmp(needle, *gte) && !cmp(*gte, needle)) {
       /* equal */
@@ -545,15 +635,17 @@ find(const BTNode<T, keys, Cmp> *const tree, const Key &needle) noexcept {
 }
 } // namespace impl
 
-template <typename T, std::size_t keys, typename Comparator, typename Key>
+template <typename T, std::size_t keys, typename Comparator,
+          template <typename> class A, typename Key>
 const T *
-find(const BTree<T, keys, Comparator> &self, const Key &needle) noexcept {
+find(const BTree<T, keys, Comparator, A> &self, const Key &needle) noexcept {
   return impl::find<T, keys, Comparator, Key>(self.root, needle);
 }
 
-template <typename T, std::size_t keys, typename Comparator, typename Key>
+template <typename T, std::size_t keys, typename Comparator,
+          template <typename> class A, typename Key>
 T *
-find(BTree<T, keys, Comparator> &self, const Key &needle) noexcept {
+find(BTree<T, keys, Comparator, A> &self, const Key &needle) noexcept {
   const auto &c_self = self;
   return (T *)find(c_self, needle);
 }
@@ -602,9 +694,11 @@ du(T &elements) noexcept {
 }
 // #endif
 
-template <typename T, std::size_t keys, typename Cmp>
+template <typename T, std::size_t keys, typename Cmp,
+          template <typename> class A>
 static bool
-merge(BTNode<T, keys, Cmp> &dest, BTNode<T, keys, Cmp> *src) noexcept {
+merge(A<BTNode<T, keys, Cmp>> &allocator, BTNode<T, keys, Cmp> &dest,
+      BTNode<T, keys, Cmp> *src) noexcept {
   assertx(src);
   // assertx(is_leaf(*src));
   // assertx(is_leaf(dest));
@@ -638,7 +732,7 @@ merge(BTNode<T, keys, Cmp> &dest, BTNode<T, keys, Cmp> *src) noexcept {
     { /**/
       clear(src->elements);
       clear(src->children);
-      delete src;
+      destroy_node(allocator, src);
     }
   }
 
@@ -647,9 +741,11 @@ merge(BTNode<T, keys, Cmp> &dest, BTNode<T, keys, Cmp> *src) noexcept {
 
 enum class ChildDir : bool { LEFT, RIGHT };
 
-template <typename T, std::size_t keys, typename Cmp>
+template <typename T, std::size_t keys, typename Cmp,
+          template <typename> class A>
 static bool
-rebalance(BTNode<T, keys, Cmp> &parent, T *pivot, ChildDir dir) noexcept {
+rebalance(A<BTNode<T, keys, Cmp>> &allocator, BTNode<T, keys, Cmp> &parent,
+          T *pivot, ChildDir dir) noexcept {
   assertx(!is_leaf(parent));
   assertx(pivot);
 
@@ -866,7 +962,7 @@ rebalance(BTNode<T, keys, Cmp> &parent, T *pivot, ChildDir dir) noexcept {
         /*delete left child node if empy*/
         assertx(is_leaf(*left_child));
         { /**/
-          delete left_child;
+          destroy_node(allocator, left_child);
         }
         children[left_idx] = nullptr;
       }
@@ -875,7 +971,7 @@ rebalance(BTNode<T, keys, Cmp> &parent, T *pivot, ChildDir dir) noexcept {
       if (right_child && is_empty(right_child->elements)) {
         assertx(is_leaf(*right_child));
         { /**/
-          delete right_child;
+          destroy_node(allocator, right_child);
         }
         children[right_idx] = nullptr;
       }
@@ -904,7 +1000,8 @@ rebalance(BTNode<T, keys, Cmp> &parent, T *pivot, ChildDir dir) noexcept {
   }
   // 2. merge right into left and gc right
   {
-    bool res = merge(/*DEST*/ *left_child, /*SRC->gc*/ right_child);
+    bool res =
+        merge(allocator, /*DEST*/ *left_child, /*SRC->gc*/ right_child);
     assertx(res);
   }
   // 3. remove old pivot
@@ -924,9 +1021,11 @@ rebalance(BTNode<T, keys, Cmp> &parent, T *pivot, ChildDir dir) noexcept {
   return true;
 }
 
-template <typename T, std::size_t keys, typename Cmp, typename Dest>
+template <typename T, std::size_t keys, typename Cmp,
+          template <typename> class A, typename Dest>
 static bool
-take_wrapper(BTNode<T, keys, Cmp> &, T *, Dest &dest) noexcept;
+take_wrapper(A<BTNode<T, keys, Cmp>> &, BTNode<T, keys, Cmp> &, T *,
+             Dest &dest) noexcept;
 
 template <typename T, std::size_t keys, typename Cmp, typename Dest>
 static bool
@@ -950,9 +1049,11 @@ take_leaf(BTNode<T, keys, Cmp> &self, T *subject, Dest &dest) noexcept {
   return is_deficient(self);
 }
 
-template <typename T, std::size_t keys, typename Cmp, typename Dest>
+template <typename T, std::size_t keys, typename Cmp,
+          template <typename> class A, typename Dest>
 static bool
-take_max(BTNode<T, keys, Cmp> &self, Dest &dest) {
+take_max(A<BTNode<T, keys, Cmp>> &allocator, BTNode<T, keys, Cmp> &self,
+         Dest &dest) {
   if (is_leaf(self)) {
     T *const subject = last(self.elements);
     assertx(subject);
@@ -962,11 +1063,11 @@ take_max(BTNode<T, keys, Cmp> &self, Dest &dest) {
   const std::size_t max_idx = length(self.elements);
   BTNode<T, keys, Cmp> *const greatest = self.children[max_idx];
   if (greatest) {
-    const bool balance = take_max(*greatest, dest);
+    const bool balance = take_max(allocator, *greatest, dest);
     if (balance) {
       T *const pivot = &self.elements[max_idx - 1];
       /* $greatest is RIGHT of $pivot */
-      return rebalance(self, pivot, ChildDir::RIGHT);
+      return rebalance(allocator, self, pivot, ChildDir::RIGHT);
     }
 
     return false;
@@ -976,9 +1077,11 @@ take_max(BTNode<T, keys, Cmp> &self, Dest &dest) {
   return false;
 }
 
-template <typename T, std::size_t keys, typename Cmp, typename Dest>
+template <typename T, std::size_t keys, typename Cmp,
+          template <typename> class A, typename Dest>
 static bool
-take_min(BTNode<T, keys, Cmp> &self, Dest &dest) {
+take_min(A<BTNode<T, keys, Cmp>> &allocator, BTNode<T, keys, Cmp> &self,
+         Dest &dest) {
   const std::size_t smallest_idx = 0;
 
   if (is_leaf(self)) {
@@ -988,11 +1091,11 @@ take_min(BTNode<T, keys, Cmp> &self, Dest &dest) {
 
   BTNode<T, keys, Cmp> *const smallest = self.children[smallest_idx];
   if (smallest) {
-    const bool balance = take_min(*smallest, dest);
+    const bool balance = take_min(allocator, *smallest, dest);
     if (balance) {
       T *const pivot = &self.elements[smallest_idx];
       /* $smallest is LEFT of $pivot */
-      return rebalance(self, pivot, ChildDir::LEFT);
+      return rebalance(allocator, self, pivot, ChildDir::LEFT);
     }
 
     return false;
@@ -1002,9 +1105,11 @@ take_min(BTNode<T, keys, Cmp> &self, Dest &dest) {
   return false;
 }
 
-template <typename T, std::size_t keys, typename Cmp, typename Dest>
+template <typename T, std::size_t keys, typename Cmp,
+          template <typename> class A, typename Dest>
 static bool
-take_internal_node(BTNode<T, keys, Cmp> &self, T *subject,
+take_internal_node(A<BTNode<T, keys, Cmp>> &allocator,
+                   BTNode<T, keys, Cmp> &self, T *subject,
                    Dest &dest) noexcept {
   assertx(subject);
   auto &elements = self.elements;
@@ -1021,9 +1126,9 @@ take_internal_node(BTNode<T, keys, Cmp> &self, T *subject,
     assertxs(!is_empty(lt->children), *subject);
     assertxs(!is_empty(*lt), *subject);
 
-    const bool balance = take_max(*lt, *subject);
+    const bool balance = take_max(allocator, *lt, *subject);
     if (balance) {
-      return rebalance(self, subject, ChildDir::LEFT);
+      return rebalance(allocator, self, subject, ChildDir::LEFT);
     }
 
     return false;
@@ -1033,9 +1138,9 @@ take_internal_node(BTNode<T, keys, Cmp> &self, T *subject,
   if (gt) {
     assertxs(!is_empty(*gt), *subject);
 
-    const bool balance = take_min(*gt, *subject);
+    const bool balance = take_min(allocator, *gt, *subject);
     if (balance) {
-      return rebalance(self, subject, ChildDir::RIGHT);
+      return rebalance(allocator, self, subject, ChildDir::RIGHT);
     }
 
     return false;
@@ -1046,20 +1151,23 @@ take_internal_node(BTNode<T, keys, Cmp> &self, T *subject,
   return false;
 }
 
-template <typename T, std::size_t keys, typename Cmp, typename Dest>
+template <typename T, std::size_t keys, typename Cmp,
+          template <typename> class A, typename Dest>
 static bool
-take_wrapper(BTNode<T, keys, Cmp> &self, T *subject, Dest &dest) noexcept {
+take_wrapper(A<BTNode<T, keys, Cmp>> &allocator, BTNode<T, keys, Cmp> &self,
+             T *subject, Dest &dest) noexcept {
   if (is_leaf(self)) {
     return take_leaf(self, subject, dest);
   }
 
-  return take_internal_node(self, subject, dest);
+  return take_internal_node(allocator, self, subject, dest);
 }
 
-template <typename T, std::size_t keys, typename C, typename Key, typename Dest>
+template <typename T, std::size_t keys, typename C,
+          template <typename> class A, typename Key, typename Dest>
 static bool
-take(BTNode<T, keys, C> *const tree, const Key &needle, Dest &dest,
-     bool &balance) noexcept {
+take(A<BTNode<T, keys, C>> &allocator, BTNode<T, keys, C> *const tree,
+     const Key &needle, Dest &dest, bool &balance) noexcept {
   if (tree == nullptr) {
     balance = false;
     return false;
@@ -1069,12 +1177,12 @@ take(BTNode<T, keys, C> *const tree, const Key &needle, Dest &dest,
   auto &elements = tree->elements;
 
   C cmp;
-  T *const gte = bin_find_gte(elements, needle, cmp);
+  T *const gte = node_find_gte(elements, needle, cmp);
   if (gte) {
     if (!cmp(needle, *gte) && !cmp(*gte, needle)) {
       /* equal */
 
-      balance = take_wrapper(*tree, gte, dest);
+      balance = take_wrapper(allocator, *tree, gte, dest);
       return true;
     }
 
@@ -1083,9 +1191,9 @@ take(BTNode<T, keys, C> *const tree, const Key &needle, Dest &dest,
     assertxs(index != capacity(elements), index, length(elements));
 
     auto child = children[index];
-    const bool result = take(child, needle, dest, balance);
+    const bool result = take(allocator, child, needle, dest, balance);
     if (balance) {
-      balance = rebalance(*tree, /*pivot*/ gte, ChildDir::LEFT);
+      balance = rebalance(allocator, *tree, /*pivot*/ gte, ChildDir::LEFT);
     }
     return result;
   }
@@ -1093,11 +1201,11 @@ take(BTNode<T, keys, C> *const tree, const Key &needle, Dest &dest,
   /* needle is greater than any other element in elements */
   BTNode<T, keys, C> **child = last(children);
   assertxs(child, length(children));
-  const bool result = take(*child, needle, dest, balance);
+  const bool result = take(allocator, *child, needle, dest, balance);
   if (balance) {
     T *const pivot = last(elements);
     assertx(pivot);
-    balance = rebalance(*tree, pivot, ChildDir::RIGHT);
+    balance = rebalance(allocator, *tree, pivot, ChildDir::RIGHT);
   }
 
   return result;
@@ -1112,12 +1220,14 @@ struct BTreeNop {
 };
 } // namespace impl
 
-template <typename T, std::size_t keys, typename Comparator, typename Key>
+template <typename T, std::size_t keys, typename Comparator,
+          template <typename> class A, typename Key>
 bool
-remove(BTree<T, keys, Comparator> &self, const Key &needle) noexcept {
+remove(BTree<T, keys, Comparator, A> &self, const Key &needle) noexcept {
   impl::BTreeNop<T> nop;
   bool balance = false;
-  const bool result = impl::take(self.root, needle, nop, balance);
+  const bool result =
+      impl::take(self.allocator, self.root, needle, nop, balance);
   if (balance) {
     BTNode<T, keys, Comparator> *const old = self.root;
     auto &elements = old->elements;
@@ -1130,7 +1240,7 @@ remove(BTree<T, keys, Comparator> &self, const Key &needle) noexcept {
       {
         clear(children);
         clear(old->elements);
-        delete old;
+        impl::destroy_node(self.allocator, old);
       }
     }
   }
@@ -1139,12 +1249,261 @@ remove(BTree<T, keys, Comparator> &self, const Key &needle) noexcept {
 }
 
 //=====================================
-template <typename T, std::size_t keys, typename Comparator>
+template <typename T, std::size_t keys, typename Comparator,
+          template <typename> class A>
 bool
-is_empty(const BTree<T, keys, Comparator> &self) noexcept {
+is_empty(const BTree<T, keys, Comparator, A> &self) noexcept {
   return self.root == nullptr;
 }
 
+//=====================================
+namespace impl {
+/* returns false when $high has been reached */
+template <typename T, std::size_t keys, typename Cmp, typename Key, typename F>
+static bool
+for_each_in_range(const BTNode<T, keys, Cmp> *const tree, const Key &low,
+                  const Key &high, F &f, std::size_t &result) noexcept {
+  if (tree == nullptr) {
+    return true;
+  }
+
+  const auto &children = tree->children;
+  const auto &elements = tree->elements;
+
+  Cmp cmp;
+  const T *const gte = node_find_gte(elements, low, cmp);
+  std::size_t i = gte ? index_of(elements, gte) : length(elements);
+  for (; i < length(elements); ++i) {
+    if (!is_empty(children)) {
+      if (!for_each_in_range(children[i], low, high, f, result)) {
+        return false;
+      }
+    }
+
+    if (!cmp(high, /*>*/ elements[i])) {
+      return false;
+    }
+
+    f(elements[i]);
+    ++result;
+  }
+
+  if (!is_empty(children)) {
+    return for_each_in_range(*last(children), low, high, f, result);
+  }
+
+  return true;
+}
+} // namespace impl
+
+template <typename T, std::size_t keys, typename Comparator,
+          template <typename> class A, typename Key, typename F>
+std::size_t
+for_each_in_range(const BTree<T, keys, Comparator, A> &self, const Key &low,
+                  const Key &high, F f) noexcept {
+  std::size_t result = 0;
+  impl::for_each_in_range(self.root, low, high, f, result);
+  return result;
+}
+
+//=====================================
+namespace impl {
+/* The number of values of a subtree of $height where every node has $per
+ * elements, saturated one below the max so that it can be incremented */
+static inline std::size_t
+btree_capacity(std::size_t per, std::size_t height) noexcept {
+  const std::size_t max = ~std::size_t(0) - 1;
+  std::size_t result = 1;
+  for (std::size_t i = 0; i < height; ++i) {
+    if (result > max / (per + 1)) {
+      return max;
+    }
+    result *= per + 1;
+  }
+  return result - 1;
+}
+
+/* $n values as a subtree of $height, every child is given an equal share of
+ * the values. The number of children is chosen from the $fill capacity of the
+ * child height and then adjusted until every share is between the $low and
+ * $keys capacity of a child. Returns nullptr if a node could not be allocated,
+ * the partial subtree is then already destroyed.
+ */
+template <typename T, std::size_t keys, typename Cmp,
+          template <typename> class A, typename It>
+static BTNode<T, keys, Cmp> *
+bulk_load(A<BTNode<T, keys, Cmp>> &allocator, It &it, std::size_t n,
+          std::size_t height, std::size_t fill, std::size_t low,
+          bool root) noexcept {
+  auto result = make_node(allocator);
+  if (!result) {
+    return nullptr;
+  }
+
+  if (height == 1) {
+    /* a leaf has a nullptr child on each side of every element */
+    assertxs(n <= keys, n);
+    for (std::size_t i = 0; i < n; ++i, ++it) {
+      T *const res = insert(result->elements, *it);
+      assertx(res);
+      auto child = insert(result->children, nullptr);
+      assertx(child);
+    }
+    auto child = insert(result->children, nullptr);
+    assertx(child);
+    return result;
+  }
+
+  /* shares are computed as $n + 1, every child and the separator to its
+   * right */
+  const std::size_t target = btree_capacity(fill, height - 1) + 1;
+  const std::size_t at_least = btree_capacity(low, height - 1) + 1;
+  const std::size_t at_most = btree_capacity(keys, height - 1) + 1;
+  const std::size_t min_children = root ? 2 : low + 1;
+
+  std::size_t children = (n + 1 + target - 1) / target;
+  children = std::max(min_children, std::min(children, keys + 1));
+  while (children > min_children && (n + 1) / children < at_least) {
+    --children;
+  }
+  while (children < keys + 1 && (n + 1 + children - 1) / children > at_most) {
+    ++children;
+  }
+  assertxs((n + 1) / children >= at_least, n, children);
+
+  const std::size_t base = (n + 1) / children;
+  const std::size_t extra = (n + 1) % children;
+  for (std::size_t i = 0; i < children; ++i) {
+    const std::size_t share = base + (i < extra ? 1 : 0) - 1;
+    auto child =
+        bulk_load(allocator, it, share, height - 1, fill, low, false);
+    if (!child) {
+      destroy_all(allocator, result);
+      return nullptr;
+    }
+
+    auto res = insert(result->children, child);
+    assertx(res);
+
+    if (i + 1 < children) {
+      T *const sep = insert(result->elements, *it);
+      assertx(sep);
+      ++it;
+    }
+  }
+
+  return result;
+}
+} // namespace impl
+
+template <typename T, std::size_t keys, typename Comparator,
+          template <typename> class A, typename It>
+bool
+bulk_load(BTree<T, keys, Comparator, A> &self, It begin, It end,
+          double fill) noexcept {
+  if (self.root) {
+    return false;
+  }
+
+  Comparator cmp;
+  std::size_t n = 0;
+  for (It it = begin, prev = begin; it != end; prev = it, ++it, ++n) {
+    assertx(n == 0 || cmp(*it, /*>*/ *prev));
+  }
+
+  if (n == 0) {
+    return true;
+  }
+
+  constexpr std::size_t low = keys / 2;
+  std::size_t per = std::size_t(double(keys) * fill);
+  per = std::max(low, std::min(per, keys));
+
+  /* the lowest height which holds $n at the requested fill, unless that
+   * does not leave enough for the root to have two children */
+  std::size_t height = 1;
+  while (impl::btree_capacity(per, height) < n) {
+    ++height;
+  }
+  while (height > 1 &&
+         n + 1 < 2 * (impl::btree_capacity(low, height - 1) + 1)) {
+    --height;
+  }
+
+  self.root =
+      impl::bulk_load(self.allocator, begin, n, height, per, low, true);
+  return self.root != nullptr;
+}
+
+//=====================================
+namespace impl {
+/* [$low, $high) bounds, nullptr is unbounded */
+template <typename T, std::size_t keys, typename Cmp>
+static bool
+verify(const BTNode<T, keys, Cmp> *node, bool root, const T *low,
+       const T *high, std::size_t depth, std::size_t &leaf_depth) noexcept {
+  Cmp cmp;
+  const auto &elements = node->elements;
+  const auto &children = node->children;
+  if (is_empty(elements)) {
+    return false;
+  }
+  if (!root && length(elements) < (keys - 1) / 2) {
+    return false;
+  }
+
+  for (std::size_t i = 0; i < length(elements); ++i) {
+    if (i > 0 && !cmp(elements[i], /*>*/ elements[i - 1])) {
+      return false;
+    }
+    if (low && !cmp(elements[i], /*>*/ *low)) {
+      return false;
+    }
+    if (high && !cmp(*high, /*>*/ elements[i])) {
+      return false;
+    }
+  }
+
+  if (length(children) != length(elements) + 1) {
+    return false;
+  }
+
+  if (children[0] == nullptr) {
+    if (!is_leaf(*node)) {
+      return false;
+    }
+    if (leaf_depth == 0) {
+      leaf_depth = depth;
+    }
+    return leaf_depth == depth;
+  }
+
+  for (std::size_t i = 0; i < length(children); ++i) {
+    const T *const l = i > 0 ? &elements[i - 1] : low;
+    const T *const h = i < length(elements) ? &elements[i] : high;
+    if (!children[i] ||
+        !verify(children[i], false, l, h, depth + 1, leaf_depth)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+} // namespace impl
+
+template <typename T, std::size_t keys, typename Comparator,
+          template <typename> class A>
+bool
+verify(const BTree<T, keys, Comparator, A> &self) noexcept {
+  if (!self.root) {
+    return true;
+  }
+
+  std::size_t leaf_depth = 0;
+  return impl::verify(self.root, true, (const T *)nullptr, (const T *)nullptr,
+                      1, leaf_depth);
+}
+
 } // namespace rec
 } // namespace sp
 
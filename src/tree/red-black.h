@@ -24,45 +24,56 @@ struct Node {
   explicit Node(K &&v, Node<T> *p = nullptr) noexcept;
 
   explicit operator std::string() const;
-  ~Node() noexcept;
 };
 
-template <typename T, typename Comparator = sp::greater>
-using Tree = bst::Tree<rb::Node<T>, Comparator>;
+template <typename T, typename Comparator = sp::greater,
+          template <typename> class Allocator = sp::Allocator>
+using Tree = bst::Tree<rb::Node<T>, Comparator, Allocator>;
 
 //=====================================
-template <typename T, typename C, typename K>
+template <typename T, typename C, template <typename> class A, typename K>
 const T *
-find(const Tree<T, C> &, const K &) noexcept;
+find(const Tree<T, C, A> &, const K &) noexcept;
 
-template <typename T, typename C, typename K>
+template <typename T, typename C, template <typename> class A, typename K>
 T *
-find(Tree<T, C> &, const K &) noexcept;
+find(Tree<T, C, A> &, const K &) noexcept;
 
 //=====================================
-template <typename T, typename C, typename K>
+template <typename T, typename C, template <typename> class A, typename K>
 std::tuple<T *, bool>
-insert(Tree<T, C> &, K &&) noexcept;
+insert(Tree<T, C, A> &, K &&) noexcept;
 
 //=====================================
-template <typename T, typename C, typename... Arg>
+template <typename T, typename C, template <typename> class A, typename... Arg>
 std::tuple<T *, bool>
-emplace(Tree<T, C> &, Arg &&...) noexcept;
+emplace(Tree<T, C, A> &, Arg &&...) noexcept;
 
 //=====================================
-template <typename T, typename C, typename K>
+/* Builds a tree from the strictly ordered range [$begin, $end) in O(n), every
+ * node is allocated once and no comparisons or rotations are made. $It has to
+ * be a forward iterator, the range is walked once to be counted and once to
+ * be built. Returns false if the tree is not empty or if a node could not be
+ * allocated, then the tree is left empty.
+ */
+template <typename T, typename C, template <typename> class A, typename It>
 bool
-remove(Tree<T, C> &, const K &) noexcept;
+bulk_load(Tree<T, C, A> &, It begin, It end) noexcept;
 
 //=====================================
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A, typename K>
+bool
+remove(Tree<T, C, A> &, const K &) noexcept;
+
+//=====================================
+template <typename T, typename C, template <typename> class A>
 void
-dump(Tree<T, C> &tree, const std::string &prefix = "") noexcept;
+dump(Tree<T, C, A> &tree, const std::string &prefix = "") noexcept;
 
 //=====================================
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 bool
-verify(Tree<T, C> &tree) noexcept;
+verify(Tree<T, C, A> &tree) noexcept;
 
 //=====================================
 //====Implementation===================
@@ -101,18 +112,6 @@ Node<T>::operator std::string() const {
   return s;
 }
 
-template <typename T>
-Node<T>::~Node() noexcept {
-  // TODO this is recursive
-  if (left) {
-    delete left;
-    left = nullptr;
-  }
-  if (right) {
-    delete right;
-    right = nullptr;
-  }
-}
 //=====================================
 namespace impl {
 namespace rb {
@@ -408,23 +407,23 @@ verify(Node<T> *parent, Node<T> *current, std::size_t &min, std::size_t &max) {
 } // namespace impl
 
 //=====================================
-template <typename T, typename C, typename K>
+template <typename T, typename C, template <typename> class A, typename K>
 const T *
-find(const Tree<T, C> &tree, const K &key) noexcept {
+find(const Tree<T, C, A> &tree, const K &key) noexcept {
   return bst::find(tree, key);
 }
 
 //=====================================
-template <typename T, typename C, typename K>
+template <typename T, typename C, template <typename> class A, typename K>
 T *
-find(Tree<T, C> &tree, const K &key) noexcept {
+find(Tree<T, C, A> &tree, const K &key) noexcept {
   return bst::find(tree, key);
 }
 
 //=====================================
-template <typename T, typename C, typename K>
+template <typename T, typename C, template <typename> class A, typename K>
 std::tuple<T *, bool>
-insert(Tree<T, C> &tree, K &&value) noexcept {
+insert(Tree<T, C, A> &tree, K &&value) noexcept {
   using impl::rb::rebalance;
   auto set_root = [&tree](Node<T> *root) {
     if (root->parent == nullptr) {
@@ -451,26 +450,26 @@ insert(Tree<T, C> &tree, K &&value) noexcept {
 } // rb::insert()
 
 //=====================================
-template <typename T, typename C, typename... Arg>
+template <typename T, typename C, template <typename> class A, typename... Arg>
 std::tuple<T *, bool>
-emplace(Tree<T, C> &self, Arg &&... args) noexcept {
+emplace(Tree<T, C, A> &self, Arg &&... args) noexcept {
   // TODO make actual impl
   return insert(self, T(std::forward<Arg>(args)...));
 } // rb::emplace()
 
 //=====================================
-template <typename T, typename C, typename K>
+template <typename T, typename C, template <typename> class A, typename K>
 bool
-remove(Tree<T, C> &, const K &) noexcept {
+remove(Tree<T, C, A> &, const K &) noexcept {
   assertx(false);
   // TODO
   return true;
 } // rb::remove()
 
 //=====================================
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 bool
-verify(Tree<T, C> &tree) noexcept {
+verify(Tree<T, C, A> &tree) noexcept {
   Node<T> *root = tree.root;
   if (root) {
     Node<T> *p = nullptr;
@@ -482,9 +481,92 @@ verify(Tree<T, C> &tree) noexcept {
 } // rb::insert()
 
 //=====================================
-template <typename T, typename C>
+namespace impl {
+namespace rb {
+/* The tree is built as balanced as possible, every leaf is at depth $red or
+ * $red - 1. All nodes are BLACK except those at depth $red which are RED, so
+ * every path has the same number of BLACK nodes and a RED node always has a
+ * BLACK parent. Returns nullptr for $n > 0 if a node could not be allocated,
+ * the partial subtree is then already destroyed.
+ */
+template <typename T, typename C, template <typename> class A, typename It>
+static Node<T> *
+bulk_load(Tree<T, C, A> &tree, It &it, std::size_t n, std::size_t depth,
+          std::size_t red) noexcept {
+  if (n == 0) {
+    return nullptr;
+  }
+
+  const std::size_t n_left = (n - 1) / 2;
+  const std::size_t n_right = n - 1 - n_left;
+  Node<T> *const left = bulk_load(tree, it, n_left, depth + 1, red);
+  if (n_left > 0 && !left) {
+    return nullptr;
+  }
+
+  auto result = bst::impl::make_node(tree, *it);
+  if (!result) {
+    bst::impl::destroy_all(tree, left);
+    return nullptr;
+  }
+  ++it;
+
+  result->left = left;
+  if (left) {
+    left->parent = result;
+  }
+
+  Node<T> *const right = bulk_load(tree, it, n_right, depth + 1, red);
+  if (n_right > 0 && !right) {
+    bst::impl::destroy_all(tree, result);
+    return nullptr;
+  }
+
+  result->right = right;
+  if (right) {
+    right->parent = result;
+  }
+
+  result->colour = depth == red ? Colour::RED : Colour::BLACK;
+  return result;
+}
+} // namespace rb
+} // namespace impl
+
+template <typename T, typename C, template <typename> class A, typename It>
+bool
+bulk_load(Tree<T, C, A> &tree, It begin, It end) noexcept {
+  if (tree.root) {
+    return false;
+  }
+
+  C cmp;
+  std::size_t n = 0;
+  for (It it = begin, prev = begin; it != end; prev = it, ++it, ++n) {
+    assertx(n == 0 || cmp(*it, /*>*/ *prev));
+  }
+
+  /* depth of the deepest node, floor(log2(n)) */
+  std::size_t deepest = 0;
+  while ((n >> (deepest + 1)) != 0) {
+    ++deepest;
+  }
+
+  /* the root must be BLACK, a single node tree has no RED level */
+  const std::size_t red = deepest == 0 ? ~std::size_t(0) : deepest;
+  Node<T> *const root = impl::rb::bulk_load(tree, begin, n, 0, red);
+  if (n > 0 && !root) {
+    return false;
+  }
+
+  tree.root = root;
+  return true;
+}
+
+//=====================================
+template <typename T, typename C, template <typename> class A>
 void
-dump(Tree<T, C> &tree, const std::string &prefix) noexcept {
+dump(Tree<T, C, A> &tree, const std::string &prefix) noexcept {
   return bst::impl::dump(tree.root, prefix);
 }
 
@@ -1,15 +1,22 @@
 #ifndef SP_TREE_BST_TREE_H
 #define SP_TREE_BST_TREE_H
 
+#include <memory/Allocator.h>
+#include <new>
 #include <string>
 #include <tuple>
+#include <type_traits>
 #include <util/assert.h>
 #include <util/comparator.h>
 
 namespace bst {
 //=====================================
-// typename Allocator = std::allocator<Key>
-template <typename T, typename Comparator>
+/* The nodes are allocated with $Allocator, which makes it possible to place
+ * the nodes of a tree in a pool, sp::StackPooledAllocator or
+ * sp::SlabAllocator.
+ */
+template <typename T, typename Comparator,
+          template <typename> class Allocator = sp::Allocator>
 struct Tree {
   using value_type = typename T::value_type;
   using reference = value_type &;
@@ -18,72 +25,129 @@ struct Tree {
   using const_pointer = const value_type *;
 
   T *root;
+  Allocator<T> allocator;
 
   explicit Tree(T *) noexcept;
   Tree() noexcept;
 
-  Tree(const Tree<T, Comparator> &) = delete;
-  Tree(Tree<T, Comparator> &&) noexcept;
+  Tree(const Tree<T, Comparator, Allocator> &) = delete;
+  Tree(Tree<T, Comparator, Allocator> &&) noexcept;
 
   Tree &
-  operator=(const Tree<T, Comparator> &) = delete;
+  operator=(const Tree<T, Comparator, Allocator> &) = delete;
   Tree &
-  operator=(const Tree<T, Comparator> &&) = delete;
+  operator=(const Tree<T, Comparator, Allocator> &&) = delete;
 
   ~Tree() noexcept;
 };
 
 //=====================================
-template <typename T, typename C, typename S>
-typename Tree<T, C>::const_pointer
-find(const Tree<T, C> &tree, const S &search) noexcept;
+template <typename T, typename C, template <typename> class A, typename S>
+typename Tree<T, C, A>::const_pointer
+find(const Tree<T, C, A> &tree, const S &search) noexcept;
 
-template <typename T, typename C, typename S>
-typename Tree<T, C>::pointer
-find(Tree<T, C> &tree, const S &search) noexcept;
+template <typename T, typename C, template <typename> class A, typename S>
+typename Tree<T, C, A>::pointer
+find(Tree<T, C, A> &tree, const S &search) noexcept;
 
 //=====================================
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 void
-swap(Tree<T, C> &, Tree<T, C> &) noexcept;
+swap(Tree<T, C, A> &, Tree<T, C, A> &) noexcept;
 
 //=====================================
 #if 0
-template <typename T, typename C, typename F>
+template <typename T, typename C, template <typename> class A, typename F>
 void
-for_each(const Tree<T, C> &, F) noexcept;
+for_each(const Tree<T, C, A> &, F) noexcept;
 
-template <typename T, typename C, typename F>
+template <typename T, typename C, template <typename> class A, typename F>
 void
-for_each(Tree<T, C> &, F) noexcept;
+for_each(Tree<T, C, A> &, F) noexcept;
 #endif
 
 //=====================================
 //====Implementation===================
 //=====================================
-template <typename T, typename C>
-Tree<T, C>::Tree(T *r) noexcept
-    : root(r) {
+namespace impl {
+//=====================================
+template <typename N, typename C, template <typename> class A,
+          typename... Arg>
+N *
+make_node(Tree<N, C, A> &self, Arg &&... args) noexcept {
+  N *const result = allocate(self.allocator);
+  if (result) {
+    ::new (result) N(std::forward<Arg>(args)...);
+  }
+
+  return result;
+}
+
+template <typename N, typename C, template <typename> class A>
+void
+destroy_node(Tree<N, C, A> &self, N *node) noexcept {
+  assertx(node);
+  node->~N();
+  deallocate(self.allocator, node);
+}
+
+//=====================================
+/* Destroys every node of the subtree $it without recursion or a stack, left
+ * children are rotated up into the right spine until the current node has no
+ * left child, then it can be destroyed.
+ */
+template <typename N, typename C, template <typename> class A>
+void
+destroy_all(Tree<N, C, A> &self, N *it) noexcept {
+  if (sp::AllocatorReleasesAll<A>::value &&
+      std::is_trivially_destructible<N>::value) {
+    /* the allocator returns all the memory when it is destroyed */
+    return;
+  }
+
+  while (it) {
+    N *const left = it->left;
+    if (left) {
+      it->left = left->right;
+      left->right = it;
+      it = left;
+    } else {
+      N *const right = it->right;
+      destroy_node(self, it);
+      it = right;
+    }
+  }
 }
 
-template <typename T, typename C>
-Tree<T, C>::Tree() noexcept
+template <typename N, typename C, template <typename> class A>
+void
+destroy_all(Tree<N, C, A> &self) noexcept {
+  N *const root = self.root;
+  self.root = nullptr;
+  destroy_all(self, root);
+}
+} // namespace impl
+
+template <typename T, typename C, template <typename> class A>
+Tree<T, C, A>::Tree(T *r) noexcept
+    : root(r)
+    , allocator() {
+}
+
+template <typename T, typename C, template <typename> class A>
+Tree<T, C, A>::Tree() noexcept
     : Tree(nullptr) {
 }
 
-template <typename T, typename C>
-Tree<T, C>::Tree(Tree<T, C> &&o) noexcept
+template <typename T, typename C, template <typename> class A>
+Tree<T, C, A>::Tree(Tree<T, C, A> &&o) noexcept
     : Tree(nullptr) {
   swap(*this, o);
 }
 
-template <typename T, typename C>
-Tree<T, C>::~Tree() noexcept {
-  if (root) {
-    // TODO support non recursive delete
-    delete root;
-    root = nullptr;
-  }
+template <typename T, typename C, template <typename> class A>
+Tree<T, C, A>::~Tree() noexcept {
+  impl::destroy_all(*this);
 }
 
 namespace impl {
@@ -159,9 +223,9 @@ Lstart:
 
 //=====================================
 /* Recursivly search in tree until matching node is found */
-template <typename N, typename C, typename K>
+template <typename N, typename C, template <typename> class A, typename K>
 const N *
-find_node(const Tree<N, C> &tree, const K &search) noexcept {
+find_node(const Tree<N, C, A> &tree, const K &search) noexcept {
   const N *current = tree.root;
 Lstart:
   if (current) {
@@ -180,20 +244,21 @@ Lstart:
   return current;
 } // bst::impl::find_node()
 
-template <typename N, typename C, typename K>
+template <typename N, typename C, template <typename> class A, typename K>
 static N *
-find_node(Tree<N, C> &tree, const K &search) noexcept {
-  const Tree<N, C> &c_tree = tree;
+find_node(Tree<N, C, A> &tree, const K &search) noexcept {
+  const Tree<N, C, A> &c_tree = tree;
   return (N *)find_node(c_tree, search);
 }
 
 //=====================================
-template <typename N, typename C, typename Key, typename... Arg>
+template <typename N, typename C, template <typename> class A, typename Key,
+          typename... Arg>
 std::tuple<N *, bool>
-emplace(Tree<N, C> &self, const Key &key, Arg &&... args) noexcept {
+emplace(Tree<N, C, A> &self, const Key &key, Arg &&... args) noexcept {
   if (self.root == nullptr) {
     // insert into empty tree
-    self.root = new (std::nothrow) N(std::forward<Arg>(args)...);
+    self.root = make_node(self, std::forward<Arg>(args)...);
     if (self.root) {
       return std::make_tuple(self.root, true);
     }
@@ -211,7 +276,7 @@ Lit:
       goto Lit;
     }
 
-    it->left = new (std::nothrow) N(std::forward<Arg>(args)..., it);
+    it->left = make_node(self, std::forward<Arg>(args)..., it);
     if (it->left) {
       return std::make_tuple(it->left, true);
     }
@@ -222,7 +287,7 @@ Lit:
       goto Lit;
     }
 
-    it->right = new (std::nothrow) N(std::forward<Arg>(args)..., it);
+    it->right = make_node(self, std::forward<Arg>(args)..., it);
     if (it->right) {
       return std::make_tuple(it->right, true);
     }
@@ -235,12 +300,12 @@ Lit:
 }
 
 //=====================================
-template <typename N, typename C, typename K>
+template <typename N, typename C, template <typename> class A, typename K>
 static std::tuple<N *, bool>
-insert(Tree<N, C> &self, K &&in) noexcept {
+insert(Tree<N, C, A> &self, K &&in) noexcept {
   if (self.root == nullptr) {
     // insert into empty tree
-    self.root = new (std::nothrow) N(std::forward<K>(in));
+    self.root = make_node(self, std::forward<K>(in));
     if (self.root) {
       return std::make_tuple(self.root, true);
     }
@@ -258,7 +323,7 @@ Lit:
       goto Lit;
     }
 
-    it->left = new (std::nothrow) N(std::forward<K>(in), it);
+    it->left = make_node(self, std::forward<K>(in), it);
     if (it->left) {
       return std::make_tuple(it->left, true);
     }
@@ -269,7 +334,7 @@ Lit:
       goto Lit;
     }
 
-    it->right = new (std::nothrow) N(std::forward<K>(in), it);
+    it->right = make_node(self, std::forward<K>(in), it);
     if (it->right) {
       return std::make_tuple(it->right, true);
     }
@@ -400,9 +465,9 @@ remove(N *const current) noexcept {
 } // namespace impl
 
 //=====================================
-template <typename N, typename C, typename K>
-typename Tree<N, C>::const_pointer
-find(const Tree<N, C> &tree, const K &search) noexcept {
+template <typename N, typename C, template <typename> class A, typename K>
+typename Tree<N, C, A>::const_pointer
+find(const Tree<N, C, A> &tree, const K &search) noexcept {
   const N *const result = bst::impl::find_node(tree, search);
   if (result) {
     return &result->value;
@@ -411,19 +476,20 @@ find(const Tree<N, C> &tree, const K &search) noexcept {
   return nullptr;
 } // bst::find()
 
-template <typename T, typename C, typename K>
-typename Tree<T, C>::pointer
-find(Tree<T, C> &tree, const K &search) noexcept {
-  const Tree<T, C> &ctree = tree;
-  return (typename Tree<T, C>::pointer)find<T, C, K>(ctree, search);
+template <typename T, typename C, template <typename> class A, typename K>
+typename Tree<T, C, A>::pointer
+find(Tree<T, C, A> &tree, const K &search) noexcept {
+  const Tree<T, C, A> &ctree = tree;
+  return (typename Tree<T, C, A>::pointer)find<T, C, A, K>(ctree, search);
 } // bst::find()
 
 //=====================================
-template <typename T, typename C>
+template <typename T, typename C, template <typename> class A>
 void
-swap(Tree<T, C> &first, Tree<T, C> &second) noexcept {
+swap(Tree<T, C, A> &first, Tree<T, C, A> &second) noexcept {
   using std::swap;
   swap(first.root, second.root);
+  swap(first.allocator, second.allocator);
 } // bst::swap()
 
 //=====================================
@@ -452,15 +518,15 @@ for_each(T *self, F f) noexcept {
 }
 } // namespace impl
 
-template <typename T, typename C, typename F>
+template <typename T, typename C, template <typename> class A, typename F>
 void
-for_each(const Tree<T, C> &self, F f) noexcept {
+for_each(const Tree<T, C, A> &self, F f) noexcept {
   impl::for_each(self.root, f);
 }
 
-template <typename T, typename C, typename F>
+template <typename T, typename C, template <typename> class A, typename F>
 void
-for_each(Tree<T, C> &self, F f) noexcept {
+for_each(Tree<T, C, A> &self, F f) noexcept {
   impl::for_each(self.root, f);
 }
 #endif
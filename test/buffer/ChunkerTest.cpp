@@ -0,0 +1,289 @@
+#include <buffer/Chunker.h>
+#include <chrono>
+#include <collection/Array.h>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <prng/util.h>
+#include <prng/xorshift.h>
+
+namespace {
+struct ChunkerSource {
+  const unsigned char *data;
+  std::size_t length;
+  std::size_t pos;
+  /* max bytes per fill */
+  std::size_t step;
+};
+} // namespace
+
+static bool
+chunker_fill(sp::CircularByteBuffer &b, void *arg) noexcept {
+  auto self = reinterpret_cast<ChunkerSource *>(arg);
+  std::size_t l = std::min(self->length - self->pos, remaining_write(b));
+  l = std::min(l, self->step);
+  if (l > 0) {
+    write(b, self->data + self->pos, l);
+    self->pos += l;
+  }
+  return true;
+}
+
+static bool
+chunker_flush(sp::CircularByteBuffer &b, void *arg) noexcept {
+  auto result = reinterpret_cast<sp::DynamicArray<sp::Chunk> *>(arg);
+  unsigned char record[16];
+  while (read(b, record, sizeof(record))) {
+    sp::Chunk current;
+    std::memcpy(&current.offset, record, 8);
+    std::memcpy(&current.length, record + 8, 4);
+    std::memcpy(&current.fingerprint, record + 12, 4);
+    if (!push(*result, current)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <std::size_t SIZE>
+static void
+chunker_run(const unsigned char *data, std::size_t length, std::size_t step,
+            sp::Chunker &chunker, sp::DynamicArray<sp::Chunk> &result) {
+  sp::StaticCircularByteBuffer<SIZE> in_buffer;
+  sp::StaticCircularByteBuffer<256> out_buffer;
+  ChunkerSource source{data, length, 0, step};
+
+  sp::Thing in(in_buffer, &source, chunker_fill);
+  sp::Sink out(out_buffer, &result, chunker_flush);
+  ASSERT_TRUE(chunk(chunker, in, out));
+  ASSERT_TRUE(flush(out));
+  ASSERT_EQ(length, source.pos);
+}
+
+static unsigned char *
+chunker_random(std::size_t length, std::uint32_t seed) {
+  prng::xorshift32 r(seed);
+  auto result = new unsigned char[length];
+  for (std::size_t i = 0; i < length; ++i) {
+    result[i] = (unsigned char)random(r);
+  }
+  return result;
+}
+
+static void
+chunker_verify(const unsigned char *data, std::size_t length,
+               const sp::Chunker &chunker,
+               const sp::DynamicArray<sp::Chunk> &chunks) {
+  std::uint64_t offset = 0;
+  for (std::size_t i = 0; i < sp::length(chunks); ++i) {
+    const sp::Chunk &current = chunks[i];
+    ASSERT_EQ(offset, current.offset);
+    ASSERT_TRUE(current.length <= chunker.max);
+    if (i + 1 != sp::length(chunks)) {
+      ASSERT_TRUE(current.length >= chunker.min);
+    }
+    ASSERT_EQ(crc32c::encode(data + current.offset, current.length),
+              current.fingerprint);
+    offset += current.length;
+  }
+  ASSERT_EQ(length, offset);
+}
+
+TEST(ChunkerTest, test_boundaries) {
+  constexpr std::size_t length = 1024 * 1024;
+  unsigned char *const data = chunker_random(length, 1);
+
+  sp::Chunker chunker(512, 2048, 8192);
+  sp::DynamicArray<sp::Chunk> chunks(4096);
+  chunker_run<4096>(data, length, length, chunker, chunks);
+  chunker_verify(data, length, chunker, chunks);
+
+  /* the sizes should be concentrated around avg */
+  const std::size_t avg = length / sp::length(chunks);
+  ASSERT_TRUE(avg > chunker.avg / 2);
+  ASSERT_TRUE(avg < chunker.avg * 2);
+
+  delete[] data;
+}
+
+TEST(ChunkerTest, test_empty_and_constant) {
+  sp::Chunker chunker(64, 256, 1024);
+  {
+    sp::DynamicArray<sp::Chunk> chunks(4096);
+    chunker_run<128>(nullptr, 0, 1, chunker, chunks);
+    ASSERT_EQ(std::size_t(0), length(chunks));
+  }
+  {
+    /* no content boundaries are found in a constant stream */
+    constexpr std::size_t length = 1024 * 10 + 7;
+    auto data = new unsigned char[length];
+    std::memset(data, 0, length);
+
+    sp::DynamicArray<sp::Chunk> chunks(4096);
+    chunker_run<512>(data, length, 100, chunker, chunks);
+    chunker_verify(data, length, chunker, chunks);
+    ASSERT_EQ(std::size_t(11), sp::length(chunks));
+    ASSERT_EQ(std::uint32_t(7), chunks[10].length);
+    delete[] data;
+  }
+}
+
+TEST(ChunkerTest, test_segmentation) {
+  /* the result does not depend on how the input is split up */
+  constexpr std::size_t length = 1024 * 256;
+  unsigned char *const data = chunker_random(length, 2);
+
+  sp::DynamicArray<sp::Chunk> expected(4096);
+  {
+    sp::Chunker chunker(256, 1024, 4096);
+    chunker_run<1024 * 64>(data, length, length, chunker, expected);
+  }
+
+  const std::size_t steps[] = {1, 7, 100, 1000, 5000};
+  for (std::size_t step : steps) {
+    sp::Chunker chunker(256, 1024, 4096);
+    sp::DynamicArray<sp::Chunk> chunks(4096);
+    chunker_run<512>(data, length, step, chunker, chunks);
+    chunker_verify(data, length, chunker, chunks);
+
+    ASSERT_EQ(sp::length(expected), sp::length(chunks));
+    for (std::size_t i = 0; i < sp::length(chunks); ++i) {
+      ASSERT_EQ(expected[i].offset, chunks[i].offset);
+      ASSERT_EQ(expected[i].length, chunks[i].length);
+      ASSERT_EQ(expected[i].fingerprint, chunks[i].fingerprint);
+    }
+  }
+
+  delete[] data;
+}
+
+TEST(ChunkerTest, test_insert_resync) {
+  /* inserting bytes in the beginning only changes the first chunks */
+  constexpr std::size_t length = 1024 * 256;
+  constexpr std::size_t inserted = 13;
+  unsigned char *const data = chunker_random(length, 3);
+  unsigned char *const shifted = new unsigned char[length + inserted];
+  std::memcpy(shifted, data, 1000);
+  std::memset(shifted + 1000, 'x', inserted);
+  std::memcpy(shifted + 1000 + inserted, data + 1000, length - 1000);
+
+  sp::DynamicArray<sp::Chunk> a(4096);
+  sp::DynamicArray<sp::Chunk> b(4096);
+  {
+    sp::Chunker chunker(256, 1024, 4096);
+    chunker_run<4096>(data, length, length, chunker, a);
+  }
+  {
+    sp::Chunker chunker(256, 1024, 4096);
+    chunker_run<4096>(shifted, length + inserted, length, chunker, b);
+  }
+
+  std::size_t common = 0;
+  for (std::size_t i = 0; i < sp::length(b); ++i) {
+    for (std::size_t k = 0; k < sp::length(a); ++k) {
+      if (a[k].fingerprint == b[i].fingerprint &&
+          a[k].length == b[i].length) {
+        ASSERT_EQ(a[k].offset + inserted, b[i].offset);
+        ++common;
+        break;
+      }
+    }
+  }
+  ASSERT_TRUE(common + 3 >= sp::length(a));
+
+  delete[] shifted;
+  delete[] data;
+}
+
+namespace {
+struct ChunkerFlaky {
+  sp::DynamicArray<sp::Chunk> *result;
+  std::size_t calls;
+};
+} // namespace
+
+/* every other flush fails without consuming anything */
+static bool
+chunker_flaky_flush(sp::CircularByteBuffer &b, void *arg) noexcept {
+  auto self = reinterpret_cast<ChunkerFlaky *>(arg);
+  if ((self->calls++ % 2) == 0) {
+    return false;
+  }
+  return chunker_flush(b, self->result);
+}
+
+TEST(ChunkerTest, test_write_retry) {
+  /* no chunk record is lost or duplicated when the output fails */
+  constexpr std::size_t length = 1024 * 128;
+  unsigned char *const data = chunker_random(length, 5);
+
+  sp::DynamicArray<sp::Chunk> expected(4096);
+  {
+    sp::Chunker chunker(256, 1024, 4096);
+    chunker_run<4096>(data, length, length, chunker, expected);
+  }
+
+  sp::DynamicArray<sp::Chunk> chunks(4096);
+  {
+    sp::StaticCircularByteBuffer<512> in_buffer;
+    /* room for 4 records */
+    sp::StaticCircularByteBuffer<64> out_buffer;
+    ChunkerSource source{data, length, 0, 300};
+    ChunkerFlaky flaky{&chunks, 0};
+
+    sp::Thing in(in_buffer, &source, chunker_fill);
+    sp::Sink out(out_buffer, &flaky, chunker_flaky_flush);
+    sp::Chunker chunker(256, 1024, 4096);
+
+    std::size_t failed = 0;
+    while (!chunk(chunker, in, out)) {
+      ++failed;
+    }
+    while (!flush(out)) {
+      ++failed;
+    }
+    ASSERT_TRUE(failed > 0);
+    ASSERT_EQ(length, source.pos);
+    chunker_verify(data, length, chunker, chunks);
+  }
+
+  ASSERT_EQ(sp::length(expected), sp::length(chunks));
+  for (std::size_t i = 0; i < sp::length(chunks); ++i) {
+    ASSERT_EQ(expected[i].offset, chunks[i].offset);
+    ASSERT_EQ(expected[i].length, chunks[i].length);
+    ASSERT_EQ(expected[i].fingerprint, chunks[i].fingerprint);
+  }
+
+  delete[] data;
+}
+
+static bool
+chunker_discard(sp::CircularByteBuffer &b, void *arg) noexcept {
+  *reinterpret_cast<std::size_t *>(arg) += remaining_read(b) / 16;
+  consume_bytes(b, remaining_read(b));
+  return true;
+}
+
+TEST(ChunkerTest, bench_throughput) {
+  constexpr std::size_t length = 1024 * 1024 * 64;
+  unsigned char *const data = chunker_random(length, 4);
+
+  sp::StaticCircularByteBuffer<1024 * 64> in_buffer;
+  sp::StaticCircularByteBuffer<1024> out_buffer;
+  ChunkerSource source{data, length, 0, length};
+  sp::Thing in(in_buffer, &source, chunker_fill);
+  std::size_t chunks = 0;
+  sp::Sink out(out_buffer, &chunks, chunker_discard);
+
+  sp::Chunker chunker(2048, 8192, 65536);
+  auto start = std::chrono::steady_clock::now();
+  ASSERT_TRUE(chunk(chunker, in, out));
+  ASSERT_TRUE(flush(out));
+  auto end = std::chrono::steady_clock::now();
+
+  const std::chrono::duration<double> secs = end - start;
+  printf("chunk: %.2f MB/s, %zu chunks\n",
+         double(length) / secs.count() / 1024 / 1024,
+         chunks);
+
+  delete[] data;
+}
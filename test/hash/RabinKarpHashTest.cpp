@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include <hash/RabinKarpHash.h>
+#include <prng/util.h>
+#include <prng/xorshift.h>
+
+static void
+test_rolling(sp::RollingHash type) {
+  constexpr std::size_t length = 1024;
+  char text[length];
+  prng::xorshift32 r(1);
+  for (std::size_t i = 0; i < length; ++i) {
+    /* small alphabet to get repeated windows */
+    text[i] = char('a' + uniform_dist(r, 0, 4));
+  }
+
+  for (std::size_t window = 1; window <= 70; window += 3) {
+    sp::RabinKarpHash h(window, type);
+    for (std::size_t i = 0; i < window; ++i) {
+      push(h, text[i]);
+    }
+
+    for (std::size_t i = window; i <= length; ++i) {
+      const char *const start = text + i - window;
+      ASSERT_EQ(sp::rolling_hash(type, start, window), hash(h));
+
+      if (i < length) {
+        roll(h, text[i - window], text[i]);
+      }
+    }
+  }
+}
+
+TEST(RabinKarpHashTest, test_polynomial) {
+  test_rolling(sp::RollingHash::POLYNOMIAL);
+}
+
+TEST(RabinKarpHashTest, test_buzhash) {
+  test_rolling(sp::RollingHash::BUZHASH);
+}
+
+TEST(RabinKarpHashTest, test_update) {
+  const char text[] = "the quick brown fox jumps over the lazy dog";
+  const std::size_t length = sizeof(text) - 1;
+  constexpr std::size_t window = 8;
+
+  for (auto type : {sp::RollingHash::POLYNOMIAL, sp::RollingHash::BUZHASH}) {
+    sp::RabinKarpHash h(window, type);
+
+    /* the first update fills the window */
+    ASSERT_EQ(window, update(h, text, length));
+    ASSERT_EQ(sp::rolling_hash(type, text, window), hash(h));
+
+    /* then one byte at a time */
+    for (std::size_t i = window; i < length; ++i) {
+      ASSERT_EQ(std::size_t(1), update(h, text + i, length - i));
+      ASSERT_EQ(sp::rolling_hash(type, text + i + 1 - window, window), hash(h));
+    }
+
+    clear(h);
+    ASSERT_EQ(std::size_t(3), update(h, text, 3));
+    ASSERT_EQ(window - 3, update(h, text + 3, length - 3));
+    ASSERT_EQ(sp::rolling_hash(type, text, window), hash(h));
+  }
+}
+
+TEST(RabinKarpHashTest, test_distinct) {
+  /* equal windows hash equal, different windows(almost always) differ */
+  const char text[] = "abcabcabd";
+  for (auto type : {sp::RollingHash::POLYNOMIAL, sp::RollingHash::BUZHASH}) {
+    ASSERT_EQ(sp::rolling_hash(type, text, 3),
+              sp::rolling_hash(type, text + 3, 3));
+    ASSERT_NE(sp::rolling_hash(type, text, 3),
+              sp::rolling_hash(type, text + 6, 3));
+    ASSERT_NE(sp::rolling_hash(type, text, 3),
+              sp::rolling_hash(type, text + 1, 3));
+  }
+}
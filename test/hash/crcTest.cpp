@@ -1,6 +1,10 @@
+#include <buffer/CircularByteBuffer.h>
 #include <hash/crc.h>
 #include "gtest/gtest.h"
+#include <chrono>
 #include <cstring>
+#include <prng/util.h>
+#include <prng/xorshift.h>
 
 // static void
 // dht_instance(std::uint8_t *ip, int num_octets, std::uint8_t (&node_id)[20]) {
@@ -157,3 +161,225 @@ TEST(crcTest, crc32) {
     assert(res == cmp);
   }
 }
+
+namespace {
+struct CrcImpl {
+  const char *name;
+  std::uint32_t (*encode)(const void *, std::size_t);
+};
+} // namespace
+
+template <std::size_t N>
+static void
+crc_cross_check(std::uint32_t (*reference)(const void *, std::size_t),
+                const CrcImpl (&impls)[N]) {
+  constexpr std::size_t max = 1024;
+  unsigned char buf[max + 16];
+  prng::xorshift32 r(1);
+  for (std::size_t i = 0; i < sizeof(buf); ++i) {
+    buf[i] = (unsigned char)uniform_dist(r, 0, 256);
+  }
+
+  for (std::size_t length = 0; length <= max; ++length) {
+    for (std::size_t offset = 0; offset < 16; offset += 3) {
+      const std::uint32_t cmp = reference(buf + offset, length);
+      for (const CrcImpl &impl : impls) {
+        ASSERT_EQ(cmp, impl.encode(buf + offset, length))
+            << impl.name << ": " << length << "," << offset;
+      }
+    }
+  }
+}
+
+TEST(crcTest, crc32c_cross_check) {
+  const CrcImpl impls[] = {
+      {"encode", crc32c::encode},
+      {"slicing8", crc32c::encode_slicing8},
+      {"slicing16", crc32c::encode_slicing16},
+  };
+  crc_cross_check(crc32c::encode_bitwise, impls);
+
+  if (crc32c::has_hardware()) {
+    const CrcImpl hw[] = {{"hardware", crc32c::encode_hardware}};
+    crc_cross_check(crc32c::encode_bitwise, hw);
+  }
+
+  const char in[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+  ASSERT_EQ(std::uint32_t(0xe3069283), crc32c::encode_slicing8(in, 9));
+  ASSERT_EQ(std::uint32_t(0xe3069283), crc32c::encode_slicing16(in, 9));
+}
+
+TEST(crcTest, crc32_cross_check) {
+  const CrcImpl impls[] = {
+      {"encode", crc32::encode},
+      {"slicing8", crc32::encode_slicing8},
+      {"slicing16", crc32::encode_slicing16},
+  };
+  crc_cross_check(crc32::encode_bitwise, impls);
+
+  const char in[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+  ASSERT_EQ(std::uint32_t(0xCBF43926), crc32::encode_slicing8(in, 9));
+  ASSERT_EQ(std::uint32_t(0xCBF43926), crc32::encode_slicing16(in, 9));
+}
+
+static double
+crc_throughput(std::uint32_t (*f)(const void *, std::size_t),
+               const unsigned char *buf, std::size_t length,
+               std::size_t total = 1024 * 1024 * 256) {
+  const std::size_t rounds = std::max(total / length, std::size_t(1));
+
+  std::uint32_t sum = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < rounds; ++i) {
+    sum += f(buf, length);
+  }
+  const std::chrono::duration<double> secs =
+      std::chrono::steady_clock::now() - start;
+
+  /* keep $sum alive */
+  if (sum == 42) {
+    printf(" ");
+  }
+
+  return double(rounds * length) / secs.count() / (1024.0 * 1024.0);
+}
+
+TEST(crcTest, bench_throughput) {
+  constexpr std::size_t length = 1024 * 64;
+  auto buf = new unsigned char[length];
+  prng::xorshift32 r(2);
+  for (std::size_t i = 0; i < length; ++i) {
+    buf[i] = (unsigned char)uniform_dist(r, 0, 256);
+  }
+
+  /* the bitwise reference is slow, hash less data */
+  constexpr std::size_t small = 1024 * 1024 * 16;
+  printf("crc32c bitwise:   %8.0f MB/s\n",
+         crc_throughput(crc32c::encode_bitwise, buf, length, small));
+  printf("crc32c slicing8:  %8.0f MB/s\n",
+         crc_throughput(crc32c::encode_slicing8, buf, length));
+  printf("crc32c slicing16: %8.0f MB/s\n",
+         crc_throughput(crc32c::encode_slicing16, buf, length));
+  if (crc32c::has_hardware()) {
+    printf("crc32c hardware:  %8.0f MB/s\n",
+           crc_throughput(crc32c::encode_hardware, buf, length));
+  }
+  printf("crc32 bitwise:    %8.0f MB/s\n",
+         crc_throughput(crc32::encode_bitwise, buf, length, small));
+  printf("crc32 slicing8:   %8.0f MB/s\n",
+         crc_throughput(crc32::encode_slicing8, buf, length));
+  printf("crc32 slicing16:  %8.0f MB/s\n",
+         crc_throughput(crc32::encode_slicing16, buf, length));
+
+  delete[] buf;
+}
+
+template <typename Context, typename Encode, typename Combine>
+static void
+crc_streaming(Encode encode, Combine combine) {
+  constexpr std::size_t max = 1024;
+  unsigned char buf[max];
+  prng::xorshift32 r(3);
+  for (std::size_t i = 0; i < sizeof(buf); ++i) {
+    buf[i] = (unsigned char)uniform_dist(r, 0, 256);
+  }
+
+  for (std::size_t length = 0; length <= max; length += 7) {
+    const std::uint32_t cmp = encode(buf, length);
+
+    /* split into random fragments */
+    Context ctx;
+    init(ctx);
+    std::size_t done = 0;
+    while (done < length) {
+      const std::size_t n = uniform_dist(r, 0, std::uint32_t(length - done + 1));
+      update(ctx, buf + done, n);
+      done += n;
+    }
+    ASSERT_EQ(cmp, final(ctx));
+
+    /* crc(AB) == combine(crc(A), crc(B), len(B)) */
+    for (std::size_t split = 0; split <= length; split += 13) {
+      const std::uint32_t a = encode(buf, split);
+      const std::uint32_t b = encode(buf + split, length - split);
+      ASSERT_EQ(cmp, combine(a, b, length - split)) << length << "," << split;
+    }
+  }
+}
+
+TEST(crcTest, crc32c_streaming) {
+  crc_streaming<crc32c::Context>(crc32c::encode, crc32c::combine);
+}
+
+TEST(crcTest, crc32_streaming) {
+  crc_streaming<crc32::Context>(crc32::encode, crc32::combine);
+}
+
+TEST(crcTest, test_CircularByteBuffer) {
+  sp::StaticCircularByteBuffer<64> b;
+  unsigned char in[48];
+  for (std::size_t i = 0; i < sizeof(in); ++i) {
+    in[i] = (unsigned char)i;
+  }
+
+  /* move the read/write position so that the content wraps around */
+  ASSERT_EQ(sizeof(in), push_back(b, in, sizeof(in)));
+  unsigned char tmp[40];
+  ASSERT_TRUE(pop_front(b, tmp));
+  ASSERT_EQ(sizeof(in), push_back(b, in, sizeof(in)));
+
+  sp::CircularByteBuffer::BufferArray segments;
+  ASSERT_TRUE(read_buffer(b, segments));
+  ASSERT_EQ(std::size_t(2), length(segments));
+
+  unsigned char flat[64];
+  const std::size_t len = remaining_read(b);
+  ASSERT_EQ(len, peek_front(b, flat, len));
+
+  crc32c::Context ctx;
+  update(ctx, segments);
+  ASSERT_EQ(crc32c::encode(flat, len), final(ctx));
+
+  crc32::Context ctx2;
+  update(ctx2, segments);
+  ASSERT_EQ(crc32::encode(flat, len), final(ctx2));
+}
+
+TEST(crcTest, test_parallel) {
+  constexpr std::size_t max = 1024 * 1024 * 2 + 3;
+  auto buf = new unsigned char[max];
+  prng::xorshift32 r(4);
+  for (std::size_t i = 0; i < max; ++i) {
+    buf[i] = (unsigned char)uniform_dist(r, 0, 256);
+  }
+
+  const std::size_t lengths[] = {0, 1, 1024, 64 * 1024 * 2 - 1, 64 * 1024 * 7,
+                                 max};
+  for (std::size_t length : lengths) {
+    const std::uint32_t c = crc32c::encode(buf, length);
+    const std::uint32_t c2 = crc32::encode(buf, length);
+    for (std::size_t threads = 0; threads <= 9; ++threads) {
+      ASSERT_EQ(c, crc32c::encode_parallel(buf, length, threads));
+      ASSERT_EQ(c2, crc32::encode_parallel(buf, length, threads));
+    }
+  }
+
+  delete[] buf;
+}
+
+TEST(crcTest, bench_parallel) {
+  constexpr std::size_t length = 1024 * 1024 * 256;
+  auto buf = new unsigned char[length];
+  std::memset(buf, 0xab, length);
+
+  for (std::size_t threads = 1; threads <= 8; threads *= 2) {
+    const auto start = std::chrono::steady_clock::now();
+    const std::uint32_t c = crc32c::encode_parallel(buf, length, threads);
+    const std::chrono::duration<double> secs =
+        std::chrono::steady_clock::now() - start;
+    printf("crc32c threads[%zu]: %8.0f MB/s [%08x]\n", threads,
+           double(length) / secs.count() / (1024.0 * 1024.0), c);
+  }
+
+  delete[] buf;
+}
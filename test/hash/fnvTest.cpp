@@ -770,3 +770,25 @@ TEST(fnvTest, test_zero) {
   ASSERT_EQ(enc({0x7a, 0x47, 0x54, 0x16, 0x6e, 0x75, 0x42, 0x78, 0x2f, 0x48} ),0ULL);
   ASSERT_EQ(enc({0x7b, 0x3e, 0x68, 0x34, 0x5f, 0x71, 0x43, 0x2a, 0x13, 0x12} ),0ULL);
 }
+
+TEST(fnvTest, test_streaming) {
+  const char in[] = "The quick brown fox jumps over the lazy dog";
+  const std::size_t len = sizeof(in) - 1;
+
+  for (std::size_t split = 0; split <= len; ++split) {
+    fnv_1a::Context ctx;
+    init(ctx);
+    update(ctx, in, split);
+    update(ctx, in + split, len - split);
+    ASSERT_EQ(fnv_1a::encode64(in, len), final(ctx));
+  }
+
+  std::tuple<const char *, std::size_t> raw[] = {
+      std::make_tuple(in, std::size_t(10)),
+      std::make_tuple(in + 10, len - 10),
+  };
+  sp::Array<std::tuple<const char *, std::size_t>> segments(raw, 2, 2);
+  fnv_1a::Context ctx;
+  update(ctx, segments);
+  ASSERT_EQ(fnv_1a::encode64(in, len), final(ctx));
+}
@@ -0,0 +1,193 @@
+#include <buffer/BytesView.h>
+#include <gtest/gtest.h>
+#include <hash/fnv.h>
+#include <hash/standard.h>
+#include <hash/wyhash.h>
+#include <map/HashSetProbing.h>
+#include <prng/util.h>
+#include <prng/xorshift.h>
+#include <string/view.h>
+
+#include <chrono>
+#include <cstring>
+
+TEST(wyhashTest, test_known_answer) {
+  /* test_vector.cpp of the upstream final version 4, the seed is the index */
+  struct {
+    const char *in;
+    std::uint64_t expected;
+  } vectors[] = {
+      {"", 0x93228a4de0eec5a2ull},
+      {"a", 0xc5bac3db178713c4ull},
+      {"abc", 0xa97f2f7b1d9b3314ull},
+      {"message digest", 0x786d1f1df3801df4ull},
+      {"abcdefghijklmnopqrstuvwxyz", 0xdca5a8138ad37c87ull},
+      {"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789",
+       0xb9e734f117cfaf70ull},
+      {"1234567890123456789012345678901234567890"
+       "1234567890123456789012345678901234567890",
+       0x6cc5eab49a92d617ull},
+  };
+
+  std::uint64_t seed = 0;
+  for (const auto &v : vectors) {
+    ASSERT_EQ(v.expected, wyhash::encode(v.in, std::strlen(v.in), seed))
+        << seed;
+    ++seed;
+  }
+}
+
+TEST(wyhashTest, test_deterministic) {
+  unsigned char buf[256 + 16];
+  prng::xorshift32 r(1);
+  for (std::size_t i = 0; i < sizeof(buf); ++i) {
+    buf[i] = (unsigned char)uniform_dist(r, 0, 256);
+  }
+
+  for (std::size_t length = 0; length <= 256; ++length) {
+    const std::uint64_t expected = wyhash::encode64(buf, length);
+
+    /* the result is independent of the alignment of the input */
+    for (std::size_t offset = 1; offset < 16; ++offset) {
+      unsigned char copy[256 + 16];
+      std::memcpy(copy + offset, buf, length);
+      ASSERT_EQ(expected, wyhash::encode64(copy + offset, length));
+    }
+
+    ASSERT_NE(expected, wyhash::encode(buf, length, 1));
+    if (length > 0) {
+      ASSERT_NE(expected, wyhash::encode64(buf, length - 1));
+    }
+  }
+}
+
+TEST(wyhashTest, test_avalanche) {
+  /* flipping any single input bit should on average flip half of the output
+   * bits, for every length class: [1-3], [4-16], [17-47] and [48-) */
+  constexpr std::size_t lengths[] = {1, 3, 4, 8, 16, 17, 32, 47, 48, 64, 200};
+  prng::xorshift32 r(2);
+
+  for (std::size_t length : lengths) {
+    unsigned char buf[256];
+    for (std::size_t i = 0; i < length; ++i) {
+      buf[i] = (unsigned char)uniform_dist(r, 0, 256);
+    }
+
+    const std::uint64_t base = wyhash::encode64(buf, length);
+    std::size_t flipped = 0;
+    for (std::size_t bit = 0; bit < length * 8; ++bit) {
+      buf[bit / 8] ^= (unsigned char)(1 << (bit % 8));
+      const std::uint64_t current = wyhash::encode64(buf, length);
+      buf[bit / 8] ^= (unsigned char)(1 << (bit % 8));
+
+      ASSERT_NE(base, current);
+      flipped += std::size_t(__builtin_popcountll(base ^ current));
+    }
+
+    const double mean = double(flipped) / double(length * 8);
+    ASSERT_TRUE(mean > 24.0 && mean < 40.0) << length << ": " << mean;
+  }
+}
+
+TEST(wyhashTest, test_Hasher_string_view) {
+  const char *const words[] = {"", "a", "ab", "abc", "abcd", "hello world",
+                               "the quick brown fox jumps over the lazy dog"};
+
+  sp::Hasher<sp::string_view> h;
+  sp::HashSetProbing<sp::string_view> set;
+  for (const char *w : words) {
+    const sp::string_view v(w);
+    ASSERT_EQ(wyhash::encode64(w, std::strlen(w)), h(v));
+    ASSERT_TRUE(insert(set, v));
+  }
+
+  for (const char *w : words) {
+    const sp::string_view *const res = lookup(set, sp::string_view(w));
+    ASSERT_TRUE(res);
+    ASSERT_EQ(res->str, w);
+  }
+  ASSERT_FALSE(lookup(set, sp::string_view("abcde")));
+}
+
+TEST(wyhashTest, test_Hasher_BytesView) {
+  unsigned char raw[64];
+  for (std::size_t i = 0; i < sizeof(raw); ++i) {
+    raw[i] = (unsigned char)(i * 7);
+  }
+
+  sp::Hasher<sp::BytesView> h;
+  sp::Hasher<sp::ConstBytesView> ch;
+  for (std::size_t length = 0; length <= 48; ++length) {
+    /* only the readable bytes are hashed, not the capacity or what has
+     * already been read */
+    sp::BytesView view(raw, sizeof(raw));
+    view.pos = 16;
+    view.length = 16 + length;
+    const std::size_t expected = wyhash::encode64(raw + 16, length);
+    ASSERT_EQ(expected, h(view));
+
+    sp::BytesView exact(raw + 16, length);
+    exact.length = length;
+    ASSERT_EQ(expected, h(exact));
+
+    sp::ConstBytesView c_view(raw + 16, length);
+    c_view.length = length;
+    ASSERT_EQ(expected, ch(c_view));
+
+    if (length > 0) {
+      sp::BytesView shorter(raw + 16, length);
+      shorter.length = length - 1;
+      ASSERT_NE(expected, h(shorter));
+    }
+  }
+
+  unsigned char other[16];
+  std::memcpy(other, raw + 16, sizeof(other));
+  sp::BytesView a(raw + 16, sizeof(other));
+  a.length = sizeof(other);
+  sp::BytesView b(other, sizeof(other));
+  b.length = sizeof(other);
+  ASSERT_EQ(h(a), h(b));
+  other[15] ^= 1;
+  ASSERT_NE(h(a), h(b));
+}
+
+template <typename F>
+static double
+bench_throughput(const unsigned char *buf, std::size_t length, F f) {
+  constexpr std::size_t total = 1024 * 1024 * 256;
+  const std::size_t rounds = std::max(total / length, std::size_t(1));
+
+  std::uint64_t sum = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < rounds; ++i) {
+    sum += f(buf + (i & 7), length);
+  }
+  const std::chrono::duration<double> secs =
+      std::chrono::steady_clock::now() - start;
+
+  /* keep $sum alive */
+  if (sum == 42) {
+    printf(" ");
+  }
+
+  return double(rounds * length) / secs.count() / (1024.0 * 1024.0);
+}
+
+TEST(wyhashTest, bench_throughput) {
+  constexpr std::size_t max = 1024 * 64;
+  auto buf = new unsigned char[max + 8];
+  prng::xorshift32 r(3);
+  for (std::size_t i = 0; i < max + 8; ++i) {
+    buf[i] = (unsigned char)uniform_dist(r, 0, 256);
+  }
+
+  printf("%8s %14s %14s\n", "bytes", "fnv_1a MB/s", "wyhash MB/s");
+  for (std::size_t length = 8; length <= max; length *= 2) {
+    const double fnv = bench_throughput(buf, length, fnv_1a::encode64);
+    const double wy = bench_throughput(buf, length, wyhash::encode64);
+    printf("%8zu %14.0f %14.0f\n", length, fnv, wy);
+  }
+
+  delete[] buf;
+}
@@ -0,0 +1,229 @@
+#include <concurrent/Barrier.h>
+#include <gtest/gtest.h>
+#include <map/ConcurrentHashMap.h>
+#include <prng/util.h>
+#include <prng/xorshift.h>
+
+#include <chrono>
+#include <pthread.h>
+
+TEST(ConcurrentHashMapTest, test_basic) {
+  sp::ConcurrentHashMap<int, int> map(5);
+  ASSERT_EQ(std::size_t(8), map.length);
+  /* no two shards share a cache line */
+  for (std::size_t i = 0; i < map.length; ++i) {
+    ASSERT_EQ(std::uintptr_t(0), std::uintptr_t(&map.shards[i]) % 64);
+  }
+
+  for (int i = 0; i < 1024; ++i) {
+    int out = -1;
+    ASSERT_FALSE(lookup(map, i, out));
+    ASSERT_FALSE(contains(map, i));
+    ASSERT_TRUE(insert(map, i, i * 2));
+    ASSERT_TRUE(lookup(map, i, out));
+    ASSERT_EQ(i * 2, out);
+    ASSERT_EQ(std::size_t(i + 1), length(map));
+  }
+
+  for (int i = 0; i < 1024; ++i) {
+    /* insert assigns an existing key */
+    ASSERT_TRUE(insert(map, i, i * 3));
+    ASSERT_TRUE(compute(map, i, [](int &v) {
+      /**/
+      v += 1;
+    }));
+
+    int out = -1;
+    ASSERT_TRUE(lookup(map, i, out));
+    ASSERT_EQ(i * 3 + 1, out);
+  }
+  ASSERT_EQ(std::size_t(1024), length(map));
+
+  for (int i = 0; i < 1024; i += 2) {
+    ASSERT_TRUE(remove(map, i));
+    ASSERT_FALSE(remove(map, i));
+    ASSERT_FALSE(contains(map, i));
+  }
+  ASSERT_EQ(std::size_t(512), length(map));
+
+  /* compute on a missing key starts from a default value */
+  ASSERT_TRUE(compute(map, 0, [](int &v) {
+    ASSERT_EQ(0, v);
+    v = 42;
+  }));
+  int out = -1;
+  ASSERT_TRUE(lookup(map, 0, out));
+  ASSERT_EQ(42, out);
+}
+
+namespace {
+struct ConcurrentHashMapArg {
+  sp::Barrier *b;
+  sp::ConcurrentHashMap<std::uint32_t, std::uint32_t> *map;
+  std::uint32_t id;
+  std::uint32_t ops;
+  std::size_t lookup_percent;
+  std::size_t found;
+  std::chrono::steady_clock::time_point start;
+  std::chrono::steady_clock::time_point end;
+
+  ConcurrentHashMapArg() noexcept
+      : b{nullptr}
+      , map{nullptr}
+      , id{0}
+      , ops{0}
+      , lookup_percent{0}
+      , found{0}
+      , start{}
+      , end{} {
+  }
+};
+} // namespace
+
+static constexpr std::uint32_t concurrent_counters = 64;
+
+static void *
+concurrent_worker(void *a) {
+  auto arg = reinterpret_cast<ConcurrentHashMapArg *>(a);
+  auto &map = *arg->map;
+  arg->b->await();
+
+  const std::uint32_t base = arg->id * arg->ops;
+  for (std::uint32_t i = 0; i < arg->ops; ++i) {
+    const std::uint32_t key = concurrent_counters + base + i;
+    if (!insert(map, key, arg->id)) {
+      return nullptr;
+    }
+
+    compute(map, i % concurrent_counters, [](std::uint32_t &v) {
+      /**/
+      ++v;
+    });
+
+    std::uint32_t out = 0;
+    if (lookup(map, key, out) && out == arg->id) {
+      ++arg->found;
+    }
+
+    if (i % 2 == 0) {
+      remove(map, key);
+    }
+  }
+
+  return nullptr;
+}
+
+TEST(ConcurrentHashMapTest, test_threaded) {
+  constexpr std::size_t threads = 8;
+  constexpr std::uint32_t ops = 1024 * 4;
+
+  sp::ConcurrentHashMap<std::uint32_t, std::uint32_t> map;
+  sp::Barrier b(threads);
+  pthread_t ts[threads];
+  ConcurrentHashMapArg args[threads];
+
+  for (std::size_t i = 0; i < threads; ++i) {
+    args[i].b = &b;
+    args[i].map = &map;
+    args[i].id = std::uint32_t(i);
+    args[i].ops = ops;
+    ASSERT_EQ(0, pthread_create(&ts[i], nullptr, concurrent_worker, &args[i]));
+  }
+
+  for (std::size_t i = 0; i < threads; ++i) {
+    ASSERT_EQ(0, pthread_join(ts[i], nullptr));
+    ASSERT_EQ(std::size_t(ops), args[i].found);
+  }
+
+  for (std::uint32_t i = 0; i < concurrent_counters; ++i) {
+    std::uint32_t out = 0;
+    ASSERT_TRUE(lookup(map, i, out));
+    ASSERT_EQ(std::uint32_t(threads * (ops / concurrent_counters)), out);
+  }
+
+  for (std::uint32_t t = 0; t < threads; ++t) {
+    for (std::uint32_t i = 0; i < ops; ++i) {
+      const std::uint32_t key = concurrent_counters + (t * ops) + i;
+      std::uint32_t out = 0;
+      ASSERT_EQ(i % 2 == 1, lookup(map, key, out));
+      if (i % 2 == 1) {
+        ASSERT_EQ(t, out);
+      }
+    }
+  }
+  ASSERT_EQ(concurrent_counters + (threads * ops) / 2, length(map));
+}
+
+static void *
+concurrent_bench_worker(void *a) {
+  auto arg = reinterpret_cast<ConcurrentHashMapArg *>(a);
+  auto &map = *arg->map;
+  prng::xorshift32 r(arg->id + 1);
+  arg->b->await();
+
+  arg->start = std::chrono::steady_clock::now();
+  for (std::uint32_t i = 0; i < arg->ops; ++i) {
+    const std::uint32_t key = uniform_dist(r, 0, 1024 * 64);
+    if (uniform_dist(r, 0, 100) < arg->lookup_percent) {
+      std::uint32_t out = 0;
+      arg->found += lookup(map, key, out);
+    } else if (key % 2 == 0) {
+      insert(map, key, key);
+    } else {
+      remove(map, key - 1);
+    }
+  }
+  arg->end = std::chrono::steady_clock::now();
+
+  return nullptr;
+}
+
+static double
+concurrent_bench(std::size_t shards, std::size_t threads,
+                 std::size_t lookup_percent) noexcept {
+  constexpr std::uint32_t total_ops = 1024 * 256;
+
+  sp::ConcurrentHashMap<std::uint32_t, std::uint32_t> map(shards);
+  for (std::uint32_t i = 0; i < 1024 * 64; i += 2) {
+    insert(map, i, i);
+  }
+
+  sp::Barrier b(threads);
+  pthread_t *ts = new pthread_t[threads];
+  ConcurrentHashMapArg *args = new ConcurrentHashMapArg[threads];
+
+  for (std::size_t i = 0; i < threads; ++i) {
+    args[i].b = &b;
+    args[i].map = &map;
+    args[i].id = std::uint32_t(i);
+    args[i].ops = std::uint32_t(total_ops / threads);
+    args[i].lookup_percent = lookup_percent;
+    pthread_create(&ts[i], nullptr, concurrent_bench_worker, &args[i]);
+  }
+
+  auto start = std::chrono::steady_clock::time_point::max();
+  auto end = std::chrono::steady_clock::time_point::min();
+  for (std::size_t i = 0; i < threads; ++i) {
+    pthread_join(ts[i], nullptr);
+    start = std::min(start, args[i].start);
+    end = std::max(end, args[i].end);
+  }
+
+  delete[] args;
+  delete[] ts;
+
+  const std::chrono::duration<double> secs = end - start;
+  return double(total_ops) / secs.count() / 1000000.0;
+}
+
+TEST(ConcurrentHashMapTest, bench_scaling) {
+  /* A single shard is the same as wrapping HashMapProbing in one lock */
+  const std::size_t lookup_percent = 90;
+  printf("lookup[%zu%%] Mops/s\n", lookup_percent);
+  printf("threads    1 shard  64 shards\n");
+  for (std::size_t threads = 1; threads <= 64; threads *= 2) {
+    const double global = concurrent_bench(1, threads, lookup_percent);
+    const double sharded = concurrent_bench(64, threads, lookup_percent);
+    printf("%7zu %10.2f %10.2f\n", threads, global, sharded);
+  }
+}
@@ -376,3 +376,76 @@ TEST(HashMapProbingTest, test_tree_gc_key) {
   sp::HashMapTree<sp::GcStruct, int> map;
   test_gc_key(map);
 }
+
+TEST(HashMapProbingTest, test_probing_incremental) {
+  ASSERT_EQ(0, sp::GcStruct::active);
+  {
+    sp::HashMapProbing<int, sp::GcStruct> map(16, 4);
+    test_simple(map);
+
+    constexpr int range = 1024 * 16;
+    for (int i = 0; i < range; ++i) {
+      sp::GcStruct *const res = insert(map, i, i * 2);
+      ASSERT_TRUE(res);
+      ASSERT_EQ(*res, std::size_t(i * 2));
+    }
+    ASSERT_EQ(std::size_t(range), length(map));
+
+    for (int i = 0; i < range; i += 2) {
+      ASSERT_TRUE(remove(map, i));
+    }
+
+    for (int i = 0; i < range; ++i) {
+      const sp::GcStruct *const res = lookup(map, i);
+      if (i % 2 == 0) {
+        ASSERT_FALSE(res);
+      } else {
+        ASSERT_TRUE(res);
+        ASSERT_EQ(*res, std::size_t(i * 2));
+      }
+    }
+    ASSERT_EQ(std::size_t(range / 2), length(map));
+  }
+  ASSERT_EQ(0, sp::GcStruct::active);
+}
+
+TEST(HashMapProbingTest, test_probing_insert_all) {
+  ASSERT_EQ(0, sp::GcStruct::active);
+  {
+    constexpr std::size_t range = 1024 * 2;
+    sp::HashMapProbing<int, sp::GcStruct> map;
+    ASSERT_TRUE(reserve(map, range));
+    for (int i = 0; i < int(range); i += 2) {
+      ASSERT_TRUE(insert(map, i, 0));
+    }
+
+    int keys[range];
+    std::size_t values[range];
+    for (std::size_t i = 0; i < range; ++i) {
+      keys[i] = int(i);
+      values[i] = i * 2;
+    }
+
+    /* existing keys are assigned */
+    ASSERT_EQ(range, insert_all(map, keys, values, range));
+    ASSERT_EQ(range, length(map));
+
+    const sp::GcStruct *res[range];
+    int needles[range];
+    for (std::size_t i = 0; i < range; ++i) {
+      needles[i] = int(i * 2);
+    }
+
+    const auto &c_map = map;
+    ASSERT_EQ(range / 2, lookup_all(c_map, needles, range, res));
+    for (std::size_t i = 0; i < range; ++i) {
+      if (std::size_t(needles[i]) < range) {
+        ASSERT_TRUE(res[i]);
+        ASSERT_EQ(*res[i], std::size_t(needles[i] * 2));
+      } else {
+        ASSERT_FALSE(res[i]);
+      }
+    }
+  }
+  ASSERT_EQ(0, sp::GcStruct::active);
+}
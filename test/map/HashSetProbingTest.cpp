@@ -9,6 +9,8 @@
 #include <util/Bitset.h>
 #include <util/Timer.h>
 
+#include <chrono>
+
 template <typename SET>
 static void
 run_bench(prng::xorshift32 &r, sp::TimerContext &ctx, SET &set) noexcept {
@@ -191,6 +193,232 @@ TEST(HashSetProbingTest, test_HashSetProbing_dtor) {
   ASSERT_EQ(std::int64_t(0), sp::GcStruct::active);
 }
 
+TEST(HashSetProbingTest, test_HashSetProbing_incremental) {
+  ASSERT_EQ(std::int64_t(0), sp::GcStruct::active);
+  {
+    prng::xorshift32 r(1);
+    sp::TimerContext ctx;
+    for (std::size_t a = 0; a < 10; ++a) {
+      sp::HashSetProbing<sp::GcStruct> set(16, 8);
+
+      run_bench(r, ctx, set);
+      ASSERT_EQ(std::size_t(0), length(set));
+      ASSERT_EQ(std::size_t(0), sp::n::length(set));
+    }
+
+    print(ctx);
+
+    printf("Average: ");
+    print(average(ctx));
+
+    printf("Median: ");
+    print(median(ctx));
+  }
+  ASSERT_EQ(std::int64_t(0), sp::GcStruct::active);
+}
+
+TEST(HashSetProbingTest, test_incremental_interleaved) {
+  constexpr int range = 1024 * 64;
+  sp::HashSetProbing<int> set(16, 2);
+
+  for (int i = 0; i < range; ++i) {
+    ASSERT_TRUE(insert(set, i));
+    ASSERT_FALSE(insert(set, i));
+
+    if (i % 3 == 0) {
+      ASSERT_TRUE(remove(set, i / 3));
+      ASSERT_FALSE(remove(set, i / 3));
+    }
+
+    if (set.old) {
+      /* both tables are consulted while the resize is in progress */
+      for (int j = std::max(0, i - 64); j <= i; ++j) {
+        const bool removed = (j * 3) <= i;
+        ASSERT_EQ(!removed, lookup(set, j) != nullptr);
+      }
+    }
+  }
+
+  const std::size_t expected = std::size_t(range - ((range - 1) / 3 + 1));
+  ASSERT_EQ(expected, length(set));
+  ASSERT_EQ(expected, sp::n::length(set));
+
+  for (int i = 0; i < range; ++i) {
+    const int *const res = lookup(set, i);
+    if (i <= (range - 1) / 3) {
+      ASSERT_FALSE(res);
+    } else {
+      ASSERT_TRUE(res);
+      ASSERT_EQ(i, *res);
+    }
+  }
+}
+
+template <typename SET>
+static long long
+bench_insert_latency(SET &set, int range) noexcept {
+  using namespace std::chrono;
+
+  nanoseconds worst(0);
+  for (int i = 0; i < range; ++i) {
+    const auto before = steady_clock::now();
+    int *const res = insert(set, i);
+    const auto diff = steady_clock::now() - before;
+
+    worst = std::max(worst, duration_cast<nanoseconds>(diff));
+    if (!res) {
+      break;
+    }
+  }
+
+  return (long long)duration_cast<microseconds>(worst).count();
+}
+
+TEST(HashSetProbingTest, bench_incremental_latency) {
+  constexpr int range = 1024 * 1024;
+  {
+    sp::HashSetProbing<int> set;
+    const long long worst = bench_insert_latency(set, range);
+    ASSERT_EQ(std::size_t(range), length(set));
+    printf("rehash:      max insert %lld usec\n", worst);
+  }
+  {
+    sp::HashSetProbing<int> set(16, 16);
+    const long long worst = bench_insert_latency(set, range);
+    ASSERT_EQ(std::size_t(range), length(set));
+    printf("incremental: max insert %lld usec\n", worst);
+  }
+}
+
+TEST(HashSetProbingTest, test_reserve) {
+  sp::HashSetProbing<int> set;
+  ASSERT_TRUE(reserve(set, 1000));
+  const std::size_t cap = set.capacity;
+  ASSERT_EQ(std::size_t(1024), cap);
+
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_TRUE(insert(set, i));
+  }
+  ASSERT_EQ(cap, capacity(set));
+
+  /* growing a populated, mid incremental resize, table */
+  sp::HashSetProbing<int> inc(16, 1);
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_TRUE(insert(inc, i));
+  }
+  ASSERT_TRUE(reserve(inc, 1024 * 16));
+  ASSERT_FALSE(inc.old);
+  ASSERT_EQ(std::size_t(1024 * 32), capacity(inc));
+  ASSERT_EQ(std::size_t(1000), length(inc));
+  for (int i = 0; i < 1000; ++i) {
+    const int *const res = lookup(inc, i);
+    ASSERT_TRUE(res);
+    ASSERT_EQ(i, *res);
+  }
+  ASSERT_TRUE(sp::rec::verify(inc));
+}
+
+TEST(HashSetProbingTest, test_insert_all) {
+  ASSERT_EQ(std::int64_t(0), sp::GcStruct::active);
+  {
+    constexpr std::size_t range = 1024 * 4;
+    sp::HashSetProbing<sp::GcStruct> set(16, 4);
+    for (std::size_t i = 0; i < range; i += 3) {
+      ASSERT_TRUE(insert(set, i));
+    }
+
+    std::size_t in[range];
+    for (std::size_t i = 0; i < range; ++i) {
+      in[i] = i;
+    }
+
+    const std::size_t inserted = insert_all(set, in, range);
+    ASSERT_EQ(range - (range / 3 + 1), inserted);
+    ASSERT_EQ(range, length(set));
+    ASSERT_EQ(range, sp::n::length(set));
+    ASSERT_EQ(0u, insert_all(set, in, range));
+
+    const sp::GcStruct *res[range * 2];
+    std::size_t needles[range * 2];
+    for (std::size_t i = 0; i < range * 2; ++i) {
+      needles[i] = (i * 7) % (range * 2);
+    }
+
+    const auto &c_set = set;
+    ASSERT_EQ(range, lookup_all(c_set, needles, range * 2, res));
+    for (std::size_t i = 0; i < range * 2; ++i) {
+      if (needles[i] < range) {
+        ASSERT_TRUE(res[i]);
+        ASSERT_EQ(res[i]->data, needles[i]);
+        ASSERT_EQ(res[i], lookup(c_set, needles[i]));
+      } else {
+        ASSERT_FALSE(res[i]);
+      }
+    }
+  }
+  ASSERT_EQ(std::int64_t(0), sp::GcStruct::active);
+}
+
+TEST(HashSetProbingTest, bench_lookup_all) {
+  using namespace std::chrono;
+  constexpr std::size_t range = 1024 * 1024 * 4;
+  constexpr std::size_t batch = 1024;
+
+  std::size_t *const keys = new std::size_t[range];
+  for (std::size_t i = 0; i < range; ++i) {
+    keys[i] = i * 0x9E3779B9;
+  }
+
+  {
+    sp::HashSetProbing<std::size_t> set;
+    const auto start = steady_clock::now();
+    for (std::size_t i = 0; i < range; ++i) {
+      insert(set, keys[i]);
+    }
+    const duration<double> secs = steady_clock::now() - start;
+    printf("insert:         %.3fs\n", secs.count());
+  }
+
+  sp::HashSetProbing<std::size_t> set;
+  {
+    const auto start = steady_clock::now();
+    for (std::size_t i = 0; i < range; i += batch) {
+      insert_all(set, keys + i, batch);
+    }
+    const duration<double> secs = steady_clock::now() - start;
+    printf("insert_all:     %.3fs\n", secs.count());
+  }
+  ASSERT_EQ(range, length(set));
+
+  prng::xorshift32 r(1);
+  sp::Array<std::size_t> shuffled(keys, range, range);
+  shuffle(r, shuffled);
+  const auto &c_set = set;
+
+  std::size_t found = 0;
+  {
+    const auto start = steady_clock::now();
+    for (std::size_t i = 0; i < range; ++i) {
+      found += lookup(c_set, keys[i]) != nullptr;
+    }
+    const duration<double> secs = steady_clock::now() - start;
+    printf("lookup:         %.3fs\n", secs.count());
+  }
+
+  {
+    const std::size_t *res[batch];
+    const auto start = steady_clock::now();
+    for (std::size_t i = 0; i < range; i += batch) {
+      found += lookup_all(c_set, keys + i, batch, res);
+    }
+    const duration<double> secs = steady_clock::now() - start;
+    printf("lookup_all:     %.3fs\n", secs.count());
+  }
+  ASSERT_EQ(range * 2, found);
+
+  delete[] keys;
+}
+
 // #if 0
 TEST(HashSetProbingTest, test_HashSetTree) {
   prng::xorshift32 r(1);
@@ -427,3 +655,168 @@ TEST(HashSetProbingTest, test_rand) {
 }
 
 // #endif
+
+namespace {
+struct HashSetProbingCollide {
+  std::size_t
+  operator()(int) const noexcept {
+    /* Same home slot and same h2 for every key */
+    return std::size_t(0x1235);
+  }
+};
+} // namespace
+
+TEST(HashSetProbingTest, test_group_collision) {
+  constexpr int range = 1024;
+  sp::HashSetProbing<int, HashSetProbingCollide> set;
+
+  for (int i = 0; i < range; ++i) {
+    ASSERT_FALSE(lookup(set, i));
+    int *const res = insert(set, i);
+    ASSERT_TRUE(res);
+    ASSERT_EQ(i, *res);
+    ASSERT_FALSE(insert(set, i));
+    ASSERT_EQ(std::size_t(i + 1), length(set));
+  }
+
+  for (int i = 0; i < range; ++i) {
+    int *const res = lookup(set, i);
+    ASSERT_TRUE(res);
+    ASSERT_EQ(i, *res);
+  }
+  ASSERT_FALSE(lookup(set, range));
+
+  for (int i = 0; i < range; i += 2) {
+    ASSERT_TRUE(remove(set, i));
+    ASSERT_FALSE(lookup(set, i));
+  }
+
+  for (int i = 0; i < range; ++i) {
+    int *const res = lookup(set, i);
+    if (i % 2 == 0) {
+      ASSERT_FALSE(res);
+    } else {
+      ASSERT_TRUE(res);
+      ASSERT_EQ(i, *res);
+    }
+  }
+
+  for (int i = 0; i < range; i += 2) {
+    ASSERT_TRUE(insert(set, i));
+  }
+  ASSERT_EQ(std::size_t(range), length(set));
+  ASSERT_EQ(std::size_t(range), sp::n::length(set));
+}
+
+template <typename SET>
+static std::size_t
+probe_histogram(const SET &set, std::size_t (&hist)[8],
+                std::size_t &max) noexcept {
+  using TT = typename SET::value_type;
+  using namespace sp::impl;
+
+  std::size_t total = 0;
+  max = 0;
+  for (auto &h : hist) {
+    h = 0;
+  }
+
+  for (std::size_t i = 0; i < capacity(set); ++i) {
+    if (sp::test(set.tags, i) == HSPTag_PRESENT) {
+      const TT *const current = (const TT *)&set.table[i];
+      sp::Hasher<TT> hash;
+      const std::size_t home = index_of(hsp_h1(hash(*current)), set.capacity);
+      const std::size_t dist = index_of(i + set.capacity - home, set.capacity);
+
+      std::size_t bucket = 0;
+      while (bucket < 7 && (std::size_t(1) << bucket) <= dist) {
+        ++bucket;
+      }
+      ++hist[bucket];
+
+      max = std::max(max, dist);
+      total += dist;
+    }
+  }
+
+  return total;
+}
+
+template <typename SET>
+static std::size_t
+print_probe_histogram(const char *ctx, const SET &set) noexcept {
+  std::size_t hist[8];
+  std::size_t max = 0;
+  const std::size_t total = probe_histogram(set, hist, max);
+  const double mean = length(set) ? double(total) / double(length(set)) : 0;
+
+  printf("%s: length[%zu] capacity[%zu] max[%zu] mean[%.2f]\n", ctx,
+         length(set), capacity(set), max, mean);
+  printf("  [0]:%zu [1]:%zu [2,4):%zu [4,8):%zu [8,16):%zu [16,32):%zu "
+         "[32,64):%zu [64,):%zu\n",
+         hist[0], hist[1], hist[2], hist[3], hist[4], hist[5], hist[6],
+         hist[7]);
+
+  return total;
+}
+
+TEST(HashSetProbingTest, bench_churn_probe_length) {
+  constexpr std::uint32_t live = 1024 * 40;
+  constexpr std::size_t rounds = 1024 * 512;
+  prng::xorshift32 r(1);
+
+  sp::HashSetProbing<std::uint32_t> set;
+  sp::UinDynamicArray<std::uint32_t> keys(live);
+
+  std::uint32_t next = 0;
+  for (std::uint32_t i = 0; i < live; ++i) {
+    ASSERT_TRUE(insert(set, next));
+    ASSERT_TRUE(push(keys, next));
+    ++next;
+  }
+  const std::size_t cap = capacity(set);
+  print_probe_histogram("before churn", set);
+
+  sp::TimerContext ctx;
+  sp::timer(ctx, [&]() {
+    for (std::size_t i = 0; i < rounds; ++i) {
+      const std::size_t idx = uniform_dist(r, 0, live);
+      ASSERT_TRUE(remove(set, keys[idx]));
+      ASSERT_TRUE(insert(set, next));
+      keys[idx] = next++;
+    }
+  });
+  printf("churn: ");
+  print(ctx);
+
+  const std::size_t churned = print_probe_histogram("after churn", set);
+
+  ASSERT_EQ(std::size_t(live), length(set));
+  ASSERT_EQ(cap, capacity(set));
+
+  std::size_t tombstones = 0;
+  for (std::size_t i = 0; i < capacity(set); ++i) {
+    if (sp::test(set.tags, i) == HSPTag_TOMBSTONE) {
+      ++tombstones;
+    }
+  }
+  ASSERT_EQ(std::size_t(0), tombstones);
+
+  for (std::size_t i = 0; i < live; ++i) {
+    const std::uint32_t *const res = lookup(set, keys[i]);
+    ASSERT_TRUE(res);
+    ASSERT_EQ(keys[i], *res);
+  }
+
+  /* A table with the same keys built from scratch, with backward shift
+   * deletion the churned table should be indistinguishable from it.
+   */
+  sp::HashSetProbing<std::uint32_t> fresh(cap);
+  for (std::size_t i = 0; i < live; ++i) {
+    ASSERT_TRUE(insert(fresh, keys[i]));
+  }
+  ASSERT_EQ(cap, capacity(fresh));
+  const std::size_t rebuilt = print_probe_histogram("rebuilt", fresh);
+
+  ASSERT_EQ(rebuilt, churned);
+}
@@ -0,0 +1,272 @@
+#include <test/gcstruct.h>
+
+#include <collection/Array.h>
+#include <gtest/gtest.h>
+#include <map/HashSetProbing.h>
+#include <map/HashSetRobinHood.h>
+#include <prng/xorshift.h>
+#include <util/Bitset.h>
+#include <util/Timer.h>
+
+TEST(HashSetRobinHoodTest, test_rand) {
+  prng::xorshift32 r(1581117242);
+
+  constexpr std::size_t range = (1024 * 4);
+  const std::uint32_t r_max = range;
+
+  const std::size_t length = sp::Bitset_number_of_buffer(range);
+  auto raw = new uint64_t[length];
+  ASSERT_TRUE(raw);
+  memset(raw, 0, length * sizeof(uint64_t));
+
+  sp::HashSetRobinHood<std::uint32_t> set;
+  sp::Bitset present(raw, length);
+  std::size_t inserted = 0;
+
+  for (std::size_t i = 0; i < range * 4; ++i) {
+    const std::uint32_t current = uniform_dist(r, 0, r_max);
+
+    const std::uint32_t *const l_before = lookup(set, current);
+    const std::uint32_t *const res = insert(set, current);
+    const std::uint32_t *const l_after = lookup(set, current);
+    ASSERT_FALSE(insert(set, current));
+
+    if (test(present, std::size_t(current))) {
+      ASSERT_FALSE(res);
+      ASSERT_TRUE(l_before);
+      ASSERT_EQ(l_before, l_after);
+
+      ASSERT_TRUE(remove(set, current));
+      ASSERT_FALSE(lookup(set, current));
+      ASSERT_FALSE(remove(set, current));
+      sp::set(present, std::size_t(current), false);
+      --inserted;
+    } else {
+      ASSERT_FALSE(l_before);
+      ASSERT_TRUE(res);
+      ASSERT_EQ(res, l_after);
+      ASSERT_EQ(current, *res);
+      sp::set(present, std::size_t(current), true);
+      ++inserted;
+    }
+
+    ASSERT_EQ(inserted, sp::length(set));
+    if (i % 64 == 0) {
+      ASSERT_TRUE(sp::rec::verify(set));
+    }
+  } // for
+
+  ASSERT_TRUE(sp::rec::verify(set));
+  ASSERT_EQ(inserted, sp::n::length(set));
+
+  for_each(present, [&set](std::size_t idx, bool v) {
+    const std::uint32_t in(idx);
+    const std::uint32_t *const res = lookup(set, in);
+    if (v) {
+      ASSERT_TRUE(res);
+      ASSERT_EQ(*res, in);
+      ASSERT_TRUE(remove(set, in));
+    } else {
+      ASSERT_FALSE(res);
+      ASSERT_FALSE(remove(set, in));
+    }
+    ASSERT_FALSE(lookup(set, in));
+  });
+
+  ASSERT_EQ(std::size_t(0), sp::length(set));
+  for (std::size_t i = 0; i < set.capacity; ++i) {
+    ASSERT_EQ(0, set.distance[i]);
+  }
+
+  delete[] raw;
+}
+
+TEST(HashSetRobinHoodTest, test_dtor) {
+  ASSERT_EQ(std::int64_t(0), sp::GcStruct::active);
+  {
+    sp::HashSetRobinHood<sp::GcStruct> set;
+    for (std::size_t i = 0; i < 1024; ++i) {
+      sp::GcStruct *const res = insert(set, i);
+      ASSERT_TRUE(res);
+      ASSERT_EQ(res->data, i);
+    }
+    ASSERT_EQ(std::int64_t(1024), sp::GcStruct::active);
+
+    for (std::size_t i = 0; i < 1024; i += 2) {
+      ASSERT_TRUE(remove(set, i));
+    }
+    ASSERT_EQ(std::int64_t(512), sp::GcStruct::active);
+
+    for (std::size_t i = 0; i < 1024; ++i) {
+      ASSERT_EQ(i % 2 == 1, lookup(set, i) != nullptr);
+    }
+    ASSERT_TRUE(sp::rec::verify(set));
+  }
+  ASSERT_EQ(std::int64_t(0), sp::GcStruct::active);
+}
+
+TEST(HashSetRobinHoodTest, test_upsert_compute) {
+  sp::HashSetRobinHood<int> set;
+  ASSERT_TRUE(upsert(set, 1));
+  ASSERT_TRUE(upsert(set, 1));
+  ASSERT_EQ(std::size_t(1), length(set));
+
+  bool computed = false;
+  int *res = lookup_compute(set, 2, [&computed](int &out, int in) {
+    computed = true;
+    new (&out) int(in);
+  });
+  ASSERT_TRUE(computed);
+  ASSERT_EQ(2, *res);
+
+  computed = false;
+  res = lookup_compute(set, 2, [&computed](int &, int) {
+    /**/
+    computed = true;
+  });
+  ASSERT_FALSE(computed);
+  ASSERT_EQ(2, *res);
+
+  ASSERT_EQ(lookup(set, 2), lookup_insert(set, 2));
+  ASSERT_TRUE(contains(set, 1));
+  ASSERT_FALSE(contains(set, 3));
+  ASSERT_EQ(std::size_t(2), length(set));
+}
+
+namespace {
+struct HashSetRobinHoodCollide {
+  std::size_t
+  operator()(int) const noexcept {
+    return std::size_t(0x1235);
+  }
+};
+} // namespace
+
+TEST(HashSetRobinHoodTest, test_collision) {
+  sp::HashSetRobinHood<int, HashSetRobinHoodCollide> set;
+  int i = 0;
+  for (; i < 1024; ++i) {
+    if (!insert(set, i)) {
+      break;
+    }
+    ASSERT_TRUE(lookup(set, i));
+  }
+  /* The probe distance is bounded, a degenerate hash fails instead of
+   * growing the table forever */
+  ASSERT_EQ(int(sp::impl::HSRH_MAX_DISTANCE + 1), i);
+  ASSERT_TRUE(sp::rec::verify(set));
+
+  for (int k = 0; k < i; ++k) {
+    ASSERT_TRUE(lookup(set, k));
+  }
+  ASSERT_FALSE(lookup(set, i));
+  ASSERT_TRUE(remove(set, 0));
+  ASSERT_TRUE(insert(set, i));
+  ASSERT_TRUE(sp::rec::verify(set));
+}
+
+TEST(HashSetRobinHoodTest, test_alloc_fail) {
+  /* the byte size of the table overflows, insert fails instead of crashing,
+   * rejected before anything is requested from the allocator */
+  sp::HashSetRobinHood<std::uint64_t> set(std::size_t(1) << 62);
+  ASSERT_FALSE(insert(set, std::uint64_t(1)));
+  ASSERT_FALSE(lookup(set, std::uint64_t(1)));
+  ASSERT_FALSE(remove(set, std::uint64_t(1)));
+  ASSERT_EQ(std::size_t(0), length(set));
+}
+
+TEST(HashSetRobinHoodTest, test_stats) {
+  sp::HashSetRobinHood<std::uint32_t> set(1024);
+  sp::HashSetRobinHoodStats st = stats(set);
+  ASSERT_EQ(std::size_t(0), st.length);
+  ASSERT_EQ(std::size_t(0), st.max_probe);
+
+  for (std::uint32_t i = 0; i < 1000; ++i) {
+    ASSERT_TRUE(insert(set, i));
+  }
+
+  st = stats(set);
+  ASSERT_EQ(std::size_t(1000), st.length);
+  ASSERT_EQ(std::size_t(1024), st.capacity);
+  ASSERT_EQ(double(1000) / double(1024), st.load_factor);
+  ASSERT_TRUE(st.mean_probe <= double(st.max_probe));
+  ASSERT_TRUE(st.max_probe <= sp::impl::HSRH_MAX_DISTANCE);
+}
+
+template <typename SET>
+static std::size_t
+probing_max_probe(const SET &set, double &mean) noexcept {
+  using TT = typename SET::value_type;
+  using namespace sp::impl;
+
+  std::size_t total = 0;
+  std::size_t max = 0;
+  for (std::size_t i = 0; i < capacity(set); ++i) {
+    if (sp::test(set.tags, i) == HSPTag_PRESENT) {
+      const TT *const current = (const TT *)&set.table[i];
+      sp::Hasher<TT> hash;
+      const std::size_t home = index_of(hsp_h1(hash(*current)), set.capacity);
+      const std::size_t dist = index_of(i + set.capacity - home, set.capacity);
+
+      max = std::max(max, dist);
+      total += dist;
+    }
+  }
+  mean = double(total) / double(length(set));
+
+  return max;
+}
+
+TEST(HashSetRobinHoodTest, bench_high_load) {
+  constexpr std::size_t cap = 1024 * 64;
+  /* 95% load */
+  constexpr std::uint32_t live = std::uint32_t((cap * 95) / 100);
+  prng::xorshift32 r(1);
+
+  sp::HashSetRobinHood<std::uint32_t> rh(cap);
+  sp::HashSetProbing<std::uint32_t> probing(cap);
+  sp::UinDynamicArray<std::uint32_t> keys(live);
+
+  for (std::uint32_t i = 0; i < live; ++i) {
+    const std::uint32_t key = random(r);
+    if (insert(rh, key)) {
+      ASSERT_TRUE(insert(probing, key));
+      ASSERT_TRUE(push(keys, key));
+    }
+  }
+  ASSERT_EQ(cap, capacity(rh));
+  ASSERT_EQ(cap, capacity(probing));
+
+  const sp::HashSetRobinHoodStats st = stats(rh);
+  double p_mean = 0;
+  const std::size_t p_max = probing_max_probe(probing, p_mean);
+  printf("load[%.2f]\n", st.load_factor);
+  printf("RobinHood: max[%zu] mean[%.2f]\n", st.max_probe, st.mean_probe);
+  printf("Probing:   max[%zu] mean[%.2f]\n", p_max, p_mean);
+
+  /* Robin Hood does not change the mean, it bounds the worst case */
+  ASSERT_TRUE(st.max_probe <= p_max);
+
+  std::size_t found = 0;
+  sp::TimerContext ctx;
+  sp::timer(ctx, [&]() {
+    for (std::size_t i = 0; i < length(keys); ++i) {
+      found += lookup(rh, keys[i]) != nullptr;
+      found += lookup(rh, ~keys[i]) != nullptr;
+    }
+  });
+  printf("RobinHood lookup: ");
+  print(ctx);
+
+  sp::TimerContext p_ctx;
+  sp::timer(p_ctx, [&]() {
+    for (std::size_t i = 0; i < length(keys); ++i) {
+      found += lookup(probing, keys[i]) != nullptr;
+      found += lookup(probing, ~keys[i]) != nullptr;
+    }
+  });
+  printf("Probing lookup:   ");
+  print(p_ctx);
+
+  ASSERT_TRUE(found >= 2 * length(keys));
+}
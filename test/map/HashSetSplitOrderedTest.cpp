@@ -0,0 +1,349 @@
+#include <test/gcstruct.h>
+
+#include <concurrent/Barrier.h>
+#include <gtest/gtest.h>
+#include <map/HashSetSplitOrdered.h>
+#include <prng/util.h>
+#include <prng/xorshift.h>
+#include <util/Bitset.h>
+
+#include <atomic>
+#include <pthread.h>
+
+TEST(HashSetSplitOrderedTest, test_rand) {
+  prng::xorshift32 r(1581117242);
+
+  constexpr std::size_t range = (1024 * 4);
+  const std::uint32_t r_max = range;
+
+  const std::size_t length = sp::Bitset_number_of_buffer(range);
+  auto raw = new uint64_t[length];
+  ASSERT_TRUE(raw);
+  memset(raw, 0, length * sizeof(uint64_t));
+
+  sp::HashSetSplitOrdered<std::uint32_t> set;
+  sp::Bitset present(raw, length);
+  std::size_t inserted = 0;
+
+  for (std::size_t i = 0; i < range * 4; ++i) {
+    const std::uint32_t current = uniform_dist(r, 0, r_max);
+
+    const std::uint32_t *const l_before = lookup(set, current);
+    const std::uint32_t *const res = insert(set, current);
+    const std::uint32_t *const l_after = lookup(set, current);
+    ASSERT_FALSE(insert(set, current));
+
+    if (test(present, std::size_t(current))) {
+      ASSERT_FALSE(res);
+      ASSERT_TRUE(l_before);
+      ASSERT_EQ(l_before, l_after);
+
+      ASSERT_TRUE(remove(set, current));
+      ASSERT_FALSE(lookup(set, current));
+      ASSERT_FALSE(remove(set, current));
+      sp::set(present, std::size_t(current), false);
+      --inserted;
+    } else {
+      ASSERT_FALSE(l_before);
+      ASSERT_TRUE(res);
+      ASSERT_EQ(res, l_after);
+      ASSERT_EQ(current, *res);
+      sp::set(present, std::size_t(current), true);
+      ++inserted;
+    }
+
+    ASSERT_EQ(inserted, sp::length(set));
+    if (i % 256 == 0) {
+      ASSERT_TRUE(sp::rec::verify(set));
+    }
+  } // for
+
+  ASSERT_TRUE(sp::rec::verify(set));
+  ASSERT_EQ(inserted, sp::n::length(set));
+
+  for_each(present, [&set](std::size_t idx, bool v) {
+    const std::uint32_t in(idx);
+    const std::uint32_t *const res = lookup(set, in);
+    if (v) {
+      ASSERT_TRUE(res);
+      ASSERT_EQ(*res, in);
+      ASSERT_TRUE(remove(set, in));
+    } else {
+      ASSERT_FALSE(res);
+      ASSERT_FALSE(remove(set, in));
+    }
+    ASSERT_FALSE(lookup(set, in));
+  });
+
+  ASSERT_EQ(std::size_t(0), sp::length(set));
+  ASSERT_EQ(std::size_t(0), sp::n::length(set));
+
+  delete[] raw;
+}
+
+TEST(HashSetSplitOrderedTest, test_dtor) {
+  ASSERT_EQ(std::int64_t(0), sp::GcStruct::active);
+  {
+    sp::HashSetSplitOrdered<sp::GcStruct> set;
+    for (std::size_t i = 0; i < 1024; ++i) {
+      sp::GcStruct *const res = insert(set, i);
+      ASSERT_TRUE(res);
+      ASSERT_EQ(res->data, i);
+      ASSERT_FALSE(insert(set, i));
+    }
+    ASSERT_EQ(std::int64_t(1024), sp::GcStruct::active);
+
+    for (std::size_t i = 0; i < 1024; i += 2) {
+      ASSERT_TRUE(remove(set, i));
+    }
+    /* without concurrent readers only the last removed entry is still
+     * waiting for its epoch to pass */
+    ASSERT_EQ(std::int64_t(512 + 1), sp::GcStruct::active);
+
+    for (std::size_t i = 0; i < 1024; ++i) {
+      ASSERT_EQ(i % 2 == 1, contains(set, i));
+    }
+    ASSERT_TRUE(sp::rec::verify(set));
+  }
+  ASSERT_EQ(std::int64_t(0), sp::GcStruct::active);
+}
+
+template <typename T, typename H, typename Eq>
+static std::size_t
+split_ordered_retired(const sp::HashSetSplitOrdered<T, H, Eq> &set) {
+  std::size_t result = 0;
+  for (const auto &stack : set.retired) {
+    for (auto *it = stack.load(); it; it = it->retired) {
+      ++result;
+    }
+  }
+  return result;
+}
+
+TEST(HashSetSplitOrderedTest, test_churn) {
+  ASSERT_EQ(std::int64_t(0), sp::GcStruct::active);
+  {
+    sp::HashSetSplitOrdered<sp::GcStruct> set;
+    for (std::size_t round = 0; round < 1024 * 4; ++round) {
+      for (std::size_t i = 0; i < 16; ++i) {
+        ASSERT_TRUE(insert(set, (round * 16) + i));
+      }
+      for (std::size_t i = 0; i < 16; ++i) {
+        ASSERT_TRUE(remove(set, (round * 16) + i));
+      }
+
+      /* the memory in use does not grow with the number of removes */
+      ASSERT_TRUE(sp::GcStruct::active <= 2);
+      ASSERT_TRUE(split_ordered_retired(set) <= 2);
+    }
+
+    std::size_t found = 0;
+    ASSERT_TRUE(insert(set, std::size_t(1)));
+    ASSERT_TRUE(lookup(set, std::size_t(1), [&found](const sp::GcStruct &v) {
+      /**/
+      found = v.data;
+    }));
+    ASSERT_EQ(std::size_t(1), found);
+    ASSERT_FALSE(lookup(set, std::size_t(2), [](const sp::GcStruct &) {}));
+  }
+  ASSERT_EQ(std::int64_t(0), sp::GcStruct::active);
+}
+
+namespace {
+struct HashSetSplitOrderedArg {
+  sp::Barrier *b;
+  sp::HashSetSplitOrdered<std::uint32_t> *set;
+  std::atomic<bool> *done;
+  std::uint32_t id;
+  std::uint32_t ops;
+  std::size_t missing;
+
+  HashSetSplitOrderedArg() noexcept
+      : b{nullptr}
+      , set{nullptr}
+      , done{nullptr}
+      , id{0}
+      , ops{0}
+      , missing{0} {
+  }
+};
+} // namespace
+
+static constexpr std::uint32_t split_ordered_stable = 1024;
+
+static void *
+split_ordered_writer(void *a) {
+  auto arg = reinterpret_cast<HashSetSplitOrderedArg *>(a);
+  auto &set = *arg->set;
+  arg->b->await();
+
+  const std::uint32_t base = split_ordered_stable + (arg->id * arg->ops);
+  for (std::uint32_t i = 0; i < arg->ops; ++i) {
+    if (!insert(set, base + i)) {
+      ++arg->missing;
+    }
+  }
+
+  for (std::uint32_t i = 0; i < arg->ops; i += 2) {
+    if (!remove(set, base + i)) {
+      ++arg->missing;
+    }
+  }
+
+  return nullptr;
+}
+
+static void *
+split_ordered_reader(void *a) {
+  auto arg = reinterpret_cast<HashSetSplitOrderedArg *>(a);
+  const auto &set = *arg->set;
+  arg->b->await();
+
+  /* The stable keys must be visible during the whole time the table grows */
+  do {
+    for (std::uint32_t i = 0; i < split_ordered_stable; ++i) {
+      const std::uint32_t *const res = lookup(set, i);
+      if (!res || *res != i) {
+        ++arg->missing;
+      }
+    }
+  } while (!arg->done->load());
+
+  return nullptr;
+}
+
+TEST(HashSetSplitOrderedTest, test_threaded) {
+  constexpr std::size_t writers = 4;
+  constexpr std::size_t readers = 4;
+  constexpr std::uint32_t ops = 1024 * 8;
+
+  sp::HashSetSplitOrdered<std::uint32_t> set(2);
+  for (std::uint32_t i = 0; i < split_ordered_stable; ++i) {
+    ASSERT_TRUE(insert(set, i));
+  }
+  const std::size_t buckets_before = set.buckets.load();
+
+  std::atomic<bool> done(false);
+  sp::Barrier b(writers + readers);
+  pthread_t ts[writers + readers];
+  HashSetSplitOrderedArg args[writers + readers];
+
+  for (std::size_t i = 0; i < writers + readers; ++i) {
+    args[i].b = &b;
+    args[i].set = &set;
+    args[i].done = &done;
+    args[i].id = std::uint32_t(i);
+    args[i].ops = ops;
+    auto worker = i < writers ? split_ordered_writer : split_ordered_reader;
+    ASSERT_EQ(0, pthread_create(&ts[i], nullptr, worker, &args[i]));
+  }
+
+  for (std::size_t i = 0; i < writers; ++i) {
+    ASSERT_EQ(0, pthread_join(ts[i], nullptr));
+  }
+  done.store(true);
+  for (std::size_t i = writers; i < writers + readers; ++i) {
+    ASSERT_EQ(0, pthread_join(ts[i], nullptr));
+  }
+
+  for (std::size_t i = 0; i < writers + readers; ++i) {
+    ASSERT_EQ(std::size_t(0), args[i].missing);
+  }
+
+  ASSERT_TRUE(set.buckets.load() > buckets_before);
+  ASSERT_TRUE(sp::rec::verify(set));
+
+  const std::size_t expected = split_ordered_stable + (writers * ops) / 2;
+  ASSERT_EQ(expected, length(set));
+  ASSERT_EQ(expected, sp::n::length(set));
+
+  for (std::uint32_t t = 0; t < writers; ++t) {
+    const std::uint32_t base = split_ordered_stable + (t * ops);
+    for (std::uint32_t i = 0; i < ops; ++i) {
+      ASSERT_EQ(i % 2 == 1, contains(set, base + i));
+    }
+  }
+}
+
+static constexpr std::uint32_t split_ordered_churn = 256;
+
+static void *
+split_ordered_churner(void *a) {
+  auto arg = reinterpret_cast<HashSetSplitOrderedArg *>(a);
+  auto &set = *arg->set;
+  arg->b->await();
+
+  for (std::uint32_t i = 0; i < arg->ops; ++i) {
+    const std::uint32_t key = (i + arg->id * 7) % split_ordered_churn;
+    if (!insert(set, key)) {
+      remove(set, key);
+    }
+  }
+
+  return nullptr;
+}
+
+static void *
+split_ordered_churn_reader(void *a) {
+  auto arg = reinterpret_cast<HashSetSplitOrderedArg *>(a);
+  const auto &set = *arg->set;
+  arg->b->await();
+
+  /* entries are removed and reclaimed while they are being read */
+  do {
+    for (std::uint32_t i = 0; i < split_ordered_churn; ++i) {
+      lookup(set, i, [arg, i](const std::uint32_t &v) {
+        if (v != i) {
+          ++arg->missing;
+        }
+      });
+    }
+  } while (!arg->done->load());
+
+  return nullptr;
+}
+
+TEST(HashSetSplitOrderedTest, test_threaded_churn) {
+  constexpr std::size_t writers = 4;
+  constexpr std::size_t readers = 4;
+  constexpr std::uint32_t ops = 1024 * 64;
+
+  sp::HashSetSplitOrdered<std::uint32_t> set;
+
+  std::atomic<bool> done(false);
+  sp::Barrier b(writers + readers);
+  pthread_t ts[writers + readers];
+  HashSetSplitOrderedArg args[writers + readers];
+
+  for (std::size_t i = 0; i < writers + readers; ++i) {
+    args[i].b = &b;
+    args[i].set = &set;
+    args[i].done = &done;
+    args[i].id = std::uint32_t(i);
+    args[i].ops = ops;
+    auto worker =
+        i < writers ? split_ordered_churner : split_ordered_churn_reader;
+    ASSERT_EQ(0, pthread_create(&ts[i], nullptr, worker, &args[i]));
+  }
+
+  for (std::size_t i = 0; i < writers; ++i) {
+    ASSERT_EQ(0, pthread_join(ts[i], nullptr));
+  }
+  done.store(true);
+  for (std::size_t i = writers; i < writers + readers; ++i) {
+    ASSERT_EQ(0, pthread_join(ts[i], nullptr));
+  }
+
+  for (std::size_t i = 0; i < writers + readers; ++i) {
+    ASSERT_EQ(std::size_t(0), args[i].missing);
+  }
+  ASSERT_TRUE(sp::rec::verify(set));
+  ASSERT_EQ(length(set), sp::n::length(set));
+
+  /* once quiescent the retired entries are reclaimed by the next writes */
+  for (std::uint32_t i = 0; i < split_ordered_churn; ++i) {
+    remove(set, i);
+  }
+  ASSERT_TRUE(split_ordered_retired(set) <= 2);
+  ASSERT_EQ(std::size_t(0), length(set));
+}
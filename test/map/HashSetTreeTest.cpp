@@ -815,3 +815,109 @@ TEST(HashSetTreeTest, hasherxx) {
     printf("unsigned char: %zu\n", hash);
   }
 }
+
+TEST(HashSetTreeTest, test_node_layout) {
+  using Node = sp::impl::HSNode<std::uint32_t>;
+  constexpr std::uint32_t range = 1024 * 16;
+
+  sp::HashSetTree<std::uint32_t> set;
+  ASSERT_TRUE(insert(set, std::uint32_t(0)));
+
+  /* A node starts small and grows on demand */
+  std::size_t nodes = 0;
+  binary::rec::inorder(set.tree, [&nodes](const Node &node) {
+    ASSERT_EQ(Node::min_capacity, node.capacity);
+    ++nodes;
+  });
+  ASSERT_EQ(std::size_t(1), nodes);
+
+  for (std::uint32_t i = 1; i < range; ++i) {
+    ASSERT_TRUE(insert(set, i));
+  }
+  ASSERT_TRUE(sp::rec::verify(set));
+
+  nodes = 0;
+  std::size_t slots = 0;
+  binary::rec::inorder(set.tree, [&nodes, &slots](const Node &node) {
+    ASSERT_TRUE(node.capacity <= Node::max_capacity);
+    ASSERT_TRUE(node.entries < node.capacity);
+    slots += node.capacity;
+    ++nodes;
+  });
+  printf("nodes[%zu] slots[%zu] entries[%u]\n", nodes, slots, range);
+  ASSERT_TRUE(nodes > 1);
+
+  for (std::uint32_t i = 0; i < range; i += 2) {
+    ASSERT_TRUE(remove(set, i));
+    ASSERT_FALSE(remove(set, i));
+  }
+  ASSERT_TRUE(sp::rec::verify(set));
+  ASSERT_EQ(std::size_t(range / 2), sp::rec::length(set));
+
+  for (std::uint32_t i = 0; i < range; ++i) {
+    const std::uint32_t *const res = lookup(set, i);
+    if (i % 2 == 0) {
+      ASSERT_FALSE(res);
+    } else {
+      ASSERT_TRUE(res);
+      ASSERT_EQ(i, *res);
+    }
+  }
+}
+
+namespace {
+/* every key has the same low bits, all keys share home slot at any capacity */
+struct HashSetTreeColliding {
+  std::size_t
+  operator()(std::uint32_t in) const noexcept {
+    return std::size_t(in) << 8;
+  }
+};
+} // namespace
+
+TEST(HashSetTreeTest, test_node_tags) {
+  using Node = sp::impl::HSNode<std::uint32_t>;
+  constexpr std::uint32_t range = 1024 * 4;
+
+  sp::HashSetTree<std::uint32_t, HashSetTreeColliding> set;
+  for (std::uint32_t i = 0; i < range; ++i) {
+    ASSERT_TRUE(insert(set, i));
+  }
+  ASSERT_TRUE(sp::rec::verify(set));
+  ASSERT_EQ(std::size_t(range), sp::rec::length(set));
+
+  /* the tag of colliding keys differs even when the index uses 7 bits or more
+   */
+  std::size_t large = 0;
+  binary::rec::inorder(set.tree, [&large](const Node &node) {
+    if (node.capacity >= 128) {
+      sp::StaticBitset<256 / 64> tags;
+      std::size_t distinct = 0;
+      for (std::size_t i = 0; i < node.capacity; ++i) {
+        if (node.tags[i] && !sp::set(tags, node.tags[i], true)) {
+          ++distinct;
+        }
+      }
+      ASSERT_TRUE(distinct > 1);
+      ++large;
+    }
+  });
+  ASSERT_TRUE(large > 0);
+
+  for (std::uint32_t i = 0; i < range * 2; ++i) {
+    const std::uint32_t *const res = lookup(set, i);
+    if (i < range) {
+      ASSERT_TRUE(res);
+      ASSERT_EQ(i, *res);
+    } else {
+      ASSERT_FALSE(res);
+    }
+  }
+
+  for (std::uint32_t i = 0; i < range; i += 2) {
+    ASSERT_TRUE(remove(set, i));
+  }
+  for (std::uint32_t i = 0; i < range; ++i) {
+    ASSERT_EQ(i % 2 == 1, contains(set, i));
+  }
+}
@@ -5,28 +5,117 @@
 #include <map/ProbingHashMap.h>
 #include <prng/xorshift.h>
 
+#include <chrono>
+
 TEST(ProbingHashMapTest, test_map) {
   // sp::ProbingHashMap<int, int> h;
   // assertx(false);
 }
 
-#if 0
+static std::size_t
+static_set_hash(const std::size_t &in) noexcept {
+  return fnv_1a::encode64(&in, sizeof(in));
+}
 
-TEST(ProbingHashMapTest, test_static_set) {
-  sp::UinStaticArray<std::size_t, 1024> arr;
-  using Set = sp::StaticProbingHashSet<std::size_t, arr.capacity,
-                                       fnv_1a::hash<std::size_t>>;
-  for (std::size_t i = 0; i < capacity(arr); ++i) {
-    ASSERT_TRUE(insert(arr, i));
+template <sp::StaticHashBuild build>
+static void
+test_static_set() {
+  constexpr std::size_t cap = 1024;
+  auto arr = new sp::UinStaticArray<std::size_t, cap>;
+  using Set = sp::StaticProbingHashSet<std::size_t, cap, static_set_hash>;
+  for (std::size_t i = 0; i < capacity(*arr); ++i) {
+    ASSERT_TRUE(insert(*arr, i * 2));
   }
   prng::xorshift32 r(1);
-  shuffle(r, arr);
+  shuffle(r, *arr);
 
-  Set set(arr);
-  for (std::size_t i = 0; i < length(arr); ++i) {
-    auto *res = lookup(set, i);
+  auto set = new Set(*arr, build);
+  ASSERT_EQ(build == sp::StaticHashBuild::PERFECT, set->perfect.valid);
+  for (std::size_t i = 0; i < length(*arr); ++i) {
+    const std::size_t *res = lookup(*set, i * 2);
     ASSERT_TRUE(res);
-    ASSERT_EQ(*res, i);
+    ASSERT_EQ(*res, i * 2);
+    ASSERT_FALSE(lookup(*set, (i * 2) + 1));
   }
+
+  delete set;
+  delete arr;
+}
+
+TEST(ProbingHashMapTest, test_static_set) {
+  test_static_set<sp::StaticHashBuild::PROBING>();
+}
+
+TEST(ProbingHashMapTest, test_static_set_perfect) {
+  test_static_set<sp::StaticHashBuild::PERFECT>();
+}
+
+TEST(ProbingHashMapTest, test_static_set_perfect_partial) {
+  sp::UinStaticArray<std::size_t, 64> arr;
+  using Set = sp::StaticProbingHashSet<std::size_t, 64, static_set_hash>;
+  for (std::size_t i = 0; i < 40; ++i) {
+    ASSERT_TRUE(insert(arr, i));
+  }
+
+  Set set(arr, sp::StaticHashBuild::PERFECT);
+  ASSERT_TRUE(set.perfect.valid);
+  std::size_t used = 0;
+  for (std::size_t i = 0; i < 64; ++i) {
+    const std::size_t *res = lookup(set, i);
+    ASSERT_EQ(i < 40, res != nullptr);
+    used += set.table[i] != nullptr;
+  }
+  ASSERT_EQ(std::size_t(40), used);
+}
+
+TEST(ProbingHashMapTest, test_perfect_hash_constexpr) {
+  static constexpr std::size_t hashes[] = {
+      0x1f3a, 0x77, 0xdead, 0xbeef, 0x1234, 0xffff0000, 42, 7, 1, 0,
+  };
+  constexpr auto ph = sp::perfect_hash(hashes);
+  static_assert(ph.valid, "");
+
+  constexpr std::size_t n = sizeof(hashes) / sizeof(hashes[0]);
+  bool seen[n] = {};
+  for (std::size_t i = 0; i < n; ++i) {
+    const std::size_t idx = slot(ph, hashes[i]);
+    ASSERT_TRUE(idx < n);
+    ASSERT_FALSE(seen[idx]);
+    seen[idx] = true;
+  }
+
+  static constexpr std::size_t duplicate[] = {1, 2, 3, 2};
+  static_assert(!sp::perfect_hash(duplicate).valid, "");
+}
+
+template <sp::StaticHashBuild build>
+static void
+bench_static_set(const char *name) {
+  constexpr std::size_t cap = 1024 * 16;
+  auto arr = new sp::UinStaticArray<std::size_t, cap>;
+  using Set = sp::StaticProbingHashSet<std::size_t, cap, static_set_hash>;
+  for (std::size_t i = 0; i < (cap / 4) * 3; ++i) {
+    insert(*arr, i);
+  }
+
+  auto set = new Set(*arr, build);
+  const auto start = std::chrono::steady_clock::now();
+  std::size_t found = 0;
+  for (std::size_t k = 0; k < 64; ++k) {
+    for (std::size_t i = 0; i < cap * 2; ++i) {
+      found += lookup(*set, i) != nullptr;
+    }
+  }
+  const std::chrono::duration<double> secs =
+      std::chrono::steady_clock::now() - start;
+  printf("%s: %.3fs found[%zu]\n", name, secs.count(), found);
+
+  delete set;
+  delete arr;
+}
+
+TEST(ProbingHashMapTest, bench_static_set) {
+  /* 75% load, 5/8 of the lookups are misses */
+  bench_static_set<sp::StaticHashBuild::PROBING>("probing");
+  bench_static_set<sp::StaticHashBuild::PERFECT>("perfect");
 }
-#endif
@@ -0,0 +1,244 @@
+#include <chrono>
+#include <collection/Array.h>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <prng/util.h>
+#include <prng/xorshift.h>
+#include <string/aho_corasick_search.h>
+#include <string/boyer_moore_horspool_search.h>
+#include <string/naive_search.h>
+
+namespace {
+struct AcMatch {
+  const char *it;
+  std::size_t pattern;
+
+  AcMatch() noexcept
+      : it{nullptr}
+      , pattern{0} {
+  }
+  AcMatch(const char *i, std::size_t p) noexcept
+      : it{i}
+      , pattern{p} {
+  }
+};
+} // namespace
+
+TEST(aho_corasick_searchTest, test) {
+  const char *const patterns[] = {"he", "she", "his", "hers"};
+  sp::ac::AhoCorasick ac;
+  ASSERT_TRUE(build(ac, patterns, 4));
+
+  const char *const text = "ushers";
+  sp::StaticArray<AcMatch, 16> matches;
+  const std::size_t res = search(ac, text, std::strlen(text),
+                                 [&](const char *it, std::size_t p) {
+                                   /**/
+                                   ASSERT_TRUE(push(matches, AcMatch(it, p)));
+                                 });
+  ASSERT_EQ(std::size_t(3), res);
+  ASSERT_EQ(res, length(matches));
+
+  /* "she" and "he" end at the same position, longest first */
+  ASSERT_EQ(text + 1, matches[0].it);
+  ASSERT_EQ(std::size_t(1), matches[0].pattern);
+  ASSERT_EQ(text + 2, matches[1].it);
+  ASSERT_EQ(std::size_t(0), matches[1].pattern);
+  ASSERT_EQ(text + 2, matches[2].it);
+  ASSERT_EQ(std::size_t(3), matches[2].pattern);
+
+  std::size_t pattern = 99;
+  ASSERT_EQ(text + 1, search(ac, text, std::strlen(text), pattern));
+  ASSERT_EQ(std::size_t(1), pattern);
+  ASSERT_EQ(nullptr, search(ac, "xyz", 3, pattern));
+}
+
+TEST(aho_corasick_searchTest, test_empty_and_duplicate) {
+  {
+    sp::ac::AhoCorasick ac;
+    ASSERT_TRUE(build(ac, nullptr, 0));
+    ASSERT_EQ(std::size_t(0),
+              search(ac, "abc", 3, [](const char *, std::size_t) {}));
+
+    const char *const empty[] = {"a", ""};
+    ASSERT_FALSE(build(ac, empty, 2));
+    ASSERT_EQ(std::size_t(0),
+              search(ac, "abc", 3, [](const char *, std::size_t) {}));
+  }
+  {
+    const char *const patterns[] = {"aa", "a", "aa"};
+    sp::ac::AhoCorasick ac;
+    ASSERT_TRUE(build(ac, patterns, 3));
+
+    std::size_t count[3] = {0};
+    const std::size_t res =
+        search(ac, "aaaa", 4, [&](const char *, std::size_t p) {
+          /**/
+          ++count[p];
+        });
+    ASSERT_EQ(std::size_t(3 + 4 + 3), res);
+    ASSERT_EQ(std::size_t(3), count[0]);
+    ASSERT_EQ(std::size_t(4), count[1]);
+    ASSERT_EQ(std::size_t(3), count[2]);
+  }
+}
+
+static std::size_t
+ac_naive_count(const char *text, std::size_t tlen, const char *needle,
+               std::size_t nlen) noexcept {
+  std::size_t result = 0;
+  const char *it = text;
+  const char *const end = text + tlen;
+  while ((it = sp::naive::search(it, std::size_t(end - it), needle, nlen))) {
+    ++result;
+    ++it;
+  }
+  return result;
+}
+
+TEST(aho_corasick_searchTest, test_rand) {
+  prng::xorshift32 r(1);
+  constexpr std::size_t length = 1024 * 64;
+  constexpr std::size_t n = 200;
+
+  /* small alphabet to get a lot of overlapping matches */
+  char *const text = new char[length];
+  for (std::size_t i = 0; i < length; ++i) {
+    text[i] = char('a' + uniform_dist(r, 0, 4));
+  }
+
+  const char *patterns[n];
+  std::size_t lengths[n];
+  for (std::size_t i = 0; i < n; ++i) {
+    lengths[i] = uniform_dist(r, 1, 9);
+    patterns[i] = text + uniform_dist(r, 0, std::uint32_t(length - lengths[i]));
+  }
+
+  sp::ac::AhoCorasick ac;
+  ASSERT_TRUE(build(ac, patterns, lengths, n));
+
+  std::size_t *const count = new std::size_t[n]();
+  std::size_t matches = search(ac, text, length, //
+                               [&](const char *it, std::size_t p) {
+                                 ASSERT_EQ(0, std::memcmp(it, patterns[p],
+                                                          lengths[p]));
+                                 ++count[p];
+                               });
+
+  std::size_t expected = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    const std::size_t c = ac_naive_count(text, length, patterns[i], lengths[i]);
+    ASSERT_EQ(c, count[i]);
+    expected += c;
+  }
+  ASSERT_EQ(expected, matches);
+
+  delete[] count;
+  delete[] text;
+}
+
+TEST(aho_corasick_searchTest, test_stream) {
+  prng::xorshift32 r(3);
+  constexpr std::size_t length = 1024 * 16;
+  constexpr std::size_t n = 50;
+
+  char *const text = new char[length];
+  for (std::size_t i = 0; i < length; ++i) {
+    text[i] = char('a' + uniform_dist(r, 0, 3));
+  }
+
+  const char *patterns[n];
+  std::size_t lengths[n];
+  for (std::size_t i = 0; i < n; ++i) {
+    lengths[i] = uniform_dist(r, 1, 20);
+    patterns[i] = text + uniform_dist(r, 0, std::uint32_t(length - lengths[i]));
+  }
+
+  sp::ac::AhoCorasick ac;
+  ASSERT_TRUE(build(ac, patterns, lengths, n));
+
+  std::uint64_t whole = 0;
+  const std::size_t expected =
+      search(ac, text, length, [&](const char *it, std::size_t p) {
+        whole += std::uint64_t(it - text) * (p + 1);
+      });
+
+  /* the same matches at the same absolute offsets when chunked */
+  sp::ac::Stream stream(ac);
+  std::uint64_t chunked = 0;
+  std::size_t matches = 0;
+  std::size_t i = 0;
+  while (i < length) {
+    const std::size_t l =
+        std::min(std::size_t(uniform_dist(r, 0, 32)), length - i);
+    matches += update(stream, text + i, l, [&](std::uint64_t o, std::size_t p) {
+      ASSERT_EQ(0, std::memcmp(text + o, patterns[p], lengths[p]));
+      chunked += o * (p + 1);
+    });
+    i += l;
+  }
+
+  ASSERT_EQ(expected, matches);
+  ASSERT_EQ(whole, chunked);
+  ASSERT_EQ(std::uint64_t(length), stream.offset);
+
+  delete[] text;
+}
+
+TEST(aho_corasick_searchTest, bench_vs_bmh) {
+  prng::xorshift32 r(2);
+  constexpr std::size_t length = 1024 * 1024 * 4;
+  constexpr std::size_t n = 256;
+
+  char *const text = new char[length];
+  for (std::size_t i = 0; i < length; ++i) {
+    text[i] = char(uniform_dist(r, ' ', '~' + 1));
+  }
+
+  char *const storage = new char[n * 16];
+  const char *patterns[n];
+  std::size_t lengths[n];
+  for (std::size_t i = 0; i < n; ++i) {
+    lengths[i] = uniform_dist(r, 6, 16);
+    std::memcpy(storage + (i * 16),
+                text + uniform_dist(r, 0, std::uint32_t(length - lengths[i])), lengths[i]);
+    patterns[i] = storage + (i * 16);
+  }
+
+  sp::ac::AhoCorasick ac;
+  auto start = std::chrono::steady_clock::now();
+  ASSERT_TRUE(build(ac, patterns, lengths, n));
+  auto end = std::chrono::steady_clock::now();
+  const std::chrono::duration<double> build_secs = end - start;
+
+  start = std::chrono::steady_clock::now();
+  const std::size_t ac_matches =
+      search(ac, text, length, [](const char *, std::size_t) {});
+  end = std::chrono::steady_clock::now();
+  const std::chrono::duration<double> ac_secs = end - start;
+
+  start = std::chrono::steady_clock::now();
+  std::size_t bmh_matches = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    const char *it = text;
+    const char *const t_end = text + length;
+    while ((it = sp::bmh::search(it, std::size_t(t_end - it), patterns[i],
+                                 lengths[i]))) {
+      ++bmh_matches;
+      ++it;
+    }
+  }
+  end = std::chrono::steady_clock::now();
+  const std::chrono::duration<double> bmh_secs = end - start;
+
+  ASSERT_EQ(bmh_matches, ac_matches);
+  printf("%zu patterns, states: %zu, alphabet: %zu, build: %.2fms\n", n,
+         ac.states, ac.alphabet, build_secs.count() * 1000);
+  printf("aho-corasick: %.2f MB/s\n",
+         double(length) / ac_secs.count() / 1024 / 1024);
+  printf("bmh loop:     %.2f MB/s\n",
+         double(length) / bmh_secs.count() / 1024 / 1024);
+
+  delete[] storage;
+  delete[] text;
+}
@@ -1,4 +1,7 @@
+#include <chrono>
+#include <cstring>
 #include <gtest/gtest.h>
+#include <limits>
 #include <prng/util.h>
 #include <prng/xorshift.h>
 #include <string/levenshtein.h>
@@ -56,3 +59,121 @@ TEST(levenshteinTest, test_speed2) {
 TEST(levenshteinTest, test_mem_speed) {
   test_speed(ascii::dp::levenshtein);
 }
+
+TEST(levenshteinTest, test_myers) {
+  test_cases([](const char *a, const char *b) {
+    /**/
+    return ascii::myers::levenshtein(a, b);
+  });
+}
+
+TEST(levenshteinTest, test_bounded) {
+  test_cases([](const char *a, const char *b) {
+    /**/
+    return ascii::levenshtein_bounded(a, b, 100);
+  });
+
+  ASSERT_EQ(std::size_t(3), ascii::levenshtein_bounded("kitten", "sitting", 3));
+  ASSERT_EQ(std::size_t(3), ascii::levenshtein_bounded("kitten", "sitting", 2));
+  ASSERT_EQ(std::size_t(2), ascii::levenshtein_bounded("kitten", "sitting", 1));
+  ASSERT_EQ(std::size_t(1), ascii::levenshtein_bounded("", "four", 0));
+  ASSERT_EQ(std::size_t(0), ascii::levenshtein_bounded("", "", 0));
+
+  /* $k larger than any possible distance */
+  const std::size_t max = std::numeric_limits<std::size_t>::max();
+  ASSERT_EQ(std::size_t(3),
+            ascii::levenshtein_bounded("kitten", "sitting", max));
+  ASSERT_EQ(std::size_t(3),
+            ascii::levenshtein_bounded("kitten", "sitting", max - 1));
+  ASSERT_EQ(std::size_t(3),
+            ascii::levenshtein_bounded("sitting", "kitten", max));
+  ASSERT_EQ(std::size_t(4), ascii::levenshtein_bounded("", "four", max));
+  ASSERT_EQ(std::size_t(0), ascii::levenshtein_bounded("", "", max));
+}
+
+static void
+levenshtein_rand_str(prng::xorshift32 &r, char *out, std::size_t len,
+                     char max) {
+  for (std::size_t i = 0; i < len; ++i) {
+    out[i] = (char)uniform_dist(r, 'a', std::uint32_t(max) + 1);
+  }
+  out[len] = '\0';
+}
+
+TEST(levenshteinTest, test_rand) {
+  /* lengths around the word boundaries of myers */
+  prng::xorshift32 r(1);
+  constexpr std::size_t cap = 300;
+  char first[cap + 1];
+  char second[cap + 1];
+
+  for (std::size_t i = 0; i < 2000; ++i) {
+    levenshtein_rand_str(r, first, uniform_dist(r, 0, cap + 1), 'd');
+    if (uniform_dist(r, 0, 2) == 0) {
+      /* a few edits apart */
+      std::strcpy(second, first);
+      std::size_t len = std::strlen(second);
+      for (std::size_t e = uniform_dist(r, 0, 8); e-- > 0 && len > 0;) {
+        second[uniform_dist(r, 0, std::uint32_t(len))] = 'e';
+      }
+    } else {
+      levenshtein_rand_str(r, second, uniform_dist(r, 0, cap + 1), 'd');
+    }
+
+    const std::size_t expected = ascii::dp::levenshtein(first, second);
+    ASSERT_EQ(expected, ascii::myers::levenshtein(first, second));
+    ASSERT_EQ(expected, ascii::levenshtein_bounded(first, second, cap));
+
+    const std::size_t k = uniform_dist(r, 0, 20);
+    ASSERT_EQ(std::min(expected, k + 1),
+              ascii::levenshtein_bounded(first, second, k));
+  }
+}
+
+template <typename F>
+static double
+levenshtein_bench(const char *words, std::size_t n, std::size_t len,
+                  std::size_t &sum, F f) {
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i + 1 < n; ++i) {
+    sum += f(words + (i * (len + 1)), words + ((i + 1) * (len + 1)));
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  const std::chrono::duration<double> secs = end - start;
+  return secs.count() * 1000000000.0 / double(n - 1);
+}
+
+TEST(levenshteinTest, bench) {
+  prng::xorshift32 r(2);
+  printf("length        dp     myers  bounded(3)  (ns/op)\n");
+
+  const std::size_t lengths[] = {8, 16, 64, 256, 1024};
+  for (std::size_t len : lengths) {
+    const std::size_t n = len >= 256 ? 64 : 1024 * 16;
+    char *const words = new char[n * (len + 1)];
+    for (std::size_t i = 0; i < n; ++i) {
+      levenshtein_rand_str(r, words + (i * (len + 1)), len, 'z');
+    }
+
+    std::size_t dp = 0;
+    std::size_t myers = 0;
+    std::size_t bounded = 0;
+    const double dp_ns =
+        levenshtein_bench(words, n, len, dp, ascii::dp::levenshtein);
+    const double myers_ns = levenshtein_bench(
+        words, n, len, myers, [](const char *a, const char *b) {
+          /**/
+          return ascii::myers::levenshtein(a, b);
+        });
+    const double bounded_ns = levenshtein_bench(
+        words, n, len, bounded, [](const char *a, const char *b) {
+          /**/
+          return ascii::levenshtein_bounded(a, b, 3);
+        });
+    ASSERT_EQ(dp, myers);
+
+    printf("%6zu %9.0f %9.0f %11.0f\n", len, dp_ns, myers_ns, bounded_ns);
+    delete[] words;
+  }
+}
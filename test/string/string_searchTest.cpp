@@ -1,14 +1,19 @@
+#include <buffer/CircularByteBuffer.h>
 #include <collection/Array.h>
 #include <gtest/gtest.h>
 #include <prng/util.h>
 #include <prng/xorshift.h>
+#include <string/boyer_moore_horspool_search.h>
 #include <string/boyer_moore_search.h>
 #include <string/knuth_morris_pratt_search.h>
 #include <string/naive_search.h>
 #include <string/rabin_karp_search.h>
+#include <string/simd_search.h>
 #include <util/Timer.h>
 #include <util/array.h>
 
+#include <chrono>
+
 typedef const char *(*test_search_fp)(const char *text, std::size_t,
                                       const char *needle, std::size_t);
 
@@ -95,6 +100,16 @@ TEST(string_search, test_booyer_moore_search2) {
   test_2(sp::bm::search);
 }
 
+TEST(string_search, test_boyer_moore_horspool2) {
+  test_2(sp::bmh::search);
+}
+
+TEST(string_search, test_simd2) {
+  test_2(sp::simd::search);
+  test_2(sp::simd::search_sse2);
+  test_2(sp::simd::search_avx2);
+}
+
 TEST(string_search, test_naive2) {
   test_2(sp::naive::search);
 }
@@ -196,6 +211,17 @@ TEST(string_search, test_boyer_moore_large) {
   // print(median(ctx));
 }
 
+TEST(string_search, test_boyer_moore_horspool_large) {
+  sp::TimerContext ctx;
+  test_large(ctx, sp::bmh::search);
+}
+
+TEST(string_search, test_simd_large) {
+  sp::TimerContext ctx;
+  test_large(ctx, sp::simd::search_sse2);
+  test_large(ctx, sp::simd::search_avx2);
+}
+
 TEST(string_search, test_knuth_morris_pratt_large) {
   sp::TimerContext ctx;
   test_large(ctx, sp::kmp::search);
@@ -232,6 +258,15 @@ TEST(string_search, test_boyer_moore_subset) {
   test_subset(sp::bm::search);
 }
 
+TEST(string_search, test_boyer_moore_horspool_subset) {
+  test_subset(sp::bmh::search);
+}
+
+TEST(string_search, test_simd_subset) {
+  test_subset(sp::simd::search_sse2);
+  test_subset(sp::simd::search_avx2);
+}
+
 TEST(string_search, test_naive_subset) {
   test_subset(sp::naive::search);
 }
@@ -240,6 +275,185 @@ TEST(string_search, test_knuth_morris_pratt_subset) {
   test_subset(sp::kmp::search);
 }
 
+static void
+test_equivalence(test_search_fp search) {
+  /* small alphabet gives many partial matches, the lengths cover the block
+   * boundaries of the SIMD implementations */
+  prng::xorshift32 r(2);
+  char text[256];
+  for (std::size_t t = 0; t < 1024 * 4; ++t) {
+    const std::size_t tlen = uniform_dist(r, 0, sizeof(text) + 1);
+    for (std::size_t i = 0; i < tlen; ++i) {
+      text[i] = char('a' + uniform_dist(r, 0, 3));
+    }
+
+    char needle[40];
+    const std::size_t nlen = uniform_dist(r, 1, sizeof(needle) + 1);
+    for (std::size_t i = 0; i < nlen; ++i) {
+      needle[i] = char('a' + uniform_dist(r, 0, 3));
+    }
+
+    ASSERT_EQ(sp::naive::search(text, tlen, needle, nlen),
+              search(text, tlen, needle, nlen));
+  }
+}
+
+TEST(string_search, test_equivalence) {
+  test_equivalence(sp::bmh::search);
+  test_equivalence(sp::kmp::search);
+  test_equivalence(sp::simd::search_scalar);
+  test_equivalence(sp::simd::search_sse2);
+  test_equivalence(sp::simd::search_avx2);
+  test_equivalence(sp::simd::search);
+}
+
+static double
+bench_search(test_search_fp search, const char *text, std::size_t tlen,
+             const char *const *needles, std::size_t nlen,
+             std::size_t n) noexcept {
+  auto start = std::chrono::steady_clock::now();
+  std::size_t found = 0;
+  std::size_t scanned = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    const char *const res = search(text, tlen, needles[i], nlen);
+    if (res) {
+      ++found;
+      scanned += std::size_t(res - text) + nlen;
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  assertxs(found == n, found, n);
+
+  /* only the text up to the match is scanned */
+  const std::chrono::duration<double> secs = end - start;
+  return double(scanned) / secs.count() / 1024 / 1024;
+}
+
+TEST(string_search, bench_throughput) {
+  /* needles are picked from the second half of the text so on average 3/4 of
+   * it is scanned, the throughput is of the bytes scanned up to the match */
+  prng::xorshift32 r(3);
+  constexpr std::size_t length = 1024 * 1024 * 4;
+  constexpr std::size_t n = 16;
+
+  char *const text = new char[length];
+  fill(r, text, length, dist_rand_readable_char);
+
+  printf("needle    naive      kmp      bmh     sse2     avx2 (MB/s)\n");
+  const std::size_t lengths[] = {4, 8, 16, 32};
+  for (std::size_t nlen : lengths) {
+    const char *needles[n];
+    for (std::size_t i = 0; i < n; ++i) {
+      needles[i] =
+          text + uniform_dist(r, length / 2, std::uint32_t(length - nlen));
+    }
+
+    printf("%6zu %8.0f %8.0f %8.0f %8.0f %8.0f\n", nlen,
+           bench_search(sp::naive::search, text, length, needles, nlen, n),
+           bench_search(sp::kmp::search, text, length, needles, nlen, n),
+           bench_search(sp::bmh::search, text, length, needles, nlen, n),
+           bench_search(sp::simd::search_sse2, text, length, needles, nlen, n),
+           bench_search(sp::simd::search_avx2, text, length, needles, nlen, n));
+  }
+
+  delete[] text;
+}
+
+template <typename Stream>
+static void
+test_stream() {
+  prng::xorshift32 r(4);
+  constexpr std::size_t tlen = 1024 * 2;
+  char text[tlen];
+
+  for (std::size_t t = 0; t < 256; ++t) {
+    for (std::size_t i = 0; i < tlen; ++i) {
+      text[i] = char('a' + uniform_dist(r, 0, 2));
+    }
+    const std::size_t nlen = uniform_dist(r, 1, 13);
+    const char *const needle = text + uniform_dist(r, 0, tlen - nlen);
+
+    sp::DynamicArray<std::uint64_t> expected(tlen);
+    for (std::size_t i = 0; i + nlen <= tlen; ++i) {
+      if (std::memcmp(text + i, needle, nlen) == 0) {
+        ASSERT_TRUE(push(expected, std::uint64_t(i)));
+      }
+    }
+
+    Stream stream;
+    ASSERT_TRUE(init(stream, needle, nlen));
+    sp::DynamicArray<std::uint64_t> found(tlen);
+    auto f = [&found](std::uint64_t offset) {
+      /**/
+      ASSERT_TRUE(push(found, offset));
+    };
+
+    /* chunks smaller and larger than the needle */
+    std::size_t i = 0;
+    while (i < tlen) {
+      const std::size_t l =
+          std::min(std::size_t(uniform_dist(r, 0, 24)), tlen - i);
+      update(stream, text + i, l, f);
+      i += l;
+    }
+    ASSERT_EQ(std::uint64_t(tlen), stream.offset);
+
+    ASSERT_EQ(length(expected), length(found));
+    for (std::size_t k = 0; k < length(found); ++k) {
+      ASSERT_EQ(expected[k], found[k]);
+    }
+  }
+}
+
+TEST(string_search, test_knuth_morris_pratt_stream) {
+  test_stream<sp::kmp::Stream>();
+}
+
+TEST(string_search, test_boyer_moore_horspool_stream) {
+  test_stream<sp::bmh::Stream>();
+}
+
+template <typename Stream>
+static void
+test_stream_circular() {
+  /* the readable part of a CircularByteBuffer is one or two segments */
+  const char *const text = "xxabcdefxxabcdefxxxabcdefabcdefxxxxxxabcdefxx";
+  const char *const needle = "abcdef";
+  const std::size_t tlen = std::strlen(text);
+
+  sp::StaticCircularByteBuffer<8> buffer;
+  Stream stream;
+  ASSERT_TRUE(init(stream, needle, std::strlen(needle)));
+
+  sp::StaticArray<std::uint64_t, 16> found;
+  std::size_t written = 0;
+  while (written < tlen) {
+    written += push_back(buffer, text + written, tlen - written);
+
+    sp::CircularByteBuffer::BufferArray segments;
+    ASSERT_TRUE(read_buffer(buffer, segments));
+    for (std::size_t i = 0; i < length(segments); ++i) {
+      const char *seg = (const char *)std::get<0>(segments[i]);
+      update(stream, seg, std::get<1>(segments[i]), [&](std::uint64_t o) {
+        /**/
+        ASSERT_TRUE(push(found, o));
+      });
+    }
+    consume_bytes(buffer, remaining_read(buffer));
+  }
+
+  ASSERT_EQ(std::size_t(5), length(found));
+  const std::uint64_t expected[] = {2, 10, 19, 25, 37};
+  for (std::size_t i = 0; i < 5; ++i) {
+    ASSERT_EQ(expected[i], found[i]);
+  }
+}
+
+TEST(string_search, test_stream_circular) {
+  test_stream_circular<sp::kmp::Stream>();
+  test_stream_circular<sp::bmh::Stream>();
+}
+
 TEST(string_search, tsts_1) {
   const char *const text = ":|$2V7%CR'B(km^N5CB&|^Z@5frI@!nE";
   const char *const needle = "^N5CB&|^Z@5";
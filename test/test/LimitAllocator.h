@@ -0,0 +1,62 @@
+#ifndef SP_TEST_UTIL_LIMIT_ALLOCATOR_H
+#define SP_TEST_UTIL_LIMIT_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <util/assert.h>
+
+namespace sp {
+//=====================================
+/* Allocator which fails once $budget allocations have been made, shared by
+ * all instances. $live is the number of allocations not yet deallocated.
+ */
+struct LimitAllocatorState {
+  std::size_t budget;
+  std::size_t live;
+};
+
+static inline LimitAllocatorState &
+limit_allocator_state() noexcept {
+  static LimitAllocatorState state{~std::size_t(0), 0};
+  return state;
+}
+
+template <typename T>
+struct LimitAllocator {};
+
+//=====================================
+template <typename T>
+T *
+allocate(LimitAllocator<T> &) noexcept {
+  LimitAllocatorState &state = limit_allocator_state();
+  if (state.budget == 0) {
+    return nullptr;
+  }
+
+  T *const result = (T *)std::malloc(sizeof(T));
+  if (result) {
+    --state.budget;
+    ++state.live;
+  }
+
+  return result;
+}
+
+template <typename T>
+void
+deallocate(LimitAllocator<T> &, T *ptr) noexcept {
+  LimitAllocatorState &state = limit_allocator_state();
+  assertx(ptr);
+  assertx(state.live > 0);
+  --state.live;
+  std::free(ptr);
+}
+
+template <typename T>
+void
+swap(LimitAllocator<T> &, LimitAllocator<T> &) noexcept {
+}
+
+} // namespace sp
+
+#endif
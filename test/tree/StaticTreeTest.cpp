@@ -1,7 +1,11 @@
 #include <tree/StaticTree.h>
 
 #include "gtest/gtest.h"
+#include <chrono>
+#include <collection/Array.h>
 #include <cstring>
+#include <prng/util.h>
+#include <prng/xorshift.h>
 #include <random>
 
 // static void
@@ -178,3 +182,157 @@ TEST(StaticTreeTest, test_for_each) {
     ASSERT_TRUE(*r == k);
   }
 }
+
+template <typename Tree>
+static void
+assert_layout(const Tree &tree, int n) {
+  /* the values are the odd numbers in [1, 2n) */
+  for (int i = 0; i <= 2 * n; ++i) {
+    const int *const res = find(tree, i);
+    if (i % 2 == 1) {
+      ASSERT_TRUE(res);
+      ASSERT_EQ(i, *res);
+    } else {
+      ASSERT_FALSE(res);
+    }
+  }
+}
+
+template <std::size_t keys>
+static void
+assert_block_layout(const int *in, int n) {
+  const std::size_t cap = binary::block_capacity<keys>(std::size_t(n));
+  int *const buffer = new int[cap + 1];
+  binary::StaticBlockTree<int, keys> tree(buffer, cap);
+  ASSERT_TRUE(bulk_load(tree, in, in + n));
+  ASSERT_FALSE(bulk_load(tree, in, in + n) && n > 0);
+  assert_layout(tree, n);
+  delete[] buffer;
+}
+
+TEST(StaticTreeTest, test_layouts) {
+  for (int n = 0; n < 300; ++n) {
+    int *const in = new int[std::size_t(n) + 1];
+    for (int i = 0; i < n; ++i) {
+      in[i] = (i * 2) + 1;
+    }
+
+    {
+      int *const buffer = new int[std::size_t(n) + 1];
+      std::memset(buffer, -1, sizeof(int) * (std::size_t(n) + 1));
+      binary::StaticTree<int, sp::greater, IntPresent> tree(buffer,
+                                                            std::size_t(n));
+      ASSERT_TRUE(bulk_load(tree, in, in + n));
+      if (n > 0) {
+        ASSERT_FALSE(bulk_load(tree, in, in + n));
+      }
+      assert_layout(tree, n);
+
+      /* a complete tree, the first n slots */
+      for (int i = 0; i < n; ++i) {
+        ASSERT_NE(-1, buffer[i]);
+      }
+      delete[] buffer;
+    }
+
+    {
+      const std::size_t cap = binary::veb_capacity(std::size_t(n));
+      ASSERT_TRUE(cap >= std::size_t(n));
+      ASSERT_TRUE(cap < std::size_t(2 * n) + 1);
+      int *const buffer = new int[cap + 1];
+      binary::StaticVebTree<int> tree(buffer, cap);
+      if (n > 0) {
+        binary::StaticVebTree<int> small(buffer, cap - 1);
+        ASSERT_FALSE(bulk_load(small, in, in + n));
+      }
+      ASSERT_TRUE(bulk_load(tree, in, in + n));
+      assert_layout(tree, n);
+      delete[] buffer;
+    }
+
+    assert_block_layout<1>(in, n);
+    assert_block_layout<3>(in, n);
+    assert_block_layout<16>(in, n);
+    delete[] in;
+  }
+}
+
+template <typename Tree>
+static double
+static_tree_bench(const Tree &tree, const int *needles, std::size_t queries,
+                  std::size_t &found) {
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t q = 0; q < queries; ++q) {
+    found += find(tree, needles[q]) ? 1 : 0;
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  const std::chrono::duration<double> secs = end - start;
+  return secs.count() * 1000000000.0 / double(queries);
+}
+
+TEST(StaticTreeTest, bench_layouts) {
+  prng::xorshift32 r(1);
+  constexpr std::size_t queries = 1024 * 1024;
+  int *const needles = new int[queries];
+
+  printf("%10s %12s %12s %12s %12s\n", "n", "bin_search", "eytzinger",
+         "veb", "block<16>");
+  const std::size_t sizes[] = {1024, 1024 * 64, 1024 * 1024, 1024 * 1024 * 8};
+  for (std::size_t n : sizes) {
+    int *const in = new int[n];
+    for (std::size_t i = 0; i < n; ++i) {
+      in[i] = int(i * 2) + 1;
+    }
+    for (std::size_t q = 0; q < queries; ++q) {
+      /* half hits */
+      needles[q] = int(uniform_dist(r, 0, std::uint32_t(n * 2)));
+    }
+
+    std::size_t bin_found = 0;
+    sp::Array<int> sorted(in, n, n);
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t q = 0; q < queries; ++q) {
+      bin_found += bin_search(sorted, needles[q]) ? 1 : 0;
+    }
+    auto end = std::chrono::steady_clock::now();
+    const std::chrono::duration<double> bin_secs = end - start;
+    const double bin = bin_secs.count() * 1000000000.0 / double(queries);
+
+    std::size_t eytzinger_found = 0;
+    int *const eytzinger_buffer = new int[n];
+    std::memset(eytzinger_buffer, -1, sizeof(int) * n);
+    binary::StaticTree<int, sp::greater, IntPresent> eytzinger(
+        eytzinger_buffer, n);
+    ASSERT_TRUE(bulk_load(eytzinger, in, in + n));
+    const double eyt =
+        static_tree_bench(eytzinger, needles, queries, eytzinger_found);
+
+    std::size_t veb_found = 0;
+    const std::size_t veb_cap = binary::veb_capacity(n);
+    int *const veb_buffer = new int[veb_cap];
+    binary::StaticVebTree<int> veb(veb_buffer, veb_cap);
+    ASSERT_TRUE(bulk_load(veb, in, in + n));
+    const double veb_ns = static_tree_bench(veb, needles, queries, veb_found);
+
+    std::size_t block_found = 0;
+    const std::size_t block_cap = binary::block_capacity<16>(n);
+    int *const block_buffer = new int[block_cap];
+    binary::StaticBlockTree<int, 16> block(block_buffer, block_cap);
+    ASSERT_TRUE(bulk_load(block, in, in + n));
+    const double block_ns =
+        static_tree_bench(block, needles, queries, block_found);
+
+    ASSERT_EQ(bin_found, eytzinger_found);
+    ASSERT_EQ(bin_found, veb_found);
+    ASSERT_EQ(bin_found, block_found);
+    printf("%10zu %10.1fns %10.1fns %10.1fns %10.1fns\n", n, bin, eyt, veb_ns,
+           block_ns);
+
+    delete[] block_buffer;
+    delete[] veb_buffer;
+    delete[] eytzinger_buffer;
+    delete[] in;
+  }
+  delete[] needles;
+}
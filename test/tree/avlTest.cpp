@@ -1,5 +1,10 @@
+#include <chrono>
+#include <collection/Array.h>
 #include <gtest/gtest.h>
+#include <memory/SlabAllocator.h>
+#include <memory/StackPooledAllocator.h>
 #include <sstream>
+#include <test/LimitAllocator.h>
 #include <tree/avl.h>
 
 struct AVLData {
@@ -398,3 +403,193 @@ const int* fr = avl::find(tree, d)
   }
 }
 #endif
+
+TEST(avlTest, test_bulk_load) {
+  for (int n = 0; n < 300; ++n) {
+    sp::DynamicArray<int> in(std::size_t(n) + 1);
+    for (int i = 0; i < n; ++i) {
+      ASSERT_TRUE(insert(in, i * 2));
+    }
+
+    avl::Tree<int> tree;
+    ASSERT_TRUE(bulk_load(tree, in.data(), in.data() + n));
+    ASSERT_TRUE(avl::verify(tree));
+    for (int i = 0; i < n; ++i) {
+      const int *res = avl::find(tree, i * 2);
+      ASSERT_TRUE(res);
+      ASSERT_EQ(i * 2, *res);
+      ASSERT_FALSE(avl::find(tree, i * 2 + 1));
+    }
+    if (n > 0) {
+      ASSERT_FALSE(bulk_load(tree, in.data(), in.data() + n));
+    }
+
+    /* still a regular tree */
+    for (int i = 0; i < n; ++i) {
+      ASSERT_TRUE(std::get<1>(avl::insert(tree, i * 2 + 1)));
+      ASSERT_TRUE(avl::remove(tree, i * 2));
+      ASSERT_TRUE(avl::verify(tree));
+    }
+  }
+}
+
+TEST(avlTest, test_bulk_load_alloc_fail) {
+  constexpr std::size_t n = 100;
+  sp::DynamicArray<int> in(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    ASSERT_TRUE(insert(in, int(i)));
+  }
+
+  sp::LimitAllocatorState &state = sp::limit_allocator_state();
+  for (std::size_t budget = 0; budget <= n; ++budget) {
+    {
+      avl::Tree<int, sp::greater, sp::LimitAllocator> tree;
+      state.budget = budget;
+      const bool res = bulk_load(tree, in.data(), in.data() + n);
+      ASSERT_EQ(budget == n, res);
+      if (res) {
+        ASSERT_TRUE(avl::verify(tree));
+      } else {
+        ASSERT_EQ(nullptr, tree.root);
+        ASSERT_EQ(std::size_t(0), state.live);
+      }
+    }
+    ASSERT_EQ(std::size_t(0), state.live);
+  }
+  state.budget = ~std::size_t(0);
+}
+
+TEST(avlTest, bench_bulk_load) {
+  constexpr int n = 1024 * 256;
+  sp::DynamicArray<int> in(n);
+  for (int i = 0; i < n; ++i) {
+    insert(in, i);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  {
+    avl::Tree<int> tree;
+    for (int i = 0; i < n; ++i) {
+      avl::insert(tree, in[std::size_t(i)]);
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  const std::chrono::duration<double> insert_secs = end - start;
+
+  start = std::chrono::steady_clock::now();
+  {
+    avl::Tree<int> tree;
+    ASSERT_TRUE(bulk_load(tree, in.data(), in.data() + n));
+  }
+  end = std::chrono::steady_clock::now();
+  const std::chrono::duration<double> bulk_secs = end - start;
+
+  printf("%d sorted values, insert: %.2fms, bulk_load: %.2fms\n", n,
+         insert_secs.count() * 1000, bulk_secs.count() * 1000);
+}
+
+namespace {
+struct AVLCounted {
+  static int live;
+  int value;
+
+  explicit AVLCounted(int v) noexcept
+      : value(v) {
+    ++live;
+  }
+
+  AVLCounted(const AVLCounted &o) noexcept
+      : value(o.value) {
+    ++live;
+  }
+
+  ~AVLCounted() noexcept {
+    --live;
+  }
+
+  bool
+  operator>(const AVLCounted &o) const noexcept {
+    return value > o.value;
+  }
+};
+
+int AVLCounted::live = 0;
+} // namespace
+
+template <template <typename> class A>
+static void
+avl_allocator() {
+  constexpr int n = 1000;
+  {
+    avl::Tree<int, sp::greater, A> tree;
+    for (int i = 0; i < n; ++i) {
+      ASSERT_TRUE(std::get<1>(avl::insert(tree, (i * 37) % n)));
+    }
+    for (int i = 1; i < n; i += 2) {
+      ASSERT_TRUE(avl::remove(tree, i));
+    }
+    ASSERT_TRUE(avl::verify(tree));
+
+    /* the removed nodes are reused */
+    for (int i = 1; i < n; i += 2) {
+      ASSERT_TRUE(std::get<1>(avl::insert(tree, i)));
+    }
+    ASSERT_TRUE(avl::verify(tree));
+    for (int i = 0; i < n; ++i) {
+      const int *res = avl::find(tree, i);
+      ASSERT_TRUE(res);
+      ASSERT_EQ(i, *res);
+    }
+
+    avl::Tree<int, sp::greater, A> moved(std::move(tree));
+    ASSERT_FALSE(tree.root);
+    ASSERT_TRUE(avl::find(moved, n - 1));
+  }
+
+  {
+    avl::Tree<AVLCounted, sp::greater, A> tree;
+    for (int i = 0; i < n; ++i) {
+      ASSERT_TRUE(std::get<1>(avl::insert(tree, AVLCounted((i * 37) % n))));
+    }
+    ASSERT_TRUE(avl::remove(tree, AVLCounted(0)));
+  }
+  ASSERT_EQ(0, AVLCounted::live);
+}
+
+TEST(avlTest, test_allocator) {
+  avl_allocator<sp::Allocator>();
+  avl_allocator<sp::StackPooledAllocator>();
+  avl_allocator<sp::SlabAllocator>();
+}
+
+template <template <typename> class A>
+static double
+avl_bench_allocator(const sp::DynamicArray<int> &in) {
+  auto start = std::chrono::steady_clock::now();
+  {
+    avl::Tree<int, sp::greater, A> tree;
+    for (std::size_t i = 0; i < length(in); ++i) {
+      avl::insert(tree, in[i]);
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  const std::chrono::duration<double> secs = end - start;
+  return secs.count() * 1000;
+}
+
+TEST(avlTest, bench_allocator) {
+  constexpr int n = 1024 * 256;
+  sp::DynamicArray<int> in(n);
+  for (int i = 0; i < n; ++i) {
+    /* a permutation of [0, n) */
+    insert(in, int((std::uint32_t(i) * 2654435761u) % std::uint32_t(n)));
+  }
+
+  const double def = avl_bench_allocator<sp::Allocator>(in);
+  const double pooled = avl_bench_allocator<sp::StackPooledAllocator>(in);
+  const double slab = avl_bench_allocator<sp::SlabAllocator>(in);
+  printf("%d inserts and destroy, allocator: %.2fms, pooled: %.2fms, "
+         "slab: %.2fms\n",
+         n, def, pooled, slab);
+}
@@ -0,0 +1,154 @@
+#include <chrono>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <prng/util.h>
+#include <prng/xorshift.h>
+#include <string/levenshtein.h>
+#include <tree/bktree.h>
+
+static char *
+bktree_words(prng::xorshift32 &r, std::size_t n, std::size_t width) {
+  char *const result = new char[n * width];
+  for (std::size_t i = 0; i < n; ++i) {
+    char *const word = result + (i * width);
+    const std::size_t len = uniform_dist(r, 3, std::uint32_t(width));
+    for (std::size_t c = 0; c < len; ++c) {
+      word[c] = char(uniform_dist(r, 'a', 'z' + 1));
+    }
+    word[len] = '\0';
+  }
+  return result;
+}
+
+TEST(bktreeTest, test) {
+  bk::Tree<const char *> tree;
+  const char *const words[] = {"book", "books", "cake", "boo",
+                               "cape", "boon", "cook", "cart"};
+  for (const char *w : words) {
+    const char *const *res = insert(tree, w);
+    ASSERT_TRUE(res);
+    ASSERT_EQ(w, *res);
+    ASSERT_TRUE(bk::rec::verify(tree));
+  }
+  ASSERT_EQ(std::size_t(8), length(tree));
+  ASSERT_FALSE(insert(tree, "cake"));
+  ASSERT_EQ(std::size_t(8), length(tree));
+
+  std::size_t found = 0;
+  search(tree, "bo", 1, [&](const char *w, std::size_t d) {
+    ASSERT_STREQ("boo", w);
+    ASSERT_EQ(std::size_t(1), d);
+    ++found;
+  });
+  ASSERT_EQ(std::size_t(1), found);
+
+  found = 0;
+  search(tree, "caqe", 1, [&](const char *w, std::size_t d) {
+    ASSERT_TRUE(std::strcmp("cake", w) == 0 || std::strcmp("cape", w) == 0);
+    ASSERT_EQ(std::size_t(1), d);
+    ++found;
+  });
+  ASSERT_EQ(std::size_t(2), found);
+
+  bk::Tree<const char *> empty;
+  ASSERT_EQ(std::size_t(0), search(empty, "a", 3, [](const char *, std::size_t) {
+              /**/
+              ASSERT_TRUE(false);
+            }));
+}
+
+TEST(bktreeTest, test_rand) {
+  prng::xorshift32 r(1);
+  constexpr std::size_t n = 2000;
+  constexpr std::size_t width = 8;
+  char *const words = bktree_words(r, n, width);
+
+  bk::Tree<const char *> tree;
+  std::size_t inserted = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    if (insert(tree, words + (i * width))) {
+      ++inserted;
+    }
+  }
+  ASSERT_EQ(inserted, length(tree));
+  ASSERT_TRUE(bk::rec::verify(tree));
+
+  char *const queries = bktree_words(r, 200, width);
+  for (std::size_t q = 0; q < 200; ++q) {
+    const char *const needle = queries + (q * width);
+    for (std::size_t k = 0; k <= 3; ++k) {
+      std::size_t found = 0;
+      search(tree, needle, k, [&](const char *w, std::size_t d) {
+        ASSERT_EQ(ascii::dp::levenshtein(needle, w), d);
+        ASSERT_TRUE(d <= k);
+        ++found;
+      });
+
+      /* linear scan, duplicates in $words are only in the tree once */
+      bk::Tree<const char *> seen;
+      for (std::size_t i = 0; i < n; ++i) {
+        const char *const w = words + (i * width);
+        if (ascii::levenshtein_bounded(needle, w, k) <= k && insert(seen, w)) {
+          --found;
+        }
+      }
+      ASSERT_EQ(std::size_t(0), found);
+    }
+  }
+
+  delete[] queries;
+  delete[] words;
+}
+
+TEST(bktreeTest, bench_visited) {
+  prng::xorshift32 r(2);
+  constexpr std::size_t n = 1024 * 64;
+  constexpr std::size_t width = 12;
+  constexpr std::size_t queries = 64;
+  char *const words = bktree_words(r, n, width);
+  char *const needles = bktree_words(r, queries, width);
+
+  bk::Tree<const char *> tree;
+  for (std::size_t i = 0; i < n; ++i) {
+    insert(tree, words + (i * width));
+  }
+
+  printf("dictionary: %zu words\n", length(tree));
+  printf("k  visited(avg)  visited(%%)    bk(us)  linear(us)\n");
+  for (std::size_t k = 1; k <= 3; ++k) {
+    std::size_t visited = 0;
+    std::size_t bk_found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t q = 0; q < queries; ++q) {
+      visited += search(tree, needles + (q * width), k,
+                        [&](const char *, std::size_t) {
+                          /**/
+                          ++bk_found;
+                        });
+    }
+    auto end = std::chrono::steady_clock::now();
+    const std::chrono::duration<double> bk_secs = end - start;
+
+    std::size_t linear_found = 0;
+    start = std::chrono::steady_clock::now();
+    for (std::size_t q = 0; q < queries; ++q) {
+      const char *const needle = needles + (q * width);
+      for (std::size_t i = 0; i < n; ++i) {
+        linear_found +=
+            ascii::myers::levenshtein(needle, words + (i * width)) <= k;
+      }
+    }
+    end = std::chrono::steady_clock::now();
+    const std::chrono::duration<double> linear_secs = end - start;
+    ASSERT_TRUE(bk_found <= linear_found);
+
+    const double avg = double(visited) / double(queries);
+    printf("%zu %13.0f %11.2f %9.1f %11.1f\n", k, avg,
+           avg * 100 / double(length(tree)),
+           bk_secs.count() * 1000000 / double(queries),
+           linear_secs.count() * 1000000 / double(queries));
+  }
+
+  delete[] needles;
+  delete[] words;
+}
@@ -0,0 +1,173 @@
+#include <chrono>
+#include <gtest/gtest.h>
+#include <prng/util.h>
+#include <prng/xorshift.h>
+#include <tree/bplus_tree.h>
+#include <tree/btree_rec.h>
+#include <util/Bitset.h>
+
+TEST(bplus_treeTest, test) {
+  bplus::Tree<int, 4> tree;
+  ASSERT_TRUE(is_empty(tree));
+  ASSERT_EQ(nullptr, lower_bound(tree, 1));
+
+  for (int i = 0; i < 100; i += 2) {
+    int *const res = insert(tree, i);
+    ASSERT_TRUE(res);
+    ASSERT_EQ(i, *res);
+    ASSERT_EQ(res, insert(tree, i));
+    ASSERT_TRUE(bplus::rec::verify(tree));
+  }
+  ASSERT_EQ(std::size_t(50), length(tree));
+
+  for (int i = 0; i < 100; ++i) {
+    const int *const res = find(tree, i);
+    if (i % 2 == 0) {
+      ASSERT_TRUE(res);
+      ASSERT_EQ(i, *res);
+    } else {
+      ASSERT_EQ(nullptr, res);
+    }
+
+    const int *const lb = lower_bound(tree, i);
+    if (i < 99) {
+      ASSERT_TRUE(lb);
+      ASSERT_EQ(i + (i % 2), *lb);
+    } else {
+      ASSERT_EQ(nullptr, lb);
+    }
+  }
+
+  int expected = 11 + 1;
+  const std::size_t res = for_each_in_range(tree, 11, 31, [&](int v) {
+    ASSERT_EQ(expected, v);
+    expected += 2;
+  });
+  ASSERT_EQ(std::size_t(10), res);
+  ASSERT_EQ(32, expected);
+  ASSERT_EQ(std::size_t(0), for_each_in_range(tree, 31, 31, [](int) {}));
+  ASSERT_EQ(std::size_t(50), for_each_in_range(tree, -1, 1000, [](int) {}));
+}
+
+TEST(bplus_treeTest, test_rand) {
+  prng::xorshift32 r(1);
+  constexpr std::size_t range = 2048;
+
+  for (std::size_t round = 0; round < 4; ++round) {
+    bplus::Tree<std::uint32_t, 5> tree;
+    sp::StaticBitset<range / 64> ref;
+    std::size_t count = 0;
+
+    for (std::size_t i = 0; i < range * 4; ++i) {
+      const std::uint32_t v = uniform_dist(r, 0, range);
+      if (uniform_dist(r, 0, 3) > 0) {
+        const bool present = test(ref, v);
+        ASSERT_TRUE(insert(tree, v));
+        if (!present) {
+          ASSERT_FALSE(set(ref, v, true));
+          ++count;
+        }
+      } else {
+        ASSERT_EQ(test(ref, v), remove(tree, v));
+        if (test(ref, v)) {
+          set(ref, v, false);
+          --count;
+        }
+      }
+      ASSERT_EQ(count, length(tree));
+      ASSERT_EQ(test(ref, v), find(tree, v) != nullptr);
+    }
+    ASSERT_TRUE(bplus::rec::verify(tree));
+
+    for (std::size_t q = 0; q < 100; ++q) {
+      const std::uint32_t low = uniform_dist(r, 0, range);
+      const std::uint32_t high = uniform_dist(r, low, range + 1);
+
+      std::uint32_t it = low;
+      std::size_t found = 0;
+      for_each_in_range(tree, low, high, [&](std::uint32_t v) {
+        for (; it < v; ++it) {
+          ASSERT_FALSE(test(ref, it));
+        }
+        ASSERT_TRUE(test(ref, v));
+        ++it;
+        ++found;
+      });
+      for (; it < high; ++it) {
+        ASSERT_FALSE(test(ref, it));
+      }
+
+      std::size_t expected = 0;
+      for (std::uint32_t i = low; i < high; ++i) {
+        expected += test(ref, i) ? 1 : 0;
+      }
+      ASSERT_EQ(expected, found);
+    }
+
+    /* drain, shrinking the height back to a single leaf */
+    for (std::uint32_t v = 0; v < range; ++v) {
+      ASSERT_EQ(test(ref, v), remove(tree, v));
+      if ((v % 64) == 0) {
+        ASSERT_TRUE(bplus::rec::verify(tree));
+      }
+    }
+    ASSERT_TRUE(is_empty(tree));
+    ASSERT_EQ(std::size_t(0), length(tree));
+    ASSERT_TRUE(bplus::rec::verify(tree));
+  }
+}
+
+TEST(bplus_treeTest, bench_range_scan) {
+  prng::xorshift32 r(2);
+  constexpr std::size_t n = 1024 * 256;
+  constexpr std::size_t queries = 256;
+  constexpr std::size_t keys = 32;
+
+  bplus::Tree<std::uint32_t, keys> bplus;
+  sp::rec::BTree<std::uint32_t, keys> btree;
+  for (std::size_t i = 0; i < n; ++i) {
+    const std::uint32_t v = random(r);
+    insert(bplus, v);
+    insert(btree, v);
+  }
+
+  printf("range(%%)  b+tree(MB/s)  btree in-order(MB/s)\n");
+  const std::size_t widths[] = {1, 10, 50};
+  for (std::size_t width : widths) {
+    std::uint32_t low[queries];
+    std::uint32_t high[queries];
+    const std::uint64_t span = (std::uint64_t(0xffffffff) * width) / 100;
+    for (std::size_t q = 0; q < queries; ++q) {
+      low[q] = uniform_dist(r, 0, std::uint32_t(0xffffffff - span));
+      high[q] = std::uint32_t(low[q] + span);
+    }
+
+    std::uint64_t bp_sum = 0;
+    std::size_t bp_visited = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t q = 0; q < queries; ++q) {
+      bp_visited += for_each_in_range(bplus, low[q], high[q],
+                                      [&](std::uint32_t v) { bp_sum += v; });
+    }
+    auto end = std::chrono::steady_clock::now();
+    const std::chrono::duration<double> bp_secs = end - start;
+
+    std::uint64_t bt_sum = 0;
+    std::size_t bt_visited = 0;
+    start = std::chrono::steady_clock::now();
+    for (std::size_t q = 0; q < queries; ++q) {
+      bt_visited += for_each_in_range(btree, low[q], high[q],
+                                      [&](std::uint32_t v) { bt_sum += v; });
+    }
+    end = std::chrono::steady_clock::now();
+    const std::chrono::duration<double> bt_secs = end - start;
+
+    ASSERT_EQ(bt_visited, bp_visited);
+    ASSERT_EQ(bt_sum, bp_sum);
+
+    const double bytes = double(bp_visited * sizeof(std::uint32_t));
+    printf("%8zu %13.2f %21.2f\n", width,
+           bytes / bp_secs.count() / 1024 / 1024,
+           bytes / bt_secs.count() / 1024 / 1024);
+  }
+}
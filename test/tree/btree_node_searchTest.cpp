@@ -0,0 +1,137 @@
+#include <chrono>
+#include <collection/Array.h>
+#include <gtest/gtest.h>
+#include <prng/util.h>
+#include <prng/xorshift.h>
+#include <tree/btree_node_search.h>
+#include <tree/btree_rec.h>
+
+namespace {
+/* not specialized, always uses the generic bin_find_gte() */
+struct generic_greater {
+  template <typename T, typename K>
+  constexpr bool
+  operator()(const T &lhs, const K &rhs) const noexcept {
+    return lhs > rhs;
+  }
+};
+} // namespace
+
+template <typename T, typename Cmp>
+static void
+node_search_rand(prng::xorshift32 &r, T low, T span) {
+  Cmp cmp;
+  for (std::size_t round = 0; round < 2000; ++round) {
+    sp::UinStaticArray<T, 48> elements;
+    const std::size_t len = uniform_dist(r, 0, 49);
+    while (length(elements) < len) {
+      const T v = T(low + T(uniform_dist(r, 0, std::uint32_t(span))));
+      bin_insert_unique(elements, v, cmp);
+    }
+
+    for (std::size_t q = 0; q < 64; ++q) {
+      const T needle = T(low + T(uniform_dist(r, 0, std::uint32_t(span))));
+      const T *const expected = bin_find_gte(elements, needle, cmp);
+      const T *const res = sp::rec::node_find_gte(elements, needle, cmp);
+      ASSERT_EQ(expected, res);
+    }
+
+    /* the extremes */
+    for (std::size_t i = 0; i < length(elements); ++i) {
+      ASSERT_EQ(&elements[i],
+                sp::rec::node_find_gte(elements, elements[i], cmp));
+    }
+  }
+}
+
+template <typename T>
+static void
+node_search_rand(prng::xorshift32 &r, T low, T span) {
+  node_search_rand<T, sp::greater>(r, low, span);
+  node_search_rand<T, sp::less>(r, low, span);
+}
+
+TEST(btree_node_searchTest, test_rand) {
+  prng::xorshift32 r(1);
+  node_search_rand<std::int32_t>(r, -100, 200);
+  node_search_rand<std::uint32_t>(r, 0, 200);
+  /* around the sign bit, the unsigned compare is done as signed */
+  node_search_rand<std::uint32_t>(r, 0x7fffff00u, 0x200u);
+  node_search_rand<std::int64_t>(r, -100, 200);
+  node_search_rand<std::uint64_t>(r, 0x7fffffffffffff00ull, 0x200u);
+}
+
+TEST(btree_node_searchTest, test_dispatch) {
+  using sp::rec::impl::NodeSearchSimd;
+  static_assert(NodeSearchSimd<int, int, sp::greater>::value, "");
+  static_assert(NodeSearchSimd<std::uint64_t, std::uint32_t, sp::less>::value,
+                "");
+  static_assert(!NodeSearchSimd<int, int, generic_greater>::value, "");
+  static_assert(!NodeSearchSimd<int, std::int64_t, sp::greater>::value, "");
+  static_assert(!NodeSearchSimd<std::uint32_t, int, sp::greater>::value, "");
+  static_assert(!NodeSearchSimd<char, char, sp::greater>::value, "");
+  static_assert(!NodeSearchSimd<double, double, sp::greater>::value, "");
+  static_assert(sp::rec::cache_line_keys<std::uint32_t>(1) == 16, "");
+  static_assert(sp::rec::cache_line_keys<std::uint64_t>(4) == 32, "");
+}
+
+template <std::size_t keys, typename Cmp>
+static double
+node_search_bench(const std::uint32_t *values, std::size_t n,
+                  const std::uint32_t *needles, std::size_t queries,
+                  std::size_t &found) {
+  sp::rec::BTree<std::uint32_t, keys, Cmp> tree;
+  for (std::size_t i = 0; i < n; ++i) {
+    insert(tree, values[i]);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t q = 0; q < queries; ++q) {
+    found += find(tree, needles[q]) ? 1 : 0;
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  const std::chrono::duration<double> secs = end - start;
+  return secs.count() * 1000000000.0 / double(queries);
+}
+
+template <std::size_t lines>
+static void
+node_search_bench(const std::uint32_t *values, std::size_t n,
+                  const std::uint32_t *needles, std::size_t queries) {
+  constexpr std::size_t keys = sp::rec::cache_line_keys<std::uint32_t>(lines);
+  std::size_t simd_found = 0;
+  std::size_t generic_found = 0;
+  const double simd = node_search_bench<keys, sp::greater>(
+      values, n, needles, queries, simd_found);
+  const double generic = node_search_bench<keys, generic_greater>(
+      values, n, needles, queries, generic_found);
+  ASSERT_EQ(generic_found, simd_found);
+
+  printf("%5zu %5zu %10.1f %12.1f\n", lines, keys, simd, generic);
+}
+
+TEST(btree_node_searchTest, bench_find) {
+  prng::xorshift32 r(2);
+  constexpr std::size_t n = 1024 * 256;
+  constexpr std::size_t queries = 1024 * 1024;
+
+  std::uint32_t *const values = new std::uint32_t[n];
+  for (std::size_t i = 0; i < n; ++i) {
+    values[i] = random(r);
+  }
+  std::uint32_t *const needles = new std::uint32_t[queries];
+  for (std::size_t q = 0; q < queries; ++q) {
+    /* half hits */
+    needles[q] = (q % 2) == 0 ? values[uniform_dist(r, 0, std::uint32_t(n))]
+                              : random(r);
+  }
+
+  printf("lines  keys  simd(ns)  generic(ns)\n");
+  node_search_bench<1>(values, n, needles, queries);
+  node_search_bench<2>(values, n, needles, queries);
+  node_search_bench<4>(values, n, needles, queries);
+
+  delete[] needles;
+  delete[] values;
+}
@@ -1,6 +1,10 @@
+#include <chrono>
 #include <gtest/gtest.h>
+#include <memory/SlabAllocator.h>
+#include <memory/StackPooledAllocator.h>
 #include <prng/util.h>
 #include <prng/xorshift.h>
+#include <test/LimitAllocator.h>
 #include <tree/avl_rec.h>
 #include <tree/btree_extra.h>
 #include <tree/btree_rec.h>
@@ -139,7 +143,8 @@ TEST(btree_recTest, test_fixup_2_gt) {
   int out = 999;
   int *optr = &out;
   sp::rec::BTNode<int, keys, cmp> *gt = nullptr;
-  auto res = sp::rec::impl::fixup(&tree, &bubble, gt, optr);
+  sp::Allocator<sp::rec::BTNode<int, keys, cmp>> allocator;
+  auto res = sp::rec::impl::fixup(allocator, &tree, &bubble, gt, optr);
   {
     int *out_bubble = std::get<0>(res);
     ASSERT_TRUE(out_bubble);
@@ -148,7 +153,7 @@ TEST(btree_recTest, test_fixup_2_gt) {
     ASSERT_TRUE(right);
     ASSERT_EQ(std::size_t(1), length(right->elements));
     ASSERT_EQ(2, right->elements[0]);
-    delete right;
+    sp::rec::impl::destroy_node(allocator, right);
 
     ASSERT_EQ(1, *out_bubble);
   }
@@ -175,7 +180,8 @@ TEST(btree_recTest, test_fixup_3_gt) {
   int out = 999;
   int *optr = &out;
   sp::rec::BTNode<int, keys, cmp> *gt = nullptr;
-  auto res = sp::rec::impl::fixup(&tree, &bubble, gt, optr);
+  sp::Allocator<sp::rec::BTNode<int, keys, cmp>> allocator;
+  auto res = sp::rec::impl::fixup(allocator, &tree, &bubble, gt, optr);
   {
     int *out_bubble = std::get<0>(res);
     ASSERT_TRUE(out_bubble);
@@ -185,7 +191,7 @@ TEST(btree_recTest, test_fixup_3_gt) {
     ASSERT_EQ(std::size_t(2), length(right->elements));
     ASSERT_EQ(2, right->elements[0]);
     ASSERT_EQ(3, right->elements[1]);
-    delete right;
+    sp::rec::impl::destroy_node(allocator, right);
 
     ASSERT_EQ(1, *out_bubble);
   }
@@ -213,7 +219,8 @@ TEST(btree_recTest, test_fixup_4_gt) {
   int out = 999;
   int *optr = &out;
   sp::rec::BTNode<int, keys, cmp> *gt = nullptr;
-  auto res = sp::rec::impl::fixup(&tree, &bubble, gt, optr);
+  sp::Allocator<sp::rec::BTNode<int, keys, cmp>> allocator;
+  auto res = sp::rec::impl::fixup(allocator, &tree, &bubble, gt, optr);
   {
     int *out_bubble = std::get<0>(res);
     ASSERT_TRUE(out_bubble);
@@ -223,7 +230,7 @@ TEST(btree_recTest, test_fixup_4_gt) {
     ASSERT_EQ(std::size_t(2), length(right->elements));
     ASSERT_EQ(3, right->elements[0]);
     ASSERT_EQ(4, right->elements[1]);
-    delete right;
+    sp::rec::impl::destroy_node(allocator, right);
 
     ASSERT_EQ(2, *out_bubble);
   }
@@ -796,8 +803,176 @@ TEST(btree_recTest, rand_remove_order_12) {
   }
 }
 
+TEST(btree_recTest, rand_remove_pooled) {
+  prng::xorshift32 r(1);
+  for (std::size_t i = 0; i < 50; ++i) {
+    btree_rand_remove<
+        sp::rec::BTree<int, 4, sp::greater, sp::StackPooledAllocator>>(r);
+    btree_rand_remove<sp::rec::BTree<int, 5, sp::greater, sp::SlabAllocator>>(
+        r);
+  }
+
+  /* nodes left in the tree are released by the allocator */
+  sp::rec::BTree<int, 3, sp::greater, sp::SlabAllocator> tree;
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_TRUE(insert(tree, i));
+  }
+  for (int i = 0; i < 1000; i += 2) {
+    ASSERT_TRUE(remove(tree, i));
+  }
+  ASSERT_TRUE(verify(tree));
+}
+
 // TEST(btree_recTest, avl_rec_remove_10) {
 //   constexpr std::size_t values = 2;
 //   const int max = 128;
 //   btree_seq_remove<avl::rec::Tree<int>>(max);
 // }
+
+template <std::size_t keys>
+static void
+btree_bulk_load(prng::xorshift32 &r, double fill) {
+  for (std::size_t n = 0; n < 400; n += 1 + (n / 16)) {
+    sp::DynamicArray<int> in(n + 1);
+    for (std::size_t i = 0; i < n; ++i) {
+      ASSERT_TRUE(insert(in, int(i * 2)));
+    }
+
+    sp::rec::BTree<int, keys> tree;
+    ASSERT_TRUE(bulk_load(tree, in.data(), in.data() + n, fill));
+    if (n > 0) {
+      ASSERT_FALSE(bulk_load(tree, in.data(), in.data() + n, fill));
+    }
+    ASSERT_TRUE(verify(tree));
+    ASSERT_EQ(n, for_each_in_range(tree, -1, int(n * 2), [](int) {}));
+    for (std::size_t i = 0; i < n; ++i) {
+      const int *res = find(tree, in[i]);
+      ASSERT_TRUE(res);
+      ASSERT_EQ(in[i], *res);
+      ASSERT_FALSE(find(tree, in[i] + 1));
+    }
+
+    /* still a regular tree */
+    for (std::size_t i = 0; i < n; ++i) {
+      const int v = int(uniform_dist(r, 0, std::uint32_t(n * 2 + 1)));
+      if (v % 2 == 1) {
+        ASSERT_TRUE(insert(tree, v));
+      } else {
+        remove(tree, v);
+      }
+      ASSERT_TRUE(verify(tree));
+    }
+  }
+}
+
+TEST(btree_recTest, test_bulk_load) {
+  prng::xorshift32 r(1);
+  const double fills[] = {0.0, 0.5, 0.7, 1.0};
+  for (double fill : fills) {
+    btree_bulk_load<2>(r, fill);
+    btree_bulk_load<3>(r, fill);
+    btree_bulk_load<4>(r, fill);
+    btree_bulk_load<5>(r, fill);
+    btree_bulk_load<10>(r, fill);
+    btree_bulk_load<11>(r, fill);
+  }
+}
+
+TEST(btree_recTest, test_bulk_load_alloc_fail) {
+  constexpr std::size_t n = 300;
+  sp::DynamicArray<int> in(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    ASSERT_TRUE(insert(in, int(i)));
+  }
+
+  /* fails until the budget covers every node */
+  sp::LimitAllocatorState &state = sp::limit_allocator_state();
+  bool done = false;
+  for (std::size_t budget = 0; !done; ++budget) {
+    ASSERT_TRUE(budget <= n);
+    {
+      sp::rec::BTree<int, 3, sp::greater, sp::LimitAllocator> tree;
+      state.budget = budget;
+      done = bulk_load(tree, in.data(), in.data() + n);
+      if (done) {
+        ASSERT_TRUE(verify(tree));
+      } else {
+        ASSERT_EQ(nullptr, tree.root);
+        ASSERT_EQ(std::size_t(0), state.live);
+      }
+    }
+    ASSERT_EQ(std::size_t(0), state.live);
+  }
+  state.budget = ~std::size_t(0);
+}
+
+TEST(btree_recTest, bench_bulk_load) {
+  constexpr std::size_t n = 1024 * 1024;
+  constexpr std::size_t keys = 32;
+  std::uint32_t *const in = new std::uint32_t[n];
+  for (std::size_t i = 0; i < n; ++i) {
+    in[i] = std::uint32_t(i * 3);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  {
+    sp::rec::BTree<std::uint32_t, keys> tree;
+    for (std::size_t i = 0; i < n; ++i) {
+      insert(tree, in[i]);
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  const std::chrono::duration<double> insert_secs = end - start;
+
+  start = std::chrono::steady_clock::now();
+  {
+    sp::rec::BTree<std::uint32_t, keys> tree;
+    ASSERT_TRUE(bulk_load(tree, in, in + n));
+  }
+  end = std::chrono::steady_clock::now();
+  const std::chrono::duration<double> bulk_secs = end - start;
+
+  printf("%zu sorted values, insert: %.2fms, bulk_load: %.2fms\n", n,
+         insert_secs.count() * 1000, bulk_secs.count() * 1000);
+  delete[] in;
+}
+
+template <typename Tree>
+static double
+btree_bench_allocator(const std::uint32_t *in, std::size_t n) {
+  auto start = std::chrono::steady_clock::now();
+  {
+    Tree tree;
+    for (std::size_t i = 0; i < n; ++i) {
+      insert(tree, in[i]);
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  const std::chrono::duration<double> secs = end - start;
+  return secs.count() * 1000;
+}
+
+TEST(btree_recTest, bench_allocator) {
+  prng::xorshift32 r(1);
+  constexpr std::size_t n = 1024 * 512;
+  constexpr std::size_t keys = 8;
+  std::uint32_t *const in = new std::uint32_t[n];
+  for (std::size_t i = 0; i < n; ++i) {
+    in[i] = random(r);
+  }
+
+  using cmp = sp::greater;
+  const double def =
+      btree_bench_allocator<sp::rec::BTree<std::uint32_t, keys, cmp>>(in, n);
+  const double pooled = btree_bench_allocator<
+      sp::rec::BTree<std::uint32_t, keys, cmp, sp::StackPooledAllocator>>(in,
+                                                                          n);
+  const double slab = btree_bench_allocator<
+      sp::rec::BTree<std::uint32_t, keys, cmp, sp::SlabAllocator>>(in, n);
+
+  printf("%zu random inserts and destroy, allocator: %.2fms, "
+         "pooled: %.2fms, slab: %.2fms\n",
+         n, def, pooled, slab);
+  delete[] in;
+}
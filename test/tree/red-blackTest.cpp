@@ -1,3 +1,8 @@
+#include <chrono>
+#include <collection/Array.h>
+#include <memory/SlabAllocator.h>
+#include <memory/StackPooledAllocator.h>
+#include <test/LimitAllocator.h>
 #include <tree/red-black.h>
 #include "gtest/gtest.h"
 #include <random>
@@ -211,3 +216,134 @@ TEST(red_blackTest, test3) {
   }
 
 }
+
+/* the number of BLACK nodes on every path to a leaf, 0 if they differ */
+static std::size_t
+rb_black_height(const rb::Node<int> *tree) {
+  if (tree == nullptr) {
+    return 1;
+  }
+
+  const std::size_t left = rb_black_height(tree->left);
+  const std::size_t right = rb_black_height(tree->right);
+  if (left == 0 || left != right) {
+    return 0;
+  }
+
+  return left + (tree->colour == rb::Colour::BLACK ? 1 : 0);
+}
+
+TEST(red_blackTest, test_bulk_load) {
+  for (int n = 0; n < 300; ++n) {
+    sp::DynamicArray<int> in(std::size_t(n) + 1);
+    for (int i = 0; i < n; ++i) {
+      ASSERT_TRUE(insert(in, i * 2));
+    }
+
+    rb::Tree<int> tree;
+    ASSERT_TRUE(bulk_load(tree, in.data(), in.data() + n));
+    ASSERT_TRUE(rb::verify(tree));
+    ASSERT_TRUE(rb_black_height(tree.root) > 0);
+    for (int i = 0; i < n; ++i) {
+      const int *res = find(tree, i * 2);
+      ASSERT_TRUE(res);
+      ASSERT_EQ(i * 2, *res);
+      ASSERT_FALSE(find(tree, i * 2 + 1));
+    }
+    if (n > 0) {
+      ASSERT_FALSE(bulk_load(tree, in.data(), in.data() + n));
+    }
+
+    /* still a regular tree */
+    for (int i = 0; i < n; ++i) {
+      ASSERT_TRUE(std::get<1>(insert(tree, i * 2 + 1)));
+      ASSERT_TRUE(rb::verify(tree));
+      ASSERT_TRUE(rb_black_height(tree.root) > 0);
+    }
+  }
+}
+
+TEST(red_blackTest, test_bulk_load_alloc_fail) {
+  constexpr std::size_t n = 100;
+  sp::DynamicArray<int> in(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    ASSERT_TRUE(insert(in, int(i)));
+  }
+
+  sp::LimitAllocatorState &state = sp::limit_allocator_state();
+  for (std::size_t budget = 0; budget <= n; ++budget) {
+    {
+      rb::Tree<int, sp::greater, sp::LimitAllocator> tree;
+      state.budget = budget;
+      const bool res = bulk_load(tree, in.data(), in.data() + n);
+      ASSERT_EQ(budget == n, res);
+      if (res) {
+        ASSERT_TRUE(rb::verify(tree));
+      } else {
+        ASSERT_EQ(nullptr, tree.root);
+        ASSERT_EQ(std::size_t(0), state.live);
+      }
+    }
+    ASSERT_EQ(std::size_t(0), state.live);
+  }
+  state.budget = ~std::size_t(0);
+}
+
+TEST(red_blackTest, bench_bulk_load) {
+  constexpr int n = 1024 * 256;
+  sp::DynamicArray<int> in(n);
+  for (int i = 0; i < n; ++i) {
+    insert(in, i);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  {
+    rb::Tree<int> tree;
+    for (int i = 0; i < n; ++i) {
+      insert(tree, in[std::size_t(i)]);
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  const std::chrono::duration<double> insert_secs = end - start;
+
+  start = std::chrono::steady_clock::now();
+  {
+    rb::Tree<int> tree;
+    ASSERT_TRUE(bulk_load(tree, in.data(), in.data() + n));
+  }
+  end = std::chrono::steady_clock::now();
+  const std::chrono::duration<double> bulk_secs = end - start;
+
+  printf("%d sorted values, insert: %.2fms, bulk_load: %.2fms\n", n,
+         insert_secs.count() * 1000, bulk_secs.count() * 1000);
+}
+
+template <template <typename> class A>
+static void
+rb_allocator() {
+  constexpr int n = 1000;
+  rb::Tree<int, sp::greater, A> tree;
+  for (int i = 0; i < n; ++i) {
+    ASSERT_TRUE(std::get<1>(insert(tree, (i * 37) % n)));
+  }
+  ASSERT_TRUE(rb::verify(tree));
+  ASSERT_TRUE(rb_black_height(tree.root) > 0);
+  for (int i = 0; i < n; ++i) {
+    const int *res = find(tree, i);
+    ASSERT_TRUE(res);
+    ASSERT_EQ(i, *res);
+  }
+
+  sp::DynamicArray<int> in(n);
+  for (int i = 0; i < n; ++i) {
+    ASSERT_TRUE(insert(in, i));
+  }
+  rb::Tree<int, sp::greater, A> bulk;
+  ASSERT_TRUE(bulk_load(bulk, in.data(), in.data() + n));
+  ASSERT_TRUE(rb::verify(bulk));
+}
+
+TEST(red_blackTest, test_allocator) {
+  rb_allocator<sp::StackPooledAllocator>();
+  rb_allocator<sp::SlabAllocator>();
+}
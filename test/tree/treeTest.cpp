@@ -63,13 +63,6 @@ a_insert(rb::Tree<T, C> &tree, A in) {
   ASSERT_TRUE(verify(tree));
 }
 
-template <typename T, typename C, std::size_t keys>
-bool
-verify(const sp::rec::BTree<T, keys, C> &) {
-  // dummy
-  return true;
-}
-
 template <typename T, typename C, std::size_t keys>
 void
 dump(const sp::rec::BTree<T, keys, C> &tree) {